@@ -1,8 +1,10 @@
 #include "Game/Activatable.hpp"
 
+#include "Game/Map.hpp"
+
 
 void Activatable::AppendToBuffer(BufferWriter& writer)
 {
 	Entity::AppendToBuffer(writer);
-	writer.AppendUint32(m_activatorUID.m_uid);
+	writer.AppendUint32(m_map->m_signalGraph.GetFirstActivatorForActivatable(m_uid).m_uid);
 }
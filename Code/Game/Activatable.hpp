@@ -23,7 +23,4 @@ public:
 	virtual void Render() const = 0;
 
 	virtual void AppendToBuffer(BufferWriter& writer) override;
-
-public:
-	EntityUID m_activatorUID = EntityUID::INVALID; // Serialized
 };
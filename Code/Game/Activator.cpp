@@ -1,8 +1,11 @@
 #include "Game/Activator.hpp"
 
+#include "Game/Map.hpp"
+
 
 void Activator::AppendToBuffer(BufferWriter& writer)
 {
 	Entity::AppendToBuffer(writer);
-	writer.AppendUint32(m_activatableUID.m_uid);
+	// Links live in the map signal graph, first link is kept here to preserve the v2 record layout
+	writer.AppendUint32(m_map->m_signalGraph.GetFirstActivatableForActivator(m_uid).m_uid);
 }
@@ -20,11 +20,7 @@ public:
 
 	virtual void Update() = 0;
 	virtual void Render() const = 0;
-	virtual void SetActivatable(EntityUID activatableUID) { m_activatableUID = activatableUID; }
 
 	virtual void AppendToBuffer(BufferWriter& writer) override;
-
-public:
-	EntityUID m_activatableUID = EntityUID::INVALID; // Serialized
 };
 
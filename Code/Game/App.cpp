@@ -2,11 +2,13 @@
 
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
 
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Core/Image.hpp"
 #include "Engine/Core/Time.hpp"
@@ -22,6 +24,9 @@
 #include "Engine/UI/UISystem.hpp"
 #include "Engine/VirtualReality/OpenXR.hpp"
 
+#include <functional>
+#include <math.h>
+
 
 App* g_app = nullptr;
 Renderer* g_renderer = nullptr;
@@ -31,6 +36,29 @@ ModelLoader* g_modelLoader = nullptr;
 RandomNumberGenerator* g_rng = nullptr;
 AudioSystem* g_audio = nullptr;
 
+static char const* const SETTINGS_FILE_PATH = "Saved/Settings.txt";
+static char const* const DESKTOP_MIRROR_MODE_NAMES[(int)DesktopMirrorMode::NUM] = { "off", "lefteye", "full" };
+
+
+static IntVec2 ComputeScreenTextureDimensions()
+{
+	// The desktop view fits the screen quad to its height, each eye sees the quad at half that size across a much wider fov
+	float stereoQuadHeightDegrees = 2.f * ConvertRadiansToDegrees(atanf(TanDegrees(Game::SCREEN_QUAD_HALF_FOV_DEGREES) * 0.5f));
+	float textureHeight = GetMax(DESKTOP_SCREEN_TEXTURE_HEIGHT, stereoQuadHeightDegrees * HMD_PIXELS_PER_DEGREE);
+	textureHeight = GetMin(textureHeight, SCREEN_SIZE_Y);
+	return IntVec2(RoundDownToInt(textureHeight * WINDOW_ASPECT), RoundDownToInt(textureHeight));
+}
+
+static IntVec2 ComputeLeftEyeMirrorDimensions()
+{
+	// The mirror is what the headset shows for that eye, so it keeps the eye's fov at the headset's pixel density
+	float fovLeft, fovRight, fovUp, fovDown;
+	g_openXR->GetFovsForEye(XREye::LEFT, fovLeft, fovRight, fovUp, fovDown);
+	float textureHeight = ConvertRadiansToDegrees(fovUp - fovDown) * HMD_PIXELS_PER_DEGREE;
+	float eyeAspect = (fovUp - fovDown) > 0.f ? (fovRight - fovLeft) / (fovUp - fovDown) : 0.f;
+	return IntVec2(RoundDownToInt(textureHeight * eyeAspect), RoundDownToInt(textureHeight));
+}
+
 
 bool App::HandleQuitRequested(EventArgs& args)
 {
@@ -65,6 +93,24 @@ bool App::ShowControls(EventArgs& args)
 	return true;
 }
 
+bool App::Event_SetDesktopMirrorMode(EventArgs& args)
+{
+	std::string modeName = args.GetValue("mode", std::string(""));
+	for (int modeIndex = 0; modeIndex < (int)DesktopMirrorMode::NUM; modeIndex++)
+	{
+		if (modeName == DESKTOP_MIRROR_MODE_NAMES[modeIndex])
+		{
+			g_app->m_desktopMirrorMode = DesktopMirrorMode(modeIndex);
+			g_app->SaveSettings();
+			g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Desktop mirror mode set to %s", DESKTOP_MIRROR_MODE_NAMES[modeIndex]), false);
+			return true;
+		}
+	}
+
+	g_console->AddLine(Rgba8::RED, Stringf("Desktop mirror mode is %s, use mode=off, mode=lefteye or mode=full", DESKTOP_MIRROR_MODE_NAMES[(int)g_app->m_desktopMirrorMode]), false);
+	return false;
+}
+
 App::App()
 {
 }
@@ -92,9 +138,11 @@ void App::Startup()
 	renderConfig.m_window = g_window;
 	g_renderer = new Renderer(renderConfig);
 
+	m_screenTextureDimensions = ComputeScreenTextureDimensions();
+
 	Camera devConsoleCamera;
 	devConsoleCamera.SetOrthoView(Vec2::ZERO, Vec2(WINDOW_ASPECT, 1.f));
-	devConsoleCamera.SetViewport(Vec2(0.f, 0.f), Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
+	devConsoleCamera.SetViewport(Vec2(0.f, 0.f), Vec2((float)m_screenTextureDimensions.x, (float)m_screenTextureDimensions.y));
 	DevConsoleConfig devConsoleConfig;
 	devConsoleConfig.m_camera = devConsoleCamera;
 	devConsoleConfig.m_consoleFontFilePathWithNoExtension = "Data/Images/SquirrelFixedFont";
@@ -138,7 +186,7 @@ void App::Startup()
 	uiSystemConfig.m_screenBoundsForVRScreen = AABB2(viewportTL, viewportTL + viewportDimensions);
 	Camera uiSystemCamera;
 	uiSystemCamera.SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
-	uiSystemCamera.SetViewport(Vec2(0.f, 0.f), Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
+	uiSystemCamera.SetViewport(Vec2(0.f, 0.f), Vec2((float)m_screenTextureDimensions.x, (float)m_screenTextureDimensions.y));
 	uiSystemConfig.m_camera = uiSystemCamera;
 	g_ui = new UISystem(uiSystemConfig);
 
@@ -149,11 +197,14 @@ void App::Startup()
 	g_modelLoader->Startup();
 	g_audio->Startup();
 
+	LoadSettings();
+
 	m_game = new Game();
 	InitializeCameras();
 
 	SubscribeEventCallbackFunction("Quit", HandleQuitRequested, "Exit the application");
 	SubscribeEventCallbackFunction("Controls", ShowControls, "Show controls");
+	SubscribeEventCallbackFunction("DesktopMirrorMode", Event_SetDesktopMirrorMode, "Choose what the desktop window shows while the HMD runs: mode=off, mode=lefteye or mode=full");
 
 	EventArgs emptyArgs;
 	FireEvent("Controls", emptyArgs);
@@ -176,30 +227,62 @@ void App::RunFrame()
 	Update();
 	double updateEndTimeSeconds = GetCurrentTimeSeconds();
 	double updateTime_ms = (updateEndTimeSeconds - updateStartTimeSeconds) * 1000.f;
-	DebugAddScreenText(Stringf("Update: %.0f ms", updateTime_ms), Vec2(48.f, 384.f), 192.f, Vec2(0.f, 0.f), 0.f);
+	AddDebugScreenText(Stringf("Update: %.0f ms", updateTime_ms), Vec2(48.f, 384.f), 192.f, Vec2(0.f, 0.f));
 
 	double renderStartTimeSecodns = GetCurrentTimeSeconds();
 	m_currentEye = XREye::NONE;
+
+	// Everything that does not depend on the view is built once here, each view below only binds its camera and replays it
+	m_game->ExtractRenderFrame();
+
 	g_renderer->BeginRenderForEye(XREye::NONE);
 
 	RenderCustomScreens();
 
-	g_renderer->BeginRenderEvent("Screen to Texture");
-	RenderScreen();
-	g_renderer->EndRenderEvent("Screen to Texture");
+	// The screen texture keeps its contents between frames, so it is only redrawn when something on it changed
+	UpdateScreenDirtyState();
+	if (m_isScreenDirty)
+	{
+		g_renderer->BeginRenderEvent("Screen to Texture");
+		RenderScreen();
+		g_renderer->EndRenderEvent("Screen to Texture");
+		m_isScreenDirty = false;
+	}
 
 	m_game->ClearScreen();
 	g_renderer->BeginRenderEvent("Desktop Single View");
-	Render();
+	if (IsDesktopSceneRendered())
+	{
+		Render();
+	}
+	else if (!IsLeftEyeMirrored())
+	{
+		RenderDesktopScreenOverlay();
+	}
 	g_renderer->EndRenderEvent("Desktop Single View");
 	
+	bool isLeftEyeMirrored = false;
 	if (g_openXR->IsInitialized())
 	{
+		isLeftEyeMirrored = IsLeftEyeMirrored() && CreateOrGetLeftEyeMirrorTexture();
+
 		m_currentEye = XREye::LEFT;
 		g_renderer->BeginRenderForEye(XREye::LEFT);
 		g_renderer->BeginRenderEvent("HMD Left Eye");
-		m_game->ClearScreen();
-		Render();
+		if (isLeftEyeMirrored)
+		{
+			// The eye is drawn once into a texture the game owns, then copied into the headset here and into the window below
+			g_renderer->SetRTV(m_leftEyeMirrorTexture);
+			m_game->ClearScreen();
+			Render();
+			g_renderer->BeginRenderForEye(XREye::LEFT);
+			RenderTextureToViewport(m_leftEyeMirrorTexture, Vec2::ZERO, Vec2(1.f, 1.f));
+		}
+		else
+		{
+			m_game->ClearScreen();
+			Render();
+		}
 		g_renderer->EndRenderEvent("HMD Left Eye");
 
 		m_currentEye = XREye::RIGHT;
@@ -209,6 +292,20 @@ void App::RunFrame()
 		Render();
 		g_renderer->EndRenderEvent("HMD Right Eye");
 	}
+
+	if (isLeftEyeMirrored)
+	{
+		m_currentEye = XREye::NONE;
+		g_renderer->BeginRenderForEye(XREye::NONE);
+		g_renderer->BeginRenderEvent("Desktop Left Eye Mirror");
+
+		// Mirroring fills the window height and keeps the eye's own aspect
+		float mirrorAspect = (float)m_leftEyeMirrorDimensions.x / (float)m_leftEyeMirrorDimensions.y;
+		float mirrorWidthFraction = GetMin(mirrorAspect / g_window->GetAspect(), 1.f);
+		RenderTextureToViewport(m_leftEyeMirrorTexture, Vec2((1.f - mirrorWidthFraction) * 0.5f, 0.f), Vec2(mirrorWidthFraction, 1.f));
+		RenderDesktopScreenOverlay();
+		g_renderer->EndRenderEvent("Desktop Left Eye Mirror");
+	}
 	double renderEndTimeSeconds = GetCurrentTimeSeconds();
 	renderTime_ms = (renderEndTimeSeconds - renderStartTimeSecodns) * 1000.f;
 
@@ -252,10 +349,53 @@ Camera const App::GetCurrentCamera() const
 	return m_worldCamera;
 }
 
+ViewFrustum const& App::GetDesktopFrustum() const
+{
+	if (m_currentEyeForScreen == XREye::LEFT)
+	{
+		return m_leftWorldFrustum;
+	}
+	else if (m_currentEyeForScreen == XREye::RIGHT)
+	{
+		return m_rightWorldFrustum;
+	}
+
+	return m_worldFrustum;
+}
+
+bool App::IsDesktopSceneRendered() const
+{
+	return !g_openXR->IsInitialized() || m_desktopMirrorMode == DesktopMirrorMode::FULL;
+}
+
+bool App::IsLeftEyeMirrored() const
+{
+	return g_openXR->IsInitialized() && m_desktopMirrorMode == DesktopMirrorMode::LEFT_EYE;
+}
+
+bool App::CreateOrGetLeftEyeMirrorTexture()
+{
+	if (m_leftEyeMirrorTexture)
+	{
+		return true;
+	}
+
+	// The eye fovs are only known once the headset reports its views, until then the left eye is drawn straight into its swapchain
+	IntVec2 mirrorDimensions = ComputeLeftEyeMirrorDimensions();
+	if (mirrorDimensions.x <= 0 || mirrorDimensions.y <= 0)
+	{
+		return false;
+	}
+
+	m_leftEyeMirrorDimensions = mirrorDimensions;
+	m_leftEyeMirrorTexture = g_renderer->CreateRenderTargetTexture("LeftEyeMirrorTexture", m_leftEyeMirrorDimensions);
+	return m_leftEyeMirrorTexture != nullptr;
+}
+
 void App::InitializeCameras()
 {
 	m_worldCamera.SetRenderBasis(Vec3::SKYWARD, Vec3::WEST, Vec3::NORTH);
-	m_worldCamera.SetPerspectiveView(WINDOW_ASPECT, 60.f, NEAR_PLANE_DISTANCE, FAR_PLANE_DISTANCE);
+	m_worldCamera.SetPerspectiveView(WINDOW_ASPECT, WORLD_CAMERA_FOV_DEGREES, NEAR_PLANE_DISTANCE, FAR_PLANE_DISTANCE);
 	m_worldCamera.SetTransform(Vec3::ZERO, EulerAngles::ZERO);
 	//m_worldCamera.SetViewport(Vec2(SCREEN_CENTER_X - SCREEN_SIZE_Y * WINDOW_ASPECT, 0.f), Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
 	m_worldCamera.SetNormalizedViewport(Vec2((g_window->GetAspect() - WINDOW_ASPECT) * 0.5f / g_window->GetAspect(), 0.f), Vec2(WINDOW_ASPECT / g_window->GetAspect(), 1.f));
@@ -265,8 +405,8 @@ void App::InitializeCameras()
 
 
 	m_screenCamera.SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
-	m_screenCamera.SetViewport(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
-	m_screenRTVTexture = g_renderer->CreateRenderTargetTexture("ScreenTexture", IntVec2(int(SCREEN_SIZE_Y * WINDOW_ASPECT), int(SCREEN_SIZE_Y)));
+	m_screenCamera.SetViewport(Vec2::ZERO, Vec2((float)m_screenTextureDimensions.x, (float)m_screenTextureDimensions.y));
+	m_screenRTVTexture = g_renderer->CreateRenderTargetTexture("ScreenTexture", m_screenTextureDimensions);
 
 	m_leftEyeCamera.SetRenderBasis(Vec3::GROUNDWARD, Vec3::WEST, Vec3::NORTH);
 	m_rightEyeCamera.SetRenderBasis(Vec3::GROUNDWARD, Vec3::WEST, Vec3::NORTH);
@@ -294,14 +434,50 @@ void App::Update()
 	HandleDevInput();
 	m_game->Update();
 
-	DebugAddScreenText(Stringf("FPS: %.0f", 1.f / Clock::GetSystemClock().GetDeltaSeconds()), Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT - 48.f, 0.f), 96.f, Vec2(1.f, 0.f), 0.f);
+	AddDebugScreenText(Stringf("FPS: %.0f", 1.f / Clock::GetSystemClock().GetDeltaSeconds()), Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT - 48.f, 0.f), 96.f, Vec2(1.f, 0.f));
+}
+
+void App::AddDebugScreenText(std::string const& text, Vec2 const& position, float size, Vec2 const& alignment)
+{
+	DebugAddScreenText(text, position, size, alignment, 0.f);
+
+	// Hidden debug text never reaches the screen texture, so only visible text can ask for a redraw
+	if (m_isDebugRenderVisible)
+	{
+		m_debugScreenTextHash = m_debugScreenTextHash * 31 + std::hash<std::string>()(text);
+	}
+}
+
+void App::UpdateScreenDirtyState()
+{
+	ScreenState screenState = m_game->GetScreenState();
+	if (screenState != m_lastScreenState)
+	{
+		m_lastScreenState = screenState;
+		m_isScreenDirty = true;
+	}
+
+	// Debug text is submitted again every frame, so the screen is only redrawn once what it says changes
+	if (m_debugScreenTextHash != m_lastDebugScreenTextHash)
+	{
+		m_lastDebugScreenTextHash = m_debugScreenTextHash;
+		m_isScreenDirty = true;
+	}
+	m_debugScreenTextHash = 0;
+
+	Vec2 cursorDelta = m_game->GetInputFrame().GetCursorClientDelta();
+	if (cursorDelta.x != 0.f || cursorDelta.y != 0.f || g_console->GetMode() != DevConsoleMode::HIDDEN)
+	{
+		m_isScreenDirty = true;
+	}
 }
 
 void App::Render() const
 {
+	Camera const desktopCamera = GetCurrentCamera();
 	if (m_currentEye == XREye::NONE)
 	{
-		g_renderer->BeginCamera(m_worldCamera);
+		g_renderer->BeginCamera(desktopCamera);
 	}
 	else if (m_currentEye == XREye::LEFT)
 	{
@@ -317,8 +493,8 @@ void App::Render() const
 
 	if (m_currentEye == XREye::NONE)
 	{
-		g_renderer->EndCamera(m_worldCamera);
-		DebugRenderWorld(m_worldCamera);
+		g_renderer->EndCamera(desktopCamera);
+		DebugRenderWorld(desktopCamera);
 	}
 	else if (m_currentEye == XREye::LEFT)
 	{
@@ -383,6 +559,35 @@ void App::RenderScreen() const
 	g_renderer->SetRTV();
 }
 
+void App::RenderDesktopScreenOverlay() const
+{
+	// The screen camera's viewport matches the screen texture, the window needs the same area the world camera covers
+	RenderTextureToViewport(m_screenRTVTexture, Vec2((g_window->GetAspect() - WINDOW_ASPECT) * 0.5f / g_window->GetAspect(), 0.f), Vec2(WINDOW_ASPECT / g_window->GetAspect(), 1.f));
+}
+
+void App::RenderTextureToViewport(Texture* texture, Vec2 const& normalizedViewportMins, Vec2 const& normalizedViewportDimensions) const
+{
+	// Draws the texture over the given part of whatever target is bound, blended so the screen texture's transparent areas keep the scene
+	std::vector<Vertex_PCU> quadVerts;
+	AddVertsForAABB2(quadVerts, AABB2(Vec2::ZERO, Vec2(1.f, 1.f)), Rgba8::WHITE);
+
+	Camera quadCamera;
+	quadCamera.SetOrthoView(Vec2::ZERO, Vec2(1.f, 1.f));
+	quadCamera.SetNormalizedViewport(normalizedViewportMins, normalizedViewportDimensions);
+
+	g_renderer->BeginCamera(quadCamera);
+	g_renderer->SetBlendMode(BlendMode::ALPHA);
+	g_renderer->SetDepthMode(DepthMode::DISABLED);
+	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_NONE);
+	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
+	g_renderer->SetSamplerMode(SamplerMode::BILINEAR_CLAMP);
+	g_renderer->SetModelConstants();
+	g_renderer->BindShader(nullptr);
+	g_renderer->BindTexture(texture);
+	g_renderer->DrawVertexArray(quadVerts);
+	g_renderer->EndCamera(quadCamera);
+}
+
 void App::RenderCustomScreens() const
 {
 	g_renderer->BeginRenderEvent("Custom Screens");
@@ -390,6 +595,44 @@ void App::RenderCustomScreens() const
 	g_renderer->EndRenderEvent("Custom Screens");
 }
 
+void App::LoadSettings()
+{
+	std::string settingsText;
+	if (FileReadToString(settingsText, SETTINGS_FILE_PATH) < 0)
+	{
+		return;
+	}
+
+	Strings settingsLines;
+	int numSettingsLines = SplitStringOnDelimiter(settingsLines, settingsText, '\n');
+	for (int lineIndex = 0; lineIndex < numSettingsLines; lineIndex++)
+	{
+		Strings keyValuePair;
+		if (SplitStringOnDelimiter(keyValuePair, settingsLines[lineIndex], '=') != 2)
+		{
+			continue;
+		}
+
+		if (keyValuePair[0] == "DesktopMirrorMode")
+		{
+			for (int modeIndex = 0; modeIndex < (int)DesktopMirrorMode::NUM; modeIndex++)
+			{
+				if (keyValuePair[1] == DESKTOP_MIRROR_MODE_NAMES[modeIndex])
+				{
+					m_desktopMirrorMode = DesktopMirrorMode(modeIndex);
+				}
+			}
+		}
+	}
+}
+
+void App::SaveSettings() const
+{
+	std::string settingsText = Stringf("DesktopMirrorMode=%s\n", DESKTOP_MIRROR_MODE_NAMES[(int)m_desktopMirrorMode]);
+	std::vector<uint8_t> buffer(settingsText.begin(), settingsText.end());
+	FileWriteBuffer(SETTINGS_FILE_PATH, buffer);
+}
+
 void App::HandleDevInput()
 {
 	if (g_console->GetMode() == DevConsoleMode::HIDDEN && g_window->HasFocus() && m_game->m_state == GameState::GAME && !g_input->IsKeyDown(KEYCODE_RMB))
@@ -409,6 +652,8 @@ void App::HandleDevInput()
 	if (g_input->WasKeyJustPressed(KEYCODE_F1))
 	{
 		FireEvent("DebugRenderToggle");
+		m_isDebugRenderVisible = !m_isDebugRenderVisible;
+		m_isScreenDirty = true;
 	}
 	if (g_input->WasKeyJustPressed(KEYCODE_F8))
 	{
@@ -424,6 +669,7 @@ void App::Shutdown()
 
 	g_audio->Shutdown();
 	g_ui->Shutdown();
+	InstancedModel::DestroyAll();
 	g_modelLoader->Shutdown();
 	g_openXR->Shutdown();
 	DebugRenderSystemShutdown();
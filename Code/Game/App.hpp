@@ -4,13 +4,28 @@
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/Models/Model.hpp"
 #include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Renderer/Camera.hpp"
 
+#include "Game/GameCommon.hpp"
+#include "Game/ViewFrustum.hpp"
+
 
 class Game;
 
+
+// What the desktop window shows while the HMD is running
+enum class DesktopMirrorMode
+{
+	OFF,
+	LEFT_EYE,
+	FULL,
+	NUM
+};
+
+
 class App
 {
 public:
@@ -27,9 +42,14 @@ public:
 
 	XREye				GetCurrentEye				() const;
 	Camera const		GetCurrentCamera			() const;
+	ViewFrustum const&	GetDesktopFrustum			() const;
+	bool				IsDesktopSceneRendered		() const;
+	bool				IsLeftEyeMirrored			() const;
+	void				AddDebugScreenText			(std::string const& text, Vec2 const& position, float size, Vec2 const& alignment);
 
 	static bool			HandleQuitRequested			(EventArgs& args);
 	static bool			ShowControls				(EventArgs& args);
+	static bool			Event_SetDesktopMirrorMode	(EventArgs& args);
 
 public:
 	Camera				m_worldCamera;
@@ -39,7 +59,19 @@ public:
 	Camera				m_leftEyeCamera;
 	Camera				m_rightEyeCamera;
 
+	ViewFrustum			m_worldFrustum;
+	ViewFrustum			m_leftWorldFrustum;
+	ViewFrustum			m_rightWorldFrustum;
+	ViewFrustum			m_leftEyeFrustum;
+	ViewFrustum			m_rightEyeFrustum;
+	ViewFrustum			m_frameFrustum;
+
 	Texture*			m_screenRTVTexture = nullptr;
+	IntVec2				m_screenTextureDimensions;
+	Texture*			m_leftEyeMirrorTexture = nullptr;
+	IntVec2				m_leftEyeMirrorDimensions;
+
+	DesktopMirrorMode	m_desktopMirrorMode			= DesktopMirrorMode::FULL;
 
 	Game* m_game = nullptr;
 
@@ -53,11 +85,25 @@ private:
 
 	void				RenderScreen				() const;
 	void				RenderCustomScreens			() const;
+	void				RenderDesktopScreenOverlay	() const;
+	void				RenderTextureToViewport		(Texture* texture, Vec2 const& normalizedViewportMins, Vec2 const& normalizedViewportDimensions) const;
+	bool				CreateOrGetLeftEyeMirrorTexture	();
 	void				HandleDevInput				();
 
+	void				UpdateScreenDirtyState		();
+
+	void				LoadSettings				();
+	void				SaveSettings				() const;
+
 private:
 	bool				m_isQuitting				= false;
 
 	XREye				m_currentEye				= XREye::NONE;
 	XREye				m_currentEyeForScreen		= XREye::NONE;
+
+	bool				m_isScreenDirty				= true;
+	ScreenState			m_lastScreenState;
+	bool				m_isDebugRenderVisible		= false;
+	size_t				m_debugScreenTextHash		= 0;
+	size_t				m_lastDebugScreenTextHash	= 0;
 };
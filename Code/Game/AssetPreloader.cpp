@@ -0,0 +1,288 @@
+#include "Game/AssetPreloader.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
+#include "Game/MapFile.hpp"
+#include "Game/MappedFile.hpp"
+
+#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Models/ModelLoader.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+#include <float.h>
+
+
+static constexpr size_t PREFETCH_PAGE_SIZE = 4096;
+
+
+static char const* GetPreloadAssetTypeName(PreloadAssetType type)
+{
+	switch (type)
+	{
+		case PreloadAssetType::SHADER:			return "Shader";
+		case PreloadAssetType::TEXTURE:			return "Texture";
+		case PreloadAssetType::SOUND:			return "Sound";
+		case PreloadAssetType::MODEL:			return "Model";
+		case PreloadAssetType::INSTANCED_MODEL:	return "InstancedModel";
+	}
+	return "Unknown";
+}
+
+AssetPreloader::~AssetPreloader()
+{
+	// Workers only touch files and their own asset, so they are simply waited for
+	m_nextAssetToPrepare = (int)m_assets.size();
+	for (int threadIndex = 0; threadIndex < (int)m_workerThreads.size(); threadIndex++)
+	{
+		m_workerThreads[threadIndex].join();
+	}
+	for (int assetIndex = 0; assetIndex < (int)m_assets.size(); assetIndex++)
+	{
+		delete m_assets[assetIndex].m_instancedModel;
+	}
+}
+
+void AssetPreloader::Start(std::string const& manifestFilePath)
+{
+	if (m_isStarted)
+	{
+		return;
+	}
+	m_isStarted = true;
+	if (m_startTimeSeconds == 0.0)
+	{
+		m_startTimeSeconds = GetCurrentTimeSeconds();
+	}
+
+	XmlDocument xmlDoc;
+	XmlResult result = xmlDoc.LoadFile(manifestFilePath.c_str());
+	if (result != XmlResult::XML_SUCCESS)
+	{
+		ERROR_AND_DIE(Stringf("Unable to open or read file \"%s\"", manifestFilePath.c_str()));
+	}
+	XmlElement const* rootElement = xmlDoc.RootElement();
+	if (!rootElement)
+	{
+		ERROR_AND_DIE(Stringf("XML file \"%s\" contains no XML element!", manifestFilePath.c_str()));
+	}
+
+	for (XmlElement const* assetElement = rootElement->FirstChildElement(); assetElement; assetElement = assetElement->NextSiblingElement())
+	{
+		PreloadAsset asset;
+		asset.m_path = ParseXmlAttribute(*assetElement, "path", asset.m_path);
+		GUARANTEE_OR_DIE(!asset.m_path.empty(), Stringf("Asset manifest entry \"%s\" has no path", assetElement->Name()));
+
+		std::string elementName = assetElement->Name();
+		if (elementName == "Shader")
+		{
+			asset.m_type = PreloadAssetType::SHADER;
+			asset.m_isVertexPCUTBN = ParseXmlAttribute(*assetElement, "vertexType", std::string("PCUTBN")) == "PCUTBN";
+		}
+		else if (elementName == "Texture")
+		{
+			asset.m_type = PreloadAssetType::TEXTURE;
+		}
+		else if (elementName == "Sound")
+		{
+			asset.m_type = PreloadAssetType::SOUND;
+			asset.m_is3D = ParseXmlAttribute(*assetElement, "is3D", false);
+		}
+		else if (elementName == "Model")
+		{
+			asset.m_type = ParseXmlAttribute(*assetElement, "instanced", true) ? PreloadAssetType::INSTANCED_MODEL : PreloadAssetType::MODEL;
+			Vec3 offset = ParseXmlAttribute(*assetElement, "offset", Vec3::ZERO);
+			asset.m_transform = Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, offset);
+		}
+		else
+		{
+			ERROR_AND_DIE(Stringf("Unknown asset manifest entry \"%s\"", elementName.c_str()));
+		}
+		m_assets.push_back(asset);
+	}
+
+	m_isAssetPrepared = std::vector<std::atomic<bool>>(m_assets.size());
+	for (int assetIndex = 0; assetIndex < (int)m_assets.size(); assetIndex++)
+	{
+		m_isAssetPrepared[assetIndex] = false;
+	}
+
+	// One core is left for the main thread, which keeps drawing the attract screen
+	int numWorkerThreads = GetMapDecodeThreadCount() - 1;
+	if (numWorkerThreads < 1)
+	{
+		numWorkerThreads = 1;
+	}
+	if (numWorkerThreads > (int)m_assets.size())
+	{
+		numWorkerThreads = (int)m_assets.size();
+	}
+	for (int threadIndex = 0; threadIndex < numWorkerThreads; threadIndex++)
+	{
+		m_workerThreads.push_back(std::thread(&AssetPreloader::PrepareAssets, this));
+	}
+}
+
+void AssetPreloader::Update()
+{
+	if (!m_isStarted || IsFinished())
+	{
+		return;
+	}
+
+	FinishPreparedAssets(GetCurrentTimeSeconds() + FRAME_BUDGET_SECONDS);
+}
+
+void AssetPreloader::FinishNow()
+{
+	if (!m_isStarted || IsFinished())
+	{
+		return;
+	}
+
+	// The main thread helps with whatever the workers have not claimed yet instead of only waiting
+	PrepareAssets();
+	while (!IsFinished())
+	{
+		FinishPreparedAssets(DBL_MAX);
+		if (!IsFinished())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool AssetPreloader::IsFinished() const
+{
+	return m_isStarted && m_numAssetsFinished == (int)m_assets.size();
+}
+
+void AssetPreloader::PrepareAssets()
+{
+	for (int assetIndex = m_nextAssetToPrepare++; assetIndex < (int)m_assets.size(); assetIndex = m_nextAssetToPrepare++)
+	{
+		double prepareStartTimeSeconds = GetCurrentTimeSeconds();
+		PrepareAsset(m_assets[assetIndex]);
+		m_assets[assetIndex].m_prepareSeconds = GetCurrentTimeSeconds() - prepareStartTimeSeconds;
+		m_isAssetPrepared[assetIndex] = true;
+	}
+}
+
+void AssetPreloader::PrepareAsset(PreloadAsset& asset) const
+{
+	if (asset.m_type == PreloadAssetType::INSTANCED_MODEL)
+	{
+		asset.m_instancedModel = InstancedModel::LoadWithoutVertexBuffers(asset.m_path + ".obj", asset.m_transform);
+		return;
+	}
+
+	// The engine loaders are not thread safe, so the worker only pulls the file into the OS cache for them
+	std::string filePath = asset.m_path;
+	if (asset.m_type == PreloadAssetType::SHADER)
+	{
+		filePath += ".hlsl";
+	}
+	else if (asset.m_type == PreloadAssetType::MODEL)
+	{
+		filePath += ".obj";
+	}
+
+	MappedFile mappedFile;
+	if (!mappedFile.Open(filePath))
+	{
+		return;
+	}
+
+	uint8_t const* data = mappedFile.GetData();
+	volatile uint8_t pageSum = 0;
+	for (size_t byteIndex = 0; byteIndex < mappedFile.GetSize(); byteIndex += PREFETCH_PAGE_SIZE)
+	{
+		pageSum += data[byteIndex];
+	}
+}
+
+void AssetPreloader::FinishAsset(PreloadAsset& asset) const
+{
+	switch (asset.m_type)
+	{
+		case PreloadAssetType::SHADER:
+		{
+			g_renderer->CreateOrGetShader(asset.m_path.c_str(), asset.m_isVertexPCUTBN ? VertexType::VERTEX_PCUTBN : VertexType::VERTEX_PCU);
+			break;
+		}
+		case PreloadAssetType::TEXTURE:
+		{
+			g_renderer->CreateOrGetTextureFromFile(asset.m_path.c_str());
+			break;
+		}
+		case PreloadAssetType::SOUND:
+		{
+			g_audio->CreateOrGetSound(asset.m_path, asset.m_is3D);
+			break;
+		}
+		case PreloadAssetType::MODEL:
+		{
+			g_modelLoader->CreateOrGetModelFromObj(asset.m_path.c_str(), asset.m_transform);
+			break;
+		}
+		case PreloadAssetType::INSTANCED_MODEL:
+		{
+			// Ownership of the decoded model passes to the instanced model cache, only its vertex buffers are created here
+			InstancedModel::CreateOrGetFromObj(asset.m_path + ".obj", asset.m_transform, asset.m_instancedModel);
+			asset.m_instancedModel = nullptr;
+			break;
+		}
+	}
+}
+
+void AssetPreloader::FinishPreparedAssets(double endTimeSeconds)
+{
+	// Assets are finished in whatever order the workers get them ready, at least one per call so loading always moves forward
+	for (int assetIndex = 0; assetIndex < (int)m_assets.size(); assetIndex++)
+	{
+		PreloadAsset& asset = m_assets[assetIndex];
+		if (asset.m_isFinished || !m_isAssetPrepared[assetIndex])
+		{
+			continue;
+		}
+
+		double finishStartTimeSeconds = GetCurrentTimeSeconds();
+		FinishAsset(asset);
+		double finishEndTimeSeconds = GetCurrentTimeSeconds();
+		asset.m_finishSeconds = finishEndTimeSeconds - finishStartTimeSeconds;
+		asset.m_isFinished = true;
+		m_numAssetsFinished++;
+
+		if (finishEndTimeSeconds >= endTimeSeconds)
+		{
+			break;
+		}
+	}
+
+	if (IsFinished())
+	{
+		for (int threadIndex = 0; threadIndex < (int)m_workerThreads.size(); threadIndex++)
+		{
+			m_workerThreads[threadIndex].join();
+		}
+		m_workerThreads.clear();
+
+		m_totalSeconds = GetCurrentTimeSeconds() - m_startTimeSeconds;
+		ReportTimings();
+	}
+}
+
+void AssetPreloader::ReportTimings() const
+{
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Startup finished in %.1f ms, %d assets preloaded", m_totalSeconds * 1000.0, (int)m_assets.size()), false);
+	for (int assetIndex = 0; assetIndex < (int)m_assets.size(); assetIndex++)
+	{
+		PreloadAsset const& asset = m_assets[assetIndex];
+		g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("  %-14s %7.2f ms worker %7.2f ms main  %s", GetPreloadAssetTypeName(asset.m_type), asset.m_prepareSeconds * 1000.0, asset.m_finishSeconds * 1000.0, asset.m_path.c_str()), false);
+	}
+}
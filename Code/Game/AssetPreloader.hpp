@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Engine/Math/Mat44.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class InstancedModel;
+
+
+enum class PreloadAssetType
+{
+	SHADER,
+	TEXTURE,
+	SOUND,
+	MODEL,
+	INSTANCED_MODEL
+};
+
+// One manifest entry, prepared on a worker thread and then finished on the main thread with the engine calls and GPU uploads
+struct PreloadAsset
+{
+public:
+	PreloadAssetType m_type = PreloadAssetType::TEXTURE;
+	std::string m_path = "";
+	Mat44 m_transform;
+	bool m_isVertexPCUTBN = true;
+	bool m_is3D = false;
+	bool m_isFinished = false;
+
+	// Written by the worker before the asset is marked prepared
+	InstancedModel* m_instancedModel = nullptr;
+	double m_prepareSeconds = 0.0;
+
+	double m_finishSeconds = 0.0;
+};
+
+
+// Loads every shader, texture, sound and model listed in the asset manifest while the attract screen is up
+// Workers read the files and decode meshes, the main thread finishes prepared assets within a frame budget
+class AssetPreloader
+{
+public:
+	~AssetPreloader();
+	AssetPreloader() = default;
+	AssetPreloader(AssetPreloader const& copy) = delete;
+	AssetPreloader& operator=(AssetPreloader const& copy) = delete;
+
+	void Start(std::string const& manifestFilePath);
+	void Update();
+	void FinishNow();
+	bool IsFinished() const;
+
+public:
+	static constexpr double FRAME_BUDGET_SECONDS = 0.004;
+
+	double m_startTimeSeconds = 0.0;
+	double m_totalSeconds = 0.0;
+
+private:
+	void PrepareAssets();
+	void PrepareAsset(PreloadAsset& asset) const;
+	void FinishAsset(PreloadAsset& asset) const;
+	void FinishPreparedAssets(double endTimeSeconds);
+	void ReportTimings() const;
+
+private:
+	std::vector<PreloadAsset> m_assets;
+	std::vector<std::atomic<bool>> m_isAssetPrepared;
+	std::atomic<int> m_nextAssetToPrepare = 0;
+	std::vector<std::thread> m_workerThreads;
+	int m_numAssetsFinished = 0;
+	bool m_isStarted = false;
+};
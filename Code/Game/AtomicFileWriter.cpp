@@ -0,0 +1,42 @@
+#include "Game/AtomicFileWriter.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+static constexpr size_t MAX_BYTES_PER_WRITE = 0x40000000;
+
+
+bool WriteFileAtomically(std::string const& filePath, std::vector<uint8_t> const& buffer)
+{
+	std::string tempFilePath = filePath + ".tmp";
+	HANDLE fileHandle = CreateFileA(tempFilePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	// WriteFile takes 32-bit sizes, so large buffers go out in pieces
+	bool isWritten = true;
+	size_t numBytesWritten = 0;
+	while (isWritten && numBytesWritten < buffer.size())
+	{
+		size_t numBytesLeft = buffer.size() - numBytesWritten;
+		DWORD numBytesToWrite = numBytesLeft > MAX_BYTES_PER_WRITE ? (DWORD)MAX_BYTES_PER_WRITE : (DWORD)numBytesLeft;
+		DWORD numBytesWrittenNow = 0;
+		isWritten = WriteFile(fileHandle, buffer.data() + numBytesWritten, numBytesToWrite, &numBytesWrittenNow, nullptr) && numBytesWrittenNow == numBytesToWrite;
+		numBytesWritten += numBytesWrittenNow;
+	}
+
+	// The rename is only safe once the data is on disk, otherwise a crash could leave the new name pointing at an empty file
+	isWritten = isWritten && FlushFileBuffers(fileHandle);
+	CloseHandle(fileHandle);
+
+	if (!isWritten || !MoveFileExA(tempFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		DeleteFileA(tempFilePath.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+// Writes the buffer to a temporary file next to filePath, flushes it to disk and only then renames it over filePath
+// A crash or a failed write leaves whatever was at filePath before untouched
+bool WriteFileAtomically(std::string const& filePath, std::vector<uint8_t> const& buffer);
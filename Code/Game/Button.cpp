@@ -1,13 +1,13 @@
 #include "Game/Button.hpp"
 
-#include "Game/Activatable.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
@@ -17,7 +17,7 @@
 Button::Button(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Activator(map, uid, position, orientation, scale, EntityType::BUTTON)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Activators/buttonSquare", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Activators/buttonSquare.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
 	m_localBounds = AABB3(Vec3(-0.25f, -0.25f, 0.f), Vec3(0.25f, 0.25f, 0.1f));
 	m_scale = MODEL_SCALE;
 }
@@ -26,27 +26,15 @@ void Button::Update()
 {
 	Entity::Update();
 
-	if (m_isPressed && !m_wasPressedLastFrame)
+	if (m_isPressed != m_wasPressedLastFrame)
 	{
-		Activatable* activatable = (Activatable*)(m_map->GetEntityFromUID(m_activatableUID));
-		if (activatable)
-		{
-			activatable->Activate();
-		}
-	}
-	else if (!m_isPressed && m_wasPressedLastFrame)
-	{
-		Activatable* activatable = (Activatable*)(m_map->GetEntityFromUID(m_activatableUID));
-		if (activatable)
-		{
-			activatable->Deactivate();
-		}
+		m_map->m_signalGraph.EmitSignal(m_uid, m_isPressed);
 	}
 
 	m_wasPressedLastFrame = m_isPressed;
 }
 
-void Button::Render() const
+void Button::Render(RenderQueue& queue) const
 {
 	Mat44 transform = Mat44::CreateTranslation3D(m_position);
 	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
@@ -55,18 +43,27 @@ void Button::Render() const
 	Mat44 knobTransform(transform);
 	knobTransform.AppendTranslation3D(Vec3(0.f, 0.f, m_isPressed ? -0.05f : 0.f));
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
+	RenderState state = m_map->GetDefaultRenderState();
+
+	m_model->SubmitSubMesh(queue, state, "buttonSquare", transform, GetColor());
+
+	m_model->SubmitSubMesh(queue, state, "knob", knobTransform, GetColor());
+}
+
+bool Button::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	if (!m_model)
+	{
+		return false;
+	}
 
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer("buttonSquare"), m_model->GetIndexBuffer("buttonSquare"), m_model->GetIndexCount("buttonSquare"));
+	Mat44 transform = GetModelMatrix();
+	Mat44 knobTransform(transform);
+	knobTransform.AppendTranslation3D(Vec3(0.f, 0.f, m_isPressed ? -0.05f : 0.f));
 
-	g_renderer->SetModelConstants(knobTransform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer("knob"), m_model->GetIndexBuffer("knob"), m_model->GetIndexCount("knob"));
+	renderer.AddInstance(m_model, "buttonSquare", transform, GetColor());
+	renderer.AddInstance(m_model, "knob", knobTransform, GetColor());
+	return true;
 }
 
 void Button::HandlePlayerInteraction()
@@ -89,8 +86,3 @@ void Button::ResetState()
 	m_isPressed = false;
 	m_wasPressedLastFrame = false;
 }
-
-void Button::SetActivatable(EntityUID activatableUID)
-{
-	m_activatableUID = activatableUID;
-}
@@ -19,12 +19,11 @@ public:
 	explicit Button(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const override;
 	virtual void HandlePlayerInteraction() override;
 	virtual void ResetState() override;
 
-	virtual void SetActivatable(EntityUID activatableUID) override;
-
 public:
 	bool m_isPressed = false;
 	mutable bool m_wasPressedLastFrame = false;
@@ -2,13 +2,12 @@
 
 #include "Game/GameCommon.hpp"
 #include "Game/Game.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
-#include "Game/GameMathUtils.hpp"
-
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 
@@ -16,7 +15,7 @@
 Coin::Coin(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Entity(map, uid, position, orientation, scale, EntityType::COIN)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Entities/coinGold", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Entities/coinGold.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
 	m_localBounds = AABB3(Vec3(-0.1f, -0.1f, 0.f), Vec3(0.1f, 0.1f, 1.f));
 	m_orientation.m_yawDegrees = g_rng->RollRandomFloatInRange(0.f, 360.f);
 }
@@ -32,11 +31,11 @@ void Coin::Update()
 
 	constexpr float ROTATION_SPEED = 25.f;
 
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_tickDeltaSeconds;
 	m_orientation.m_yawDegrees += ROTATION_SPEED * deltaSeconds;
 }
 
-void Coin::Render() const
+void Coin::Render(RenderQueue& queue) const
 {
 	if (m_isCollected)
 	{
@@ -47,26 +46,32 @@ void Coin::Render() const
 	transform.Append(this->m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
 	transform.AppendScaleUniform3D(m_scale);
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer(), m_model->GetIndexBuffer(), m_model->GetIndexCount());
+	RenderState state = m_map->GetDefaultRenderState();
+	m_model->Submit(queue, state, transform, GetColor());
 }
 
-void Coin::HandlePlayerInteraction()
+bool Coin::AddModelInstances(ModelInstanceRenderer& renderer) const
 {
 	if (m_isCollected)
+	{
+		return true;
+	}
+
+	return Entity::AddModelInstances(renderer);
+}
+
+void Coin::HandlePlayerInteraction()
+{
+}
+
+void Coin::HandleTriggerEvent(TriggerEventType type)
+{
+	if (type != TriggerEventType::ENTER || m_isCollected)
 	{
 		return;
 	}
 
-	Vec3 const& playerPawnPosition = m_map->m_game->m_player->m_pawn->m_position;
-	Vec3 playerPawnTop(playerPawnPosition + Vec3::SKYWARD * PlayerPawn::PLAYER_HEIGHT);
-	if (!m_map->m_game->m_player->m_pawn->m_hasWon && DoZCylinderAndZOBB3Overlap(playerPawnPosition, playerPawnTop, PlayerPawn::PLAYER_RADIUS, GetBounds()))
+	if (!m_map->m_game->m_player->m_pawn->m_hasWon)
 	{
 		m_map->m_coinsCollected++;
 		m_isCollected = true;
@@ -10,8 +10,10 @@ public:
 	explicit Coin(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const override;
 	virtual void HandlePlayerInteraction() override;
+	virtual void HandleTriggerEvent(TriggerEventType type) override;
 	virtual void ResetState() override;
 
 public:
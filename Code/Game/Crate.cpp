@@ -3,13 +3,13 @@
 #include "Game/GameCommon.hpp"
 #include "Game/Game.hpp"
 #include "Game/HandController.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
 #include "Game/GameMathUtils.hpp"
 
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 
@@ -17,7 +17,7 @@
 Crate::Crate(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Entity(map, uid, position, orientation, scale, EntityType::CRATE)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Entities/crate", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Entities/crate.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
 	m_localBounds = AABB3(Vec3(-0.25f, -0.25f, 0.f), Vec3(0.25f, 0.25f, 0.5f));
 }
 
@@ -30,10 +30,35 @@ void Crate::Update()
 		return;
 	}
 
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	if (m_isAsleep)
+	{
+		if (!HasSupportChanged())
+		{
+			return;
+		}
+		Wake();
+	}
+
+	float deltaSeconds = m_tickDeltaSeconds;
 
 	if (!m_isHeldInLeftHand && !m_isHeldInRightHand)
 	{
+		if (m_isGrounded && m_velocity.GetLengthSquared() < SLEEP_SPEED_THRESHOLD * SLEEP_SPEED_THRESHOLD)
+		{
+			m_numRestingTicks++;
+			if (m_numRestingTicks >= NUM_RESTING_TICKS_TO_SLEEP)
+			{
+				m_velocity = Vec3::ZERO;
+				m_acceleration = Vec3::ZERO;
+				Sleep();
+				return;
+			}
+		}
+		else
+		{
+			m_numRestingTicks = 0;
+		}
+
 		// Add force due to gravity
 		AddForce(Vec3::GROUNDWARD * GRAVITY * MASS);
 
@@ -61,20 +86,14 @@ void Crate::Update()
 	}
 }
 
-void Crate::Render() const
+void Crate::Render(RenderQueue& queue) const
 {
 	Mat44 transform = Mat44::CreateTranslation3D(m_position);
 	transform.Append(this->m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
 	transform.AppendScaleUniform3D(m_scale);
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer(), m_model->GetIndexBuffer(), m_model->GetIndexCount());
+	RenderState state = m_map->GetDefaultRenderState();
+	m_model->Submit(queue, state, transform, GetColor());
 }
 
 void Crate::HandlePlayerInteraction()
@@ -88,11 +107,13 @@ void Crate::HandlePlayerInteraction()
 		{
 			m_isHeldInLeftHand = true;
 			m_isGrounded = false;
+			Wake();
 		}
 		if (DoSphereAndOBB3Overlap(player->m_rightController->m_worldPosition, Player::CONTROLLER_RADIUS, GetBounds()) && player->m_rightController->GetController().WasGripJustPressed())
 		{
 			m_isHeldInRightHand = true;
 			m_isGrounded = false;
+			Wake();
 		}
 	}
 	else if (m_isHeldInLeftHand)
@@ -125,8 +146,11 @@ void Crate::HandlePlayerInteraction()
 	else
 	{
 		OBB3 bounds = GetBounds();
-		PushZOBB3OutOfFixedZCylinder(bounds, playerPawn->m_position, playerPawn->m_position + Vec3::SKYWARD * PlayerPawn::PLAYER_HEIGHT, PlayerPawn::PLAYER_RADIUS);
-		m_position = bounds.m_center + Vec3::GROUNDWARD * m_localBounds.GetDimensions().z * m_scale * 0.5f;
+		if (PushZOBB3OutOfFixedZCylinder(bounds, playerPawn->m_position, playerPawn->m_position + Vec3::SKYWARD * PlayerPawn::PLAYER_HEIGHT, PlayerPawn::PLAYER_RADIUS))
+		{
+			m_position = bounds.m_center + Vec3::GROUNDWARD * m_localBounds.GetDimensions().z * m_scale * 0.5f;
+			Wake();
+		}
 	}
 }
 
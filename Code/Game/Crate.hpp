@@ -10,7 +10,7 @@ public:
 	explicit Crate(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
 	virtual void HandlePlayerInteraction() override;
 	virtual void ResetState() override;
 
@@ -13,7 +13,7 @@ public:
 	explicit Door(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
 	virtual void HandlePlayerInteraction() override;
 	virtual void ResetState() override;
 
@@ -22,6 +22,6 @@ public:
 
 public:
 	bool m_isOpen = false;
-	Model* m_closedModel = nullptr;
-	Model* m_openModel = nullptr;
+	InstancedModel const* m_closedModel = nullptr;
+	InstancedModel const* m_openModel = nullptr;
 };
@@ -2,23 +2,29 @@
 
 #include "Game/HandController.hpp"
 #include "Game/Game.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/VirtualReality/OpenXR.hpp"
 
 
+static char const* ORC_PART_NAMES[(int)OrcPart::NUM] = { "body", "head", "arm-left", "arm-right", "leg-left", "leg-right" };
+
+
 Enemy_Orc::Enemy_Orc(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Entity(map, uid, position, orientation, scale, EntityType::ENEMY_ORC)
-	, m_walkAnimationTimer(&map->m_game->m_clock, 0.5f)
 	, m_lastKnownPlayerLocation(position)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Enemies/character-orc", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3(0.f, 0.f, -0.3f)));
-	m_walkAnimationTimer.Start();
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Enemies/character-orc.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3(0.f, 0.f, -0.3f)));
+	for (int partIndex = 0; partIndex < (int)OrcPart::NUM; partIndex++)
+	{
+		m_partSubMeshes[partIndex] = m_model->GetSubMesh(ORC_PART_NAMES[partIndex]);
+	}
 	m_localBounds = AABB3(Vec3(-0.2f, -0.2f, 0.f), Vec3(0.2f, 0.2f, 1.f));
 	m_scale = MODEL_SCALE;
 
@@ -31,7 +37,7 @@ void Enemy_Orc::Update()
 {
 	Entity::Update();
 
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_tickDeltaSeconds;
 
 	if (m_map->m_game->m_player->m_state != PlayerState::PLAY)
 	{
@@ -43,7 +49,18 @@ void Enemy_Orc::Update()
 	}
 
 	PlayerPawn* const& playerPawn = m_map->m_game->m_player->m_pawn;
-	if (GetDistanceXYSquared3D(m_position, playerPawn->m_position) < 25.f)
+	bool isPlayerInRange = GetDistanceXYSquared3D(m_position, playerPawn->m_position) < 25.f;
+
+	if (m_isAsleep)
+	{
+		if (!isPlayerInRange && !HasSupportChanged())
+		{
+			return;
+		}
+		Wake();
+	}
+
+	if (isPlayerInRange)
 	{
 		m_lastKnownPlayerLocation = playerPawn->m_position;
 		if (!m_wasPlayerInRangeLastFrame)
@@ -71,7 +88,7 @@ void Enemy_Orc::Update()
 
 	if (m_isHeldInLeftHand || m_isHeldInRightHand)
 	{
-		m_walkAnimationTimer.m_duration = 0.1f;
+		m_walkAnimationDuration = 0.1f;
 		m_isGrounded = false;
 
 		if (m_isHeldInLeftHand)
@@ -85,6 +102,23 @@ void Enemy_Orc::Update()
 	}
 	else
 	{
+		if (m_isGrounded && !isPlayerInRange && m_velocity.GetLengthSquared() < SLEEP_SPEED_THRESHOLD * SLEEP_SPEED_THRESHOLD)
+		{
+			m_numRestingTicks++;
+			if (m_numRestingTicks >= NUM_RESTING_TICKS_TO_SLEEP)
+			{
+				m_velocity = Vec3::ZERO;
+				m_acceleration = Vec3::ZERO;
+				m_walkAnimationDuration = 0.f;
+				Sleep();
+				return;
+			}
+		}
+		else
+		{
+			m_numRestingTicks = 0;
+		}
+
 		// Add force due to gravity
 		AddForce(Vec3::GROUNDWARD * GRAVITY * MASS);
 
@@ -101,11 +135,11 @@ void Enemy_Orc::Update()
 		float speed = m_velocity.GetLength();
 		if (speed == 0.f)
 		{
-			m_walkAnimationTimer.m_duration = 0.f;
+			m_walkAnimationDuration = 0.f;
 		}
 		else
 		{
-			m_walkAnimationTimer.m_duration = 1.f / m_velocity.GetLength() * 0.5f;
+			m_walkAnimationDuration = 1.f / m_velocity.GetLength() * 0.5f;
 		}
 
 		m_velocity += m_acceleration * deltaSeconds;
@@ -113,9 +147,11 @@ void Enemy_Orc::Update()
 		m_acceleration = Vec3::ZERO;
 	}
 
-	if (m_walkAnimationTimer.m_duration != 0.f && m_walkAnimationTimer.HasDurationElapsed())
+	// Stepped by the tick delta like the rest of the orc, so replays swap legs on the same ticks they were recorded on
+	m_walkAnimationSeconds += deltaSeconds;
+	if (m_walkAnimationDuration != 0.f && m_walkAnimationSeconds >= m_walkAnimationDuration)
 	{
-		m_walkAnimationTimer.Restart();
+		m_walkAnimationSeconds = 0.f;
 		m_animationLeg = m_animationLeg == AnimationLeg::LEFT ? AnimationLeg::RIGHT : AnimationLeg::LEFT;
 	}
 
@@ -125,61 +161,51 @@ void Enemy_Orc::Update()
 	}
 }
 
-void Enemy_Orc::Render() const
+void Enemy_Orc::Render(RenderQueue& queue) const
 {
 	if (m_isDead)
 	{
 		return;
 	}
 
-	float animationFraction = m_walkAnimationTimer.GetElapsedFraction();
-	if (m_animationLeg == AnimationLeg::RIGHT)
+	Mat44 partTransforms[(int)OrcPart::NUM];
+	GetPartTransforms(partTransforms);
+
+	RenderState state = m_map->GetDefaultRenderState();
+	for (int partIndex = 0; partIndex < (int)OrcPart::NUM; partIndex++)
 	{
-		animationFraction = 1.f - animationFraction;
+		InstancedSubMesh const* partSubMesh = m_partSubMeshes[partIndex];
+		if (partSubMesh && partSubMesh->m_vertexBuffer)
+		{
+			queue.SubmitVertexes(state, partTransforms[partIndex], GetColor(), partSubMesh->m_vertexBuffer, (int)partSubMesh->m_vertexes.size());
+		}
 	}
-	if (m_map->m_game->m_player->m_state != PlayerState::PLAY)
+}
+
+bool Enemy_Orc::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	if (m_isDead)
 	{
-		animationFraction = 0.f;
+		return true;
 	}
 
-	Mat44 transform = Mat44::CreateTranslation3D(m_position + Vec3::SKYWARD * 0.6f);
-	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
-	transform.AppendScaleUniform3D(m_scale);
-
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("body"), m_model->GetVertexCount("body"));
-
-	Mat44 headTransform = transform;
-	headTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -5.f, 5.f));
-	g_renderer->SetModelConstants(headTransform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("head"), m_model->GetVertexCount("head"));
-
-	Mat44 leftArmTransform = transform;
-	leftArmTransform.AppendXRotation(-20.f);
-	leftArmTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -15.f, 15.f));
-	g_renderer->SetModelConstants(leftArmTransform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("arm-left"), m_model->GetVertexCount("arm-left"));
-
-	Mat44 rightArmTransform = transform;
-	rightArmTransform.AppendXRotation(20.f);
-	rightArmTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, 15.f, -15.f));
-	g_renderer->SetModelConstants(rightArmTransform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("arm-right"), m_model->GetVertexCount("arm-right"));
-
-	Mat44 leftLegTransform = transform;
-	leftLegTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, 15.f, -15.f));
-	g_renderer->SetModelConstants(leftLegTransform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("leg-left"), m_model->GetVertexCount("leg-left"));
+	for (int partIndex = 0; partIndex < (int)OrcPart::NUM; partIndex++)
+	{
+		if (!m_partSubMeshes[partIndex] || !m_partSubMeshes[partIndex]->m_vertexBuffer)
+		{
+			return false;
+		}
+	}
 
-	Mat44 rightLegTransform = transform;
-	rightLegTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -15.f, 15.f));
-	g_renderer->SetModelConstants(rightLegTransform, GetColor());
-	g_renderer->DrawVertexBuffer(m_model->GetVertexBuffer("leg-right"), m_model->GetVertexCount("leg-right"));
+	// Every part of every orc lands in its part's instance group, so each part type costs one draw per batch instead of one per orc
+	Mat44 partTransforms[(int)OrcPart::NUM];
+	GetPartTransforms(partTransforms);
+	Rgba8 color = GetColor();
+	for (int partIndex = 0; partIndex < (int)OrcPart::NUM; partIndex++)
+	{
+		renderer.AddInstance(m_partSubMeshes[partIndex], partTransforms[partIndex], color);
+	}
+	return true;
 }
 
 void Enemy_Orc::HandlePlayerInteraction()
@@ -223,6 +249,7 @@ void Enemy_Orc::HandlePlayerInteraction()
 
 	if (DoZCylindersOverlap(playerPawn->m_position, playerPawn->m_position + Vec3::SKYWARD * PlayerPawn::PLAYER_HEIGHT, PlayerPawn::PLAYER_RADIUS, m_position, m_position + Vec3::SKYWARD * Enemy_Orc::HEIGHT, Enemy_Orc::RADIUS))
 	{
+		Wake();
 		playerPawn->m_health -= 1;
 		playerPawn->AddImpulse((playerPawn->m_position - m_position).GetXY().GetNormalized().ToVec3() * ATTACK_IMPULSE);
 		g_audio->StartSoundAt(m_attackSFX, m_position);
@@ -233,6 +260,7 @@ void Enemy_Orc::HandlePlayerInteraction()
 		if (!m_isHeldInRightHand && player->m_leftController->GetController().WasGripJustPressed())
 		{
 			m_isHeldInLeftHand = true;
+			Wake();
 		}
 
 		if (player->m_leftController->m_velocity.GetLengthSquared() > 16.f && player->m_leftController->GetController().GetGrip() && player->m_leftController->GetController().GetTrigger())
@@ -252,6 +280,7 @@ void Enemy_Orc::HandlePlayerInteraction()
 		if (!m_isHeldInLeftHand && player->m_rightController->GetController().WasGripJustPressed())
 		{
 			m_isHeldInRightHand = true;
+			Wake();
 		}
 
 		if (player->m_rightController->m_velocity.GetLengthSquared() > 16.f && player->m_rightController->GetController().GetGrip() && player->m_rightController->GetController().GetTrigger())
@@ -279,7 +308,8 @@ void Enemy_Orc::ResetState()
 	Entity::ResetState();
 	m_velocity = Vec3::ZERO;
 	m_acceleration = Vec3::ZERO;
-	m_walkAnimationTimer.m_duration = 0.5f;
+	m_walkAnimationDuration = 0.5f;
+	m_walkAnimationSeconds = 0.f;
 	m_animationLeg = AnimationLeg::LEFT;
 	m_isDead = false;
 	m_lastKnownPlayerLocation = m_position;
@@ -303,6 +333,46 @@ void Enemy_Orc::MoveInDirection(Vec3 const& direction)
 
 void Enemy_Orc::TurnToYaw(float goalYaw)
 {
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_tickDeltaSeconds;
 	m_orientation.m_yawDegrees = GetTurnedTowardDegrees(m_orientation.m_yawDegrees, goalYaw, TURN_RATE * deltaSeconds);
 }
+
+void Enemy_Orc::GetPartTransforms(Mat44* out_partTransforms) const
+{
+	float animationFraction = m_walkAnimationDuration != 0.f ? m_walkAnimationSeconds / m_walkAnimationDuration : 0.f;
+	if (m_animationLeg == AnimationLeg::RIGHT)
+	{
+		animationFraction = 1.f - animationFraction;
+	}
+	if (m_map->m_game->m_player->m_state != PlayerState::PLAY)
+	{
+		animationFraction = 0.f;
+	}
+
+	Mat44 transform = Mat44::CreateTranslation3D(m_position + Vec3::SKYWARD * 0.6f);
+	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
+	transform.AppendScaleUniform3D(m_scale);
+	out_partTransforms[(int)OrcPart::BODY] = transform;
+
+	Mat44& headTransform = out_partTransforms[(int)OrcPart::HEAD];
+	headTransform = transform;
+	headTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -5.f, 5.f));
+
+	Mat44& leftArmTransform = out_partTransforms[(int)OrcPart::ARM_LEFT];
+	leftArmTransform = transform;
+	leftArmTransform.AppendXRotation(-20.f);
+	leftArmTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -15.f, 15.f));
+
+	Mat44& rightArmTransform = out_partTransforms[(int)OrcPart::ARM_RIGHT];
+	rightArmTransform = transform;
+	rightArmTransform.AppendXRotation(20.f);
+	rightArmTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, 15.f, -15.f));
+
+	Mat44& leftLegTransform = out_partTransforms[(int)OrcPart::LEG_LEFT];
+	leftLegTransform = transform;
+	leftLegTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, 15.f, -15.f));
+
+	Mat44& rightLegTransform = out_partTransforms[(int)OrcPart::LEG_RIGHT];
+	rightLegTransform = transform;
+	rightLegTransform.AppendYRotation(RangeMap(animationFraction, 0.f, 1.f, -15.f, 15.f));
+}
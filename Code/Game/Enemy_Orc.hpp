@@ -11,6 +11,20 @@ enum class AnimationLeg
 	NUM,
 };
 
+enum class OrcPart
+{
+	BODY,
+	HEAD,
+	ARM_LEFT,
+	ARM_RIGHT,
+	LEG_LEFT,
+	LEG_RIGHT,
+	NUM
+};
+
+struct InstancedSubMesh;
+
+
 class Enemy_Orc : public Entity
 {
 public:
@@ -18,7 +32,8 @@ public:
 	Enemy_Orc(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const override;
 	virtual void HandlePlayerInteraction() override;
 	virtual void SaveEditorState() override;
 	virtual void ResetState() override;
@@ -27,6 +42,7 @@ public:
 	void AddImpulse(Vec3 const& impulse);
 	void MoveInDirection(Vec3 const& direction);
 	void TurnToYaw(float goalYaw);
+	void GetPartTransforms(Mat44* out_partTransforms) const;
 
 public:
 	static constexpr float AIR_DRAG = 0.1f;
@@ -44,7 +60,8 @@ public:
 
 	Vec3 m_velocity = Vec3::ZERO;
 	Vec3 m_acceleration = Vec3::ZERO;
-	Stopwatch m_walkAnimationTimer;
+	float m_walkAnimationDuration = 0.5f;
+	float m_walkAnimationSeconds = 0.f;
 	AnimationLeg m_animationLeg = AnimationLeg::LEFT;
 	bool m_isDead = false;
 	bool m_isGrounded = false;
@@ -56,4 +73,7 @@ public:
 	SoundID m_playerSensedSFX = MISSING_SOUND_ID;
 	SoundID m_attackSFX = MISSING_SOUND_ID;
 	SoundID m_dieSFX = MISSING_SOUND_ID;
+
+	// Resolved once so batching does not look parts up by name for every orc every frame
+	InstancedSubMesh const* m_partSubMeshes[(int)OrcPart::NUM] = {};
 };
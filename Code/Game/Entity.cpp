@@ -5,9 +5,13 @@
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Map.hpp"
+#include "Game/MapFile.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
 #include "Game/MovingPlatform.hpp"
 #include "Game/Player.hpp"
 
+#include "Game/GameMathUtils.hpp"
+
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/UI/UISystem.hpp"
@@ -30,7 +34,6 @@ Entity::Entity(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const&
 	, m_scale(scale)
 	, m_editorScale(scale)
 	, m_type(type)
-	, m_pulseTimer(&m_map->m_game->m_clock, 1.f)
 {
 	InitializeUI();
 }
@@ -202,6 +205,26 @@ void Entity::InitializeUI()
 			->SetBorderWidth(0.1f)
 			->SetClickEventName(Stringf("LinkEntity entity=%d", m_uid.m_uid));
 
+		if (IsActivatable())
+		{
+			m_combinatorButtonWidget = g_ui->CreateWidget(m_detailsWidget);
+			m_combinatorButtonWidget->SetText("Requires Any")
+				->SetPosition(Vec2(0.5f, 0.25f))
+				->SetDimensions(Vec2(0.8f, 0.04f))
+				->SetPivot(Vec2(0.5f, 0.5f))
+				->SetAlignment(Vec2(0.5f, 0.5f))
+				->SetBackgroundColor(PRIMARY_COLOR)
+				->SetHoverBackgroundColor(PRIMARY_COLOR_VARIANT_LIGHT)
+				->SetColor(SECONDARY_COLOR)
+				->SetHoverColor(SECONDARY_COLOR_VARIANT_LIGHT)
+				->SetFontSize(4.f)
+				->SetBorderColor(SECONDARY_COLOR)
+				->SetHoverBorderColor(SECONDARY_COLOR_VARIANT_LIGHT)
+				->SetBorderRadius(0.2f)
+				->SetBorderWidth(0.1f)
+				->SetClickEventName(Stringf("ToggleSignalCombinator entity=%d", m_uid.m_uid));
+		}
+
 		if (m_type == EntityType::MOVING_PLATFORM)
 		{
 			UIWidget* movementDirectionTextWidget = g_ui->CreateWidget(m_detailsWidget);
@@ -273,43 +296,66 @@ void Entity::InitializeUI()
 
 void Entity::Update()
 {
+	// Details are only visible for the selected entity
+	if (!m_isSelected)
+	{
+		return;
+	}
+
 	m_positionValuesWidget->SetText(Stringf("%.2f, %.2f, %.2f", m_position.x, m_position.y, m_position.z));
 	m_orientationValuesWidget->SetText(Stringf("%.2f", m_orientation.m_yawDegrees));
 	m_scaleValueWidget->SetText(Stringf("%.2f", m_scale));
 
-	if (m_map->m_game->m_player->m_linkingEntity != this && (m_type == EntityType::BUTTON || m_type == EntityType::LEVER))
+	if (m_map->m_game->m_player->m_linkingEntity != this && (IsInteractable() || IsActivatable()))
 	{
-		Activator* activator = (Activator*)this;
-		Entity* linkedEntity = m_map->GetEntityFromUID(activator->m_activatableUID);
-		if (linkedEntity)
+		std::vector<EntityUID> linkedEntityUIDs;
+		if (IsInteractable())
 		{
-			m_linkedEntityValueWidget->SetText(Stringf("%s (%#010x)", m_map->GetEntityNameFromType(linkedEntity->m_type).c_str(), linkedEntity->m_uid));
-			m_linkButtonWidget->SetText("Change");
+			m_map->m_signalGraph.GetActivatablesForActivator(m_uid, linkedEntityUIDs);
 		}
 		else
 		{
-			m_linkedEntityValueWidget->SetText(Stringf("None"));
-			m_linkButtonWidget->SetText("Link");
+			m_map->m_signalGraph.GetActivatorsForActivatable(m_uid, linkedEntityUIDs);
 		}
-	}
 
-	if (m_map->m_game->m_player->m_linkingEntity != this && (m_type == EntityType::DOOR || m_type == EntityType::MOVING_PLATFORM))
-	{
-		Activatable* activator = (Activatable*)this;
-		Entity* linkedEntity = m_map->GetEntityFromUID(activator->m_activatorUID);
-		if (linkedEntity)
+		Entity* linkedEntity = linkedEntityUIDs.empty() ? nullptr : m_map->GetEntityFromUID(linkedEntityUIDs[0]);
+		if (linkedEntity && linkedEntityUIDs.size() > 1)
+		{
+			m_linkedEntityValueWidget->SetText(Stringf("%s (%#010x) +%d", m_map->GetEntityNameFromType(linkedEntity->m_type).c_str(), linkedEntity->m_uid, (int)linkedEntityUIDs.size() - 1));
+		}
+		else if (linkedEntity)
 		{
 			m_linkedEntityValueWidget->SetText(Stringf("%s (%#010x)", m_map->GetEntityNameFromType(linkedEntity->m_type).c_str(), linkedEntity->m_uid));
-			m_linkButtonWidget->SetText("Change");
 		}
 		else
 		{
 			m_linkedEntityValueWidget->SetText(Stringf("None"));
-			m_linkButtonWidget->SetText("Link");
 		}
+		m_linkButtonWidget->SetText(linkedEntity ? "Add/Remove" : "Link");
+	}
+
+	if (IsActivatable())
+	{
+		SignalCombinator combinator = m_map->m_signalGraph.GetCombinator(m_uid);
+		m_combinatorButtonWidget->SetText(combinator == SignalCombinator::AND ? "Requires All" : "Requires Any");
 	}
 }
 
+void Entity::HandleTriggerEvent(TriggerEventType type)
+{
+	UNUSED(type);
+}
+
+bool Entity::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	if (!m_model)
+	{
+		return false;
+	}
+
+	return renderer.AddInstance(m_model, "", GetModelMatrix(), GetColor());
+}
+
 void Entity::AppendToBuffer(BufferWriter& writer)
 {
 	SaveEditorState();
@@ -321,6 +367,12 @@ void Entity::AppendToBuffer(BufferWriter& writer)
 	writer.AppendFloat(m_editorScale);
 }
 
+void Entity::AppendToMapFile(MapFileContents& contents)
+{
+	SaveEditorState();
+	contents.m_entities.push_back(GetMapRecord());
+}
+
 void Entity::SaveEditorState()
 {
 	m_editorPosition = m_position;
@@ -338,6 +390,9 @@ void Entity::ResetState()
 	m_isRightHovered = false;
 	m_isLeftHovered = false;
 	m_isSelected = false;
+	m_isAsleep = false;
+	m_numRestingTicks = 0;
+	m_supportUID = EntityUID::INVALID;
 }
 
 Vec3 const Entity::GetForwardNormal() const
@@ -363,6 +418,29 @@ OBB3 const Entity::GetBounds() const
 	return bounds;
 }
 
+AABB3 const Entity::ComputeRenderBounds() const
+{
+	// Collision bounds do not cover animated or offset parts such as the orc's limbs and the lever handle, so they are padded
+	AABB3 bounds = GetTransformedAABB3(m_localBounds, GetModelMatrix());
+	Vec3 padding = Vec3(1.f, 1.f, 1.f) * RENDER_BOUNDS_PADDING * m_scale;
+	return AABB3(bounds.m_mins - padding, bounds.m_maxs + padding);
+}
+
+MapEntityRecord const Entity::GetMapRecord() const
+{
+	MapEntityRecord record;
+	record.m_uid = m_uid.m_uid;
+	record.m_position[0] = m_editorPosition.x;
+	record.m_position[1] = m_editorPosition.y;
+	record.m_position[2] = m_editorPosition.z;
+	record.m_orientation[0] = m_editorOrientation.m_yawDegrees;
+	record.m_orientation[1] = m_editorOrientation.m_pitchDegrees;
+	record.m_orientation[2] = m_editorOrientation.m_rollDegrees;
+	record.m_scale = m_editorScale;
+	record.m_type = (uint8_t)m_type;
+	return record;
+}
+
 ArchiLeapRaycastResult3D Entity::Raycast(Vec3 const& rayStartPos, Vec3 const& fwdNormal, float maxDistance)
 {
 	RaycastResult3D raycastResult = RaycastVsOBB3(rayStartPos, fwdNormal, maxDistance, GetBounds());
@@ -387,9 +465,10 @@ Rgba8 Entity::GetColor() const
 		return Rgba8(0, 255, 255, 127);
 	}
 
-	if (!m_pulseTimer.IsStopped())
+	if (m_isPulsing)
 	{
-		return Interpolate(Rgba8::WHITE, SECONDARY_COLOR, 0.5f + 0.5f * sinf(2.f * m_pulseTimer.GetElapsedTime()));
+		float pulseSeconds = (float)(m_map->m_pulseSeconds - m_pulseStartSeconds);
+		return Interpolate(Rgba8::WHITE, SECONDARY_COLOR, 0.5f + 0.5f * sinf(2.f * pulseSeconds));
 	}
 	
 	return Rgba8::WHITE;
@@ -397,21 +476,37 @@ Rgba8 Entity::GetColor() const
 
 void Entity::SetMouseHovered(bool hovered)
 {
+	if (m_isMouseHovered != hovered)
+	{
+		m_map->m_tileChunks.OnEntityChanged(this);
+	}
 	m_isMouseHovered = hovered;
 }
 
 void Entity::SetRightHovered(bool hovered)
 {
+	if (m_isRightHovered != hovered)
+	{
+		m_map->m_tileChunks.OnEntityChanged(this);
+	}
 	m_isRightHovered = hovered;
 }
 
 void Entity::SetLeftHovered(bool hovered)
 {
+	if (m_isLeftHovered != hovered)
+	{
+		m_map->m_tileChunks.OnEntityChanged(this);
+	}
 	m_isLeftHovered = hovered;
 }
 
 void Entity::SetSelected(bool selected)
 {
+	if (m_isSelected != selected)
+	{
+		m_map->m_tileChunks.OnEntityChanged(this);
+	}
 	m_isSelected = selected;
 	m_detailsWidget->SetVisible(selected);
 	m_detailsWidget->SetFocus(selected);
@@ -426,3 +521,38 @@ bool Entity::IsInteractable() const
 {
 	return m_type == EntityType::BUTTON || m_type == EntityType::LEVER;
 }
+
+bool Entity::IsTrigger() const
+{
+	return m_type == EntityType::COIN || m_type == EntityType::FLAG;
+}
+
+void Entity::Sleep()
+{
+	Entity* support = m_map->GetEntityFromUID(m_supportUID);
+	if (!support)
+	{
+		m_numRestingTicks = 0;
+		return;
+	}
+
+	m_isAsleep = true;
+	m_supportPositionAtSleep = support->m_position;
+}
+
+void Entity::Wake()
+{
+	m_isAsleep = false;
+	m_numRestingTicks = 0;
+}
+
+bool Entity::HasSupportChanged() const
+{
+	Entity* support = m_map->GetEntityFromUID(m_supportUID);
+	if (!support)
+	{
+		return true;
+	}
+
+	return support->m_position != m_supportPositionAtSleep;
+}
@@ -6,10 +6,18 @@
 #include "Engine/Core/BufferWriter.hpp"
 #include "Engine/Core/Models/Model.hpp"
 #include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
 #include "Engine/Math/Vec3.hpp"
 
 
+class InstancedModel;
 class Map;
+class ModelInstanceRenderer;
+class RenderQueue;
+struct MapEntityRecord;
+struct MapFileContents;
+
+enum class TriggerEventType;
 
 
 class Entity
@@ -21,16 +29,21 @@ public:
 	virtual void InitializeUI();
 
 	virtual void Update();
-	virtual void Render() const = 0;
+	virtual void Render(RenderQueue& queue) const = 0;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const;
 	virtual void HandlePlayerInteraction() = 0;
+	virtual void HandleTriggerEvent(TriggerEventType type);
 
 	virtual void AppendToBuffer(BufferWriter& writer);
+	virtual void AppendToMapFile(MapFileContents& contents);
 	virtual void SaveEditorState();
 	virtual void ResetState();
 
 	Vec3 const GetForwardNormal() const;
 	Mat44 const GetModelMatrix() const;
 	OBB3 const GetBounds() const;
+	AABB3 const ComputeRenderBounds() const;
+	MapEntityRecord const GetMapRecord() const;
 
 	ArchiLeapRaycastResult3D Raycast(Vec3 const& rayStartPos, Vec3 const& fwdNormal, float maxDistance);
 	Rgba8 GetColor() const;
@@ -41,8 +54,17 @@ public:
 
 	bool IsActivatable() const;
 	bool IsInteractable() const;
+	bool IsTrigger() const;
+
+	void Sleep();
+	void Wake();
+	bool HasSupportChanged() const;
 
 public:
+	static constexpr float SLEEP_SPEED_THRESHOLD = 0.05f;
+	static constexpr int NUM_RESTING_TICKS_TO_SLEEP = 30;
+	static constexpr float RENDER_BOUNDS_PADDING = 0.5f;
+
 	Map* m_map = nullptr;
 	EntityUID m_uid = EntityUID::INVALID; // Serialized
 	Vec3 m_editorPosition = Vec3::ZERO; // Serialized
@@ -56,7 +78,7 @@ public:
 	bool m_isRightHovered = false;
 	bool m_isLeftHovered = false;
 	bool m_isSelected = false;
-	Model* m_model = nullptr;
+	InstancedModel const* m_model = nullptr;
 	AABB3 m_localBounds;
 	EntityType m_type = EntityType::NONE; // Serialized
 
@@ -66,10 +88,31 @@ public:
 	UIWidget* m_scaleValueWidget = nullptr;
 	UIWidget* m_linkedEntityValueWidget = nullptr;
 	UIWidget* m_linkButtonWidget = nullptr;
+	UIWidget* m_combinatorButtonWidget = nullptr;
 	UIWidget* m_movementDirButtonX = nullptr;
 	UIWidget* m_movementDirButtonY = nullptr;
 	UIWidget* m_movementDirButtonZ = nullptr;
 	//UIWidget* m_linkedEntityUIDWidget = nullptr;
 	
-	Stopwatch m_pulseTimer;
+	bool m_isPulsing = false;
+	double m_pulseStartSeconds = 0.0;
+
+	float m_tickDeltaSeconds = 0.f;
+	double m_lastTickSeconds = 0.0;
+	int m_lastTickFrame = -1;
+	int m_lastScheduledFrame = -1;
+	IntVec2 m_tickCell;
+
+	bool m_isAsleep = false;
+	int m_numRestingTicks = 0;
+	EntityUID m_supportUID = EntityUID::INVALID;
+	Vec3 m_supportPositionAtSleep = Vec3::ZERO;
+
+	// Cached by EntityCullingGrid, refreshed when the transform below no longer matches the entity's
+	AABB3 m_renderBounds;
+	Vec3 m_renderBoundsPosition = Vec3::ZERO;
+	EulerAngles m_renderBoundsOrientation = EulerAngles::ZERO;
+	float m_renderBoundsScale = 1.f;
+	long long m_cullingCellKey = 0;
+	bool m_isInCullingGrid = false;
 };
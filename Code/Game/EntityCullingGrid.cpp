@@ -0,0 +1,320 @@
+#include "Game/EntityCullingGrid.hpp"
+
+#include "Game/Entity.hpp"
+#include "Game/EntityTickScheduler.hpp"
+#include "Game/GameMathUtils.hpp"
+#include "Game/Map.hpp"
+#include "Game/Tile.hpp"
+#include "Game/TileChunkBaker.hpp"
+#include "Game/ViewFrustum.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+
+EntityCullingGrid::EntityCullingGrid(Map* map)
+	: m_map(map)
+{
+}
+
+void EntityCullingGrid::MarkDirty()
+{
+	m_isDirty = true;
+}
+
+void EntityCullingGrid::OnEntityAdded(Entity* entity)
+{
+	if (m_isDirty || !IsCulledIndividually(entity))
+	{
+		return;
+	}
+
+	InsertEntity(entity);
+	if (EntityTickScheduler::IsScheduledType(entity->m_type))
+	{
+		m_dynamicEntities.push_back(entity);
+	}
+}
+
+void EntityCullingGrid::OnEntityRemoved(Entity* entity)
+{
+	if (m_isDirty)
+	{
+		return;
+	}
+
+	if (entity->m_isInCullingGrid)
+	{
+		EraseEntity(entity);
+	}
+	for (int entityIndex = 0; entityIndex < (int)m_dynamicEntities.size(); entityIndex++)
+	{
+		if (m_dynamicEntities[entityIndex] == entity)
+		{
+			m_dynamicEntities[entityIndex] = m_dynamicEntities.back();
+			m_dynamicEntities.pop_back();
+			break;
+		}
+	}
+	for (int entityIndex = 0; entityIndex < (int)m_movedEntities.size(); entityIndex++)
+	{
+		if (m_movedEntities[entityIndex] == entity)
+		{
+			m_movedEntities[entityIndex] = m_movedEntities.back();
+			m_movedEntities.pop_back();
+			entityIndex--;
+		}
+	}
+}
+
+void EntityCullingGrid::OnEntityMoved(Entity* entity)
+{
+	if (m_isDirty || !entity)
+	{
+		return;
+	}
+
+	// Applied in Update, after the tile chunks have settled which tiles they bake
+	m_movedEntities.push_back(entity);
+}
+
+void EntityCullingGrid::Update()
+{
+	if (m_isDirty)
+	{
+		RebuildCells();
+	}
+
+	// Only scheduled entities move by themselves, everything else is reported by whatever moved it
+	for (int entityIndex = 0; entityIndex < (int)m_dynamicEntities.size(); entityIndex++)
+	{
+		RefreshEntity(m_dynamicEntities[entityIndex]);
+	}
+	for (int entityIndex = 0; entityIndex < (int)m_movedEntities.size(); entityIndex++)
+	{
+		UpdateMovedEntity(m_movedEntities[entityIndex]);
+	}
+	m_movedEntities.clear();
+
+	for (auto cellIter = m_cellsByKey.begin(); cellIter != m_cellsByKey.end(); ++cellIter)
+	{
+		CullingCell& cell = cellIter->second;
+		if (!cell.m_isBoundsDirty || cell.m_entities.empty())
+		{
+			continue;
+		}
+
+		cell.m_bounds = cell.m_entities[0]->m_renderBounds;
+		for (int entityIndex = 1; entityIndex < (int)cell.m_entities.size(); entityIndex++)
+		{
+			cell.m_bounds = GetUnionOfAABB3s(cell.m_bounds, cell.m_entities[entityIndex]->m_renderBounds);
+		}
+		cell.m_isBoundsDirty = false;
+	}
+}
+
+void EntityCullingGrid::CollectVisibleEntities(ViewFrustum const& frustum, std::vector<Entity*>& out_visibleEntities)
+{
+	m_numCellsTested = 0;
+	m_numEntitiesTested = 0;
+	m_numEntitiesDrawn = 0;
+	m_numEntitiesCulled = 0;
+
+	// Whole cells are accepted or rejected first, so entities are only tested one by one in cells the frustum edges pass through
+	for (auto cellIter = m_cellsByKey.begin(); cellIter != m_cellsByKey.end(); ++cellIter)
+	{
+		CullingCell const& cell = cellIter->second;
+		m_numCellsTested++;
+
+		FrustumTestResult cellResult = frustum.TestAABB3(cell.m_bounds);
+		if (cellResult == FrustumTestResult::OUTSIDE)
+		{
+			m_numEntitiesCulled += (int)cell.m_entities.size();
+			continue;
+		}
+
+		if (cellResult == FrustumTestResult::INSIDE)
+		{
+			out_visibleEntities.insert(out_visibleEntities.end(), cell.m_entities.begin(), cell.m_entities.end());
+			m_numEntitiesDrawn += (int)cell.m_entities.size();
+			continue;
+		}
+
+		for (int entityIndex = 0; entityIndex < (int)cell.m_entities.size(); entityIndex++)
+		{
+			Entity* entity = cell.m_entities[entityIndex];
+			m_numEntitiesTested++;
+			if (frustum.IsAABB3Visible(entity->m_renderBounds))
+			{
+				out_visibleEntities.push_back(entity);
+				m_numEntitiesDrawn++;
+			}
+			else
+			{
+				m_numEntitiesCulled++;
+			}
+		}
+	}
+}
+
+void EntityCullingGrid::CollectEntitiesInBounds(AABB3 const& bounds, std::vector<Entity*>& out_entities)
+{
+	if (m_isDirty)
+	{
+		RebuildCells();
+	}
+
+	// Entities are filed by the center of their render bounds, so the cells one step outside the query can still hold something reaching into it
+	IntVec2 minCell = GetCellForPosition(bounds.m_mins);
+	IntVec2 maxCell = GetCellForPosition(bounds.m_maxs);
+	for (int cellY = minCell.y - 1; cellY <= maxCell.y + 1; cellY++)
+	{
+		for (int cellX = minCell.x - 1; cellX <= maxCell.x + 1; cellX++)
+		{
+			auto cellIter = m_cellsByKey.find(GetCellKey(IntVec2(cellX, cellY)));
+			if (cellIter == m_cellsByKey.end())
+			{
+				continue;
+			}
+
+			std::vector<Entity*> const& cellEntities = cellIter->second.m_entities;
+			for (int entityIndex = 0; entityIndex < (int)cellEntities.size(); entityIndex++)
+			{
+				if (DoAABB3sOverlap(cellEntities[entityIndex]->m_renderBounds, bounds))
+				{
+					out_entities.push_back(cellEntities[entityIndex]);
+				}
+			}
+		}
+	}
+}
+
+bool EntityCullingGrid::IsCulledIndividually(Entity const* entity)
+{
+	// Tiles baked into a chunk are culled together with their chunk
+	if (TileChunkBaker::IsTileType(entity->m_type))
+	{
+		return !static_cast<Tile const*>(entity)->m_isInTileChunk;
+	}
+
+	return true;
+}
+
+void EntityCullingGrid::RebuildCells()
+{
+	m_cellsByKey.clear();
+	m_dynamicEntities.clear();
+	m_movedEntities.clear();
+
+	for (int entityIndex = 0; entityIndex < (int)m_map->m_entities.size(); entityIndex++)
+	{
+		Entity* entity = m_map->m_entities[entityIndex];
+		if (!entity)
+		{
+			continue;
+		}
+
+		entity->m_isInCullingGrid = false;
+		if (!IsCulledIndividually(entity))
+		{
+			continue;
+		}
+
+		InsertEntity(entity);
+		if (EntityTickScheduler::IsScheduledType(entity->m_type))
+		{
+			m_dynamicEntities.push_back(entity);
+		}
+	}
+
+	m_isDirty = false;
+}
+
+void EntityCullingGrid::RefreshEntity(Entity* entity)
+{
+	EulerAngles const& orientation = entity->m_orientation;
+	EulerAngles const& cachedOrientation = entity->m_renderBoundsOrientation;
+	bool isSameOrientation = orientation.m_yawDegrees == cachedOrientation.m_yawDegrees && orientation.m_pitchDegrees == cachedOrientation.m_pitchDegrees && orientation.m_rollDegrees == cachedOrientation.m_rollDegrees;
+	Vec3 const& position = entity->m_position;
+	Vec3 const& cachedPosition = entity->m_renderBoundsPosition;
+	bool isSamePosition = position.x == cachedPosition.x && position.y == cachedPosition.y && position.z == cachedPosition.z;
+	if (isSamePosition && isSameOrientation && entity->m_scale == entity->m_renderBoundsScale)
+	{
+		return;
+	}
+
+	EraseEntity(entity);
+	InsertEntity(entity);
+}
+
+void EntityCullingGrid::InsertEntity(Entity* entity)
+{
+	entity->m_renderBounds = entity->ComputeRenderBounds();
+	entity->m_renderBoundsPosition = entity->m_position;
+	entity->m_renderBoundsOrientation = entity->m_orientation;
+	entity->m_renderBoundsScale = entity->m_scale;
+	entity->m_cullingCellKey = GetCellKey(GetCellForPosition((entity->m_renderBounds.m_mins + entity->m_renderBounds.m_maxs) * 0.5f));
+	entity->m_isInCullingGrid = true;
+
+	CullingCell& cell = m_cellsByKey[entity->m_cullingCellKey];
+	cell.m_entities.push_back(entity);
+	cell.m_isBoundsDirty = true;
+}
+
+void EntityCullingGrid::EraseEntity(Entity* entity)
+{
+	entity->m_isInCullingGrid = false;
+
+	auto cellIter = m_cellsByKey.find(entity->m_cullingCellKey);
+	if (cellIter == m_cellsByKey.end())
+	{
+		return;
+	}
+
+	std::vector<Entity*>& cellEntities = cellIter->second.m_entities;
+	for (int entityIndex = 0; entityIndex < (int)cellEntities.size(); entityIndex++)
+	{
+		if (cellEntities[entityIndex] == entity)
+		{
+			cellEntities[entityIndex] = cellEntities.back();
+			cellEntities.pop_back();
+			break;
+		}
+	}
+
+	if (cellEntities.empty())
+	{
+		m_cellsByKey.erase(cellIter);
+	}
+	else
+	{
+		cellIter->second.m_isBoundsDirty = true;
+	}
+}
+
+void EntityCullingGrid::UpdateMovedEntity(Entity* entity)
+{
+	// Tiles can move in or out of a chunk while being edited
+	bool shouldBeInGrid = IsCulledIndividually(entity);
+	if (shouldBeInGrid && !entity->m_isInCullingGrid)
+	{
+		InsertEntity(entity);
+	}
+	else if (!shouldBeInGrid && entity->m_isInCullingGrid)
+	{
+		EraseEntity(entity);
+	}
+	else if (shouldBeInGrid)
+	{
+		RefreshEntity(entity);
+	}
+}
+
+IntVec2 EntityCullingGrid::GetCellForPosition(Vec3 const& position) const
+{
+	return IntVec2(RoundDownToInt(position.x / CELL_SIZE), RoundDownToInt(position.y / CELL_SIZE));
+}
+
+long long EntityCullingGrid::GetCellKey(IntVec2 const& cell)
+{
+	return ((long long)cell.x << 32) | (long long)(unsigned int)cell.y;
+}
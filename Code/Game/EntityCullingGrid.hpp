@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+
+class Entity;
+class Map;
+class ViewFrustum;
+
+
+struct CullingCell
+{
+public:
+	std::vector<Entity*> m_entities;
+	AABB3 m_bounds;
+	bool m_isBoundsDirty = true;
+};
+
+
+class EntityCullingGrid
+{
+public:
+	~EntityCullingGrid() = default;
+	EntityCullingGrid() = default;
+	explicit EntityCullingGrid(Map* map);
+
+	void MarkDirty();
+	void OnEntityAdded(Entity* entity);
+	void OnEntityRemoved(Entity* entity);
+	void OnEntityMoved(Entity* entity);
+	void Update();
+	void CollectVisibleEntities(ViewFrustum const& frustum, std::vector<Entity*>& out_visibleEntities);
+	void CollectEntitiesInBounds(AABB3 const& bounds, std::vector<Entity*>& out_entities);
+
+	static bool IsCulledIndividually(Entity const* entity);
+
+public:
+	static constexpr float CELL_SIZE = 16.f;
+
+	Map* m_map = nullptr;
+	int m_numCellsTested = 0;
+	int m_numEntitiesTested = 0;
+	int m_numEntitiesDrawn = 0;
+	int m_numEntitiesCulled = 0;
+
+private:
+	void RebuildCells();
+	void RefreshEntity(Entity* entity);
+	void InsertEntity(Entity* entity);
+	void EraseEntity(Entity* entity);
+	void UpdateMovedEntity(Entity* entity);
+	IntVec2 GetCellForPosition(Vec3 const& position) const;
+	static long long GetCellKey(IntVec2 const& cell);
+
+private:
+	std::unordered_map<long long, CullingCell> m_cellsByKey;
+	std::vector<Entity*> m_dynamicEntities;
+	std::vector<Entity*> m_movedEntities;
+	bool m_isDirty = true;
+};
@@ -0,0 +1,322 @@
+#include "Game/EntityTickScheduler.hpp"
+
+#include "Game/Entity.hpp"
+#include "Game/Map.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+
+EntityTickScheduler::EntityTickScheduler(Map* map)
+	: m_map(map)
+{
+}
+
+void EntityTickScheduler::OnEntityAdded(Entity* entity)
+{
+	if (m_isDirty || !entity)
+	{
+		return;
+	}
+
+	InsertEntity(entity);
+}
+
+void EntityTickScheduler::OnEntityRemoved(Entity* entity)
+{
+	if (m_isDirty || !entity)
+	{
+		return;
+	}
+
+	if (IsEveryFrameType(entity->m_type))
+	{
+		for (int entityIndex = 0; entityIndex < (int)m_everyFrameEntities.size(); entityIndex++)
+		{
+			if (m_everyFrameEntities[entityIndex] == entity)
+			{
+				m_everyFrameEntities[entityIndex] = m_everyFrameEntities.back();
+				m_everyFrameEntities.pop_back();
+				break;
+			}
+		}
+		return;
+	}
+	if (!IsScheduledType(entity->m_type))
+	{
+		return;
+	}
+
+	for (int entityIndex = 0; entityIndex < (int)m_scheduledEntities.size(); entityIndex++)
+	{
+		if (m_scheduledEntities[entityIndex] == entity)
+		{
+			m_scheduledEntities[entityIndex] = m_scheduledEntities.back();
+			m_scheduledEntities.pop_back();
+			break;
+		}
+	}
+
+	auto cellIter = m_entitiesByCell.find(GetCellKey(entity->m_tickCell));
+	if (cellIter == m_entitiesByCell.end())
+	{
+		return;
+	}
+
+	std::vector<Entity*>& cellEntities = cellIter->second;
+	for (int entityIndex = 0; entityIndex < (int)cellEntities.size(); entityIndex++)
+	{
+		if (cellEntities[entityIndex] == entity)
+		{
+			cellEntities[entityIndex] = cellEntities.back();
+			cellEntities.pop_back();
+			break;
+		}
+	}
+}
+
+void EntityTickScheduler::UpdateEveryFrameEntities()
+{
+	if (m_isDirty)
+	{
+		RebuildCells();
+	}
+
+	// Levers and buttons follow hands and signals wherever they are, everything else without a schedule has nothing to simulate
+	for (int entityIndex = 0; entityIndex < (int)m_everyFrameEntities.size(); entityIndex++)
+	{
+		m_everyFrameEntities[entityIndex]->Update();
+	}
+}
+
+void EntityTickScheduler::Update(float deltaSeconds, Vec3 const& referencePosition, bool useDistanceRates)
+{
+	if (m_isDirty)
+	{
+		RebuildCells();
+	}
+
+	m_frameIndex++;
+	m_totalSeconds += (double)deltaSeconds;
+	m_numEntitiesVisited = 0;
+	m_numEntitiesTicked = 0;
+
+	m_entitiesToTick.clear();
+
+	if (!useDistanceRates)
+	{
+		// Editor and menus tick everything at full rate so edits are reflected immediately
+		for (int entityIndex = 0; entityIndex < (int)m_scheduledEntities.size(); entityIndex++)
+		{
+			Entity* entity = m_scheduledEntities[entityIndex];
+			if (entity->m_lastScheduledFrame != m_frameIndex - 1)
+			{
+				entity->m_lastTickSeconds = m_totalSeconds - (double)deltaSeconds;
+			}
+			entity->m_lastScheduledFrame = m_frameIndex;
+			m_entitiesToTick.push_back(entity);
+		}
+	}
+	else
+	{
+		// Only cells within the outermost radius are visited, so the cost scales with the entities around the player and not with the size of the map
+		IntVec2 minCell = GetCellForPosition(referencePosition - Vec3(MINIMAL_RATE_RADIUS, MINIMAL_RATE_RADIUS, 0.f));
+		IntVec2 maxCell = GetCellForPosition(referencePosition + Vec3(MINIMAL_RATE_RADIUS, MINIMAL_RATE_RADIUS, 0.f));
+
+		for (int cellY = minCell.y; cellY <= maxCell.y; cellY++)
+		{
+			for (int cellX = minCell.x; cellX <= maxCell.x; cellX++)
+			{
+				auto cellIter = m_entitiesByCell.find(GetCellKey(IntVec2(cellX, cellY)));
+				if (cellIter == m_entitiesByCell.end())
+				{
+					continue;
+				}
+
+				std::vector<Entity*> const& cellEntities = cellIter->second;
+				for (int entityIndex = 0; entityIndex < (int)cellEntities.size(); entityIndex++)
+				{
+					Entity* entity = cellEntities[entityIndex];
+					m_numEntitiesVisited++;
+
+					TickRate tickRate = GetTickRateForDistanceSquared(GetDistanceSquared3D(entity->m_position, referencePosition), entity->m_type);
+					if (tickRate == TickRate::PAUSED)
+					{
+						continue;
+					}
+
+					if (entity->m_lastScheduledFrame != m_frameIndex - 1)
+					{
+						// Entity was paused last frame, so time spent out of range should not be handed to it
+						entity->m_lastTickSeconds = m_totalSeconds - (double)deltaSeconds;
+					}
+					entity->m_lastScheduledFrame = m_frameIndex;
+
+					// Stagger reduced rate entities across frames using their index so the work per frame stays even
+					int tickInterval = GetTickInterval(tickRate);
+					if ((m_frameIndex + (int)entity->m_uid.GetIndex()) % tickInterval != 0)
+					{
+						continue;
+					}
+
+					m_entitiesToTick.push_back(entity);
+				}
+			}
+		}
+	}
+
+	for (int entityIndex = 0; entityIndex < (int)m_entitiesToTick.size(); entityIndex++)
+	{
+		TickEntity(m_entitiesToTick[entityIndex]);
+	}
+	m_numEntitiesTicked = (int)m_entitiesToTick.size();
+}
+
+void EntityTickScheduler::MarkDirty()
+{
+	m_isDirty = true;
+}
+
+void EntityTickScheduler::Restart()
+{
+	// Frame staggering depends on the frame index, so replays have to start counting from the same place
+	m_frameIndex = 0;
+	m_totalSeconds = 0.0;
+	m_isDirty = true;
+}
+
+bool EntityTickScheduler::WasTickedThisFrame(Entity const* entity) const
+{
+	return entity->m_lastTickFrame == m_frameIndex;
+}
+
+bool EntityTickScheduler::IsScheduledType(EntityType type)
+{
+	return type == EntityType::COIN || type == EntityType::CRATE || type == EntityType::ENEMY_ORC || type == EntityType::MOVING_PLATFORM;
+}
+
+bool EntityTickScheduler::IsEveryFrameType(EntityType type)
+{
+	return type == EntityType::LEVER || type == EntityType::BUTTON;
+}
+
+bool EntityTickScheduler::IsPhysicsType(EntityType type)
+{
+	return type == EntityType::CRATE || type == EntityType::ENEMY_ORC;
+}
+
+TickRate EntityTickScheduler::GetTickRateForDistanceSquared(float distanceSquared, EntityType type)
+{
+	if (distanceSquared < FULL_RATE_RADIUS * FULL_RATE_RADIUS)
+	{
+		return TickRate::FULL;
+	}
+	if (distanceSquared < REDUCED_RATE_RADIUS * REDUCED_RATE_RADIUS)
+	{
+		return TickRate::REDUCED;
+	}
+	// Physics bodies integrate explicitly, so large accumulated steps would tunnel through tiles
+	if (IsPhysicsType(type))
+	{
+		return TickRate::PAUSED;
+	}
+	if (distanceSquared < MINIMAL_RATE_RADIUS * MINIMAL_RATE_RADIUS)
+	{
+		return TickRate::MINIMAL;
+	}
+
+	return TickRate::PAUSED;
+}
+
+int EntityTickScheduler::GetTickInterval(TickRate rate)
+{
+	switch (rate)
+	{
+		case TickRate::FULL:		return 1;
+		case TickRate::REDUCED:		return REDUCED_RATE_INTERVAL;
+		case TickRate::MINIMAL:		return MINIMAL_RATE_INTERVAL;
+	}
+
+	return 1;
+}
+
+void EntityTickScheduler::RebuildCells()
+{
+	m_entitiesByCell.clear();
+	m_scheduledEntities.clear();
+	m_everyFrameEntities.clear();
+
+	for (int entityIndex = 0; entityIndex < (int)m_map->m_entities.size(); entityIndex++)
+	{
+		Entity* entity = m_map->m_entities[entityIndex];
+		if (entity)
+		{
+			InsertEntity(entity);
+		}
+	}
+
+	m_isDirty = false;
+}
+
+void EntityTickScheduler::InsertEntity(Entity* entity)
+{
+	if (IsEveryFrameType(entity->m_type))
+	{
+		m_everyFrameEntities.push_back(entity);
+		return;
+	}
+	if (!IsScheduledType(entity->m_type))
+	{
+		return;
+	}
+
+	// Counts as scheduled on the frame before the next Update, so its first tick is handed a single frame of time
+	entity->m_tickCell = GetCellForPosition(entity->m_position);
+	entity->m_lastTickSeconds = m_totalSeconds;
+	entity->m_lastScheduledFrame = m_frameIndex;
+	m_scheduledEntities.push_back(entity);
+	m_entitiesByCell[GetCellKey(entity->m_tickCell)].push_back(entity);
+}
+
+void EntityTickScheduler::TickEntity(Entity* entity)
+{
+	entity->m_tickDeltaSeconds = (float)(m_totalSeconds - entity->m_lastTickSeconds);
+	entity->m_lastTickSeconds = m_totalSeconds;
+	entity->m_lastTickFrame = m_frameIndex;
+
+	entity->Update();
+
+	UpdateEntityCell(entity);
+}
+
+void EntityTickScheduler::UpdateEntityCell(Entity* entity)
+{
+	IntVec2 newCell = GetCellForPosition(entity->m_position);
+	if (newCell == entity->m_tickCell)
+	{
+		return;
+	}
+
+	std::vector<Entity*>& oldCellEntities = m_entitiesByCell[GetCellKey(entity->m_tickCell)];
+	for (int entityIndex = 0; entityIndex < (int)oldCellEntities.size(); entityIndex++)
+	{
+		if (oldCellEntities[entityIndex] == entity)
+		{
+			oldCellEntities[entityIndex] = oldCellEntities.back();
+			oldCellEntities.pop_back();
+			break;
+		}
+	}
+
+	entity->m_tickCell = newCell;
+	m_entitiesByCell[GetCellKey(newCell)].push_back(entity);
+}
+
+IntVec2 EntityTickScheduler::GetCellForPosition(Vec3 const& position) const
+{
+	return IntVec2(RoundDownToInt(position.x / CELL_SIZE), RoundDownToInt(position.y / CELL_SIZE));
+}
+
+long long EntityTickScheduler::GetCellKey(IntVec2 const& cell)
+{
+	return ((long long)cell.x << 32) | (long long)(unsigned int)cell.y;
+}
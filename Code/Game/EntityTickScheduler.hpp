@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+
+class Entity;
+class Map;
+
+
+enum class TickRate
+{
+	NONE = -1,
+	FULL,
+	REDUCED,
+	MINIMAL,
+	PAUSED,
+	NUM
+};
+
+
+class EntityTickScheduler
+{
+public:
+	~EntityTickScheduler() = default;
+	EntityTickScheduler() = default;
+	explicit EntityTickScheduler(Map* map);
+
+	void OnEntityAdded(Entity* entity);
+	void OnEntityRemoved(Entity* entity);
+	void UpdateEveryFrameEntities();
+	void Update(float deltaSeconds, Vec3 const& referencePosition, bool useDistanceRates);
+	void MarkDirty();
+	void Restart();
+	bool WasTickedThisFrame(Entity const* entity) const;
+
+	static bool IsScheduledType(EntityType type);
+	static bool IsEveryFrameType(EntityType type);
+	static bool IsPhysicsType(EntityType type);
+	static TickRate GetTickRateForDistanceSquared(float distanceSquared, EntityType type);
+	static int GetTickInterval(TickRate rate);
+
+public:
+	static constexpr float CELL_SIZE = 16.f;
+	static constexpr float FULL_RATE_RADIUS = 20.f;
+	static constexpr float REDUCED_RATE_RADIUS = 50.f;
+	static constexpr float MINIMAL_RATE_RADIUS = 100.f;
+	static constexpr int REDUCED_RATE_INTERVAL = 4;
+	static constexpr int MINIMAL_RATE_INTERVAL = 16;
+
+	Map* m_map = nullptr;
+	int m_frameIndex = 0;
+	double m_totalSeconds = 0.0;
+	bool m_isDirty = true;
+	int m_numEntitiesVisited = 0;
+	int m_numEntitiesTicked = 0;
+	std::vector<Entity*> m_scheduledEntities;
+	std::vector<Entity*> m_everyFrameEntities;
+
+private:
+	void RebuildCells();
+	void InsertEntity(Entity* entity);
+	void TickEntity(Entity* entity);
+	void UpdateEntityCell(Entity* entity);
+	IntVec2 GetCellForPosition(Vec3 const& position) const;
+	static long long GetCellKey(IntVec2 const& cell);
+
+private:
+	std::unordered_map<long long, std::vector<Entity*>> m_entitiesByCell;
+	std::vector<Entity*> m_entitiesToTick;
+};
@@ -1,9 +1,11 @@
 #include "Game/Game.hpp"
 
 #include "Game/App.hpp"
+#include "Game/Entity.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/HandController.hpp"
 #include "Game/Map.hpp"
+#include "Game/MapLoader.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 #include "Game/TileDefinition.hpp"
@@ -13,6 +15,7 @@
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/AABB3.hpp"
@@ -26,15 +29,22 @@
 #include "Engine/UI/UISystem.hpp"
 #include "Engine/VirtualReality/OpenXR.hpp"
 
+#include <functional>
+
 
 Game::~Game()
 {
+	delete m_mapLoader;
+	m_mapLoader = nullptr;
+
 	delete m_player;
 	m_player = nullptr;
 }
 
 Game::Game()
+	: m_inputTrace(this)
 {
+	m_assetPreloader.m_startTimeSeconds = GetCurrentTimeSeconds();
 	LoadAssets();
 	InitializeUI();
 
@@ -62,11 +72,15 @@ Game::Game()
 	SubscribeEventCallbackFunction("ToggleMapImage", Event_ToggleInGameMapImage, "Toggles the in-game map image");
 	SubscribeEventCallbackFunction("ConnectToPerforce", Event_ConnectToPerforce, "Connect to perforce");
 	SubscribeEventCallbackFunction("StartTutorial", Event_StartTutorial, "Starts the tutorial");
+	SubscribeEventCallbackFunction("TutorialTrigger", Event_TutorialTrigger, "Shows or hides tutorial text when the player enters or leaves a tutorial zone");
 }
 
 void Game::Update()
 {
-	float deltaSeconds = m_clock.GetDeltaSeconds();
+	m_inputTrace.BeginFrame(m_clock.GetDeltaSeconds());
+	m_assetPreloader.Update();
+
+	float deltaSeconds = GetDeltaSeconds();
 	m_timeInState += deltaSeconds;
 	m_player->Update();
 
@@ -82,14 +96,31 @@ void Game::Update()
 		case GameState::HOW_TO_PLAY:		UpdateHowToPlay();			break;
 		case GameState::CREDITS:			UpdateCredits();			break;
 		case GameState::MAP_SELECT:			UpdateMapSelect();			break;
+		case GameState::LOADING:			UpdateLoading();			break;
 		case GameState::GAME:				UpdateGame();				break;
 		case GameState::PAUSE:				UpdatePause();				break;
 		case GameState::LEVEL_COMPLETE:		UpdateLevelComplete();		break;
 	}
 
+	// Saves finish in the background, so they are picked up in every state the map is alive in
+	if (m_currentMap)
+	{
+		m_currentMap->UpdateSave();
+	}
+
 	HandleStateChange();
 }
 
+float Game::GetDeltaSeconds() const
+{
+	return m_inputTrace.GetFrame().m_deltaSeconds;
+}
+
+InputFrame const& Game::GetInputFrame() const
+{
+	return m_inputTrace.GetFrame();
+}
+
 void Game::FixedUpdate(float deltaSeconds)
 {
 	m_player->FixedUpdate(deltaSeconds);
@@ -101,6 +132,99 @@ void Game::ClearScreen()
 	g_renderer->ClearScreen(clearColor);
 }
 
+void Game::ExtractRenderFrame()
+{
+	// Static shapes are uploaded once, only the skybox transform follows the player
+	if (!m_skyboxGeometry.IsBuilt())
+	{
+		std::vector<Vertex_PCU> skyboxVerts;
+		Vec3 BLF = Vec3(-0.5f, 0.5f, -0.5f);
+		Vec3 BRF = Vec3(-0.5f, -0.5f, -0.5f);
+		Vec3 TRF = Vec3(-0.5f, -0.5f, 0.5f);
+		Vec3 TLF = Vec3(-0.5f, 0.5f, 0.5f);
+		Vec3 BLB = Vec3(0.5f, 0.5f, -0.5f);
+		Vec3 BRB = Vec3(0.5f, -0.5f, -0.5f);
+		Vec3 TRB = Vec3(0.5f, -0.5f, 0.5f);
+		Vec3 TLB = Vec3(0.5f, 0.5f, 0.5f);
+
+		AddVertsForGradientQuad3D(skyboxVerts, BRB, BLB, TLB, TRB, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // +X
+		AddVertsForGradientQuad3D(skyboxVerts, BLF, BRF, TRF, TLF, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // -X
+		AddVertsForGradientQuad3D(skyboxVerts, BLB, BLF, TLF, TLB, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // +Y
+		AddVertsForGradientQuad3D(skyboxVerts, BRF, BRB, TRB, TRF, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // -Y
+		AddVertsForQuad3D(skyboxVerts, TLF, TRF, TRB, TLB, AZIMUTH_COLOR); // +Z
+		AddVertsForQuad3D(skyboxVerts, BLB, BRB, BRF, BLF, HORIZON_COLOR); // -Z
+		m_skyboxGeometry.Upload(skyboxVerts);
+	}
+	m_skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::WEST * 0.5f);
+	m_skyboxTransform.AppendScaleUniform3D(100.f);
+
+	if (!m_desktopScreenQuadGeometry.IsBuilt())
+	{
+		std::vector<Vertex_PCU> screenQuadVerts;
+		// The eye buffers show the quad at half the height of the desktop view
+		float desktopQuadHeight = SCREEN_QUAD_DISTANCE * TanDegrees(SCREEN_QUAD_HALF_FOV_DEGREES);
+		float desktopQuadWidth = desktopQuadHeight * WINDOW_ASPECT;
+		AddVertsForQuad3D(screenQuadVerts, Vec3(0.f, desktopQuadWidth, -desktopQuadHeight), Vec3(0.f, -desktopQuadWidth, -desktopQuadHeight), Vec3(0.f, -desktopQuadWidth, desktopQuadHeight), Vec3(0.f, desktopQuadWidth, desktopQuadHeight), Rgba8::WHITE, AABB2(Vec2(1.f, 1.f), Vec2(0.f, 0.f)));
+		m_desktopScreenQuadGeometry.Upload(screenQuadVerts);
+
+		float stereoQuadHeight = desktopQuadHeight * 0.5f;
+		float stereoQuadWidth = stereoQuadHeight * WINDOW_ASPECT;
+		screenQuadVerts.clear();
+		AddVertsForQuad3D(screenQuadVerts, Vec3(0.f, stereoQuadWidth, -stereoQuadHeight), Vec3(0.f, -stereoQuadWidth, -stereoQuadHeight), Vec3(0.f, -stereoQuadWidth, stereoQuadHeight), Vec3(0.f, stereoQuadWidth, stereoQuadHeight), Rgba8::WHITE, AABB2(Vec2(1.f, 1.f), Vec2(0.f, 0.f)));
+		m_stereoScreenQuadGeometry.Upload(screenQuadVerts);
+	}
+
+	if (!m_reticleGeometry.IsBuilt())
+	{
+		std::vector<Vertex_PCU> reticleVerts;
+		AddVertsForDisc2D(reticleVerts, Vec2(SCREEN_CENTER_X, SCREEN_CENTER_Y), 5.f, Rgba8::RED, Vec2::ZERO, Vec2::ONE, 32);
+		m_reticleGeometry.Upload(reticleVerts);
+
+		std::vector<Vertex_PCU> imageVerts;
+		AABB2 screenBounds(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
+		AddVertsForAABB2(imageVerts, screenBounds.GetBoxAtUVs(Vec2(0.55f, 0.45f), Vec2(0.95f, 0.85f)), Rgba8::WHITE);
+		m_mapImageGeometry.Upload(imageVerts);
+	}
+
+	// The health bar is the only HUD shape that changes, and only when the health value does
+	if (m_player->m_pawn && m_player->m_pawn->m_health != m_healthBarGeometryHealth)
+	{
+		m_healthBarGeometryHealth = m_player->m_pawn->m_health;
+
+		std::vector<Vertex_PCU> healthBarVerts;
+		AABB2 healthBarBounds(Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT * 0.05f, SCREEN_SIZE_Y * 0.05f), Vec2(SCREEN_SIZE_Y * g_window->GetAspect() * 0.25f, SCREEN_SIZE_Y * 0.075f));
+		AddVertsForAABB2(healthBarVerts, healthBarBounds, Rgba8::RED);
+		AddVertsForAABB2(healthBarVerts, healthBarBounds.GetBoxAtUVs(Vec2::ZERO, Vec2((float)m_healthBarGeometryHealth / 100.f, 1.f)), Rgba8::GREEN);
+		AddVertsForLineSegment2D(healthBarVerts, healthBarBounds.m_mins, Vec2(healthBarBounds.m_maxs.x, healthBarBounds.m_mins.y), 2.f, PRIMARY_COLOR);
+		AddVertsForLineSegment2D(healthBarVerts, Vec2(healthBarBounds.m_maxs.x, healthBarBounds.m_mins.y), healthBarBounds.m_maxs, 2.f, PRIMARY_COLOR);
+		AddVertsForLineSegment2D(healthBarVerts, healthBarBounds.m_maxs, Vec2(healthBarBounds.m_mins.x, healthBarBounds.m_maxs.y), 2.f, PRIMARY_COLOR);
+		AddVertsForLineSegment2D(healthBarVerts, Vec2(healthBarBounds.m_mins.x, healthBarBounds.m_maxs.y), healthBarBounds.m_mins, 2.f, PRIMARY_COLOR);
+		m_healthBarGeometry.Upload(healthBarVerts);
+	}
+
+	// The loading bar only changes shape when the whole percentage does
+	if (m_state == GameState::LOADING && GetLoadingPercent() != m_loadingBarGeometryPercent)
+	{
+		m_loadingBarGeometryPercent = GetLoadingPercent();
+
+		std::vector<Vertex_PCU> loadingBarVerts;
+		AABB2 screenBounds(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
+		AABB2 loadingBarBounds = screenBounds.GetBoxAtUVs(Vec2(0.3f, 0.47f), Vec2(0.7f, 0.53f));
+		AddVertsForAABB2(loadingBarVerts, loadingBarBounds, PRIMARY_COLOR_VARIANT_DARK);
+		AddVertsForAABB2(loadingBarVerts, loadingBarBounds.GetBoxAtUVs(Vec2::ZERO, Vec2((float)m_loadingBarGeometryPercent / 100.f, 1.f)), SECONDARY_COLOR);
+		AddVertsForLineSegment2D(loadingBarVerts, loadingBarBounds.m_mins, Vec2(loadingBarBounds.m_maxs.x, loadingBarBounds.m_mins.y), 2.f, SECONDARY_COLOR_VARIANT_LIGHT);
+		AddVertsForLineSegment2D(loadingBarVerts, Vec2(loadingBarBounds.m_maxs.x, loadingBarBounds.m_mins.y), loadingBarBounds.m_maxs, 2.f, SECONDARY_COLOR_VARIANT_LIGHT);
+		AddVertsForLineSegment2D(loadingBarVerts, loadingBarBounds.m_maxs, Vec2(loadingBarBounds.m_mins.x, loadingBarBounds.m_maxs.y), 2.f, SECONDARY_COLOR_VARIANT_LIGHT);
+		AddVertsForLineSegment2D(loadingBarVerts, Vec2(loadingBarBounds.m_mins.x, loadingBarBounds.m_maxs.y), loadingBarBounds.m_mins, 2.f, SECONDARY_COLOR_VARIANT_LIGHT);
+		m_loadingBarGeometry.Upload(loadingBarVerts);
+	}
+
+	if (m_state == GameState::GAME && m_currentMap)
+	{
+		m_currentMap->ExtractRenderFrame();
+	}
+}
+
 void Game::Render() const
 {
 	RenderSkybox();
@@ -111,6 +235,7 @@ void Game::Render() const
 		case GameState::HOW_TO_PLAY:		RenderHowToPlay();			break;
 		case GameState::CREDITS:			RenderCredits();			break;
 		case GameState::MAP_SELECT:			RenderMapSelect();			break;
+		case GameState::LOADING:			RenderLoading();			break;
 		case GameState::GAME:				RenderGame();				break;
 		case GameState::PAUSE:				RenderPause();				break;
 		case GameState::LEVEL_COMPLETE:		RenderLevelComplete();		break;
@@ -132,6 +257,7 @@ void Game::RenderScreen() const
 		case GameState::HOW_TO_PLAY:		RenderScreenHowToPlay();		break;
 		case GameState::CREDITS:			RenderScreenCredits();			break;
 		case GameState::MAP_SELECT:			RenderScreenMapSelect();		break;
+		case GameState::LOADING:			RenderScreenLoading();			break;
 		case GameState::GAME:				RenderScreenGame();				break;
 		case GameState::PAUSE:				RenderScreenPause();			break;
 		case GameState::LEVEL_COMPLETE:		RenderScreenLevelComplete();	break;
@@ -153,7 +279,7 @@ ArchiLeapRaycastResult3D Game::RaycastVsScreen(Vec3 const& startPosition, Vec3 c
 	result.m_rayForwardNormal = fwdNormal;
 	result.m_rayMaxLength = maxDistance;
 
-	float quadHeight = SCREEN_QUAD_DISTANCE / TanDegrees(60.f) * 0.5f;
+	float quadHeight = SCREEN_QUAD_DISTANCE * TanDegrees(SCREEN_QUAD_HALF_FOV_DEGREES) * 0.5f;
 	float quadWidth = quadHeight * WINDOW_ASPECT;
 
 	Vec3 screenRight = m_screenBillboardMatrix.GetJBasis3D().GetNormalized() * (quadWidth);
@@ -200,6 +326,60 @@ ArchiLeapRaycastResult3D Game::RaycastVsScreen(Vec3 const& startPosition, Vec3 c
 	return result;
 }
 
+ScreenState Game::GetScreenState() const
+{
+	ScreenState screenState;
+	screenState.m_state = (int)m_state;
+	screenState.m_nextState = (int)m_nextState;
+	screenState.m_playerState = (int)m_player->m_state;
+	screenState.m_isMapImageVisible = m_isMapImageVisible;
+	screenState.m_showInstructions = m_showInstructions;
+	screenState.m_isStartPlayAtCameraPosition = m_player->m_isStartPlayAtCameraPosition;
+	screenState.m_activeTutorialVolumeID = m_activeTutorialVolumeID;
+	screenState.m_hoveredWidget = g_ui->GetLastHoveredWidget();
+	screenState.m_selectedEntity = m_player->m_selectedEntity;
+	screenState.m_linkingEntity = m_player->m_linkingEntity;
+	if (m_player->m_selectedEntity)
+	{
+		screenState.m_selectedEntityPosition = m_player->m_selectedEntity->m_position;
+		screenState.m_selectedEntityYawDegrees = m_player->m_selectedEntity->m_orientation.m_yawDegrees;
+		screenState.m_selectedEntityScale = m_player->m_selectedEntity->m_scale;
+	}
+	if (m_player->m_pawn)
+	{
+		screenState.m_health = m_player->m_pawn->m_health;
+	}
+	if (m_currentMap)
+	{
+		screenState.m_coinsCollected = m_currentMap->m_coinsCollected;
+		screenState.m_renderLinkLines = m_currentMap->m_renderLinkLines;
+	}
+	if (m_state == GameState::LOADING)
+	{
+		screenState.m_loadingPercent = GetLoadingPercent();
+	}
+	if (m_state == GameState::MAP_SELECT)
+	{
+		screenState.m_numSavedMapInfoWidgets = (int)m_savedMapInfoWidgets.size();
+		screenState.m_savedMapInfoStatsVersion = m_savedMapInfoStatsVersion;
+		screenState.m_savedMapsListWidget = m_savedMapsListWidget;
+	}
+	if (g_openXR && g_openXR->IsInitialized())
+	{
+		screenState.m_isLeftTriggerDown = m_player->m_leftController->GetController().GetTrigger() > 0.f;
+		screenState.m_isRightTriggerDown = m_player->m_rightController->GetController().GetTrigger() > 0.f;
+	}
+
+	// Text fields are folded into one hash, so typing is noticed without copying the text every frame
+	std::hash<std::string> hashText;
+	std::string const* inputTexts[] = { &m_mapNameInputField->m_text, &m_perforceUserTextInputFieldWidget->m_text, &m_perforceWorkspaceTextInputFieldWidget->m_text, &m_perforceServerTextInputFieldWidget->m_text };
+	for (int textIndex = 0; textIndex < 4; textIndex++)
+	{
+		screenState.m_inputTextHash = screenState.m_inputTextHash * 31 + hashText(*inputTexts[textIndex]);
+	}
+	return screenState;
+}
+
 bool Game::Event_Navigate(EventArgs& args)
 {
 	if (!g_app->m_game)
@@ -235,10 +415,12 @@ bool Game::Event_SetHowToPlayTab(EventArgs& args)
 void Game::LoadAssets()
 {
 	TileDefinition::CreateFromXml();
+
 	g_squirrelFont = g_renderer->CreateBitmapFromFile("Data/Images/SquirrelFixedFont");
 	m_gameLogoTexture = g_renderer->CreateOrGetTextureFromFile("Data/Images/ArchiLeap_Temp_Logo.png");
 
-	m_mapImageTexture = g_renderer->CreateOrGetTextureFromFile("Data/Images/LevelImage.jpg");
+	// Everything else the game uses is listed in the manifest and loaded in the background while the attract screen is up
+	m_assetPreloader.Start("Data/Definitions/AssetManifest.xml");
 }
 
 void Game::InitializeUI()
@@ -514,6 +696,18 @@ void Game::InitializeMapSelectUI()
 		->SetFocus(false)
 		->SetVisible(false)
 		->SetClickEventName(Stringf("Navigate target=%d", (int)GameState::PERFORCE));
+
+	m_mapLoadErrorTextWidget = g_ui->CreateWidget(m_mapSelectWidget);
+	m_mapLoadErrorTextWidget->SetText("")
+		->SetPosition(Vec2(0.5f, 0.05f))
+		->SetDimensions(Vec2(0.9f, 0.05f))
+		->SetPivot(Vec2(0.5f, 0.5f))
+		->SetAlignment(Vec2(0.5f, 0.5f))
+		->SetColor(Rgba8::RED)
+		->SetHoverColor(Rgba8::RED)
+		->SetFontSize(8.f)
+		->SetFocus(false)
+		->SetVisible(false);
 }
 
 void Game::InitializeHowToPlayUI()
@@ -1614,7 +1808,20 @@ void Game::UpdateMapSelect()
 		m_nextState = GameState::MENU;
 	}
 
-	if (g_openXR && g_openXR->IsInitialized())
+	// Maps synced, checked out or saved while the list is open show up without leaving the screen
+	m_mapCatalog.Update();
+	if (m_mapCatalog.HasDirectoryChanged() && m_mapCatalog.Refresh())
+	{
+		RebuildSavedMapsList();
+	}
+	if (m_savedMapInfoStatsVersion != m_mapCatalog.m_statsVersion)
+	{
+		m_savedMapInfoStatsVersion = m_mapCatalog.m_statsVersion;
+		UpdateSavedMapInfoTexts();
+	}
+	BuildSavedMapRows(NUM_SAVED_MAP_ROWS_PER_FRAME);
+
+	if (g_openXR && g_openXR->IsInitialized() && m_savedMapsListWidget)
 	{
 		VRController const& leftController = g_openXR->GetLeftController();
 		m_savedMapsListWidget->AddScroll(leftController.GetJoystick().GetPosition().y * 200.f * deltaSeconds);
@@ -1641,6 +1848,37 @@ void Game::UpdatePerforce()
 {
 }
 
+void Game::UpdateLoading()
+{
+	if (!m_mapLoader)
+	{
+		return;
+	}
+
+	m_mapLoader->Update();
+	if (m_mapLoader->IsFailed())
+	{
+		// A broken map file only costs the player this load, they are sent back to pick another map
+		g_console->AddLine(Rgba8::RED, Stringf("Failed to load map: %s", m_mapLoader->m_error.c_str()), false);
+		m_mapLoadErrorTextWidget->SetText(Stringf("Could not load map: %s", m_mapLoader->m_error.c_str()));
+		delete m_mapLoader;
+		m_mapLoader = nullptr;
+		m_nextState = GameState::MAP_SELECT;
+		return;
+	}
+	if (!m_mapLoader->IsFinished())
+	{
+		return;
+	}
+
+	// The finished map is swapped in behind the sphere, the fade into GAME reveals it
+	m_currentMap = m_mapLoader->TakeMap();
+	m_currentMap->EnterGameAfterLoad(m_mapLoader->m_mapFileName);
+	delete m_mapLoader;
+	m_mapLoader = nullptr;
+	m_nextState = GameState::GAME;
+}
+
 void Game::UpdateGame()
 {
 	if (m_currentMap)
@@ -1655,21 +1893,6 @@ void Game::UpdateGame()
 		{
 			m_gamePlayerStateWidget->SetFocus(true)->SetBackgroundColor(SECONDARY_COLOR)->SetHoverBackgroundColor(SECONDARY_COLOR_VARIANT_LIGHT);
 		}
-
-		if (m_isTutorial)
-		{
-			UpdateTutorialInstructions("");
-
-			for (auto tutorialTriggerBoxMapIter = m_tutorialTriggerBoxesByText.begin(); tutorialTriggerBoxMapIter != m_tutorialTriggerBoxesByText.end(); ++tutorialTriggerBoxMapIter)
-			{
-				DebugAddWorldWireBox(tutorialTriggerBoxMapIter->second, 0.f, Rgba8::MAGENTA, Rgba8::MAGENTA, DebugRenderMode::USE_DEPTH);
-
-				if (DoZCylinderAndAABB3Overlap(m_player->m_pawn->m_position, m_player->m_pawn->m_position + Vec3::SKYWARD * PlayerPawn::PLAYER_HEIGHT, PlayerPawn::PLAYER_RADIUS, tutorialTriggerBoxMapIter->second))
-				{
-					UpdateTutorialInstructions(tutorialTriggerBoxMapIter->first);
-				}
-			}
-		}
 	}
 
 	if (m_player->m_state != PlayerState::PLAY)
@@ -1848,6 +2071,29 @@ void Game::RenderScreenPerforce() const
 {
 }
 
+void Game::RenderLoading() const
+{
+	// Nothing of the map is drawn until it is complete, the player only sees the inside of the transition sphere and the loading bar
+	RenderTransitionSphere(Mat44::CreateTranslation3D(m_player->m_position), Rgba8::BLACK);
+}
+
+void Game::RenderScreenLoading() const
+{
+	g_renderer->BeginRenderEvent("Loading Screen");
+	{
+		g_renderer->SetBlendMode(BlendMode::ALPHA);
+		g_renderer->SetDepthMode(DepthMode::DISABLED);
+		g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
+		g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
+		g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
+		g_renderer->SetModelConstants();
+		g_renderer->BindShader(nullptr);
+		g_renderer->BindTexture(nullptr);
+		m_loadingBarGeometry.Draw();
+	}
+	g_renderer->EndRenderEvent("Loading Screen");
+}
+
 void Game::RenderGame() const
 {
 	if (m_currentMap)
@@ -1868,9 +2114,6 @@ void Game::RenderScreenGame() const
 	{
 		if (!g_openXR || !g_openXR->IsInitialized())
 		{
-			Vec2 screenCenter(SCREEN_CENTER_X, SCREEN_CENTER_Y);
-			std::vector<Vertex_PCU> reticleVerts;
-			AddVertsForDisc2D(reticleVerts, screenCenter, 5.f, Rgba8::RED, Vec2::ZERO, Vec2::ONE, 32);
 			g_renderer->SetBlendMode(BlendMode::ALPHA);
 			g_renderer->SetDepthMode(DepthMode::DISABLED);
 			g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
@@ -1879,19 +2122,11 @@ void Game::RenderScreenGame() const
 			g_renderer->SetModelConstants();
 			g_renderer->BindShader(nullptr);
 			g_renderer->BindTexture(nullptr);
-			g_renderer->DrawVertexArray(reticleVerts);
+			m_reticleGeometry.Draw();
 		}
 
 		if (m_player->m_state == PlayerState::PLAY)
 		{
-			std::vector<Vertex_PCU> healthBarVerts;
-			AABB2 healthBarBounds(Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT * 0.05f, SCREEN_SIZE_Y * 0.05f), Vec2(SCREEN_SIZE_Y * g_window->GetAspect() * 0.25f, SCREEN_SIZE_Y * 0.075f));
-			AddVertsForAABB2(healthBarVerts, healthBarBounds, Rgba8::RED);
-			AddVertsForAABB2(healthBarVerts, healthBarBounds.GetBoxAtUVs(Vec2::ZERO, Vec2((float)m_player->m_pawn->m_health / 100.f, 1.f)), Rgba8::GREEN);
-			AddVertsForLineSegment2D(healthBarVerts, healthBarBounds.m_mins, Vec2(healthBarBounds.m_maxs.x, healthBarBounds.m_mins.y), 2.f, PRIMARY_COLOR);
-			AddVertsForLineSegment2D(healthBarVerts, Vec2(healthBarBounds.m_maxs.x, healthBarBounds.m_mins.y), healthBarBounds.m_maxs, 2.f, PRIMARY_COLOR);
-			AddVertsForLineSegment2D(healthBarVerts, healthBarBounds.m_maxs, Vec2(healthBarBounds.m_mins.x, healthBarBounds.m_maxs.y), 2.f, PRIMARY_COLOR);
-			AddVertsForLineSegment2D(healthBarVerts, Vec2(healthBarBounds.m_mins.x, healthBarBounds.m_maxs.y), healthBarBounds.m_mins, 2.f, PRIMARY_COLOR);
 			g_renderer->SetBlendMode(BlendMode::ALPHA);
 			g_renderer->SetDepthMode(DepthMode::DISABLED);
 			g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
@@ -1900,14 +2135,11 @@ void Game::RenderScreenGame() const
 			g_renderer->SetModelConstants();
 			g_renderer->BindShader(nullptr);
 			g_renderer->BindTexture(nullptr);
-			g_renderer->DrawVertexArray(healthBarVerts);
+			m_healthBarGeometry.Draw();
 		}
 
 		if (m_isMapImageVisible)
 		{
-			std::vector<Vertex_PCU> imageVerts;
-			AABB2 screenBounds(Vec2::ZERO, Vec2(SCREEN_SIZE_Y * WINDOW_ASPECT, SCREEN_SIZE_Y));
-			AddVertsForAABB2(imageVerts, screenBounds.GetBoxAtUVs(Vec2(0.55f, 0.45f), Vec2(0.95f, 0.85f)), Rgba8::WHITE);
 			g_renderer->SetBlendMode(BlendMode::ALPHA);
 			g_renderer->SetDepthMode(DepthMode::DISABLED);
 			g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
@@ -1916,7 +2148,7 @@ void Game::RenderScreenGame() const
 			g_renderer->SetModelConstants();
 			g_renderer->BindShader(nullptr);
 			g_renderer->BindTexture(m_mapImageTexture);
-			g_renderer->DrawVertexArray(imageVerts);
+			m_mapImageGeometry.Draw();
 		}
 	}
 	g_renderer->EndRenderEvent("Game Screen");
@@ -1967,14 +2199,7 @@ void Game::RenderWorldScreenQuad() const
 {
 	g_renderer->BeginRenderEvent("World Screen Quad");
 	{
-		// Math for rendering screen quad
 		XREye currentEye = g_app->GetCurrentEye();
-		float quadHeight = SCREEN_QUAD_DISTANCE * TanDegrees(30.f) * (currentEye == XREye::NONE ? 1.f : 0.5f);
-		float quadWidth = quadHeight * WINDOW_ASPECT;
-
-		// Render screen quad
-		std::vector<Vertex_PCU> screenVerts;
-		AddVertsForQuad3D(screenVerts, Vec3(0.f, quadWidth, -quadHeight), Vec3(0.f, -quadWidth, -quadHeight), Vec3(0.f, -quadWidth, quadHeight), Vec3(0.f, quadWidth, quadHeight), Rgba8::WHITE, AABB2(Vec2(1.f, 1.f), Vec2(0.f, 0.f)));
 		g_renderer->SetBlendMode(BlendMode::ALPHA);
 		g_renderer->SetDepthMode(DepthMode::DISABLED);
 		g_renderer->SetModelConstants(m_screenBillboardMatrix);
@@ -1983,7 +2208,14 @@ void Game::RenderWorldScreenQuad() const
 		g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
 		g_renderer->BindTexture(g_app->m_screenRTVTexture);
 		g_renderer->BindShader(nullptr);
-		g_renderer->DrawVertexArray(screenVerts);
+		if (currentEye == XREye::NONE)
+		{
+			m_desktopScreenQuadGeometry.Draw();
+		}
+		else
+		{
+			m_stereoScreenQuadGeometry.Draw();
+		}
 	}
 	g_renderer->EndRenderEvent("World Screen Quad");
 }
@@ -2022,18 +2254,7 @@ void Game::RenderOutroTransition() const
 
 	float t = EaseOutQuadratic(m_transitionTimer.GetElapsedFraction());
 	Rgba8 transitionColor = Interpolate(Rgba8::TRANSPARENT_BLACK, Rgba8::BLACK, t);
-	Mat44 modelTransform = Mat44::CreateTranslation3D(m_player->m_position);
-	g_renderer->BeginRenderEvent("Transition Sphere");
-	g_renderer->SetBlendMode(BlendMode::ALPHA);
-	g_renderer->SetDepthMode(DepthMode::DISABLED);
-	g_renderer->SetModelConstants(modelTransform, transitionColor);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_FRONT);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->BindShader(nullptr);
-	g_renderer->DrawVertexBuffer(m_transitionSphereVBO, (int)m_transitionSphereVBO->m_size / sizeof(Vertex_PCU));
-	g_renderer->EndRenderEvent("Transition Sphere");
+	RenderTransitionSphere(Mat44::CreateTranslation3D(m_player->m_position), transitionColor);
 }
 
 void Game::RenderIntroTransition() const
@@ -2045,11 +2266,15 @@ void Game::RenderIntroTransition() const
 
 	float t = EaseOutQuadratic(m_timeInState * 2.f);
 	Rgba8 transitionColor = Interpolate(Rgba8::BLACK, Rgba8::TRANSPARENT_BLACK, t);
-	Mat44 modelTransform = m_player->GetModelMatrix();
+	RenderTransitionSphere(m_player->GetModelMatrix(), transitionColor);
+}
+
+void Game::RenderTransitionSphere(Mat44 const& modelTransform, Rgba8 const& color) const
+{
 	g_renderer->BeginRenderEvent("Transition Sphere");
 	g_renderer->SetBlendMode(BlendMode::ALPHA);
 	g_renderer->SetDepthMode(DepthMode::DISABLED);
-	g_renderer->SetModelConstants(modelTransform, transitionColor);
+	g_renderer->SetModelConstants(modelTransform, color);
 	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_FRONT);
 	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
 	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
@@ -2080,6 +2305,7 @@ void Game::HandleStateChange()
 			case GameState::HOW_TO_PLAY:	ExitHowToPlay();		break;
 			case GameState::CREDITS:		ExitCredits();			break;
 			case GameState::PERFORCE:		ExitPerforce();			break;
+			case GameState::LOADING:		ExitLoading();			break;
 			case GameState::GAME:			ExitGame();				break;
 			case GameState::PAUSE:			ExitPause();			break;
 			case GameState::LEVEL_IMAGE:	ExitLevelImage();		break;
@@ -2097,6 +2323,7 @@ void Game::HandleStateChange()
 			case GameState::HOW_TO_PLAY:	EnterHowToPlay();		break;
 			case GameState::CREDITS:		EnterCredits();			break;
 			case GameState::PERFORCE:		EnterPerforce();		break;
+			case GameState::LOADING:		EnterLoading();			break;
 			case GameState::GAME:			EnterGame();			break;
 			case GameState::PAUSE:			EnterPause();			break;
 			case GameState::LEVEL_IMAGE:	EnterLevelImage();		break;
@@ -2136,63 +2363,94 @@ void Game::EnterMapSelect()
 {
 	m_mapSelectWidget->SetFocus(true);
 	m_mapSelectWidget->SetVisible(true);
+	m_mapLoadErrorTextWidget->SetVisible(!m_mapLoadErrorTextWidget->m_text.empty());
 
+	// Only maps that changed since the catalog was last written are read again, and that happens on the catalog's worker
+	m_mapCatalog.Refresh();
+	m_savedMapInfoStatsVersion = m_mapCatalog.m_statsVersion;
+	RebuildSavedMapsList();
+	BuildSavedMapRows(NUM_SAVED_MAP_ROWS_ON_ENTER);
+}
 
-	Strings mapNames;
-	int numSavedMaps = ListAllFilesInDirectory("Saved", mapNames);
+void Game::RebuildSavedMapsList()
+{
+	if (m_savedMapsListWidget)
+	{
+		delete m_savedMapsListWidget;
+		m_savedMapsListWidget = nullptr;
+	}
+	m_savedMapInfoWidgets.clear();
 
-	if (numSavedMaps == 1)
+	if (m_mapCatalog.GetNumEntries() == 0)
 	{
+		m_connectToPerforceMessageWidget->SetVisible(false)->SetFocus(false);
 		m_noSavedMapsWidget->SetVisible(true);
 		m_noSavedMapsWidget->SetFocus(true);
 		m_createMapWidget->SetVisible(true);
 		m_createMapWidget->SetFocus(true);
+		return;
+	}
+
+	if (!m_isConnectedToPerforce)
+	{
+		m_connectToPerforceMessageWidget->SetText("Connect to perforce to start read-only editing maps")->SetFocus(true)->SetVisible(true);
 	}
 	else
 	{
-		if (!m_isConnectedToPerforce)
-		{
-			m_connectToPerforceMessageWidget->SetText("Connect to perforce to start read-only editing maps")->SetFocus(true)->SetVisible(true);
-		}
-		else
-		{
-			m_connectToPerforceMessageWidget->SetVisible(false)->SetFocus(false);
-		}
+		m_connectToPerforceMessageWidget->SetVisible(false)->SetFocus(false);
+	}
 
-		m_noSavedMapsWidget->SetVisible(false);
-		m_noSavedMapsWidget->SetFocus(false);
-		m_createMapWidget->SetVisible(false);
-		m_createMapWidget->SetFocus(false);
+	m_noSavedMapsWidget->SetVisible(false);
+	m_noSavedMapsWidget->SetFocus(false);
+	m_createMapWidget->SetVisible(false);
+	m_createMapWidget->SetFocus(false);
 
-		m_savedMapsListWidget = g_ui->CreateWidget(m_mapSelectWidget);
-		m_savedMapsListWidget->SetPosition(Vec2(0.05f, 0.f))
-			->SetDimensions(Vec2(0.9f, 0.8f))
-			->SetPivot(Vec2(0.f, 0.f))
-			->SetAlignment(Vec2(0.f, 0.f))
-			->SetRaycastTarget(false)
-			->SetScrollable(true)
-			->SetScrollBuffer(200.f);
+	m_savedMapsListWidget = g_ui->CreateWidget(m_mapSelectWidget);
+	m_savedMapsListWidget->SetPosition(Vec2(0.05f, 0.f))
+		->SetDimensions(Vec2(0.9f, 0.8f))
+		->SetPivot(Vec2(0.f, 0.f))
+		->SetAlignment(Vec2(0.f, 0.f))
+		->SetRaycastTarget(false)
+		->SetScrollable(true)
+		->SetScrollBuffer(200.f);
+}
+
+static std::string GetSavedMapInfoText(MapCatalogEntry const& entry)
+{
+	if (!entry.m_hasStats)
+	{
+		return "Reading...";
+	}
+	if (entry.m_numEntities < 0)
+	{
+		return "Unreadable";
 	}
 
-	float widgetPositionY = 1.f;
-	for (int savedMapIndex = 0; savedMapIndex < numSavedMaps; savedMapIndex++)
+	Vec3 boundsDimensions = entry.m_bounds.GetDimensions();
+	return Stringf("%d entities, %.0fx%.0fx%.0f, %.0f KB", entry.m_numEntities, boundsDimensions.x, boundsDimensions.y, boundsDimensions.z, (float)entry.m_fileSize / 1024.f);
+}
+
+void Game::BuildSavedMapRows(int maxRowsToBuild)
+{
+	if (!m_savedMapsListWidget)
 	{
-		if (!strcmp(mapNames[savedMapIndex].c_str(), "placeholder.txt"))
-		{
-			// Skip the placeholder.txt created for perforce
-			continue;
-		}
+		return;
+	}
+
+	// Rows are built in order a few at a time, the ones at the top of the list exist on the first frame and the rest follow before they can be scrolled to
+	int firstRowIndex = (int)m_savedMapInfoWidgets.size();
+	int endRowIndex = firstRowIndex + maxRowsToBuild;
+	if (endRowIndex > m_mapCatalog.GetNumEntries())
+	{
+		endRowIndex = m_mapCatalog.GetNumEntries();
+	}
+	for (int savedMapIndex = firstRowIndex; savedMapIndex < endRowIndex; savedMapIndex++)
+	{
+		MapCatalogEntry const& entry = m_mapCatalog.GetEntry(savedMapIndex);
+		float widgetPositionY = 1.f - 0.075f * (float)savedMapIndex;
 
-		std::string mapDisplayName = "";
-		Strings splitMapName;
-		int numSplits = SplitStringOnDelimiter(splitMapName, mapNames[savedMapIndex], '.');
-		for (int splitIndex = 0; splitIndex < numSplits - 1; splitIndex++)
-		{
-			mapDisplayName += splitMapName[splitIndex];
-		}
-		
 		UIWidget* savedMapWidget = g_ui->CreateWidget(m_savedMapsListWidget);
-		savedMapWidget->SetText(mapDisplayName)
+		savedMapWidget->SetText(entry.m_displayName)
 			->SetPosition(Vec2(0.f, widgetPositionY))
 			->SetDimensions(Vec2(1.f, 0.05f))
 			->SetPivot(Vec2(0.f, 0.5f))
@@ -2204,6 +2462,30 @@ void Game::EnterMapSelect()
 			->SetFontSize(8.f)
 			->SetRaycastTarget(false);
 
+		UIWidget* savedMapInfoWidget = g_ui->CreateWidget(savedMapWidget);
+		savedMapInfoWidget->SetText(GetSavedMapInfoText(entry))
+			->SetPosition(Vec2(0.575f, 0.f))
+			->SetDimensions(Vec2(0.25f, 0.9f))
+			->SetPivot(Vec2(0.5f, 0.5f))
+			->SetAlignment(Vec2(0.5f, 0.5f))
+			->SetBackgroundColor(SECONDARY_COLOR)
+			->SetHoverBackgroundColor(SECONDARY_COLOR)
+			->SetColor(PRIMARY_COLOR_VARIANT_DARK)
+			->SetHoverColor(PRIMARY_COLOR_VARIANT_DARK)
+			->SetFontSize(6.f)
+			->SetRaycastTarget(false);
+		m_savedMapInfoWidgets.push_back(savedMapInfoWidget);
+
+		if (!entry.m_thumbnailPath.empty())
+		{
+			UIWidget* thumbnailWidget = g_ui->CreateWidget(savedMapWidget);
+			thumbnailWidget->SetImage(entry.m_thumbnailPath)
+				->SetPosition(Vec2(0.725f, 0.f))
+				->SetDimensions(Vec2(0.04f, 0.9f))
+				->SetPivot(Vec2(0.5f, 0.5f))
+				->SetRaycastTarget(false);
+		}
+
 		UIWidget* playMapButton = g_ui->CreateWidget(savedMapWidget);
 		playMapButton->SetText("Play")
 			->SetPosition(Vec2(0.8f, 0.f))
@@ -2217,13 +2499,10 @@ void Game::EnterMapSelect()
 			->SetBorderRadius(0.5f)
 			->SetFontSize(8.f)
 			->SetRaycastTarget(true)
-			->SetClickEventName(Stringf("PlayMap name=Saved/%s", mapNames[savedMapIndex].c_str()));
+			->SetClickEventName(Stringf("PlayMap name=Saved/%s", entry.m_fileName.c_str()));
 
-		bool isFileReadOnly = false;
-		if (!m_isConnectedToPerforce)
-		{
-			isFileReadOnly = IsFileReadOnly((Stringf("Saved/%s", mapNames[savedMapIndex].c_str())));
-		}
+		// The read-only attribute comes from the catalog's directory scan rather than a query per file
+		bool isFileReadOnly = !m_isConnectedToPerforce && entry.m_isReadOnly;
 
 		UIWidget* editMapButton = g_ui->CreateWidget(savedMapWidget);
 		editMapButton->SetText("Edit")
@@ -2239,18 +2518,27 @@ void Game::EnterMapSelect()
 			->SetFontSize(8.f)
 			->SetRaycastTarget(true)
 			->SetFocus(!isFileReadOnly)
-			->SetClickEventName(Stringf("EditMap name=Saved/%s", mapNames[savedMapIndex].c_str()));
+			->SetClickEventName(Stringf("EditMap name=Saved/%s", entry.m_fileName.c_str()));
+	}
+}
 
-		widgetPositionY -= 0.075f;
+void Game::UpdateSavedMapInfoTexts()
+{
+	for (int savedMapIndex = 0; savedMapIndex < (int)m_savedMapInfoWidgets.size(); savedMapIndex++)
+	{
+		m_savedMapInfoWidgets[savedMapIndex]->SetText(GetSavedMapInfoText(m_mapCatalog.GetEntry(savedMapIndex)));
 	}
 }
 
 void Game::ExitMapSelect()
 {
+	m_mapLoadErrorTextWidget->SetText("")->SetVisible(false);
 	if (m_savedMapsListWidget)
 	{
 		delete m_savedMapsListWidget;
+		m_savedMapsListWidget = nullptr;
 	}
+	m_savedMapInfoWidgets.clear();
 
 	m_mapSelectWidget->SetFocus(false);
 	m_mapSelectWidget->SetVisible(false);
@@ -2296,8 +2584,22 @@ void Game::ExitPerforce()
 	m_perforceWidget->SetVisible(false);
 }
 
+void Game::EnterLoading()
+{
+	m_loadingBarGeometryPercent = -1;
+}
+
+void Game::ExitLoading()
+{
+}
+
 void Game::EnterGame()
 {
+	m_assetPreloader.FinishNow();
+	if (!m_mapImageTexture)
+	{
+		m_mapImageTexture = g_renderer->CreateOrGetTextureFromFile("Data/Images/LevelImage.jpg");
+	}
 	if (!m_gridVBO)
 	{
 		InitializeGrid();
@@ -2309,43 +2611,43 @@ void Game::EnterGame()
 		m_player->m_orientation = EulerAngles(-45.f, 0.f, 0.f);
 	}
 
-	if (m_isTutorial)
+	if (m_isTutorial && m_tutorialTextsByVolumeID.empty())
 	{
-		m_tutorialTextWidget->SetVisible(true);
+		m_tutorialTextWidget->SetVisible(false);
 
 		std::string tutorialTextMovement = "Use the left controller joystick to move.\nUse the right controller joystick to look around.";
 		AABB3 tutorialTriggerBoxMovement(Vec3(-5.f, -5.5f, 0.f), Vec3(2.f, 5.5f, 2.f));
-		m_tutorialTriggerBoxesByText[tutorialTextMovement] = tutorialTriggerBoxMovement;
+		AddTutorialTriggerVolume(tutorialTriggerBoxMovement, tutorialTextMovement);
 
 		std::string tutorialTextJump = "Use A on the right controller to jump.";
 		AABB3 tutorialTriggerBoxJump(Vec3(4.f, -5.5f, 0.f), Vec3(5.f, 5.5f, 2.f));
-		m_tutorialTriggerBoxesByText[tutorialTextJump] = tutorialTriggerBoxJump;
+		AddTutorialTriggerVolume(tutorialTriggerBoxJump, tutorialTextJump);
 
 		std::string tutorialTextLedgeGrab = "That jump looks like it's too far.\nAfter jumping, reach out with either hand\nand use the Grip button to grab a ledge.";
 		AABB3 tutorialTriggerBoxLedgeGrab(Vec3(8.f, 0.5f, 0.5f), Vec3(10.f, 5.5f, 2.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextLedgeGrab] = tutorialTriggerBoxLedgeGrab;
+		AddTutorialTriggerVolume(tutorialTriggerBoxLedgeGrab, tutorialTextLedgeGrab);
 
 		std::string tutorialTextLever = "Reach out with either hand and use\nthe grip button to grab the lever.\nMove the handle by moving your hand while holding it.";
 		AABB3 tutorialTriggerBoxLever(Vec3(15.f, 0.5f, 0.5f), Vec3(18.f, 5.5f, 2.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextLever] = tutorialTriggerBoxLever;
+		AddTutorialTriggerVolume(tutorialTriggerBoxLever, tutorialTextLever);
 
 		std::string tutorialTextLedgeGrab2 = "Try jumping up and grabbing the ledge again.";
 		AABB3 tutorialTriggerBoxLedgeGrab2(Vec3(15.f, 6.5f, 3.5f), Vec3(17.f, 7.5f, 4.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextLedgeGrab2] = tutorialTriggerBoxLedgeGrab2;
+		AddTutorialTriggerVolume(tutorialTriggerBoxLedgeGrab2, tutorialTextLedgeGrab2);
 
 		std::string tutorialTextEnemy = "Punch an enemy by holding the grip and\ntrigger buttons and swinging your hand.\nGrab an enemy by reaching out and holding the grip button.";
 		AABB3 tutorialTriggerBoxEnemy(Vec3(13.f, 10.f, 3.5f), Vec3(19.f, 16.f, 6.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextEnemy] = tutorialTriggerBoxEnemy;
+		AddTutorialTriggerVolume(tutorialTriggerBoxEnemy, tutorialTextEnemy);
 
 		std::string tutorialTextButton = "Stand on a button to open the door.\nWhen you step off, the door will close.";
 		AABB3 tutorialTriggerBoxButton(Vec3(6.f, 15.f, 4.5f), Vec3(7.f, 16.5f, 6.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextButton] = tutorialTriggerBoxButton;
+		AddTutorialTriggerVolume(tutorialTriggerBoxButton, tutorialTextButton);
 
 		std::string tutorialTextCrate = "Push the crate or reach out and use the grip button\nto grab it";
 		AABB3 tutorialTriggerBoxCrate(Vec3(7.f, 11.f, 4.5f), Vec3(10.f, 12.f, 6.5f));
-		m_tutorialTriggerBoxesByText[tutorialTextCrate] = tutorialTriggerBoxCrate;
+		AddTutorialTriggerVolume(tutorialTriggerBoxCrate, tutorialTextCrate);
 	}
-	else
+	else if (!m_isTutorial)
 	{
 		m_tutorialTextWidget->SetVisible(false);
 	}
@@ -2359,6 +2661,10 @@ void Game::ExitGame()
 {
 	if (m_nextState != GameState::PAUSE && m_nextState != GameState::LEVEL_COMPLETE)
 	{
+		if (m_currentMap)
+		{
+			m_currentMap->DiscardUnsavedEdits();
+		}
 		delete m_currentMap;
 		m_currentMap = nullptr;
 
@@ -2377,6 +2683,8 @@ void Game::ExitGame()
 		m_player->m_pawn->m_health = PlayerPawn::MAX_HEALTH;
 		m_player->m_pawn->m_hasWon = false;
 		m_isTutorial = false;
+		m_tutorialTextsByVolumeID.clear();
+		m_activeTutorialVolumeID = -1;
 	}
 	m_gameWidget->SetFocus(false);
 	m_gameWidget->SetVisible(false);
@@ -2392,6 +2700,7 @@ void Game::ExitPause()
 {
 	if (m_nextState != GameState::GAME && m_nextState != GameState::LEVEL_IMAGE && m_currentMap)
 	{
+		m_currentMap->DiscardUnsavedEdits();
 		delete m_currentMap;
 		m_currentMap = nullptr;
 
@@ -2406,6 +2715,8 @@ void Game::ExitPause()
 		m_player->m_angularVelocity = EulerAngles::ZERO;
 		m_player->m_pawn->m_hasWon = false;
 		m_isTutorial = false;
+		m_tutorialTextsByVolumeID.clear();
+		m_activeTutorialVolumeID = -1;
 	}
 	m_pauseWidget->SetFocus(false);
 	m_pauseWidget->SetVisible(false);
@@ -2434,6 +2745,7 @@ void Game::ExitLevelComplete()
 {
 	if (m_nextState != GameState::GAME && m_currentMap)
 	{
+		m_currentMap->DiscardUnsavedEdits();
 		delete m_currentMap;
 		m_currentMap = nullptr;
 
@@ -2448,6 +2760,8 @@ void Game::ExitLevelComplete()
 		m_player->m_angularVelocity = EulerAngles::ZERO;
 		m_player->m_pawn->m_hasWon = false;
 		m_isTutorial = false;
+		m_tutorialTextsByVolumeID.clear();
+		m_activeTutorialVolumeID = -1;
 	}
 	m_levelCompleteWidget->SetFocus(false);
 	m_levelCompleteWidget->SetVisible(false);
@@ -2455,67 +2769,24 @@ void Game::ExitLevelComplete()
 
 void Game::RenderSkybox() const
 {
-	Vec3 BLF = Vec3(-0.5f, 0.5f, -0.5f);
-	Vec3 BRF = Vec3(-0.5f, -0.5f, -0.5f);
-	Vec3 TRF = Vec3(-0.5f, -0.5f, 0.5f);
-	Vec3 TLF = Vec3(-0.5f, 0.5f, 0.5f);
-	Vec3 BLB = Vec3(0.5f, 0.5f, -0.5f);
-	Vec3 BRB = Vec3(0.5f, -0.5f, -0.5f);
-	Vec3 TRB = Vec3(0.5f, -0.5f, 0.5f);
-	Vec3 TLB = Vec3(0.5f, 0.5f, 0.5f);
-
 	g_renderer->BeginRenderEvent("Skybox");
-	std::vector<Vertex_PCU> skyboxVerts;
-	AddVertsForGradientQuad3D(skyboxVerts, BRB, BLB, TLB, TRB, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // +X
-	Mat44 skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::WEST * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
 	g_renderer->SetBlendMode(BlendMode::ALPHA);
 	g_renderer->SetDepthMode(DepthMode::DISABLED);
-	g_renderer->SetModelConstants(skyboxTransform);
+	g_renderer->SetModelConstants(m_skyboxTransform);
 	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_FRONT);
 	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
 	g_renderer->BindShader(nullptr);
 	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
-	skyboxVerts.clear();
-	AddVertsForGradientQuad3D(skyboxVerts, BLF, BRF, TRF, TLF, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // -X
-	skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::EAST * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
-	skyboxVerts.clear();
-	AddVertsForGradientQuad3D(skyboxVerts, BLB, BLF, TLF, TLB, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // +Y
-	skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::SOUTH * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
-	skyboxVerts.clear();
-	AddVertsForGradientQuad3D(skyboxVerts, BRF, BRB, TRB, TRF, HORIZON_COLOR, HORIZON_COLOR, AZIMUTH_COLOR, AZIMUTH_COLOR); // -Y
-	skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::NORTH * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
-	skyboxVerts.clear();
-	AddVertsForQuad3D(skyboxVerts, TLF, TRF, TRB, TLB, AZIMUTH_COLOR); // +Z
-	skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::SKYWARD * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
-	skyboxVerts.clear();
-	AddVertsForQuad3D(skyboxVerts, BLB, BRB, BRF, BLF, HORIZON_COLOR); // -Z
-	skyboxTransform = Mat44::CreateTranslation3D(m_player->m_position + Vec3::GROUNDWARD * 0.5f);
-	skyboxTransform.AppendScaleUniform3D(100.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(skyboxVerts);
-
+	m_skyboxGeometry.Draw();
 	g_renderer->EndRenderEvent("Skybox");
 }
 
+void Game::AddTutorialTriggerVolume(AABB3 const& bounds, std::string const& tutorialText)
+{
+	int volumeID = m_currentMap->m_triggerVolumes.AddVolume(bounds, "TutorialTrigger");
+	m_tutorialTextsByVolumeID[volumeID] = tutorialText;
+}
+
 void Game::UpdateTutorialInstructions(std::string const& tutorialText)
 {
 	if (tutorialText.empty())
@@ -2606,6 +2877,28 @@ void Game::UpdateInGameInstruction()
 	m_instructionsWidget->SetText(m_instructionsText);
 }
 
+void Game::StartLoadingMap(std::string const& mapFileName, MapMode mode)
+{
+	if (m_mapLoader)
+	{
+		return;
+	}
+
+	// Reading starts right away on the worker, so it overlaps the fade out of the current screen
+	m_mapLoader = new MapLoader(this, mapFileName, mode);
+	m_nextState = GameState::LOADING;
+}
+
+int Game::GetLoadingPercent() const
+{
+	if (!m_mapLoader)
+	{
+		return 100;
+	}
+
+	return RoundDownToInt(m_mapLoader->GetProgress() * 100.f);
+}
+
 void Game::ReadPerforceSettings()
 {
 	m_p4User = "";
@@ -2706,8 +2999,7 @@ bool Game::Event_EditMap(EventArgs& args)
 
 	std::string p4checkoutResult = RunCommand(Stringf("p4 edit %s\\%s", g_app->m_game->m_currentDir.c_str(), mapName.c_str()));
 	
-	g_app->m_game->m_currentMap = new Map(g_app->m_game, mapName, MapMode::EDIT);
-	g_app->m_game->m_nextState = GameState::GAME;
+	g_app->m_game->StartLoadingMap(mapName, MapMode::EDIT);
 	return true;
 }
 
@@ -2719,8 +3011,7 @@ bool Game::Event_PlayMap(EventArgs& args)
 		return false;
 	}
 
-	g_app->m_game->m_currentMap = new Map(g_app->m_game, mapName, MapMode::PLAY);
-	g_app->m_game->m_nextState = GameState::GAME;
+	g_app->m_game->StartLoadingMap(mapName, MapMode::PLAY);
 	return true;
 }
 
@@ -2790,14 +3081,39 @@ bool Game::Event_ToggleInGameMapImage(EventArgs& args)
 	return true;
 }
 
+bool Game::Event_TutorialTrigger(EventArgs& args)
+{
+	int volumeID = args.GetValue("volume", -1);
+	TriggerEventType triggerType = (TriggerEventType)args.GetValue("trigger", (int)TriggerEventType::NONE);
+
+	Game*& game = g_app->m_game;
+	auto tutorialTextIter = game->m_tutorialTextsByVolumeID.find(volumeID);
+	if (tutorialTextIter == game->m_tutorialTextsByVolumeID.end())
+	{
+		return false;
+	}
+
+	if (triggerType == TriggerEventType::ENTER)
+	{
+		game->m_activeTutorialVolumeID = volumeID;
+		game->UpdateTutorialInstructions(tutorialTextIter->second);
+	}
+	else if (triggerType == TriggerEventType::EXIT && game->m_activeTutorialVolumeID == volumeID)
+	{
+		game->m_activeTutorialVolumeID = -1;
+		game->UpdateTutorialInstructions("");
+	}
+
+	return true;
+}
+
 bool Game::Event_StartTutorial(EventArgs& args)
 {
 	UNUSED(args);
 
 	Game*& game = g_app->m_game;
 	game->m_isTutorial = true;
-	game->m_currentMap = new Map(game, "Saved/Tutorial.almap", MapMode::PLAY);
-	game->m_nextState = GameState::GAME;
+	game->StartLoadingMap("Saved/Tutorial.almap", MapMode::PLAY);
 
 	return true;
 }
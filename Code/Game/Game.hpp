@@ -1,6 +1,10 @@
 #pragma once
 
+#include "Game/AssetPreloader.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InputTrace.hpp"
+#include "Game/MapCatalog.hpp"
+#include "Game/RetainedGeometry.hpp"
 
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/EventSystem.hpp"
@@ -16,6 +20,7 @@
 
 
 class Map;
+class MapLoader;
 class Player;
 
 
@@ -29,6 +34,7 @@ enum class GameState
 	HOW_TO_PLAY,
 	CREDITS,
 	PERFORCE,
+	LOADING,
 	GAME,
 	PAUSE,
 	LEVEL_IMAGE,
@@ -47,10 +53,15 @@ public:
 	void Update();
 	void FixedUpdate(float deltaSeconds);
 	void ClearScreen();
+	void ExtractRenderFrame();
 	void Render() const;
 	void RenderScreen() const;
 	void RenderCustomScreens() const;
 	ArchiLeapRaycastResult3D RaycastVsScreen(Vec3 const& startPosition, Vec3 const& fwdNormal, float maxDistance) const;
+	ScreenState GetScreenState() const;
+
+	float GetDeltaSeconds() const;
+	InputFrame const& GetInputFrame() const;
 
 public:
 	static bool Event_Navigate(EventArgs& args);
@@ -66,20 +77,24 @@ public:
 	static bool Event_ConnectToPerforce(EventArgs& args);
 	static bool Event_ToggleInGameMapImage(EventArgs& args);
 	static bool Event_StartTutorial(EventArgs& args);
+	static bool Event_TutorialTrigger(EventArgs& args);
 
 public:
 	static 	constexpr float SCREEN_QUAD_DISTANCE = 2.f;
+	static	constexpr float SCREEN_QUAD_HALF_FOV_DEGREES = 30.f;
 
 	GameState m_state = GameState::NONE;
 	GameState m_nextState = GameState::ATTRACT;
 	float m_timeInState = 0.f;
 
 	Clock m_clock = Clock();
+	InputTrace m_inputTrace;
 
 	VertexBuffer* m_gridVBO = nullptr;
 
 	Player* m_player = nullptr;
 	Map* m_currentMap = nullptr;
+	MapLoader* m_mapLoader = nullptr;
 
 	Texture* m_gameLogoTexture = nullptr;
 
@@ -93,7 +108,9 @@ public:
 	UIWidget* m_noSavedMapsWidget = nullptr;
 	UIWidget* m_createMapWidget = nullptr;
 	UIWidget* m_savedMapsListWidget = nullptr;
+	std::vector<UIWidget*> m_savedMapInfoWidgets;
 	UIWidget* m_connectToPerforceMessageWidget = nullptr;
+	UIWidget* m_mapLoadErrorTextWidget = nullptr;
 
 	UIWidget* m_controlsWidget = nullptr;
 	UIWidget* m_controlsWidgetTabButtons[4] = {nullptr, nullptr, nullptr, nullptr};
@@ -148,14 +165,19 @@ public:
 	std::string m_currentDir = "";
 
 	bool m_isConnectedToPerforce = false;
+	MapCatalog m_mapCatalog;
+	uint32_t m_savedMapInfoStatsVersion = 0;
 
 	int m_controlsTabIndex = 0;
 
 	bool m_isMapImageVisible = false;
 	Texture* m_mapImageTexture = nullptr;
 
+	AssetPreloader m_assetPreloader;
+
 	bool m_isTutorial = false;
-	std::map<std::string, AABB3> m_tutorialTriggerBoxesByText;
+	std::map<int, std::string> m_tutorialTextsByVolumeID;
+	int m_activeTutorialVolumeID = -1;
 
 private:
 	void LoadAssets();
@@ -179,6 +201,7 @@ private:
 	void UpdateHowToPlay();
 	void UpdateCredits();
 	void UpdatePerforce();
+	void UpdateLoading();
 	void UpdateGame();
 	void UpdatePause();
 	void UpdateLevelImage();
@@ -202,6 +225,9 @@ private:
 	void RenderPerforce() const;
 	void RenderScreenPerforce() const;
 
+	void RenderLoading() const;
+	void RenderScreenLoading() const;
+
 	void RenderGame() const;
 	void RenderScreenGame() const;
 
@@ -222,6 +248,7 @@ private:
 
 	void RenderOutroTransition() const;
 	void RenderIntroTransition() const;
+	void RenderTransitionSphere(Mat44 const& modelTransform, Rgba8 const& color) const;
 
 	void HandleStateChange();
 
@@ -243,6 +270,9 @@ private:
 	void EnterPerforce();
 	void ExitPerforce();
 
+	void EnterLoading();
+	void ExitLoading();
+
 	void EnterGame();
 	void ExitGame();
 
@@ -257,13 +287,31 @@ private:
 
 	void RenderSkybox() const;
 
+	void AddTutorialTriggerVolume(AABB3 const& bounds, std::string const& tutorialText);
 	void UpdateTutorialInstructions(std::string const& tutorialText);
 	void UpdateInGameInstruction();
+	void StartLoadingMap(std::string const& mapFileName, MapMode mode);
+	int GetLoadingPercent() const;
+	void RebuildSavedMapsList();
+	void BuildSavedMapRows(int maxRowsToBuild);
+	void UpdateSavedMapInfoTexts();
 
 private:
 	static constexpr int NUM_HOW_TO_PLAY_TABS = 4;
+	static constexpr int NUM_SAVED_MAP_ROWS_ON_ENTER = 16;
+	static constexpr int NUM_SAVED_MAP_ROWS_PER_FRAME = 8;
 
 	VertexBuffer* m_transitionSphereVBO = nullptr;
+	RetainedGeometry m_skyboxGeometry;
+	Mat44 m_skyboxTransform = Mat44::IDENTITY;
+	RetainedGeometry m_desktopScreenQuadGeometry;
+	RetainedGeometry m_stereoScreenQuadGeometry;
+	RetainedGeometry m_reticleGeometry;
+	RetainedGeometry m_mapImageGeometry;
+	RetainedGeometry m_healthBarGeometry;
+	int m_healthBarGeometryHealth = -1;
+	RetainedGeometry m_loadingBarGeometry;
+	int m_loadingBarGeometryPercent = -1;
 	Stopwatch m_transitionTimer = Stopwatch(0.25f);
 	//Stopwatch m_logoAnimationTimer = Stopwatch(0.5f);
 
@@ -19,3 +19,25 @@ std::string GetAxisLockDirectionStr(AxisLockDirection axisLockDirection)
 
 	return "None";
 }
+
+bool ScreenState::operator==(ScreenState const& other) const
+{
+	return m_state == other.m_state && m_nextState == other.m_nextState && m_playerState == other.m_playerState
+		&& m_isMapImageVisible == other.m_isMapImageVisible && m_showInstructions == other.m_showInstructions
+		&& m_isStartPlayAtCameraPosition == other.m_isStartPlayAtCameraPosition && m_renderLinkLines == other.m_renderLinkLines
+		&& m_isLeftTriggerDown == other.m_isLeftTriggerDown && m_isRightTriggerDown == other.m_isRightTriggerDown
+		&& m_activeTutorialVolumeID == other.m_activeTutorialVolumeID && m_hoveredWidget == other.m_hoveredWidget
+		&& m_selectedEntity == other.m_selectedEntity && m_linkingEntity == other.m_linkingEntity
+		&& m_selectedEntityPosition.x == other.m_selectedEntityPosition.x
+		&& m_selectedEntityPosition.y == other.m_selectedEntityPosition.y && m_selectedEntityPosition.z == other.m_selectedEntityPosition.z
+		&& m_selectedEntityYawDegrees == other.m_selectedEntityYawDegrees
+		&& m_selectedEntityScale == other.m_selectedEntityScale && m_health == other.m_health && m_coinsCollected == other.m_coinsCollected
+		&& m_loadingPercent == other.m_loadingPercent && m_numSavedMapInfoWidgets == other.m_numSavedMapInfoWidgets
+		&& m_savedMapInfoStatsVersion == other.m_savedMapInfoStatsVersion && m_savedMapsListWidget == other.m_savedMapsListWidget
+		&& m_inputTextHash == other.m_inputTextHash;
+}
+
+bool ScreenState::operator!=(ScreenState const& other) const
+{
+	return !(*this == other);
+}
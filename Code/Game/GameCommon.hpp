@@ -43,8 +43,13 @@ constexpr float WINDOW_ASPECT = 1.f;
 constexpr float SCREEN_CENTER_X = SCREEN_SIZE_Y * WINDOW_ASPECT * 0.5f;
 constexpr float SCREEN_CENTER_Y = SCREEN_SIZE_Y * 0.5f;
 
+// Screen space is laid out in SCREEN_SIZE_Y units, the texture it is drawn into only needs as many pixels as a display can resolve
+constexpr float DESKTOP_SCREEN_TEXTURE_HEIGHT = 1440.f;
+constexpr float HMD_PIXELS_PER_DEGREE = 24.f;
+
 constexpr float NEAR_PLANE_DISTANCE = 0.01f;
 constexpr float FAR_PLANE_DISTANCE = 1000.f;
+constexpr float WORLD_CAMERA_FOV_DEGREES = 60.f;
 
 constexpr float GRAVITY = 9.8f;
 
@@ -69,6 +74,7 @@ const Vec3 SUN_DIRECTION = Vec3(1.f, 2.f, -2.f).GetNormalized();
 constexpr float SUN_INTENSITY = 0.9f;
 
 constexpr int g_archiLeapShaderConstantsSlot = 4;
+constexpr int g_instanceConstantsSlot = 5;
 struct ArchiLeapShaderConstants
 {
 	Vec4 m_skyColor;
@@ -91,6 +97,39 @@ public:
 	Entity* m_impactEntity = nullptr;
 };
 
+// Everything the screen texture shows that is cheap to read back, the texture is only redrawn when this changes
+struct ScreenState
+{
+public:
+	bool operator==(ScreenState const& other) const;
+	bool operator!=(ScreenState const& other) const;
+
+public:
+	int m_state = -1;
+	int m_nextState = -1;
+	int m_playerState = -1;
+	bool m_isMapImageVisible = false;
+	bool m_showInstructions = false;
+	bool m_isStartPlayAtCameraPosition = false;
+	bool m_renderLinkLines = false;
+	bool m_isLeftTriggerDown = false;
+	bool m_isRightTriggerDown = false;
+	int m_activeTutorialVolumeID = -1;
+	void const* m_hoveredWidget = nullptr;
+	void const* m_selectedEntity = nullptr;
+	void const* m_linkingEntity = nullptr;
+	Vec3 m_selectedEntityPosition = Vec3::ZERO;
+	float m_selectedEntityYawDegrees = 0.f;
+	float m_selectedEntityScale = 0.f;
+	int m_health = 0;
+	int m_coinsCollected = 0;
+	int m_loadingPercent = 0;
+	int m_numSavedMapInfoWidgets = 0;
+	uint32_t m_savedMapInfoStatsVersion = 0;
+	void const* m_savedMapsListWidget = nullptr;
+	size_t m_inputTextHash = 0;
+};
+
 enum class EntityType
 {
 	NONE,
@@ -155,9 +194,7 @@ struct Action
 	EulerAngles m_actionEntityPreviousOrientation = EulerAngles::ZERO;
 	float m_actionEntityPreviousScale = 1.f;
 	Activator* m_activator = nullptr;
-	EntityUID m_prevLinkedActivatable = EntityUID::INVALID;
 	Activatable* m_activatable = nullptr;
-	EntityUID m_prevLinkedActivator = EntityUID::INVALID;
 };
 
 enum class AxisLockDirection
@@ -172,4 +209,7 @@ enum class AxisLockDirection
 std::string GetAxisLockDirectionStr(AxisLockDirection axisLockDirection);
 
 constexpr char const* SAVEFILE_4CC_CODE = "GHAL";
-constexpr uint8_t SAVEFILE_VERSION = 2;
+constexpr uint8_t SAVEFILE_VERSION = 5;
+constexpr uint8_t SAVEFILE_VERSION_FIXED_STRIDE = 4;
+constexpr uint8_t SAVEFILE_VERSION_SIGNAL_GRAPH = 3;
+constexpr uint8_t SAVEFILE_VERSION_SINGLE_LINKS = 2;
@@ -233,3 +233,31 @@ bool PushZOBB3OutOfFixedZOBB3(OBB3& zOrientedBoxA, OBB3 const& zOrientedBoxB)
 	zOrientedBoxA.m_center += pushDist * pushDirection;
 	return true;
 }
+
+AABB3 const GetTransformedAABB3(AABB3 const& localBox, Mat44 const& transform)
+{
+	Vec3 firstCorner = transform.TransformPosition3D(localBox.m_mins);
+	AABB3 result(firstCorner, firstCorner);
+	for (int cornerIndex = 1; cornerIndex < 8; cornerIndex++)
+	{
+		Vec3 localCorner((cornerIndex & 1) ? localBox.m_maxs.x : localBox.m_mins.x, (cornerIndex & 2) ? localBox.m_maxs.y : localBox.m_mins.y, (cornerIndex & 4) ? localBox.m_maxs.z : localBox.m_mins.z);
+		Vec3 corner = transform.TransformPosition3D(localCorner);
+		result.m_mins = Vec3(GetMin(result.m_mins.x, corner.x), GetMin(result.m_mins.y, corner.y), GetMin(result.m_mins.z, corner.z));
+		result.m_maxs = Vec3(GetMax(result.m_maxs.x, corner.x), GetMax(result.m_maxs.y, corner.y), GetMax(result.m_maxs.z, corner.z));
+	}
+	return result;
+}
+
+AABB3 const GetUnionOfAABB3s(AABB3 const& boxA, AABB3 const& boxB)
+{
+	Vec3 mins(GetMin(boxA.m_mins.x, boxB.m_mins.x), GetMin(boxA.m_mins.y, boxB.m_mins.y), GetMin(boxA.m_mins.z, boxB.m_mins.z));
+	Vec3 maxs(GetMax(boxA.m_maxs.x, boxB.m_maxs.x), GetMax(boxA.m_maxs.y, boxB.m_maxs.y), GetMax(boxA.m_maxs.z, boxB.m_maxs.z));
+	return AABB3(mins, maxs);
+}
+
+bool DoAABB3sOverlap(AABB3 const& boxA, AABB3 const& boxB)
+{
+	return boxA.m_mins.x <= boxB.m_maxs.x && boxA.m_maxs.x >= boxB.m_mins.x
+		&& boxA.m_mins.y <= boxB.m_maxs.y && boxA.m_maxs.y >= boxB.m_mins.y
+		&& boxA.m_mins.z <= boxB.m_maxs.z && boxA.m_maxs.z >= boxB.m_mins.z;
+}
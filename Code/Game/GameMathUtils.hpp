@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Math/OBB3.hpp"
 
@@ -9,3 +11,6 @@ bool PushZCylinderOutOfFixedZOBB3(Vec3& cylinderBaseCenter, Vec3& cylinderTopCen
 bool PushZOBB3OutOfFixedZCylinder(OBB3& zOrientedBox, Vec3 const& cylinderBaseCenter, Vec3 const& cylinderTopCenter, float cylinderRadius);
 bool DoZOBB3Overlap(OBB3 const& zOrientedBoxA, OBB3 const& zOrientedBoxB);
 bool PushZOBB3OutOfFixedZOBB3(OBB3& mobileBox, OBB3 const& fixedBox);
+AABB3 const GetTransformedAABB3(AABB3 const& localBox, Mat44 const& transform);
+AABB3 const GetUnionOfAABB3s(AABB3 const& boxA, AABB3 const& boxB);
+bool DoAABB3sOverlap(AABB3 const& boxA, AABB3 const& boxB);
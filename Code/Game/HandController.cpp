@@ -5,6 +5,7 @@
 #include "Game/Entity.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
@@ -46,13 +47,18 @@ HandController::HandController(XRHand hand, Player* owner)
 	AddVertsForSphere3D(jointVertexes, Vec3::ZERO, 1.f, Rgba8::WHITE);
 	m_sphereVBO = g_renderer->CreateVertexBuffer(jointVertexes.size() * sizeof(Vertex_PCUTBN), VertexType::VERTEX_PCUTBN);
 	g_renderer->CopyCPUToGPU(jointVertexes.data(), jointVertexes.size() * sizeof(Vertex_PCUTBN), m_sphereVBO);
+
+	// The ray is built once along the local forward axis and placed by the controller transform each frame
+	std::vector<Vertex_PCU> rayVerts;
+	AddVertsForGradientLineSegment3D(rayVerts, Vec3(0.25f, 0.f, 0.f), Vec3(Game::SCREEN_QUAD_DISTANCE, 0.f, 0.f), 0.002f, Rgba8(255, 255, 255, 127), Rgba8::TRANSPARENT_WHITE, AABB2::ZERO_TO_ONE, 16);
+	m_rayGeometry.Upload(rayVerts);
 }
 
 void HandController::UpdateTransform()
 {
 	constexpr float HAND_DISTANCE_SCALING_FACTOR = 1.2f;
 
-	VRController const& controller = GetController();
+	ControllerInputState const& controller = GetController();
 
 	m_worldPositionLastFrame = m_worldPosition;
 	m_orientationLastFrame = m_orientation;
@@ -116,7 +122,7 @@ void HandController::HandleInput()
 
 void HandController::Render() const
 {
-	VRController const& controller = GetController();
+	ControllerInputState const& controller = GetController();
 
 	if (!controller.IsActive())
 	{
@@ -141,12 +147,9 @@ void HandController::Render() const
 	EulerAngles handOrientation = m_orientation;
 	handOrientation.m_rollDegrees += m_hand == XRHand::RIGHT ? -90.f : 90.f;
 	controllerTransform.Append(handOrientation.GetAsMatrix_iFwd_jLeft_kUp());
-	Vec3 const& controllerFwd = controllerTransform.GetIBasis3D();
 
 	if (m_player->m_game->m_state != GameState::GAME || m_player->m_state != PlayerState::PLAY)
 	{
-		std::vector<Vertex_PCU> rayVerts;
-		AddVertsForGradientLineSegment3D(rayVerts, m_worldPosition + controllerFwd * 0.25f, m_worldPosition + controllerFwd * Game::SCREEN_QUAD_DISTANCE, 0.002f, Rgba8(255, 255, 255, 127), Rgba8::TRANSPARENT_WHITE, AABB2::ZERO_TO_ONE, 16);
 		g_renderer->BeginRenderEvent("Controller Ray");
 		g_renderer->BindShader(nullptr);
 		g_renderer->SetBlendMode(BlendMode::ALPHA);
@@ -155,8 +158,8 @@ void HandController::Render() const
 		g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
 		g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
 		g_renderer->BindTexture(nullptr);
-		g_renderer->SetModelConstants();
-		g_renderer->DrawVertexArray(rayVerts);
+		g_renderer->SetModelConstants(controllerTransform);
+		m_rayGeometry.Draw();
 		g_renderer->EndRenderEvent("Controller Ray");
 	}
 
@@ -450,8 +453,8 @@ void HandController::Render() const
 
 void HandController::HandleCreateInput()
 {
-	VRController const& controller = GetController();
-	float deltaSeconds = m_player->m_game->m_clock.GetDeltaSeconds();
+	ControllerInputState const& controller = GetController();
+	float deltaSeconds = m_player->m_game->GetDeltaSeconds();
 
 	if (m_selectedEntityType != EntityType::NONE && controller.IsJoystickPressed())
 	{
@@ -490,13 +493,13 @@ void HandController::HandleCreateInput()
 
 void HandController::HandleEditInput()
 {
-	VRController const& controller = GetController();
+	ControllerInputState const& controller = GetController();
 	if (!controller.IsActive())
 	{
 		return;
 	}
 
-	float deltaSeconds = m_player->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_player->m_game->GetDeltaSeconds();
 
 	//if (controller.WasThumbRestJustTouched())
 	//{
@@ -507,7 +510,7 @@ void HandController::HandleEditInput()
 		HandController* otherController = GetOtherHandController();
 		if (otherController->m_actionState == ActionType::TRANSLATE && m_hoveredEntity == otherController->m_selectedEntity)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 			m_actionState = ActionType::SCALE;
 			m_selectedEntityType = m_hoveredEntity->m_type;
@@ -533,7 +536,7 @@ void HandController::HandleEditInput()
 		{
 			if (m_hoveredEntity)
 			{
-				GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+				GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 				m_actionState = ActionType::TRANSLATE;
 				m_selectedEntityType = m_hoveredEntity->m_type;
@@ -557,7 +560,7 @@ void HandController::HandleEditInput()
 		{
 			if (m_hoveredEntity)
 			{
-				GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+				GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 				GetOtherController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 				m_actionState = ActionType::CLONE;
@@ -576,7 +579,7 @@ void HandController::HandleEditInput()
 		}
 		else if (m_actionState == ActionType::TRANSLATE)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 			m_actionState = ActionType::ROTATE;
 			Action rotateAction;
@@ -591,7 +594,13 @@ void HandController::HandleEditInput()
 	{
 		if (m_actionState == ActionType::TRANSLATE || m_actionState == ActionType::ROTATE)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+
+			// A grab is journaled once where it ends rather than every frame it moves
+			if (m_selectedEntity)
+			{
+				m_player->m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
+			}
 
 			m_selectedEntityType = EntityType::NONE;
 			m_selectedEntity = nullptr;
@@ -600,9 +609,14 @@ void HandController::HandleEditInput()
 		}
 		else if (m_actionState == ActionType::SCALE)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 			GetOtherController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
+			if (m_selectedEntity)
+			{
+				m_player->m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
+			}
+
 			HandController* otherController = GetOtherHandController();
 			otherController->m_actionState = ActionType::NONE;
 			otherController->m_selectedEntityType = EntityType::NONE;
@@ -618,7 +632,12 @@ void HandController::HandleEditInput()
 	{
 		if (m_actionState == ActionType::CLONE)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+
+			if (m_selectedEntity)
+			{
+				m_player->m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
+			}
 
 			m_selectedEntityType = EntityType::NONE;
 			m_selectedEntity = nullptr;
@@ -627,7 +646,7 @@ void HandController::HandleEditInput()
 		}
 		else if (m_actionState == ActionType::ROTATE)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 			m_actionState = ActionType::TRANSLATE;
 		}
@@ -636,7 +655,7 @@ void HandController::HandleEditInput()
 	{
 		if (m_selectedEntity)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 			Action deleteAction;
 			deleteAction.m_actionType = ActionType::DELETE;
@@ -656,7 +675,7 @@ void HandController::HandleEditInput()
 		}
 		if (m_hoveredEntity)
 		{
-			GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+			GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 			Action deleteAction;
 			deleteAction.m_actionType = ActionType::DELETE;
@@ -707,7 +726,7 @@ void HandController::HandleEditInput()
 				{
 					if (m_selectedEntity)
 					{
-						GetController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
+						GetVRController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 
 						constexpr int NUM_RAYCASTS = 9;
 						OBB3 selectedEntityBounds = m_selectedEntity->GetBounds();
@@ -754,6 +773,7 @@ void HandController::HandleEditInput()
 						{
 							m_selectedEntity->m_position.z = 0.f;
 						}
+						m_player->m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 
 						m_selectedEntity = nullptr;
 						m_player->m_game->m_currentMap->SetSelectedEntity(nullptr);
@@ -839,9 +859,7 @@ void HandController::HandleEditInput()
 				Action linkAction;
 				linkAction.m_actionType = ActionType::LINK;
 				linkAction.m_activator = activator;
-				linkAction.m_prevLinkedActivatable = activator->m_activatableUID;
 				linkAction.m_activatable = activatable;
-				linkAction.m_prevLinkedActivator = activatable->m_activatorUID;
 
 				m_undoActionStack.push(linkAction);
 				m_player->m_game->m_currentMap->m_isUnsaved = true;
@@ -868,7 +886,7 @@ void HandController::HandleEditInput()
 
 void HandController::HandlePlayInput()
 {
-	VRController const& controller = GetController();
+	ControllerInputState const& controller = GetController();
 
 	if ((m_player->m_pawn->m_isHangingByLeftHand && m_hand == XRHand::LEFT) || (m_player->m_pawn->m_isHangingByRightHand && m_hand == XRHand::RIGHT))
 	{
@@ -927,7 +945,7 @@ void HandController::HandleButtonClicks()
 		return;
 	}
 
-	VRController const& controller = GetController();
+	ControllerInputState const& controller = GetController();
 	if (controller.WasTriggerJustPressed())
 	{
 		m_hoveredWidget->m_isVRClicked = true;
@@ -1109,7 +1127,7 @@ void HandController::RenderFakeEntitiesForSpawn() const
 				g_renderer->BindTexture(nullptr);
 				g_renderer->BindShader(nullptr);
 				g_renderer->SetModelConstants(transform, Rgba8(255, 255, 255, 195));
-				g_renderer->DrawIndexBuffer(m_selectedEntity->m_model->GetVertexBuffer(), m_selectedEntity->m_model->GetIndexBuffer(), m_selectedEntity->m_model->GetIndexCount());
+				m_selectedEntity->m_model->Draw();
 
 				ArchiLeapRaycastResult3D groundwardRaycastResult = m_player->m_game->m_currentMap->RaycastVsEntities(entityPosition, Vec3::GROUNDWARD, 100.f, m_selectedEntity);
 				if (groundwardRaycastResult.m_didImpact)
@@ -1141,21 +1159,22 @@ void HandController::RenderFakeEntitiesForSpawn() const
 	}
 }
 
-VRController& HandController::GetController()
+ControllerInputState const& HandController::GetController() const
 {
+	InputFrame const& input = m_player->m_game->GetInputFrame();
 	if (m_hand == XRHand::LEFT)
 	{
-		return g_openXR->GetLeftController();
+		return input.m_leftController;
 	}
 	if (m_hand == XRHand::RIGHT)
 	{
-		return g_openXR->GetRightController();
+		return input.m_rightController;
 	}
 
 	ERROR_AND_DIE("Attempted GetController on HandController with invalid hand!");
 }
 
-VRController const& HandController::GetController() const
+VRController& HandController::GetVRController()
 {
 	if (m_hand == XRHand::LEFT)
 	{
@@ -1166,7 +1185,7 @@ VRController const& HandController::GetController() const
 		return g_openXR->GetRightController();
 	}
 
-	ERROR_AND_DIE("Attempted GetController on HandController with invalid hand!");
+	ERROR_AND_DIE("Attempted GetVRController on HandController with invalid hand!");
 }
 
 VRController& HandController::GetOtherController()
@@ -1237,6 +1256,7 @@ void HandController::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_position = lastAction.m_actionEntityPreviousPosition;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::ROTATE:
@@ -1248,6 +1268,7 @@ void HandController::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_orientation = lastAction.m_actionEntityPreviousOrientation;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::SCALE:
@@ -1259,6 +1280,7 @@ void HandController::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_scale = lastAction.m_actionEntityPreviousScale;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::CREATE:
@@ -1335,16 +1357,19 @@ void HandController::RedoLastAction()
 		case ActionType::TRANSLATE:
 		{
 			lastAction.m_actionEntity->m_position = lastAction.m_actionEntityPreviousPosition;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::ROTATE:
 		{
 			lastAction.m_actionEntity->m_orientation = lastAction.m_actionEntityPreviousOrientation;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::SCALE:
 		{
 			lastAction.m_actionEntity->m_scale = lastAction.m_actionEntityPreviousScale;
+			m_player->m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::CREATE:
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Game/GameCommon.hpp"
+#include "Game/InputTrace.hpp"
+#include "Game/RetainedGeometry.hpp"
 
 #include "Engine/VirtualReality/VRController.hpp"
 
@@ -24,8 +26,8 @@ public:
 	void RedoLastAction();
 
 
-	VRController& GetController();
-	VRController const& GetController() const;
+	ControllerInputState const& GetController() const;
+	VRController& GetVRController();
 	VRController& GetOtherController();
 	VRController const& GetOtherController() const;
 	HandController* GetOtherHandController() const;
@@ -73,6 +75,7 @@ public:
 
 	Shader* m_diffuseShader = nullptr;
 	VertexBuffer* m_sphereVBO = nullptr;
+	RetainedGeometry m_rayGeometry;
 
 	// Create mode variables
 	EntityType m_selectedEntityType = EntityType::NONE;
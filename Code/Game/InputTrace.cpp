@@ -0,0 +1,414 @@
+#include "Game/InputTrace.hpp"
+
+#include "Game/App.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Player.hpp"
+
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Input/InputSystem.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/VirtualReality/OpenXR.hpp"
+#include "Engine/VirtualReality/VRController.hpp"
+
+
+void ControllerInputState::CaptureFromController(VRController const& controller)
+{
+	m_position = controller.GetPosition_iFwd_jLeft_kUp();
+	m_orientation = controller.GetOrientation_iFwd_jLeft_kUp();
+	m_linearVelocity = controller.GetLinearVelocity_iFwd_jLeft_kUp();
+	m_joystick.m_position = controller.GetJoystick().GetPosition();
+	m_grip = controller.GetGrip();
+	m_trigger = controller.GetTrigger();
+
+	m_buttonFlags = 0;
+	m_buttonFlags |= controller.IsActive()						? CONTROLLER_ACTIVE : 0;
+	m_buttonFlags |= controller.IsJoystickPressed()				? CONTROLLER_JOYSTICK_PRESSED : 0;
+	m_buttonFlags |= controller.IsJoystickTouched()				? CONTROLLER_JOYSTICK_TOUCHED : 0;
+	m_buttonFlags |= controller.IsSelectButtonTouched()			? CONTROLLER_SELECT_TOUCHED : 0;
+	m_buttonFlags |= controller.IsTriggerTouched()				? CONTROLLER_TRIGGER_TOUCHED : 0;
+	m_buttonFlags |= controller.IsBackButtonTouched()			? CONTROLLER_BACK_TOUCHED : 0;
+	m_buttonFlags |= controller.WasBackButtonJustPressed()		? CONTROLLER_BACK_JUST_PRESSED : 0;
+	m_buttonFlags |= controller.WasGripJustPressed()			? CONTROLLER_GRIP_JUST_PRESSED : 0;
+	m_buttonFlags |= controller.WasGripJustReleased()			? CONTROLLER_GRIP_JUST_RELEASED : 0;
+	m_buttonFlags |= controller.WasSelectButtonJustPressed()	? CONTROLLER_SELECT_JUST_PRESSED : 0;
+	m_buttonFlags |= controller.WasThumbRestJustTouched()		? CONTROLLER_THUMB_REST_JUST_TOUCHED : 0;
+	m_buttonFlags |= controller.WasTriggerJustPressed()			? CONTROLLER_TRIGGER_JUST_PRESSED : 0;
+	m_buttonFlags |= controller.WasTriggerJustReleased()		? CONTROLLER_TRIGGER_JUST_RELEASED : 0;
+}
+
+void ControllerInputState::AppendToBuffer(BufferWriter& writer) const
+{
+	writer.AppendVec3(m_position);
+	writer.AppendEulerAngles(m_orientation);
+	writer.AppendVec3(m_linearVelocity);
+	writer.AppendFloat(m_joystick.m_position.x);
+	writer.AppendFloat(m_joystick.m_position.y);
+	writer.AppendFloat(m_grip);
+	writer.AppendFloat(m_trigger);
+	writer.AppendByte((uint8_t)(m_buttonFlags & 0xFF));
+	writer.AppendByte((uint8_t)(m_buttonFlags >> 8));
+}
+
+void ControllerInputState::ParseFromBuffer(BufferParser& parser)
+{
+	m_position = parser.ParseVec3();
+	m_orientation = parser.ParseEulerAngles();
+	m_linearVelocity = parser.ParseVec3();
+	m_joystick.m_position.x = parser.ParseFloat();
+	m_joystick.m_position.y = parser.ParseFloat();
+	m_grip = parser.ParseFloat();
+	m_trigger = parser.ParseFloat();
+	uint16_t lowFlags = (uint16_t)parser.ParseByte();
+	uint16_t highFlags = (uint16_t)parser.ParseByte();
+	m_buttonFlags = lowFlags | (highFlags << 8);
+}
+
+//---------------------------------------------------------------------------------------
+
+void InputFrame::CaptureLive()
+{
+	m_isVRActive = g_openXR && g_openXR->IsInitialized();
+
+	if (g_openXR)
+	{
+		g_openXR->GetTransformForEye_iFwd_jLeft_kUp(XREye::LEFT, m_leftEyeLocalPosition, m_leftEyeOrientation);
+		g_openXR->GetTransformForEye_iFwd_jLeft_kUp(XREye::RIGHT, m_rightEyeLocalPosition, m_rightEyeOrientation);
+		m_leftController.CaptureFromController(g_openXR->GetLeftController());
+		m_rightController.CaptureFromController(g_openXR->GetRightController());
+	}
+
+	for (int keyCode = 0; keyCode < NUM_KEYS; keyCode++)
+	{
+		m_isKeyDown[keyCode] = g_input->IsKeyDown((unsigned char)keyCode);
+	}
+	m_isShiftHeld = g_input->IsShiftHeld();
+	m_cursorClientDelta = Vec2((float)g_input->GetCursorClientDelta().x, (float)g_input->GetCursorClientDelta().y);
+	m_wheelScrollDelta = (float)g_input->m_cursorState.m_wheelScrollDelta;
+}
+
+void InputFrame::DeriveKeyTransitions(InputFrame const& previousFrame)
+{
+	m_wasKeyDown = previousFrame.m_isKeyDown;
+}
+
+void InputFrame::AppendToBuffer(BufferWriter& writer) const
+{
+	uint8_t frameFlags = 0;
+	frameFlags |= m_isVRActive ? 1 : 0;
+	frameFlags |= m_isShiftHeld ? 2 : 0;
+
+	writer.AppendFloat(m_deltaSeconds);
+	writer.AppendByte(frameFlags);
+
+	writer.AppendVec3(m_leftEyeLocalPosition);
+	writer.AppendVec3(m_rightEyeLocalPosition);
+	writer.AppendEulerAngles(m_leftEyeOrientation);
+	writer.AppendEulerAngles(m_rightEyeOrientation);
+
+	m_leftController.AppendToBuffer(writer);
+	m_rightController.AppendToBuffer(writer);
+
+	writer.AppendByte((uint8_t)m_isKeyDown.count());
+	for (int keyCode = 0; keyCode < NUM_KEYS; keyCode++)
+	{
+		if (m_isKeyDown[keyCode])
+		{
+			writer.AppendByte((uint8_t)keyCode);
+		}
+	}
+	writer.AppendFloat(m_cursorClientDelta.x);
+	writer.AppendFloat(m_cursorClientDelta.y);
+	writer.AppendFloat(m_wheelScrollDelta);
+}
+
+void InputFrame::ParseFromBuffer(BufferParser& parser)
+{
+	m_deltaSeconds = parser.ParseFloat();
+	uint8_t frameFlags = parser.ParseByte();
+	m_isVRActive = (frameFlags & 1) != 0;
+	m_isShiftHeld = (frameFlags & 2) != 0;
+
+	m_leftEyeLocalPosition = parser.ParseVec3();
+	m_rightEyeLocalPosition = parser.ParseVec3();
+	m_leftEyeOrientation = parser.ParseEulerAngles();
+	m_rightEyeOrientation = parser.ParseEulerAngles();
+
+	m_leftController.ParseFromBuffer(parser);
+	m_rightController.ParseFromBuffer(parser);
+
+	m_isKeyDown.reset();
+	uint8_t numKeysDown = parser.ParseByte();
+	for (int keyIndex = 0; keyIndex < (int)numKeysDown; keyIndex++)
+	{
+		m_isKeyDown[parser.ParseByte()] = true;
+	}
+	m_cursorClientDelta.x = parser.ParseFloat();
+	m_cursorClientDelta.y = parser.ParseFloat();
+	m_wheelScrollDelta = parser.ParseFloat();
+}
+
+//---------------------------------------------------------------------------------------
+
+InputTrace::InputTrace(Game* game)
+	: m_game(game)
+{
+	SubscribeEventCallbackFunction("StartInputRecording", Event_StartInputRecording, "Records input to a trace file. Usage: StartInputRecording file=<name>");
+	SubscribeEventCallbackFunction("StopInputRecording", Event_StopInputRecording, "Stops recording and writes the trace file");
+	SubscribeEventCallbackFunction("StartInputReplay", Event_StartInputReplay, "Replays a recorded input trace. Usage: StartInputReplay file=<name>");
+	SubscribeEventCallbackFunction("StopInputReplay", Event_StopInputReplay, "Stops replaying and returns to live input");
+}
+
+void InputTrace::BeginFrame(float liveDeltaSeconds)
+{
+	InputFrame previousFrame = m_frame;
+
+	if (m_mode == InputTraceMode::REPLAYING)
+	{
+		if (m_replayFrameIndex < (int)m_recordedFrames.size())
+		{
+			m_frame = m_recordedFrames[m_replayFrameIndex];
+			m_replayFrameIndex++;
+			m_frame.DeriveKeyTransitions(previousFrame);
+			return;
+		}
+
+		g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Input replay finished after %d frames", m_replayFrameIndex), false);
+		StopReplay();
+	}
+
+	m_frame.m_deltaSeconds = liveDeltaSeconds;
+	m_frame.CaptureLive();
+	m_frame.DeriveKeyTransitions(previousFrame);
+
+	if (m_mode == InputTraceMode::RECORDING)
+	{
+		m_recordedFrames.push_back(m_frame);
+	}
+}
+
+bool InputTrace::StartRecording(std::string const& filename)
+{
+	if (m_mode != InputTraceMode::LIVE || !m_game->m_currentMap)
+	{
+		return false;
+	}
+
+	m_seed = (unsigned int)(GetCurrentTimeSeconds() * 1000.0);
+	m_startPlayerState = m_game->m_player->m_state;
+	m_startPlayerPosition = m_game->m_player->m_position;
+	m_startPlayerOrientation = m_game->m_player->m_orientation;
+	RestartSimulation(m_seed);
+
+	m_filename = filename;
+	m_recordedFrames.clear();
+	m_mode = InputTraceMode::RECORDING;
+	return true;
+}
+
+void InputTrace::StopRecording()
+{
+	if (m_mode != InputTraceMode::RECORDING)
+	{
+		return;
+	}
+
+	std::vector<uint8_t> buffer;
+	BufferWriter writer(buffer);
+
+	writer.AppendByte(INPUT_TRACE_4CC_CODE[0]);
+	writer.AppendByte(INPUT_TRACE_4CC_CODE[1]);
+	writer.AppendByte(INPUT_TRACE_4CC_CODE[2]);
+	writer.AppendByte(INPUT_TRACE_4CC_CODE[3]);
+	writer.AppendByte(INPUT_TRACE_VERSION);
+	writer.AppendUint32(m_seed);
+	writer.AppendByte((uint8_t)m_startPlayerState);
+	writer.AppendVec3(m_startPlayerPosition);
+	writer.AppendEulerAngles(m_startPlayerOrientation);
+	writer.AppendUint32((uint32_t)m_recordedFrames.size());
+
+	for (int frameIndex = 0; frameIndex < (int)m_recordedFrames.size(); frameIndex++)
+	{
+		m_recordedFrames[frameIndex].AppendToBuffer(writer);
+	}
+
+	FileWriteBuffer(Stringf("Saved\\%s.altrace", m_filename.c_str()), buffer);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Recorded %d input frames to %s.altrace", (int)m_recordedFrames.size(), m_filename.c_str()), false);
+
+	m_recordedFrames.clear();
+	m_mode = InputTraceMode::LIVE;
+}
+
+bool InputTrace::StartReplay(std::string const& filename)
+{
+	if (m_mode != InputTraceMode::LIVE || !m_game->m_currentMap)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> traceRawData;
+	FileReadToBuffer(traceRawData, Stringf("Saved\\%s.altrace", filename.c_str()));
+	if (traceRawData.empty())
+	{
+		g_console->AddLine(Rgba8::RED, Stringf("Could not read input trace %s.altrace", filename.c_str()), false);
+		return false;
+	}
+
+	if (traceRawData.size() < INPUT_TRACE_HEADER_SIZE)
+	{
+		g_console->AddLine(Rgba8::RED, Stringf("Input trace %s.altrace is truncated", filename.c_str()), false);
+		return false;
+	}
+
+	BufferParser parser(traceRawData);
+	for (int codeIndex = 0; codeIndex < 4; codeIndex++)
+	{
+		if (parser.ParseChar() != INPUT_TRACE_4CC_CODE[codeIndex])
+		{
+			g_console->AddLine(Rgba8::RED, "File code mismatch! Are you sure this is a .altrace file?", false);
+			return false;
+		}
+	}
+	if (parser.ParseByte() != INPUT_TRACE_VERSION)
+	{
+		g_console->AddLine(Rgba8::RED, "Input trace version mismatch!", false);
+		return false;
+	}
+
+	m_seed = parser.ParseUint32();
+	m_startPlayerState = (PlayerState)parser.ParseByte();
+	m_startPlayerPosition = parser.ParseVec3();
+	m_startPlayerOrientation = parser.ParseEulerAngles();
+
+	if (m_startPlayerState != m_game->m_player->m_state)
+	{
+		g_console->AddLine(Rgba8::RED, "Input trace was recorded in a different player state", false);
+		return false;
+	}
+
+	uint32_t numFrames = parser.ParseUint32();
+	if (!IsTraceComplete(traceRawData, numFrames))
+	{
+		g_console->AddLine(Rgba8::RED, Stringf("Input trace %s.altrace is truncated", filename.c_str()), false);
+		return false;
+	}
+
+	m_recordedFrames.resize(numFrames);
+	for (int frameIndex = 0; frameIndex < (int)numFrames; frameIndex++)
+	{
+		m_recordedFrames[frameIndex].ParseFromBuffer(parser);
+	}
+
+	RestartSimulation(m_seed);
+
+	m_filename = filename;
+	m_replayFrameIndex = 0;
+	m_mode = InputTraceMode::REPLAYING;
+	return true;
+}
+
+void InputTrace::StopReplay()
+{
+	if (m_mode != InputTraceMode::REPLAYING)
+	{
+		return;
+	}
+
+	m_recordedFrames.clear();
+	m_replayFrameIndex = 0;
+	m_mode = InputTraceMode::LIVE;
+}
+
+InputFrame const& InputTrace::GetFrame() const
+{
+	return m_frame;
+}
+
+bool InputTrace::IsRecording() const
+{
+	return m_mode == InputTraceMode::RECORDING;
+}
+
+bool InputTrace::IsReplaying() const
+{
+	return m_mode == InputTraceMode::REPLAYING;
+}
+
+void InputTrace::RestartSimulation(unsigned int seed)
+{
+	// Gameplay randomness has to restart from the same seed for the recorded inputs to produce the same world
+	delete g_rng;
+	g_rng = new RandomNumberGenerator(seed);
+
+	Player* player = m_game->m_player;
+	player->m_position = m_startPlayerPosition;
+	player->m_orientation = m_startPlayerOrientation;
+
+	Map* map = m_game->m_currentMap;
+	if (player->m_state == PlayerState::PLAY)
+	{
+		map->ResetAllEntityStates();
+	}
+	map->m_tickScheduler.Restart();
+
+	m_frame = InputFrame();
+}
+
+bool InputTrace::IsTraceComplete(std::vector<uint8_t> const& traceRawData, uint32_t numFrames)
+{
+	// Frames vary in size with the keys held, so the whole trace is walked once before the parser is allowed to read it
+	size_t offset = INPUT_TRACE_HEADER_SIZE;
+	for (uint32_t frameIndex = 0; frameIndex < numFrames; frameIndex++)
+	{
+		if (traceRawData.size() - offset < InputFrame::BUFFER_SIZE_BEFORE_KEYS + 1)
+		{
+			return false;
+		}
+
+		size_t numKeysDown = (size_t)traceRawData[offset + InputFrame::BUFFER_SIZE_BEFORE_KEYS];
+		size_t frameSize = InputFrame::BUFFER_SIZE_BEFORE_KEYS + 1 + numKeysDown + InputFrame::BUFFER_SIZE_AFTER_KEYS;
+		if (traceRawData.size() - offset < frameSize)
+		{
+			return false;
+		}
+		offset += frameSize;
+	}
+
+	return true;
+}
+
+bool InputTrace::Event_StartInputRecording(EventArgs& args)
+{
+	std::string filename = args.GetValue("file", "trace");
+	InputTrace& inputTrace = g_app->m_game->m_inputTrace;
+	if (!inputTrace.StartRecording(filename))
+	{
+		g_console->AddLine(Rgba8::RED, "Could not start recording. A map must be open and no trace can be active", false);
+		return false;
+	}
+
+	return true;
+}
+
+bool InputTrace::Event_StopInputRecording(EventArgs& args)
+{
+	UNUSED(args);
+	g_app->m_game->m_inputTrace.StopRecording();
+	return true;
+}
+
+bool InputTrace::Event_StartInputReplay(EventArgs& args)
+{
+	std::string filename = args.GetValue("file", "trace");
+	return g_app->m_game->m_inputTrace.StartReplay(filename);
+}
+
+bool InputTrace::Event_StopInputReplay(EventArgs& args)
+{
+	UNUSED(args);
+	g_app->m_game->m_inputTrace.StopReplay();
+	return true;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+
+class Game;
+class VRController;
+
+
+enum class InputTraceMode
+{
+	NONE = -1,
+	LIVE,
+	RECORDING,
+	REPLAYING,
+	NUM
+};
+
+enum ControllerButtonFlags : uint16_t
+{
+	CONTROLLER_ACTIVE						= 1 << 0,
+	CONTROLLER_JOYSTICK_PRESSED				= 1 << 1,
+	CONTROLLER_JOYSTICK_TOUCHED				= 1 << 2,
+	CONTROLLER_SELECT_TOUCHED				= 1 << 3,
+	CONTROLLER_TRIGGER_TOUCHED				= 1 << 4,
+	CONTROLLER_BACK_TOUCHED					= 1 << 5,
+	CONTROLLER_BACK_JUST_PRESSED			= 1 << 6,
+	CONTROLLER_GRIP_JUST_PRESSED			= 1 << 7,
+	CONTROLLER_GRIP_JUST_RELEASED			= 1 << 8,
+	CONTROLLER_SELECT_JUST_PRESSED			= 1 << 9,
+	CONTROLLER_THUMB_REST_JUST_TOUCHED		= 1 << 10,
+	CONTROLLER_TRIGGER_JUST_PRESSED			= 1 << 11,
+	CONTROLLER_TRIGGER_JUST_RELEASED		= 1 << 12,
+};
+
+
+struct JoystickInputState
+{
+public:
+	Vec2 GetPosition() const { return m_position; }
+
+public:
+	Vec2 m_position = Vec2::ZERO;
+};
+
+// Mirrors the subset of VRController that gameplay reads, so recorded frames can stand in for the live device
+struct ControllerInputState
+{
+public:
+	void CaptureFromController(VRController const& controller);
+	void AppendToBuffer(BufferWriter& writer) const;
+	void ParseFromBuffer(BufferParser& parser);
+
+	static constexpr size_t BUFFER_SIZE = 3 * 12 + 4 * 4 + 2;
+
+	bool IsActive() const								{ return (m_buttonFlags & CONTROLLER_ACTIVE) != 0; }
+	Vec3 GetPosition_iFwd_jLeft_kUp() const				{ return m_position; }
+	EulerAngles GetOrientation_iFwd_jLeft_kUp() const	{ return m_orientation; }
+	Vec3 GetLinearVelocity_iFwd_jLeft_kUp() const		{ return m_linearVelocity; }
+	JoystickInputState const& GetJoystick() const		{ return m_joystick; }
+	float GetGrip() const								{ return m_grip; }
+	float GetTrigger() const							{ return m_trigger; }
+	bool IsJoystickPressed() const						{ return (m_buttonFlags & CONTROLLER_JOYSTICK_PRESSED) != 0; }
+	bool IsJoystickTouched() const						{ return (m_buttonFlags & CONTROLLER_JOYSTICK_TOUCHED) != 0; }
+	bool IsSelectButtonTouched() const					{ return (m_buttonFlags & CONTROLLER_SELECT_TOUCHED) != 0; }
+	bool IsTriggerTouched() const						{ return (m_buttonFlags & CONTROLLER_TRIGGER_TOUCHED) != 0; }
+	bool IsBackButtonTouched() const					{ return (m_buttonFlags & CONTROLLER_BACK_TOUCHED) != 0; }
+	bool WasBackButtonJustPressed() const				{ return (m_buttonFlags & CONTROLLER_BACK_JUST_PRESSED) != 0; }
+	bool WasGripJustPressed() const						{ return (m_buttonFlags & CONTROLLER_GRIP_JUST_PRESSED) != 0; }
+	bool WasGripJustReleased() const					{ return (m_buttonFlags & CONTROLLER_GRIP_JUST_RELEASED) != 0; }
+	bool WasSelectButtonJustPressed() const				{ return (m_buttonFlags & CONTROLLER_SELECT_JUST_PRESSED) != 0; }
+	bool WasThumbRestJustTouched() const				{ return (m_buttonFlags & CONTROLLER_THUMB_REST_JUST_TOUCHED) != 0; }
+	bool WasTriggerJustPressed() const					{ return (m_buttonFlags & CONTROLLER_TRIGGER_JUST_PRESSED) != 0; }
+	bool WasTriggerJustReleased() const					{ return (m_buttonFlags & CONTROLLER_TRIGGER_JUST_RELEASED) != 0; }
+
+public:
+	Vec3 m_position = Vec3::ZERO;
+	EulerAngles m_orientation = EulerAngles::ZERO;
+	Vec3 m_linearVelocity = Vec3::ZERO;
+	JoystickInputState m_joystick;
+	float m_grip = 0.f;
+	float m_trigger = 0.f;
+	uint16_t m_buttonFlags = 0;
+};
+
+// Everything gameplay reads from devices in one frame
+// Only keys that are held are stored, and just pressed/released are derived from the previous frame the same way the input system does
+struct InputFrame
+{
+public:
+	void CaptureLive();
+	void DeriveKeyTransitions(InputFrame const& previousFrame);
+	void AppendToBuffer(BufferWriter& writer) const;
+	void ParseFromBuffer(BufferParser& parser);
+
+	bool IsKeyDown(unsigned char keyCode) const				{ return m_isKeyDown[keyCode]; }
+	bool WasKeyJustPressed(unsigned char keyCode) const		{ return m_isKeyDown[keyCode] && !m_wasKeyDown[keyCode]; }
+	bool WasKeyJustReleased(unsigned char keyCode) const	{ return !m_isKeyDown[keyCode] && m_wasKeyDown[keyCode]; }
+	bool IsShiftHeld() const								{ return m_isShiftHeld; }
+	Vec2 GetCursorClientDelta() const						{ return m_cursorClientDelta; }
+	float GetWheelScrollDelta() const						{ return m_wheelScrollDelta; }
+
+public:
+	static constexpr int NUM_KEYS = 256;
+
+	// A frame is written as this fixed part, then a count of held keys, one byte per held key, and the cursor and wheel deltas
+	static constexpr size_t BUFFER_SIZE_BEFORE_KEYS = 4 + 1 + 4 * 12 + 2 * ControllerInputState::BUFFER_SIZE;
+	static constexpr size_t BUFFER_SIZE_AFTER_KEYS = 3 * 4;
+
+	float m_deltaSeconds = 0.f;
+	bool m_isVRActive = false;
+
+	Vec3 m_leftEyeLocalPosition = Vec3::ZERO;
+	Vec3 m_rightEyeLocalPosition = Vec3::ZERO;
+	EulerAngles m_leftEyeOrientation = EulerAngles::ZERO;
+	EulerAngles m_rightEyeOrientation = EulerAngles::ZERO;
+
+	ControllerInputState m_leftController;
+	ControllerInputState m_rightController;
+
+	std::bitset<NUM_KEYS> m_isKeyDown;
+	std::bitset<NUM_KEYS> m_wasKeyDown;
+	bool m_isShiftHeld = false;
+	Vec2 m_cursorClientDelta = Vec2::ZERO;
+	float m_wheelScrollDelta = 0.f;
+};
+
+
+class InputTrace
+{
+public:
+	~InputTrace() = default;
+	InputTrace() = default;
+	explicit InputTrace(Game* game);
+
+	void BeginFrame(float liveDeltaSeconds);
+
+	bool StartRecording(std::string const& filename);
+	void StopRecording();
+	bool StartReplay(std::string const& filename);
+	void StopReplay();
+
+	InputFrame const& GetFrame() const;
+	bool IsRecording() const;
+	bool IsReplaying() const;
+
+	static bool Event_StartInputRecording(EventArgs& args);
+	static bool Event_StopInputRecording(EventArgs& args);
+	static bool Event_StartInputReplay(EventArgs& args);
+	static bool Event_StopInputReplay(EventArgs& args);
+
+public:
+	static constexpr char const* INPUT_TRACE_4CC_CODE = "GHIT";
+	static constexpr uint8_t INPUT_TRACE_VERSION = 1;
+	static constexpr size_t INPUT_TRACE_HEADER_SIZE = 4 + 1 + 4 + 1 + 12 + 12 + 4;
+
+	Game* m_game = nullptr;
+	InputTraceMode m_mode = InputTraceMode::LIVE;
+	std::string m_filename = "";
+
+private:
+	void RestartSimulation(unsigned int seed);
+	static bool IsTraceComplete(std::vector<uint8_t> const& traceRawData, uint32_t numFrames);
+
+private:
+	InputFrame m_frame;
+	std::vector<InputFrame> m_recordedFrames;
+	int m_replayFrameIndex = 0;
+
+	unsigned int m_seed = 0;
+	PlayerState m_startPlayerState = PlayerState::NONE;
+	Vec3 m_startPlayerPosition = Vec3::ZERO;
+	EulerAngles m_startPlayerOrientation = EulerAngles::ZERO;
+};
@@ -0,0 +1,345 @@
+#include "Game/InstancedModel.hpp"
+
+#include "Game/MeshCache.hpp"
+#include "Game/RenderQueue.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+
+#include <algorithm>
+
+
+std::map<std::string, InstancedModel*> InstancedModel::s_instancedModelsByPath;
+
+
+InstancedModel::~InstancedModel()
+{
+	for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+	{
+		delete m_subMeshes[subMeshIndex].m_vertexBuffer;
+	}
+}
+
+InstancedSubMesh const* InstancedModel::GetSubMesh(std::string const& subMeshName) const
+{
+	// An unnamed lookup means the whole model, which only maps to a single draw when there is one group
+	if (subMeshName.empty())
+	{
+		return m_subMeshes.size() == 1 ? &m_subMeshes[0] : nullptr;
+	}
+
+	for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+	{
+		if (m_subMeshes[subMeshIndex].m_name == subMeshName)
+		{
+			return &m_subMeshes[subMeshIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+void InstancedModel::Submit(RenderQueue& queue, RenderState const& state, Mat44 const& transform, Rgba8 const& color) const
+{
+	for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+	{
+		InstancedSubMesh const& subMesh = m_subMeshes[subMeshIndex];
+		if (subMesh.m_vertexBuffer)
+		{
+			queue.SubmitVertexes(state, transform, color, subMesh.m_vertexBuffer, (int)subMesh.m_vertexes.size());
+		}
+	}
+}
+
+void InstancedModel::SubmitSubMesh(RenderQueue& queue, RenderState const& state, std::string const& subMeshName, Mat44 const& transform, Rgba8 const& color) const
+{
+	InstancedSubMesh const* subMesh = GetSubMesh(subMeshName);
+	if (subMesh && subMesh->m_vertexBuffer)
+	{
+		queue.SubmitVertexes(state, transform, color, subMesh->m_vertexBuffer, (int)subMesh->m_vertexes.size());
+	}
+}
+
+void InstancedModel::Draw() const
+{
+	for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+	{
+		InstancedSubMesh const& subMesh = m_subMeshes[subMeshIndex];
+		if (subMesh.m_vertexBuffer)
+		{
+			g_renderer->DrawVertexBuffer(subMesh.m_vertexBuffer, (int)subMesh.m_vertexes.size());
+		}
+	}
+}
+
+InstancedModel const* InstancedModel::CreateOrGetFromObj(std::string const& objFilePath, Mat44 const& transform, InstancedModel* loadedInstancedModel)
+{
+	// A model loaded ahead of time on another thread is adopted here, or dropped if the same model was created first
+	auto modelIter = s_instancedModelsByPath.find(objFilePath);
+	if (modelIter != s_instancedModelsByPath.end())
+	{
+		delete loadedInstancedModel;
+		return modelIter->second;
+	}
+
+	InstancedModel* instancedModel = loadedInstancedModel ? loadedInstancedModel : LoadWithoutVertexBuffers(objFilePath, transform);
+	instancedModel->CreateVertexBuffers();
+	s_instancedModelsByPath[objFilePath] = instancedModel;
+	return instancedModel;
+}
+
+InstancedModel* InstancedModel::LoadWithoutVertexBuffers(std::string const& objFilePath, Mat44 const& transform)
+{
+	// Touches nothing but files and the new model, so it can run on any thread
+	InstancedModel* instancedModel = new InstancedModel();
+	instancedModel->LoadFromCacheOrObj(objFilePath, transform);
+	return instancedModel;
+}
+
+void InstancedModel::DestroyAll()
+{
+	for (auto modelIter = s_instancedModelsByPath.begin(); modelIter != s_instancedModelsByPath.end(); ++modelIter)
+	{
+		delete modelIter->second;
+	}
+	s_instancedModelsByPath.clear();
+}
+
+int InstancedModel::SplitObjLine(std::vector<std::string>& out_tokens, std::string const& line)
+{
+	// OBJ and MTL fields may be separated by any run of spaces or tabs, and exporters often leave a trailing '\r'
+	out_tokens.clear();
+	size_t tokenStart = 0;
+	while (tokenStart < line.size())
+	{
+		while (tokenStart < line.size() && (line[tokenStart] == ' ' || line[tokenStart] == '\t' || line[tokenStart] == '\r'))
+		{
+			tokenStart++;
+		}
+
+		size_t tokenEnd = tokenStart;
+		while (tokenEnd < line.size() && line[tokenEnd] != ' ' && line[tokenEnd] != '\t' && line[tokenEnd] != '\r')
+		{
+			tokenEnd++;
+		}
+
+		if (tokenEnd > tokenStart)
+		{
+			out_tokens.push_back(line.substr(tokenStart, tokenEnd - tokenStart));
+		}
+		tokenStart = tokenEnd;
+	}
+
+	return (int)out_tokens.size();
+}
+
+void InstancedModel::LoadFromCacheOrObj(std::string const& objFilePath, Mat44 const& transform)
+{
+	// The OBJ is only hashed to find its cooked copy, it is parsed when that copy is missing or stale and the result is cooked for next time
+	uint64_t contentHash = ComputeMeshSourceHash(objFilePath, transform);
+	if (contentHash != 0)
+	{
+		std::string cacheFilePath = GetMeshCacheFilePath(contentHash);
+		if (ReadMeshCache(cacheFilePath, contentHash, m_subMeshes))
+		{
+			m_objFilePath = objFilePath;
+			return;
+		}
+
+		LoadFromObj(objFilePath, transform);
+		WriteMeshCache(cacheFilePath, contentHash, m_subMeshes);
+		return;
+	}
+
+	LoadFromObj(objFilePath, transform);
+}
+
+void InstancedModel::LoadFromObj(std::string const& objFilePath, Mat44 const& transform)
+{
+	m_objFilePath = objFilePath;
+
+	std::string objText;
+	if (FileReadToString(objText, objFilePath) < 0)
+	{
+		ERROR_AND_DIE(Stringf("Unable to open or read file \"%s\"", objFilePath.c_str()));
+	}
+
+	std::string objDirectory = "";
+	size_t lastSlashIndex = objFilePath.find_last_of("/\\");
+	if (lastSlashIndex != std::string::npos)
+	{
+		objDirectory = objFilePath.substr(0, lastSlashIndex + 1);
+	}
+
+	std::map<std::string, Rgba8> materialColorsByName;
+	std::vector<Vec3> positions;
+	std::vector<Vec3> normals;
+	std::vector<Vec2> uvs;
+	Rgba8 currentColor = Rgba8::WHITE;
+	InstancedSubMesh* currentSubMesh = nullptr;
+
+	Strings objLines;
+	int numObjLines = SplitStringOnDelimiter(objLines, objText, '\n');
+	for (int lineIndex = 0; lineIndex < numObjLines; lineIndex++)
+	{
+		Strings tokens;
+		int numTokens = SplitObjLine(tokens, objLines[lineIndex]);
+		if (numTokens == 0 || tokens[0][0] == '#')
+		{
+			continue;
+		}
+
+		std::string const& keyword = tokens[0];
+		if (keyword == "v" && numTokens >= 4)
+		{
+			positions.push_back(Vec3((float)atof(tokens[1].c_str()), (float)atof(tokens[2].c_str()), (float)atof(tokens[3].c_str())));
+		}
+		else if (keyword == "vn" && numTokens >= 4)
+		{
+			normals.push_back(Vec3((float)atof(tokens[1].c_str()), (float)atof(tokens[2].c_str()), (float)atof(tokens[3].c_str())));
+		}
+		else if (keyword == "vt" && numTokens >= 3)
+		{
+			uvs.push_back(Vec2((float)atof(tokens[1].c_str()), (float)atof(tokens[2].c_str())));
+		}
+		else if ((keyword == "g" || keyword == "o") && numTokens >= 2)
+		{
+			// Groups may be reopened later in the file, so append to the existing sub-mesh rather than starting a new one
+			currentSubMesh = nullptr;
+			for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+			{
+				if (m_subMeshes[subMeshIndex].m_name == tokens[1])
+				{
+					currentSubMesh = &m_subMeshes[subMeshIndex];
+					break;
+				}
+			}
+			if (!currentSubMesh)
+			{
+				m_subMeshes.push_back(InstancedSubMesh());
+				currentSubMesh = &m_subMeshes.back();
+				currentSubMesh->m_name = tokens[1];
+			}
+		}
+		else if (keyword == "mtllib" && numTokens >= 2)
+		{
+			std::string mtlText;
+			if (FileReadToString(mtlText, objDirectory + tokens[1]) < 0)
+			{
+				continue;
+			}
+
+			Strings mtlLines;
+			int numMtlLines = SplitStringOnDelimiter(mtlLines, mtlText, '\n');
+			std::string materialName = "";
+			for (int mtlLineIndex = 0; mtlLineIndex < numMtlLines; mtlLineIndex++)
+			{
+				Strings mtlTokens;
+				int numMtlTokens = SplitObjLine(mtlTokens, mtlLines[mtlLineIndex]);
+				if (numMtlTokens >= 2 && mtlTokens[0] == "newmtl")
+				{
+					materialName = mtlTokens[1];
+				}
+				else if (numMtlTokens >= 4 && mtlTokens[0] == "Kd")
+				{
+					materialColorsByName[materialName] = Rgba8(DenormalizeByte((float)atof(mtlTokens[1].c_str())), DenormalizeByte((float)atof(mtlTokens[2].c_str())), DenormalizeByte((float)atof(mtlTokens[3].c_str())), 255);
+				}
+			}
+		}
+		else if (keyword == "usemtl" && numTokens >= 2)
+		{
+			auto materialIter = materialColorsByName.find(tokens[1]);
+			currentColor = materialIter != materialColorsByName.end() ? materialIter->second : Rgba8::WHITE;
+		}
+		else if (keyword == "f" && numTokens >= 4)
+		{
+			if (!currentSubMesh)
+			{
+				m_subMeshes.push_back(InstancedSubMesh());
+				currentSubMesh = &m_subMeshes.back();
+			}
+
+			std::vector<Vertex_PCUTBN> faceVertexes;
+			bool isMissingNormals = false;
+			for (int tokenIndex = 1; tokenIndex < numTokens; tokenIndex++)
+			{
+				// Face corners are "v", "v/vt", "v//vn" or "v/vt/vn" with 1-based indexes
+				Strings cornerIndexes;
+				int numCornerIndexes = SplitStringOnDelimiter(cornerIndexes, tokens[tokenIndex], '/');
+				int positionIndex = atoi(cornerIndexes[0].c_str()) - 1;
+				int uvIndex = (numCornerIndexes > 1 && !cornerIndexes[1].empty()) ? atoi(cornerIndexes[1].c_str()) - 1 : -1;
+				int normalIndex = (numCornerIndexes > 2 && !cornerIndexes[2].empty()) ? atoi(cornerIndexes[2].c_str()) - 1 : -1;
+
+				Vec3 position = (positionIndex >= 0 && positionIndex < (int)positions.size()) ? positions[positionIndex] : Vec3::ZERO;
+				Vec2 uv = (uvIndex >= 0 && uvIndex < (int)uvs.size()) ? uvs[uvIndex] : Vec2::ZERO;
+				Vec3 normal = Vec3::ZERO;
+				if (normalIndex >= 0 && normalIndex < (int)normals.size())
+				{
+					normal = normals[normalIndex];
+				}
+				else
+				{
+					isMissingNormals = true;
+				}
+
+				position = transform.TransformPosition3D(position);
+				normal = transform.TransformVectorQuantity3D(normal).GetNormalized();
+				faceVertexes.push_back(Vertex_PCUTBN(position, currentColor, uv, Vec3::ZERO, Vec3::ZERO, normal));
+			}
+
+			// Faces without normals get a flat one, and anything with more than three corners is fanned
+			for (int cornerIndex = 1; cornerIndex + 1 < (int)faceVertexes.size(); cornerIndex++)
+			{
+				Vertex_PCUTBN triangle[3] = { faceVertexes[0], faceVertexes[cornerIndex], faceVertexes[cornerIndex + 1] };
+				if (isMissingNormals)
+				{
+					Vec3 faceNormal = CrossProduct3D(triangle[1].m_position - triangle[0].m_position, triangle[2].m_position - triangle[0].m_position).GetNormalized();
+					triangle[0].m_normal = faceNormal;
+					triangle[1].m_normal = faceNormal;
+					triangle[2].m_normal = faceNormal;
+				}
+
+				currentSubMesh->m_vertexes.push_back(triangle[0]);
+				currentSubMesh->m_vertexes.push_back(triangle[1]);
+				currentSubMesh->m_vertexes.push_back(triangle[2]);
+			}
+		}
+	}
+}
+
+void InstancedModel::CreateVertexBuffers()
+{
+	for (int subMeshIndex = 0; subMeshIndex < (int)m_subMeshes.size(); subMeshIndex++)
+	{
+		InstancedSubMesh& subMesh = m_subMeshes[subMeshIndex];
+		int numVertexesPerInstance = (int)subMesh.m_vertexes.size();
+		if (numVertexesPerInstance == 0)
+		{
+			continue;
+		}
+
+		// Large meshes get fewer copies so the replicated buffer stays bounded
+		subMesh.m_maxInstancesPerDraw = std::max(1, std::min(MAX_REPLICATED_VERTEXES / numVertexesPerInstance, MAX_INSTANCES_PER_DRAW));
+
+		std::vector<Vertex_PCUTBN> replicatedVertexes;
+		replicatedVertexes.reserve((size_t)numVertexesPerInstance * (size_t)subMesh.m_maxInstancesPerDraw);
+		for (int instanceSlot = 0; instanceSlot < subMesh.m_maxInstancesPerDraw; instanceSlot++)
+		{
+			for (int vertexIndex = 0; vertexIndex < numVertexesPerInstance; vertexIndex++)
+			{
+				Vertex_PCUTBN vertex = subMesh.m_vertexes[vertexIndex];
+				vertex.m_tangent = Vec3((float)instanceSlot, 0.f, 0.f);
+				replicatedVertexes.push_back(vertex);
+			}
+		}
+
+		size_t vertexBufferSize = replicatedVertexes.size() * sizeof(Vertex_PCUTBN);
+		subMesh.m_vertexBuffer = g_renderer->CreateVertexBuffer(vertexBufferSize, VertexType::VERTEX_PCUTBN);
+		g_renderer->CopyCPUToGPU(replicatedVertexes.data(), vertexBufferSize, subMesh.m_vertexBuffer);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/Mat44.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+class RenderQueue;
+class VertexBuffer;
+struct RenderState;
+
+
+// One OBJ group ("knob", "handle", "body"...) kept on the CPU and laid out for DiffuseInstanced.hlsl
+// The triangle list is repeated m_maxInstancesPerDraw times in m_vertexBuffer and each copy stores its instance slot in tangent.x
+// The first copy is the plain triangle list, so single draws use the same buffer with only m_vertexes.size() vertexes
+struct InstancedSubMesh
+{
+public:
+	std::string m_name = "";
+	std::vector<Vertex_PCUTBN> m_vertexes;
+	int m_maxInstancesPerDraw = 0;
+	VertexBuffer* m_vertexBuffer = nullptr;
+};
+
+
+class InstancedModel
+{
+public:
+	~InstancedModel();
+	InstancedModel() = default;
+
+	InstancedSubMesh const* GetSubMesh(std::string const& subMeshName) const;
+	void Submit(RenderQueue& queue, RenderState const& state, Mat44 const& transform, Rgba8 const& color) const;
+	void SubmitSubMesh(RenderQueue& queue, RenderState const& state, std::string const& subMeshName, Mat44 const& transform, Rgba8 const& color) const;
+	void Draw() const;
+
+	static InstancedModel const* CreateOrGetFromObj(std::string const& objFilePath, Mat44 const& transform, InstancedModel* loadedInstancedModel = nullptr);
+	static InstancedModel* LoadWithoutVertexBuffers(std::string const& objFilePath, Mat44 const& transform);
+	static void DestroyAll();
+	static int SplitObjLine(std::vector<std::string>& out_tokens, std::string const& line);
+
+public:
+	static constexpr int MAX_INSTANCES_PER_DRAW = 256;
+	static constexpr int MAX_REPLICATED_VERTEXES = 65536;
+
+	std::string m_objFilePath = "";
+	std::vector<InstancedSubMesh> m_subMeshes;
+
+private:
+	void LoadFromCacheOrObj(std::string const& objFilePath, Mat44 const& transform);
+	void LoadFromObj(std::string const& objFilePath, Mat44 const& transform);
+	void CreateVertexBuffers();
+
+private:
+	static std::map<std::string, InstancedModel*> s_instancedModelsByPath;
+};
@@ -1,16 +1,16 @@
 #include "Game/Lever.hpp"
 
-#include "Game/Activatable.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/HandController.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
@@ -22,7 +22,7 @@
 Lever::Lever(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Activator(map, uid, position, orientation, scale, EntityType::LEVER)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Activators/lever", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Activators/lever.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
 	m_scale = MODEL_SCALE;
 	m_localBounds = AABB3(Vec3(-0.1f, -0.3f, 0.f), Vec3(0.1f, 0.3f, 1.f));
 	m_crankSFX = g_audio->CreateOrGetSound("Data/SFX/Lever.wav", true);
@@ -74,15 +74,7 @@ void Lever::Update()
 		}
 
 		m_value = 1.f;
-		Entity* activatableEntity = m_map->GetEntityFromUID(m_activatableUID);
-		if (activatableEntity)
-		{
-			Activatable* activatable = dynamic_cast<Activatable*>(activatableEntity);
-			if (activatable)
-			{
-				activatable->Activate();
-			}
-		}
+		m_map->m_signalGraph.EmitSignal(m_uid, true);
 	}
 	else if (m_value < 0.9f && m_valueLastFrame >= 0.9f)
 	{
@@ -96,15 +88,7 @@ void Lever::Update()
 			g_openXR->GetRightController().ApplyHapticFeedback(CONTROLLER_VIBRATION_AMPLITUDE, CONTROLLER_VIBRATION_DURATION);
 		}
 
-		Entity* activatableEntity = m_map->GetEntityFromUID(m_activatableUID);
-		if (activatableEntity)
-		{
-			Activatable* activatable = dynamic_cast<Activatable*>(activatableEntity);
-			if (activatable)
-			{
-				activatable->Deactivate();
-			}
-		}
+		m_map->m_signalGraph.EmitSignal(m_uid, false);
 	}
 
 	m_valueLastFrame = m_value;
@@ -112,7 +96,7 @@ void Lever::Update()
 
 //---------------------------------------------------------------------------------------
 
-void Lever::Render() const
+void Lever::Render(RenderQueue& queue) const
 {
 	Mat44 transform = Mat44::CreateTranslation3D(m_position);
 	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
@@ -123,25 +107,34 @@ void Lever::Render() const
 	handleTransform.AppendScaleUniform3D(m_scale);
 	handleTransform.AppendXRotation(RangeMapClamped(m_value, -1.f, 1.f, -45.f, 45.f));
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
+	RenderState state = m_map->GetDefaultRenderState();
 
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer("lever"), m_model->GetIndexBuffer("lever"), m_model->GetIndexCount("lever"));
+	m_model->SubmitSubMesh(queue, state, "lever", transform, GetColor());
+
+	m_model->SubmitSubMesh(queue, state, "handle", handleTransform, GetColor());
+}
+
+bool Lever::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	if (!m_model)
+	{
+		return false;
+	}
+
+	Mat44 transform = GetModelMatrix();
+	Mat44 handleTransform(transform);
+	handleTransform.AppendXRotation(RangeMapClamped(m_value, -1.f, 1.f, -45.f, 45.f));
 
-	g_renderer->SetModelConstants(handleTransform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer("handle"), m_model->GetIndexBuffer("handle"), m_model->GetIndexCount("handle"));
+	renderer.AddInstance(m_model, "lever", transform, GetColor());
+	renderer.AddInstance(m_model, "handle", handleTransform, GetColor());
+	return true;
 }
 
 //---------------------------------------------------------------------------------------
 
 void Lever::HandlePlayerInteraction()
 {
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_map->m_game->GetDeltaSeconds();
 
 	Player* player = m_map->m_game->m_player;
 	Vec3& playerLeftControllerPosition = player->m_leftController->m_worldPosition;
@@ -168,7 +161,7 @@ void Lever::HandlePlayerInteraction()
 
 		if (m_shouldCheckForLeftHandGrip && m_previousFrameLeftHandGripValue == 0.f)
 		{
-			VRController leftController = g_openXR->GetLeftController();
+			ControllerInputState const& leftController = m_map->m_game->GetInputFrame().m_leftController;
 			float leftHandGrip = leftController.GetGrip();
 			if (leftHandGrip > 0.f)
 			{
@@ -183,7 +176,7 @@ void Lever::HandlePlayerInteraction()
 
 		if (m_shouldCheckForRightHandGrip && m_previousFrameRightHandGripValue == 0.f)
 		{
-			VRController rightController = g_openXR->GetRightController();
+			ControllerInputState const& rightController = m_map->m_game->GetInputFrame().m_rightController;
 			float rightHandGrip = rightController.GetGrip();
 			if (rightHandGrip > 0.f)
 			{
@@ -198,7 +191,7 @@ void Lever::HandlePlayerInteraction()
 
 		if (m_isLeftHandGripped)
 		{
-			VRController leftController = g_openXR->GetLeftController();
+			ControllerInputState const& leftController = m_map->m_game->GetInputFrame().m_leftController;
 			float leftHandGrip = leftController.GetGrip();
 			if (leftHandGrip == 0.f)
 			{
@@ -228,7 +221,7 @@ void Lever::HandlePlayerInteraction()
 		}
 		if (m_isRightHandGripped)
 		{
-			VRController rightController = g_openXR->GetRightController();
+			ControllerInputState const& rightController = m_map->m_game->GetInputFrame().m_rightController;
 			float rightHandGrip = rightController.GetGrip();
 			if (rightHandGrip == 0.f)
 			{
@@ -258,18 +251,18 @@ void Lever::HandlePlayerInteraction()
 
 	if (GetDistanceSquared3D(m_position, m_map->m_game->m_player->m_pawn->m_position) < 1.f)
 	{
-		if (g_input->IsKeyDown('E'))
+		if (m_map->m_game->GetInputFrame().IsKeyDown('E'))
 		{
 			m_value += 1.f * deltaSeconds;
 		}
-		if (g_input->IsKeyDown('Q'))
+		if (m_map->m_game->GetInputFrame().IsKeyDown('Q'))
 		{
 			m_value -= 1.f * deltaSeconds;
 		}
 	}
 
-	m_previousFrameLeftHandGripValue = g_openXR->GetLeftController().GetGrip();
-	m_previousFrameRightHandGripValue = g_openXR->GetRightController().GetGrip();
+	m_previousFrameLeftHandGripValue = m_map->m_game->GetInputFrame().m_leftController.GetGrip();
+	m_previousFrameRightHandGripValue = m_map->m_game->GetInputFrame().m_rightController.GetGrip();
 }
 
 void Lever::ResetState()
@@ -11,12 +11,17 @@
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Goal.hpp"
+#include "Game/HandController.hpp"
 #include "Game/Lever.hpp"
+#include "Game/MapFile.hpp"
+#include "Game/MapSaver.hpp"
+#include "Game/MappedFile.hpp"
 #include "Game/MovingPlatform.hpp"
 #include "Game/Particle.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 #include "Game/PlayerStart.hpp"
+#include "Game/RegionStreamer.hpp"
 #include "Game/Tile.hpp"
 #include "Game/TileDefinition.hpp"
 
@@ -24,8 +29,10 @@
 
 #include "Engine/Core/BufferParser.hpp"
 #include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
@@ -34,14 +41,27 @@
 #include "Engine/UI/UISystem.hpp"
 #include "Engine/VirtualReality/VRController.hpp"
 
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <utility>
+
 
 Map::~Map()
 {
+	delete m_mapSaver;
+	delete m_regionStreamer;
 	delete m_shaderCBO;
 }
 
 Map::Map(Game* game)
 	: m_game(game)
+	, m_tickScheduler(this)
+	, m_signalGraph(this)
+	, m_triggerVolumes(this)
+	, m_tileChunks(this)
+	, m_cullingGrid(this)
 {
 	LoadAssets();
 
@@ -55,45 +75,46 @@ Map::Map(Game* game)
 	m_shaderCBO = g_renderer->CreateConstantBuffer(sizeof(ArchiLeapShaderConstants));
 
 	SubscribeEventCallbackFunction("ToggleLinkLines", Event_ToggleLinkLines, "Toggles link lines rendering");
+	SubscribeEventCallbackFunction("ToggleParticleDepthSort", Event_ToggleParticleDepthSort, "Toggles back to front sorting of particles before they are drawn");
 	SubscribeEventCallbackFunction("ResetTransform", Event_ResetTransform, "Resets transform for an entity");
 	SubscribeEventCallbackFunction("SaveMap", Event_SaveMap, "Saves the map");
+	SubscribeEventCallbackFunction("BenchmarkMapLoad", Event_BenchmarkMapLoad, "Times loading a generated map in the current and previous formats. Usage: BenchmarkMapLoad entities=<count>");
+	SubscribeEventCallbackFunction("VerifyMapEncoding", Event_VerifyMapEncoding, "Encodes the current map, decodes it again and reports any entity that did not survive the round trip");
 	SubscribeEventCallbackFunction("ChangeMovementDirection", Event_ChangeMovementDirection, "Changes the movement direction for a moving platform");
+	SubscribeEventCallbackFunction("ToggleSignalCombinator", Event_ToggleSignalCombinator, "Toggles whether an activatable requires any or all of its activators");
+	SubscribeEventCallbackFunction("SetSignalEdgeType", Event_SetSignalEdgeType, "Sets a link to direct or inverted. Usage: SetSignalEdgeType activator=<uid> activatable=<uid> inverted=<true|false>");
+	SubscribeEventCallbackFunction("RenderQueueStats", RenderQueue::Event_RenderQueueStats, "Prints draw and state change counts for the last rendered view");
 }
 
-Map::Map(Game* game, std::string mapFileName, MapMode mode)
+Map::Map(Game* game, MapMode mode)
 	: m_game(game)
 	, m_mode(mode)
+	, m_tickScheduler(this)
+	, m_signalGraph(this)
+	, m_triggerVolumes(this)
+	, m_tileChunks(this)
+	, m_cullingGrid(this)
 {
 	LoadAssets();
 	m_shaderCBO = g_renderer->CreateConstantBuffer(sizeof(ArchiLeapShaderConstants));
 
 	SubscribeEventCallbackFunction("ToggleLinkLines", Event_ToggleLinkLines, "Toggles link lines rendering");
+	SubscribeEventCallbackFunction("ToggleParticleDepthSort", Event_ToggleParticleDepthSort, "Toggles back to front sorting of particles before they are drawn");
 	SubscribeEventCallbackFunction("ResetTransform", Event_ResetTransform, "Resets transform for an entity");
 	SubscribeEventCallbackFunction("SaveMap", Event_SaveMap, "Saves the map");
+	SubscribeEventCallbackFunction("BenchmarkMapLoad", Event_BenchmarkMapLoad, "Times loading a generated map in the current and previous formats. Usage: BenchmarkMapLoad entities=<count>");
+	SubscribeEventCallbackFunction("VerifyMapEncoding", Event_VerifyMapEncoding, "Encodes the current map, decodes it again and reports any entity that did not survive the round trip");
 	SubscribeEventCallbackFunction("ChangeMovementDirection", Event_ChangeMovementDirection, "Changes the movement direction for a moving platform");
+	SubscribeEventCallbackFunction("ToggleSignalCombinator", Event_ToggleSignalCombinator, "Toggles whether an activatable requires any or all of its activators");
+	SubscribeEventCallbackFunction("SetSignalEdgeType", Event_SetSignalEdgeType, "Sets a link to direct or inverted. Usage: SetSignalEdgeType activator=<uid> activatable=<uid> inverted=<true|false>");
+	SubscribeEventCallbackFunction("RenderQueueStats", RenderQueue::Event_RenderQueueStats, "Prints draw and state change counts for the last rendered view");
+}
 
+Map::Map(Game* game, std::string mapFileName, MapMode mode)
+	: Map(game, mode)
+{
 	LoadFromFile(mapFileName);
-
-	Strings mapFilePathSplit;
-	int numSplitsInFileName = SplitStringOnDelimiter(mapFilePathSplit, mapFileName, '/');
-	std::string mapFileNameWithNoDirectory = mapFilePathSplit[numSplitsInFileName - 1];
-	Strings splitMapName;
-	int numSplits = SplitStringOnDelimiter(splitMapName, mapFileNameWithNoDirectory, '.');
-	std::string mapDisplayName = "";
-	for (int splitIndex = 0; splitIndex < numSplits - 1; splitIndex++)
-	{
-		mapDisplayName += splitMapName[splitIndex];
-	}
-	m_game->m_mapNameInputField->SetText(mapDisplayName);
-
-	if (m_mode == MapMode::PLAY)
-	{
-		m_game->m_player->m_pawn->m_position = m_playerStart->m_position;
-		m_game->m_player->m_pawn->m_orientation = m_playerStart->m_orientation;
-		m_game->m_player->m_pawn->m_velocity = Vec3::ZERO;
-		m_game->m_player->m_pawn->m_acceleration = Vec3::ZERO;
-		m_game->m_player->m_state = PlayerState::PLAY;
-	}
+	EnterGameAfterLoad(mapFileName);
 }
 
 void Map::LoadAssets()
@@ -119,79 +140,511 @@ void Map::InitializeTiles()
 
 void Map::LoadFromFile(std::string filename)
 {
-	std::vector<uint8_t> mapRawData;
-	FileReadToBuffer(mapRawData, filename);
+	double loadStartTimeSeconds = GetCurrentTimeSeconds();
 
-	GUARANTEE_OR_DIE(!mapRawData.empty(), "Could not read data in map file!");
+	MapFileContents contents;
+	bool isStreamed = false;
+	std::string readError;
+	GUARANTEE_OR_DIE(ReadMapFile(filename, m_mode, contents, isStreamed, readError), readError);
+	m_lastLoadReadSeconds = GetCurrentTimeSeconds() - loadStartTimeSeconds;
 
-	BufferParser parser(mapRawData);
+	LoadPlayerStart(contents.m_playerStart);
+	if (isStreamed)
+	{
+		m_regionStreamer = new RegionStreamer(this, filename);
+		m_regionStreamer->LoadRegionsAroundNow(m_playerStart->m_position);
+	}
+	else
+	{
+		m_entities.assign(contents.m_entities.size(), nullptr);
+		for (int slotIndex = 0; slotIndex < (int)contents.m_entities.size(); slotIndex++)
+		{
+			ConstructEntityFromRecord(slotIndex, contents.m_entities[slotIndex]);
+		}
+		LoadSideTables(contents);
+		OpenJournal(filename, contents.m_lastJournalSequence);
+	}
+
+	m_tileChunks.MarkDirty();
+	m_cullingGrid.MarkDirty();
+	OnEntitiesLoaded();
+
+	m_lastLoadTotalSeconds = GetCurrentTimeSeconds() - loadStartTimeSeconds;
+}
+
+bool Map::ReadMapFile(std::string const& filename, MapMode mode, MapFileContents& out_contents, bool& out_isStreamed, std::string& out_error)
+{
+	// Touches nothing but the file and its out parameters, so it can run on a loading thread
+	// A bad file is reported back instead of dying, the caller decides what the player sees
+	out_isStreamed = false;
+	MappedFile mappedFile;
+	if (!mappedFile.Open(filename))
+	{
+		out_error = Stringf("Could not read map file \"%s\"", filename.c_str());
+		return false;
+	}
+	if (mappedFile.GetSize() <= 4 || memcmp(mappedFile.GetData(), SAVEFILE_4CC_CODE, 4) != 0)
+	{
+		out_error = Stringf("\"%s\" is not an .almap file", filename.c_str());
+		return false;
+	}
 
-	uint8_t saveFile4ccCode0 = parser.ParseChar();
-	GUARANTEE_OR_DIE(saveFile4ccCode0 == SAVEFILE_4CC_CODE[0], "File code mismatch! Are you sure this is a .almap file?");
-	uint8_t saveFile4ccCode1 = parser.ParseChar();
-	GUARANTEE_OR_DIE(saveFile4ccCode1 == SAVEFILE_4CC_CODE[1], "File code mismatch! Are you sure this is a .almap file?");
-	uint8_t saveFile4ccCode2 = parser.ParseChar();
-	GUARANTEE_OR_DIE(saveFile4ccCode2 == SAVEFILE_4CC_CODE[2], "File code mismatch! Are you sure this is a .almap file?");
-	uint8_t saveFile4ccCode3 = parser.ParseChar();
-	GUARANTEE_OR_DIE(saveFile4ccCode3 == SAVEFILE_4CC_CODE[3], "File code mismatch! Are you sure this is a .almap file?");
+	// Version 4 and later files are read in place from the mapped view, older versions are copied out and parsed field by field
+	uint8_t saveFileVersion = mappedFile.GetData()[4];
+	if (saveFileVersion < SAVEFILE_VERSION_FIXED_STRIDE)
+	{
+		std::vector<uint8_t> mapRawData(mappedFile.GetData(), mappedFile.GetData() + mappedFile.GetSize());
+		mappedFile.Close();
+		if (!ParseLegacyBuffer(mapRawData, out_contents))
+		{
+			out_error = Stringf("Map file \"%s\" is truncated or corrupt", filename.c_str());
+			return false;
+		}
+
+		std::vector<MapJournalRecord> legacyJournalRecords;
+		ReadMapJournal(GetMapJournalFilePath(filename), out_contents.m_lastJournalSequence, legacyJournalRecords);
+		ApplyMapJournalRecords(legacyJournalRecords, out_contents);
+		return true;
+	}
+
+	MapFileReader reader;
+	if (!reader.Open(mappedFile.GetData(), mappedFile.GetSize()))
+	{
+		out_error = Stringf("Map file \"%s\" is truncated or corrupt", filename.c_str());
+		return false;
+	}
+	if (!reader.ReadSideTables(out_contents))
+	{
+		out_error = Stringf("Map file \"%s\" has no player start", filename.c_str());
+		return false;
+	}
+
+	// Edits made since the last compaction are replayed onto the whole entity list, so a map with any is never streamed
+	std::vector<MapJournalRecord> journalRecords;
+	ReadMapJournal(GetMapJournalFilePath(filename), out_contents.m_lastJournalSequence, journalRecords);
+
+	// Large levels are only played through the regions around the player, the editor always needs every entity
+	if (mode == MapMode::PLAY && journalRecords.empty() && RegionStreamer::IsStreamable(reader))
+	{
+		MapFileSectionView<MapRegionRecord> regionRecords;
+		if (!reader.GetRegions(regionRecords))
+		{
+			out_error = Stringf("Map file \"%s\" has a region pointing past its records", filename.c_str());
+			return false;
+		}
+
+		out_isStreamed = true;
+		return true;
+	}
+
+	// Tile chunks and full records are decoded across every core and merged back into slot order before anything is constructed
+	if (!reader.GetEntityRecordsInSlotOrder(out_contents.m_entities, GetMapDecodeThreadCount()))
+	{
+		out_error = Stringf("Map file \"%s\" entity data is corrupt", filename.c_str());
+		return false;
+	}
+	ApplyMapJournalRecords(journalRecords, out_contents);
+	return true;
+}
+
+// Byte sizes of the legacy fields, checked against what is left of the buffer before each one is parsed
+constexpr size_t LEGACY_HEADER_SIZE = 4 + 1 + 4;
+constexpr size_t LEGACY_ENTITY_RECORD_SIZE = 4 + 3 * 4 + 3 * 4 + 4;
+constexpr size_t LEGACY_SIGNAL_EDGE_SIZE = 4 + 4 + 1;
+constexpr size_t LEGACY_SIGNAL_COMBINATOR_SIZE = 4 + 1;
+
+static bool ConsumeLegacyBytes(size_t& inout_bytesRemaining, size_t numBytes)
+{
+	if (inout_bytesRemaining < numBytes)
+	{
+		return false;
+	}
+
+	inout_bytesRemaining -= numBytes;
+	return true;
+}
+
+static uint32_t PeekLegacyUint32(std::vector<uint8_t> const& mapRawData, size_t offset)
+{
+	uint32_t value = 0;
+	memcpy(&value, mapRawData.data() + offset, sizeof(value));
+	return value;
+}
+
+static MapEntityRecord ParseLegacyEntityRecord(BufferParser& parser, uint8_t entityTypeIndex)
+{
+	MapEntityRecord record;
+	record.m_uid = parser.ParseUint32();
+	Vec3 position = parser.ParseVec3();
+	record.m_position[0] = position.x;
+	record.m_position[1] = position.y;
+	record.m_position[2] = position.z;
+	EulerAngles orientation = parser.ParseEulerAngles();
+	record.m_orientation[0] = orientation.m_yawDegrees;
+	record.m_orientation[1] = orientation.m_pitchDegrees;
+	record.m_orientation[2] = orientation.m_rollDegrees;
+	record.m_scale = parser.ParseFloat();
+	record.m_type = entityTypeIndex;
+	return record;
+}
+
+bool Map::ParseLegacyBuffer(std::vector<uint8_t> const& mapRawData, MapFileContents& out_contents)
+{
+	// Files come from disk and may be cut short or damaged, so every read is checked before the parser is allowed to make it
+	size_t bytesRemaining = mapRawData.size();
+	if (!ConsumeLegacyBytes(bytesRemaining, LEGACY_HEADER_SIZE + 1 + LEGACY_ENTITY_RECORD_SIZE))
+	{
+		return false;
+	}
+
+	BufferParser parser(mapRawData);
+	for (int codeIndex = 0; codeIndex < 4; codeIndex++)
+	{
+		if (parser.ParseChar() != SAVEFILE_4CC_CODE[codeIndex])
+		{
+			return false;
+		}
+	}
 	uint8_t saveFileVersion = parser.ParseByte();
-	GUARANTEE_OR_DIE(saveFileVersion == SAVEFILE_VERSION, "Save file version mismatch!");
+	if (saveFileVersion != SAVEFILE_VERSION_SIGNAL_GRAPH && saveFileVersion != SAVEFILE_VERSION_SINGLE_LINKS)
+	{
+		return false;
+	}
 
 	uint32_t numEntities = parser.ParseUint32();
 
 	uint8_t playerStartUnnecessaryType = parser.ParseByte();
-	UNUSED(playerStartUnnecessaryType);
-	EntityUID playerStartUID(parser.ParseUint32());
-	Vec3 playerStartPosition = parser.ParseVec3();
-	EulerAngles playerStartOrientation = parser.ParseEulerAngles();
-	float playerStartScale = parser.ParseFloat();
-	m_playerStart = new PlayerStart(this, playerStartUID, playerStartPosition, playerStartOrientation);
-	m_playerStart->m_scale = playerStartScale;
+	out_contents.m_playerStart = ParseLegacyEntityRecord(parser, playerStartUnnecessaryType);
 
+	// Every slot takes at least its type byte, so a count larger than what is left cannot be real
+	if ((size_t)numEntities > bytesRemaining)
+	{
+		return false;
+	}
+
+	// Links are gathered in a graph with no map so old files get the same duplicate filtering they always had
+	SignalGraph legacySignalGraph;
+	out_contents.m_entities.reserve(numEntities);
 	for (int entityIndex = 0; entityIndex < (int)numEntities; entityIndex++)
 	{
+		if (!ConsumeLegacyBytes(bytesRemaining, 1))
+		{
+			return false;
+		}
 		uint8_t entityTypeIndex = parser.ParseByte();
 		if (entityTypeIndex == 0xFF)
 		{
 			// This is an invalid entity
-			// To maintain indexes, push a nullptr in the entities list
-			m_entities.push_back(nullptr);
+			// To maintain indexes, keep an empty slot in the entities list
+			MapEntityRecord emptySlot;
+			emptySlot.m_uid = ENTITYUID_INVALID;
+			emptySlot.m_type = MAP_RECORD_EMPTY_SLOT;
+			out_contents.m_entities.push_back(emptySlot);
 			continue;
 		}
+		if (entityTypeIndex >= (uint8_t)EntityType::NUM)
+		{
+			return false;
+		}
 
 		EntityType entityType = EntityType(entityTypeIndex);
+		size_t recordSize = LEGACY_ENTITY_RECORD_SIZE;
+		if (entityType == EntityType::BUTTON || entityType == EntityType::LEVER || entityType == EntityType::DOOR)
+		{
+			recordSize += 4;
+		}
+		else if (entityType == EntityType::MOVING_PLATFORM)
+		{
+			recordSize += 4 + 1;
+		}
+		if (!ConsumeLegacyBytes(bytesRemaining, recordSize))
+		{
+			return false;
+		}
 
-		EntityUID entityUID(parser.ParseUint32());
-		Vec3 entityPosition = parser.ParseVec3();
-		EulerAngles entityOrientation = parser.ParseEulerAngles();
-		float entityScale = parser.ParseFloat();
-		Entity* entity = CreateEntityOfTypeWithUID(entityType, entityUID, entityPosition, entityOrientation, entityScale);
+		MapEntityRecord entityRecord = ParseLegacyEntityRecord(parser, entityTypeIndex);
 		if (entityType == EntityType::BUTTON || entityType == EntityType::LEVER)
 		{
+			// Version 3 keeps the first link here for layout compatibility, the full graph follows the entities
 			EntityUID activatableUID(parser.ParseUint32());
-			Activator* activator = (Activator*)entity;
-			activator->SetActivatable(activatableUID);
+			if (saveFileVersion == SAVEFILE_VERSION_SINGLE_LINKS)
+			{
+				legacySignalGraph.AddEdge(EntityUID(entityRecord.m_uid), activatableUID);
+			}
 		}
 		else if (entityType == EntityType::DOOR || entityType == EntityType::MOVING_PLATFORM)
 		{
-			EntityUID activatorUID(parser.ParseUint32());
-			Activatable* activatable = (Activatable*)entity;
-			activatable->m_activatorUID = activatorUID;
-			
+			// Activators are the authority on version 2 links, so this only mirrors the activator side
+			uint32_t unusedActivatorUID = parser.ParseUint32();
+			UNUSED(unusedActivatorUID);
+
 			if (entityType == EntityType::MOVING_PLATFORM)
 			{
-				MovementDirection movementDirection = (MovementDirection)parser.ParseByte();
-				MovingPlatform* movingPlatform = (MovingPlatform*)activatable;
-				movingPlatform->m_movementDirection = movementDirection;
+				MapMovementRecord movementRecord;
+				movementRecord.m_entityIndex = (uint32_t)entityIndex;
+				movementRecord.m_movementDirection = parser.ParseByte();
+				out_contents.m_movements.push_back(movementRecord);
 			}
 		}
-		m_entities.push_back(entity);
+		out_contents.m_entities.push_back(entityRecord);
+	}
+
+	if (saveFileVersion == SAVEFILE_VERSION_SIGNAL_GRAPH)
+	{
+		// The graph parses its own counts, so both tables are measured here before it is handed the parser
+		size_t edgesOffset = mapRawData.size() - bytesRemaining;
+		if (!ConsumeLegacyBytes(bytesRemaining, 4))
+		{
+			return false;
+		}
+		uint32_t numEdges = PeekLegacyUint32(mapRawData, edgesOffset);
+		if ((size_t)numEdges > bytesRemaining / LEGACY_SIGNAL_EDGE_SIZE)
+		{
+			return false;
+		}
+		bytesRemaining -= (size_t)numEdges * LEGACY_SIGNAL_EDGE_SIZE;
+
+		size_t combinatorsOffset = mapRawData.size() - bytesRemaining;
+		if (!ConsumeLegacyBytes(bytesRemaining, 4))
+		{
+			return false;
+		}
+		uint32_t numCombinators = PeekLegacyUint32(mapRawData, combinatorsOffset);
+		if ((size_t)numCombinators > bytesRemaining / LEGACY_SIGNAL_COMBINATOR_SIZE)
+		{
+			return false;
+		}
+
+		legacySignalGraph.ParseFromBuffer(parser);
+	}
+	legacySignalGraph.AppendToMapFile(out_contents);
+	return true;
+}
+
+void Map::LoadPlayerStart(MapEntityRecord const& playerStartRecord)
+{
+	m_playerStart = new PlayerStart(this, EntityUID(playerStartRecord.m_uid), playerStartRecord.GetPosition(), playerStartRecord.GetOrientation());
+	m_playerStart->m_scale = playerStartRecord.m_scale;
+}
+
+void Map::ConstructEntityFromRecord(int slotIndex, MapEntityRecord const& entityRecord)
+{
+	// Empty slots stay null so later entities keep the index their UIDs point to
+	if (entityRecord.m_type == MAP_RECORD_EMPTY_SLOT)
+	{
+		return;
+	}
+
+	Entity* entity = CreateEntityOfTypeWithUID((EntityType)entityRecord.m_type, EntityUID(entityRecord.m_uid), entityRecord.GetPosition(), entityRecord.GetOrientation(), entityRecord.m_scale);
+	m_entities[slotIndex] = entity;
+	m_tickScheduler.OnEntityAdded(entity);
+	m_tileChunks.OnEntityAdded(entity);
+	m_cullingGrid.OnEntityAdded(entity);
+}
+
+void Map::LoadSideTables(MapFileContents const& contents)
+{
+	for (int movementIndex = 0; movementIndex < (int)contents.m_movements.size(); movementIndex++)
+	{
+		MapMovementRecord const& movementRecord = contents.m_movements[movementIndex];
+		if (movementRecord.m_entityIndex >= (uint32_t)m_entities.size())
+		{
+			continue;
+		}
+
+		Entity* entity = m_entities[movementRecord.m_entityIndex];
+		if (entity && entity->m_type == EntityType::MOVING_PLATFORM)
+		{
+			MovingPlatform* movingPlatform = (MovingPlatform*)entity;
+			movingPlatform->m_movementDirection = (MovementDirection)movementRecord.m_movementDirection;
+		}
+	}
+
+	m_signalGraph.LoadFromMapFile(contents);
+}
+
+void Map::OnEntitiesLoaded()
+{
+	m_tickScheduler.MarkDirty();
+	m_triggerVolumes.MarkDirty();
+	m_entityListVersion++;
+}
+
+void Map::EnterGameAfterLoad(std::string const& mapFileName)
+{
+	Strings mapFilePathSplit;
+	int numSplitsInFileName = SplitStringOnDelimiter(mapFilePathSplit, mapFileName, '/');
+	std::string mapFileNameWithNoDirectory = mapFilePathSplit[numSplitsInFileName - 1];
+	Strings splitMapName;
+	int numSplits = SplitStringOnDelimiter(splitMapName, mapFileNameWithNoDirectory, '.');
+	std::string mapDisplayName = "";
+	for (int splitIndex = 0; splitIndex < numSplits - 1; splitIndex++)
+	{
+		mapDisplayName += splitMapName[splitIndex];
+	}
+	m_game->m_mapNameInputField->SetText(mapDisplayName);
+
+	if (m_mode == MapMode::PLAY)
+	{
+		m_game->m_player->m_pawn->m_position = m_playerStart->m_position;
+		m_game->m_player->m_pawn->m_orientation = m_playerStart->m_orientation;
+		m_game->m_player->m_pawn->m_velocity = Vec3::ZERO;
+		m_game->m_player->m_pawn->m_acceleration = Vec3::ZERO;
+		m_game->m_player->m_state = PlayerState::PLAY;
+	}
+}
+
+void Map::OpenJournal(std::string const& mapFileName, uint32_t lastJournalSequenceInFile)
+{
+	// Only the editor changes a map, edits from here on are appended next to the file it was loaded from
+	if (m_mode == MapMode::EDIT)
+	{
+		m_journal.Open(mapFileName, lastJournalSequenceInFile);
+
+		// Records left over from a session that crashed were replayed into the map, they are still not in its file
+		m_isUnsaved = m_journal.GetNumRecords() > 0;
+	}
+}
+
+static std::string GetSavedMapFilePath(std::string const& mapName)
+{
+	return Stringf("Saved/%s.almap", mapName.c_str());
+}
+
+void Map::StartSave(std::string const& filePath)
+{
+	double snapshotStartTimeSeconds = GetCurrentTimeSeconds();
+	MapFileContents contents;
+	AppendToMapFile(contents);
+
+	// The journal stays with the current map file until the write succeeds, so a failed save to a new name loses nothing
+	contents.m_lastJournalSequence = m_journal.GetLastSequence();
+
+	// Cleared as soon as the snapshot is taken so edits made during the write mark the map unsaved again, a failed write restores it
+	m_isUnsaved = false;
+	m_mapSaver = new MapSaver(std::move(contents), filePath);
+	m_mapSaver->m_snapshotSeconds = GetCurrentTimeSeconds() - snapshotStartTimeSeconds;
+	m_mapSaver->m_lastJournalSequence = m_journal.GetLastSequence();
+}
+
+void Map::UpdateSave()
+{
+	// Journal rewrites also land in the background, records made meanwhile are appended once they have
+	m_journal.Update();
+
+	if (!m_mapSaver || !m_mapSaver->IsFinished())
+	{
+		return;
+	}
+
+	if (m_mapSaver->HasSucceeded())
+	{
+		g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Saved %s: %.2f MB, snapshot %.2f ms, encode and write %.2f ms in the background", m_mapSaver->m_filePath.c_str(), (double)m_mapSaver->m_numBytesWritten / (1024.0 * 1024.0), m_mapSaver->m_snapshotSeconds * 1000.0, m_mapSaver->m_writeSeconds * 1000.0), false);
+
+		// Records made while the file was being written are newer than the snapshot and stay in the journal
+		if (m_journal.IsOpen() && m_journal.m_mapFilePath == m_mapSaver->m_filePath)
+		{
+			m_journal.DiscardRecordsUpTo(m_mapSaver->m_lastJournalSequence);
+		}
+		else if (m_mode == MapMode::EDIT)
+		{
+			m_journal.MoveTo(m_mapSaver->m_filePath, m_mapSaver->m_lastJournalSequence);
+		}
+	}
+	else
+	{
+		m_isUnsaved = true;
+		g_console->AddLine(Rgba8::RED, Stringf("Could not save %s, the previous version of the file was kept", m_mapSaver->m_filePath.c_str()), false);
+	}
+
+	delete m_mapSaver;
+	m_mapSaver = nullptr;
+
+	if (m_isSaveRequested)
+	{
+		m_isSaveRequested = false;
+		StartSave(GetSavedMapFilePath(m_game->m_mapNameInputField->m_text));
+		return;
+	}
+
+	CompactJournalIfNeeded();
+}
+
+void Map::CompactJournalIfNeeded()
+{
+	// Compaction only rewrites the journal, the map file itself is never touched without an explicit save
+	if (m_journal.IsCompactionDue())
+	{
+		m_journal.Compact();
+	}
+}
+
+bool Map::HasUnsavedChanges() const
+{
+	// The save button only shows the map as saved once its write has actually succeeded
+	return m_isUnsaved || m_mapSaver != nullptr;
+}
+
+void Map::DiscardUnsavedEdits()
+{
+	// Leaving the editor without saving throws the edits away, the journal is only there to bring them back after a crash
+	delete m_mapSaver;
+	m_mapSaver = nullptr;
+	m_journal.Delete();
+	m_isUnsaved = false;
+}
+
+void Map::AppendToMapFile(MapFileContents& contents)
+{
+	m_playerStart->SaveEditorState();
+	contents.m_playerStart = m_playerStart->GetMapRecord();
+
+	contents.m_entities.reserve(m_entities.size());
+	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	{
+		if (!m_entities[entityIndex])
+		{
+			MapEntityRecord emptySlot;
+			emptySlot.m_uid = ENTITYUID_INVALID;
+			emptySlot.m_type = MAP_RECORD_EMPTY_SLOT;
+			contents.m_entities.push_back(emptySlot);
+			continue;
+		}
+
+		m_entities[entityIndex]->AppendToMapFile(contents);
+	}
+
+	m_signalGraph.AppendToMapFile(contents);
+}
+
+void Map::AppendToLegacyBuffer(BufferWriter& writer)
+{
+	writer.AppendByte(SAVEFILE_4CC_CODE[0]);
+	writer.AppendByte(SAVEFILE_4CC_CODE[1]);
+	writer.AppendByte(SAVEFILE_4CC_CODE[2]);
+	writer.AppendByte(SAVEFILE_4CC_CODE[3]);
+	writer.AppendByte(SAVEFILE_VERSION_SIGNAL_GRAPH);
+	writer.AppendUint32((uint32_t)m_entities.size());
+
+	m_playerStart->AppendToBuffer(writer);
+
+	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	{
+		if (!m_entities[entityIndex])
+		{
+			writer.AppendByte(0xFF);
+			continue;
+		}
+
+		m_entities[entityIndex]->AppendToBuffer(writer);
 	}
+
+	m_signalGraph.AppendToBuffer(writer);
 }
 
 void Map::Update()
 {
-	if (m_isUnsaved)
+	if (HasUnsavedChanges())
 	{
 		m_game->m_saveButtonWidget->SetColor(PRIMARY_COLOR)
 			->SetHoverColor(PRIMARY_COLOR_VARIANT_LIGHT)
@@ -206,63 +659,88 @@ void Map::Update()
 			->SetHoverBackgroundColor(PRIMARY_COLOR_VARIANT_LIGHT);
 	}
 
+	if (m_regionStreamer)
+	{
+		m_regionStreamer->Update(m_game->m_player->m_pawn->m_position);
+	}
+
+	// Pulses follow the frame delta and not the live clock, so replays highlight the same way they were recorded
+	m_pulseSeconds += (double)m_game->GetDeltaSeconds();
+
 	m_game->m_player->m_pawn->Update();
 	m_playerStart->Update();
-	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	m_tickScheduler.UpdateEveryFrameEntities();
+	if (m_selectedEntity && m_selectedEntity != m_playerStart && !EntityTickScheduler::IsScheduledType(m_selectedEntity->m_type) && !EntityTickScheduler::IsEveryFrameType(m_selectedEntity->m_type))
 	{
-		if (!m_entities[entityIndex])
-		{
-			continue;
-		}
-
-		m_entities[entityIndex]->Update();
+		// Only refreshes the details widget, which is all the remaining entity types do in Update
+		m_selectedEntity->Update();
+	}
+	if (m_game->m_player->m_state == PlayerState::PLAY)
+	{
+		m_signalGraph.DispatchSignals();
 	}
+	m_tickScheduler.Update(m_game->GetDeltaSeconds(), m_game->m_player->GetPlayerPosition(), m_game->m_player->m_state == PlayerState::PLAY);
 
 	m_game->m_coinsCollectedTextWidget->SetText(Stringf("%d", m_coinsCollected));
 
 	HandlePlayerPawnEntityInteractions();
+	m_triggerVolumes.AddDebugDraw();
 	HandleMovingPlatformsVsEntities();
 	HandleCratesVsEntities();
 	HandleOrcsVsEntities();
 	UpdateParticles();
+	UpdateHeldEntities();
+	m_tileChunks.Update();
+	m_cullingGrid.Update();
 	UpdateShaderConstants();
+
+	g_app->AddDebugScreenText(Stringf("Culling: %d/%d entities, %d/%d tile chunks drawn", m_cullingGrid.m_numEntitiesDrawn, m_cullingGrid.m_numEntitiesDrawn + m_cullingGrid.m_numEntitiesCulled, m_tileChunks.m_numChunksDrawn, m_tileChunks.m_numChunksDrawn + m_tileChunks.m_numChunksCulled), Vec2(48.f, 640.f), 192.f, Vec2(0.f, 0.f));
+	if (m_regionStreamer)
+	{
+		g_app->AddDebugScreenText(Stringf("Streaming: %d regions, %d/%d entities resident", m_regionStreamer->m_numResidentRegions, m_regionStreamer->m_numResidentEntities, (int)m_entities.size()), Vec2(48.f, 600.f), 192.f, Vec2(0.f, 0.f));
+	}
 }
 
-void Map::Render() const
+void Map::ExtractRenderFrame()
 {
-	g_renderer->BeginRenderEvent("Map");
-
-	g_renderer->BeginRenderEvent("Entities");
-	g_renderer->BindShader(m_diffuseShader);
-	Vec3 eyePosition = g_app->GetCurrentCamera().GetPosition();
-	g_renderer->SetLightConstants(SUN_DIRECTION.GetNormalized(), SUN_INTENSITY, 1.f - SUN_INTENSITY, eyePosition);
-	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	// Everything submits into the queue once per frame and is sorted once, each view then replays it with redundant state changes skipped
+	m_renderQueue.BeginFrame(m_game->m_player->GetPlayerPosition());
+
+	ViewFrustum const& frustum = g_app->m_frameFrustum;
+	m_visibleTileChunks.clear();
+	m_tileChunks.CollectVisibleChunks(frustum, m_visibleTileChunks);
+	m_visibleEntities.clear();
+	m_cullingGrid.CollectVisibleEntities(frustum, m_visibleEntities);
+
+	// Entities sharing a model are drawn together, anything that cannot be instanced falls back to its own Render
+	m_modelInstanceRenderer.BeginFrame();
+	m_tileChunks.RenderChunks(m_visibleTileChunks, m_renderQueue, m_modelInstanceRenderer);
+	for (int entityIndex = 0; entityIndex < (int)m_visibleEntities.size(); entityIndex++)
 	{
-		if (!m_entities[entityIndex])
+		if (!m_visibleEntities[entityIndex]->AddModelInstances(m_modelInstanceRenderer))
 		{
-			continue;
+			m_visibleEntities[entityIndex]->Render(m_renderQueue);
 		}
-
-		m_entities[entityIndex]->Render();
 	}
-	g_renderer->EndRenderEvent("Entities");
-
-	Vec3 playerEyeCenterPosition = m_game->m_player->GetPlayerPosition();
-	VRController leftController = g_openXR->GetLeftController();
-	EulerAngles leftControllerOrientation = leftController.GetOrientation_iFwd_jLeft_kUp();
-	Vec3 leftControllerPosition = leftController.GetPosition_iFwd_jLeft_kUp();
+	m_modelInstanceRenderer.Render(m_renderQueue);
 
-	Vec3 leftControllerFwd, leftControllerLeft, leftControllerUp;
-	leftControllerOrientation.GetAsVectors_iFwd_jLeft_kUp(leftControllerFwd, leftControllerLeft, leftControllerUp);
-
-	g_renderer->BeginRenderEvent("PlayerStart");
-	g_renderer->BindShader(nullptr);
-	m_playerStart->Render();
-	g_renderer->EndRenderEvent("PlayerStart");
+	m_playerStart->Render(m_renderQueue);
 
+	UpdateLinkLineGeometry();
 	RenderLinkLines();
 	RenderParticles();
 
+	m_renderQueue.Sort();
+}
+
+void Map::Render() const
+{
+	g_renderer->BeginRenderEvent("Map");
+
+	g_renderer->BeginRenderEvent("RenderQueue");
+	m_renderQueue.Execute(g_app->GetCurrentCamera().GetPosition());
+	g_renderer->EndRenderEvent("RenderQueue");
+
 	g_renderer->EndRenderEvent("Map");
 }
 
@@ -283,70 +761,101 @@ void Map::DestroyGarbageParticles()
 	m_particles.erase(std::remove_if(m_particles.begin(), m_particles.end(), [](Particle* particle){ return particle->m_isDestroyed; }), m_particles.end());
 }
 
-void Map::RenderLinkLines() const
+void Map::DestroyAllParticles()
 {
-	if (!m_renderLinkLines)
+	for (int particleIndex = 0; particleIndex < (int)m_particles.size(); particleIndex++)
 	{
-		return;
+		delete m_particles[particleIndex];
 	}
-	if (m_game->m_player->m_state == PlayerState::PLAY)
+	m_particles.clear();
+}
+
+void Map::UpdateLinkLineGeometry()
+{
+	if (!m_renderLinkLines || m_game->m_player->m_state == PlayerState::PLAY)
 	{
 		return;
 	}
 
-	g_renderer->BeginRenderEvent("Link Lines");
-
-	std::vector<Vertex_PCU> linkLinesVerts;
-	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	// UIDs are only resolved again when the graph or the entity list changes, a moved endpoint only rebuilds the vertexes
+	bool isRebuildNeeded = false;
+	if (m_linkLinesEdgesVersion != m_signalGraph.m_edgesVersion || m_linkLinesEntityListVersion != m_entityListVersion)
 	{
-		if (!m_entities[entityIndex])
+		m_linkLinesEdgesVersion = m_signalGraph.m_edgesVersion;
+		m_linkLinesEntityListVersion = m_entityListVersion;
+		m_linkLines.clear();
+		for (int edgeIndex = 0; edgeIndex < (int)m_signalGraph.m_edges.size(); edgeIndex++)
 		{
-			continue;
-		}
-
-		if (m_entities[entityIndex]->m_type != EntityType::BUTTON && m_entities[entityIndex]->m_type != EntityType::LEVER)
-		{
-			continue;
+			SignalEdge const& edge = m_signalGraph.m_edges[edgeIndex];
+			LinkLine linkLine;
+			linkLine.m_activator = GetEntityFromUID(edge.m_activatorUID);
+			linkLine.m_activatable = GetEntityFromUID(edge.m_activatableUID);
+			linkLine.m_color = edge.m_type == SignalEdgeType::INVERTED ? Rgba8::RED : Rgba8::GRAY;
+			if (linkLine.m_activator && linkLine.m_activatable)
+			{
+				m_linkLines.push_back(linkLine);
+			}
 		}
+		isRebuildNeeded = true;
+	}
 
-		Activator* activator = (Activator*)m_entities[entityIndex];
-		Entity* activatable = GetEntityFromUID(activator->m_activatableUID);
-		if (activatable)
+	for (int lineIndex = 0; lineIndex < (int)m_linkLines.size(); lineIndex++)
+	{
+		LinkLine& linkLine = m_linkLines[lineIndex];
+		if (linkLine.m_activatorPosition != linkLine.m_activator->m_position || linkLine.m_activatablePosition != linkLine.m_activatable->m_position)
 		{
-			AddVertsForLineSegment3D(linkLinesVerts, activator->m_position, activatable->m_position, 0.01f, Rgba8::GRAY);
+			linkLine.m_activatorPosition = linkLine.m_activator->m_position;
+			linkLine.m_activatablePosition = linkLine.m_activatable->m_position;
+			isRebuildNeeded = true;
 		}
 	}
 
-	g_renderer->BindShader(nullptr);
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetModelConstants();
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->DrawVertexArray(linkLinesVerts);
+	if (!isRebuildNeeded)
+	{
+		return;
+	}
 
-	g_renderer->EndRenderEvent("Link Lines");
+	m_linkLineVerts.clear();
+	for (int lineIndex = 0; lineIndex < (int)m_linkLines.size(); lineIndex++)
+	{
+		LinkLine const& linkLine = m_linkLines[lineIndex];
+		AddVertsForLineSegment3D(m_linkLineVerts, linkLine.m_activatorPosition, linkLine.m_activatablePosition, 0.01f, linkLine.m_color);
+	}
+	m_linkLinesGeometry.Upload(m_linkLineVerts);
 }
 
-void Map::RenderParticles() const
+void Map::RenderLinkLines() const
 {
-	g_renderer->BindShader(m_diffuseShader);
-	g_renderer->SetLightConstants(Vec3::ZERO, 0.f, 1.f);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->SetBlendMode(BlendMode::ALPHA);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
+	if (!m_renderLinkLines)
+	{
+		return;
+	}
+	if (m_game->m_player->m_state == PlayerState::PLAY)
+	{
+		return;
+	}
 
-	for (int particleIndex = 0; particleIndex < (int)m_particles.size(); particleIndex++)
+	if (m_linkLinesGeometry.m_numVertexes > 0)
 	{
-		m_particles[particleIndex]->Render();
+		m_renderQueue.SubmitVertexes(RenderState(), Mat44(), Rgba8::WHITE, m_linkLinesGeometry.m_vertexBuffer, m_linkLinesGeometry.m_numVertexes);
 	}
 }
 
+void Map::RenderParticles()
+{
+	// Every live particle goes into one instance buffer, so a burst costs a single draw instead of one per particle
+	m_particleRenderer.BuildInstances(m_particles, m_game->m_player->GetPlayerPosition());
+	m_particleRenderer.Render(m_renderQueue);
+}
+
+RenderState Map::GetDefaultRenderState() const
+{
+	RenderState state;
+	state.m_shader = m_diffuseShader;
+	state.m_lighting = RenderLighting::SUN;
+	return state;
+}
+
 void Map::HandlePlayerPawnEntityInteractions()
 {
 	if (m_game->m_player->m_state != PlayerState::PLAY)
@@ -354,15 +863,42 @@ void Map::HandlePlayerPawnEntityInteractions()
 		return;
 	}
 
-	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+	// Solid entities only react to a pawn or hand touching them, levers, buttons and platforms track the player from any distance
+	Player* player = m_game->m_player;
+	Vec3 const& pawnPosition = player->m_pawn->m_position;
+	AABB3 interactionBounds(pawnPosition - Vec3(PlayerPawn::PLAYER_RADIUS, PlayerPawn::PLAYER_RADIUS, 0.f), pawnPosition + Vec3(PlayerPawn::PLAYER_RADIUS, PlayerPawn::PLAYER_RADIUS, PlayerPawn::PLAYER_HEIGHT));
+	Vec3 const& leftControllerPosition = player->m_leftController->m_worldPosition;
+	Vec3 const& rightControllerPosition = player->m_rightController->m_worldPosition;
+	interactionBounds = GetUnionOfAABB3s(interactionBounds, AABB3(leftControllerPosition - Vec3(Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS), leftControllerPosition + Vec3(Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS)));
+	interactionBounds = GetUnionOfAABB3s(interactionBounds, AABB3(rightControllerPosition - Vec3(Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS), rightControllerPosition + Vec3(Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS, Player::CONTROLLER_RADIUS)));
+
+	CollectCollisionCandidates(interactionBounds, m_collisionCandidates);
+	for (int entityIndex = 0; entityIndex < (int)m_collisionCandidates.size(); entityIndex++)
 	{
-		if (!m_entities[entityIndex])
+		EntityType type = m_collisionCandidates[entityIndex]->m_type;
+		if (type == EntityType::MOVING_PLATFORM || EntityTickScheduler::IsEveryFrameType(type))
 		{
-			continue;
+			m_collisionCandidates[entityIndex] = m_collisionCandidates.back();
+			m_collisionCandidates.pop_back();
+			entityIndex--;
 		}
+	}
+	m_collisionCandidates.insert(m_collisionCandidates.end(), m_tickScheduler.m_everyFrameEntities.begin(), m_tickScheduler.m_everyFrameEntities.end());
+	for (int entityIndex = 0; entityIndex < (int)m_tickScheduler.m_scheduledEntities.size(); entityIndex++)
+	{
+		if (m_tickScheduler.m_scheduledEntities[entityIndex]->m_type == EntityType::MOVING_PLATFORM)
+		{
+			m_collisionCandidates.push_back(m_tickScheduler.m_scheduledEntities[entityIndex]);
+		}
+	}
+	std::sort(m_collisionCandidates.begin(), m_collisionCandidates.end(), [](Entity const* a, Entity const* b) { return a->m_uid.GetIndex() < b->m_uid.GetIndex(); });
 
-		m_entities[entityIndex]->HandlePlayerInteraction();
+	for (int entityIndex = 0; entityIndex < (int)m_collisionCandidates.size(); entityIndex++)
+	{
+		m_collisionCandidates[entityIndex]->HandlePlayerInteraction();
 	}
+
+	m_triggerVolumes.Update(m_game->m_player->m_pawn->m_position, PlayerPawn::PLAYER_HEIGHT, PlayerPawn::PLAYER_RADIUS);
 }
 
 void Map::HandleMovingPlatformsVsEntities()
@@ -372,35 +908,39 @@ void Map::HandleMovingPlatformsVsEntities()
 		return;
 	}
 
-	for (int movingPlatformIndex = 0; movingPlatformIndex < (int)m_entities.size(); movingPlatformIndex++)
+	std::vector<Entity*> const& scheduledEntities = m_tickScheduler.m_scheduledEntities;
+	for (int movingPlatformIndex = 0; movingPlatformIndex < (int)scheduledEntities.size(); movingPlatformIndex++)
 	{
-		if (!m_entities[movingPlatformIndex])
-		{
-			continue;
-		}
-		if (m_entities[movingPlatformIndex]->m_type != EntityType::MOVING_PLATFORM)
+		if (scheduledEntities[movingPlatformIndex]->m_type != EntityType::MOVING_PLATFORM)
 		{
 			continue;
 		}
 
-		MovingPlatform* movingPlatform = (MovingPlatform*)m_entities[movingPlatformIndex];
+		MovingPlatform* movingPlatform = (MovingPlatform*)scheduledEntities[movingPlatformIndex];
 		OBB3 movingPlatformBounds = movingPlatform->GetBounds();
-		for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+		CollectCollisionCandidates(movingPlatform->ComputeRenderBounds(), m_collisionCandidates);
+		for (int entityIndex = 0; entityIndex < (int)m_collisionCandidates.size(); entityIndex++)
 		{
-			if (entityIndex == movingPlatformIndex)
+			Entity* entity = m_collisionCandidates[entityIndex];
+			if (entity == movingPlatform)
 			{
 				continue;
 			}
-			if (!m_entities[entityIndex])
+			if  (entity->m_type == EntityType::CRATE || entity->m_type == EntityType::ENEMY_ORC)
 			{
+				// Resting bodies skip their own collision pass, so a platform moving into one has to wake it
+				if (movingPlatform->m_isMoving && entity->m_isAsleep && DoZOBB3Overlap(movingPlatformBounds, entity->GetBounds()))
+				{
+					entity->Wake();
+				}
 				continue;
 			}
-			if  (m_entities[entityIndex]->m_type == EntityType::CRATE || m_entities[entityIndex]->m_type == EntityType::ENEMY_ORC || m_entities[entityIndex]->m_type == EntityType::COIN)
+			if (entity->m_type == EntityType::COIN)
 			{
 				continue;
 			}
 
-			if (DoZOBB3Overlap(movingPlatformBounds, m_entities[entityIndex]->GetBounds()))
+			if (DoZOBB3Overlap(movingPlatformBounds, entity->GetBounds()))
 			{
 				movingPlatform->m_isMoving = false;
 			}
@@ -415,50 +955,63 @@ void Map::HandleCratesVsEntities()
 		return;
 	}
 
-	for (int crateIndex = 0; crateIndex < (int)m_entities.size(); crateIndex++)
+	std::vector<Entity*> const& scheduledEntities = m_tickScheduler.m_scheduledEntities;
+	for (int crateIndex = 0; crateIndex < (int)scheduledEntities.size(); crateIndex++)
 	{
-		if (!m_entities[crateIndex])
+		if (scheduledEntities[crateIndex]->m_type != EntityType::CRATE)
 		{
 			continue;
 		}
 
-		if (m_entities[crateIndex]->m_type != EntityType::CRATE)
+		Crate* crate = (Crate*)scheduledEntities[crateIndex];
+		if (!m_tickScheduler.WasTickedThisFrame(crate) || crate->m_isAsleep)
 		{
+			// Crate has not moved since it was last resolved, but should still hold down the button it rests on
+			Entity* support = GetEntityFromUID(crate->m_supportUID);
+			if (support && support->m_type == EntityType::BUTTON)
+			{
+				Button* button = (Button*)support;
+				button->m_isPressed = true;
+			}
 			continue;
 		}
 
-		Crate* crate = (Crate*)m_entities[crateIndex];
+		crate->m_supportUID = EntityUID::INVALID;
 		OBB3 crateBox = crate->GetBounds();
 
-		for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+		CollectCollisionCandidates(crate->ComputeRenderBounds(), m_collisionCandidates);
+		for (int entityIndex = 0; entityIndex < (int)m_collisionCandidates.size(); entityIndex++)
 		{
-			if (entityIndex == crateIndex)
+			Entity* entity = m_collisionCandidates[entityIndex];
+			if (entity == crate)
 			{
 				continue;
 			}
-			if (!m_entities[entityIndex])
-			{
-				continue;
-			}
-			if (m_entities[entityIndex]->m_type == EntityType::COIN)
+			if (entity->m_type == EntityType::COIN)
 			{
 				continue;
 			}
 
 			float cratePositionZBeforePush = crate->m_position.z;
-			if (PushZOBB3OutOfFixedZOBB3(crateBox, m_entities[entityIndex]->GetBounds()))
+			if (PushZOBB3OutOfFixedZOBB3(crateBox, entity->GetBounds()))
 			{
 				crate->m_position = crateBox.m_center + Vec3::GROUNDWARD * crate->m_localBounds.GetDimensions().z * crate->m_scale * 0.5f;
 				if (cratePositionZBeforePush < crate->m_position.z)
 				{
 					crate->m_velocity.z = 0.f;
 					crate->m_isGrounded = true;
-					if (m_entities[entityIndex]->m_type == EntityType::BUTTON)
+					crate->m_supportUID = entity->m_uid;
+					if (entity->m_type == EntityType::BUTTON)
 					{
-						Button* button = (Button*)m_entities[entityIndex];
+						Button* button = (Button*)entity;
 						button->m_isPressed = true;
 					}
 				}
+				else if (entity->m_isAsleep)
+				{
+					// Pushed sideways against a resting body, so that body should respond as well
+					entity->Wake();
+				}
 			}
 		}
 	}
@@ -471,46 +1024,61 @@ void Map::HandleOrcsVsEntities()
 		return;
 	}
 
-	for (int orcIndex = 0; orcIndex < (int)m_entities.size(); orcIndex++)
+	std::vector<Entity*> const& scheduledEntities = m_tickScheduler.m_scheduledEntities;
+	for (int orcIndex = 0; orcIndex < (int)scheduledEntities.size(); orcIndex++)
 	{
-		if (!m_entities[orcIndex])
+		if (scheduledEntities[orcIndex]->m_type != EntityType::ENEMY_ORC)
 		{
 			continue;
 		}
 
-		if (m_entities[orcIndex]->m_type != EntityType::ENEMY_ORC)
+		Enemy_Orc* orc = (Enemy_Orc*)scheduledEntities[orcIndex];
+		if (!m_tickScheduler.WasTickedThisFrame(orc) || orc->m_isAsleep)
 		{
 			continue;
 		}
 
-		Enemy_Orc* orc = (Enemy_Orc*)m_entities[orcIndex];
-		for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
+		orc->m_supportUID = EntityUID::INVALID;
+
+		CollectCollisionCandidates(orc->ComputeRenderBounds(), m_collisionCandidates);
+		for (int entityIndex = 0; entityIndex < (int)m_collisionCandidates.size(); entityIndex++)
 		{
-			if (entityIndex == orcIndex)
-			{
-				continue;
-			}
-			if (!m_entities[entityIndex])
+			Entity* entity = m_collisionCandidates[entityIndex];
+			if (entity == orc)
 			{
 				continue;
 			}
-			if (m_entities[entityIndex]->m_type == EntityType::COIN)
+			if (entity->m_type == EntityType::COIN)
 			{
 				continue;
 			}
 
 			float orcZPositionBeforePush = orc->m_position.z;
 			Vec3 orcCylinderTop = orc->m_position + Vec3::SKYWARD * Enemy_Orc::HEIGHT;
-			PushZCylinderOutOfFixedZOBB3(orc->m_position, orcCylinderTop, Enemy_Orc::RADIUS, m_entities[entityIndex]->GetBounds());
+			PushZCylinderOutOfFixedZOBB3(orc->m_position, orcCylinderTop, Enemy_Orc::RADIUS, entity->GetBounds());
 			if (orc->m_position.z > orcZPositionBeforePush)
 			{
 				orc->m_isGrounded = true;
 				orc->m_velocity.z = 0.f;
+				orc->m_supportUID = entity->m_uid;
 			}
 		}
 	}
 }
 
+void Map::CollectCollisionCandidates(AABB3 const& bounds, std::vector<Entity*>& out_candidates)
+{
+	out_candidates.clear();
+
+	// Bodies that moved this frame are still filed under last frame's bounds, the margin keeps them in reach
+	AABB3 queryBounds(bounds.m_mins - Vec3(COLLISION_QUERY_MARGIN, COLLISION_QUERY_MARGIN, COLLISION_QUERY_MARGIN), bounds.m_maxs + Vec3(COLLISION_QUERY_MARGIN, COLLISION_QUERY_MARGIN, COLLISION_QUERY_MARGIN));
+	m_tileChunks.CollectTilesInBounds(queryBounds, out_candidates);
+	m_cullingGrid.CollectEntitiesInBounds(queryBounds, out_candidates);
+
+	// Pushes are resolved one after another, so candidates go in slot order like the full scan did and replays stay deterministic
+	std::sort(out_candidates.begin(), out_candidates.end(), [](Entity const* a, Entity const* b) { return a->m_uid.GetIndex() < b->m_uid.GetIndex(); });
+}
+
 void Map::RenderCustomScreens() const
 {
 }
@@ -595,6 +1163,12 @@ Entity* Map::SpawnNewEntityOfType(EntityType type, Vec3 const& position, EulerAn
 		{
 			m_entities.push_back(entity);
 		}
+		m_tickScheduler.OnEntityAdded(entity);
+		m_triggerVolumes.MarkDirty();
+		m_tileChunks.OnEntityAdded(entity);
+		m_cullingGrid.OnEntityAdded(entity);
+		m_entityListVersion++;
+		JournalEntityPlaced(entity);
 	}
 
 	return entity;
@@ -649,6 +1223,13 @@ bool Map::RemoveEntityFromMap(Entity* entity)
 		{
 			//delete m_entities[entityIndex];
 			m_entities[entityIndex] = nullptr;
+			m_signalGraph.RemoveEdgesForEntity(entity->m_uid);
+			m_tickScheduler.OnEntityRemoved(entity);
+			m_triggerVolumes.MarkDirty();
+			m_tileChunks.OnEntityRemoved(entity);
+			m_cullingGrid.OnEntityRemoved(entity);
+			m_entityListVersion++;
+			JournalEntityRemoved(entity);
 			return true;
 		}
 	}
@@ -667,50 +1248,121 @@ void Map::LinkEntities(Entity* entity1, Entity* entity2)
 		TogglePulseActivators();
 	}
 
-	if (entity1->m_type == EntityType::BUTTON || entity1->m_type == EntityType::LEVER)
+	if (entity1->IsInteractable() && entity2->IsActivatable())
 	{
-		if (entity2->m_type == EntityType::DOOR || entity2->m_type == EntityType::MOVING_PLATFORM)
-		{
-			Activator* activator = (Activator*)entity1;
-			Activatable* activatable = (Activatable*)entity2;
+		m_signalGraph.ToggleEdge(entity1->m_uid, entity2->m_uid);
+		JournalSignalEdge(entity1->m_uid, entity2->m_uid);
+	}
+	else if (entity1->IsActivatable() && entity2->IsInteractable())
+	{
+		m_signalGraph.ToggleEdge(entity2->m_uid, entity1->m_uid);
+		JournalSignalEdge(entity2->m_uid, entity1->m_uid);
+	}
+}
 
-			Activator* prevActivator = dynamic_cast<Activator*>(GetEntityFromUID(activatable->m_activatorUID));
-			if (prevActivator)
-			{
-				prevActivator->m_activatableUID = EntityUID::INVALID;
-			}
-			Activatable* prevActivatable = dynamic_cast<Activatable*>(GetEntityFromUID(activator->m_activatableUID));
-			if (prevActivatable)
-			{
-				prevActivatable->m_activatorUID = EntityUID::INVALID;
-			}
+void Map::OnEntityMoved(Entity* entity)
+{
+	// Tile chunks go first so the culling grid sees which tiles they still bake
+	m_tileChunks.OnEntityChanged(entity);
+	m_cullingGrid.OnEntityMoved(entity);
+}
 
-			activator->m_activatableUID = activatable->m_uid;
-			activatable->m_activatorUID = activator->m_uid;
-		}
+void Map::UpdateHeldEntities()
+{
+	if (m_game->m_player->m_state == PlayerState::PLAY)
+	{
+		return;
 	}
-	else if (entity1->m_type == EntityType::DOOR || entity1->m_type == EntityType::MOVING_PLATFORM)
+
+	// Entities being dragged, rotated or scaled change every frame and only report in once they are let go
+	Player* player = m_game->m_player;
+	OnEntityMoved(player->m_selectedEntity);
+	if (player->m_leftController)
 	{
-		if (entity2->m_type == EntityType::BUTTON || entity2->m_type == EntityType::LEVER)
-		{
-			Activator* activator = (Activator*)entity2;
-			Activatable* activatable = (Activatable*)entity1;
+		OnEntityMoved(player->m_leftController->m_selectedEntity);
+	}
+	if (player->m_rightController)
+	{
+		OnEntityMoved(player->m_rightController->m_selectedEntity);
+	}
+}
 
-			Activator* prevActivator = dynamic_cast<Activator*>(GetEntityFromUID(activatable->m_activatorUID));
-			if (prevActivator)
-			{
-				prevActivator->m_activatableUID = EntityUID::INVALID;
-			}
-			Activatable* prevActivatable = dynamic_cast<Activatable*>(GetEntityFromUID(activator->m_activatableUID));
-			if (prevActivatable)
-			{
-				prevActivatable->m_activatorUID = EntityUID::INVALID;
-			}
+void Map::JournalEntityPlaced(Entity* entity)
+{
+	// Every editor placement is journaled, so this is also where the tile chunks and culling grid hear about it
+	OnEntityMoved(entity);
+
+	// The editor moves entities directly, their editor state only catches up when the map is saved or played
+	MapJournalRecord record;
+	record.m_type = (uint8_t)MapJournalRecordType::PLACE_ENTITY;
+	record.m_entity.m_uid = entity->m_uid.m_uid;
+	record.m_entity.m_position[0] = entity->m_position.x;
+	record.m_entity.m_position[1] = entity->m_position.y;
+	record.m_entity.m_position[2] = entity->m_position.z;
+	record.m_entity.m_orientation[0] = entity->m_orientation.m_yawDegrees;
+	record.m_entity.m_orientation[1] = entity->m_orientation.m_pitchDegrees;
+	record.m_entity.m_orientation[2] = entity->m_orientation.m_rollDegrees;
+	record.m_entity.m_scale = entity->m_scale;
+	record.m_entity.m_type = (uint8_t)entity->m_type;
+	AppendJournalRecord(record);
+}
 
-			activator->m_activatableUID = activatable->m_uid;
-			activatable->m_activatorUID = activator->m_uid;
+void Map::JournalEntityRemoved(Entity const* entity)
+{
+	MapJournalRecord record;
+	record.m_type = (uint8_t)MapJournalRecordType::REMOVE_ENTITY;
+	record.m_entity.m_uid = entity->m_uid.m_uid;
+	AppendJournalRecord(record);
+}
+
+void Map::JournalSignalEdge(EntityUID activatorUID, EntityUID activatableUID)
+{
+	// Links toggle, so the record holds whether the edge exists afterwards rather than the toggle itself
+	MapJournalRecord record;
+	record.m_type = (uint8_t)MapJournalRecordType::REMOVE_SIGNAL_EDGE;
+	record.m_entity.m_uid = activatorUID.m_uid;
+	record.m_otherUID = activatableUID.m_uid;
+	for (int edgeIndex = 0; edgeIndex < (int)m_signalGraph.m_edges.size(); edgeIndex++)
+	{
+		SignalEdge const& edge = m_signalGraph.m_edges[edgeIndex];
+		if (edge.m_activatorUID.m_uid == activatorUID.m_uid && edge.m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			record.m_type = (uint8_t)MapJournalRecordType::SET_SIGNAL_EDGE;
+			record.m_value = (uint8_t)edge.m_type;
+			break;
 		}
 	}
+	AppendJournalRecord(record);
+}
+
+void Map::JournalSignalCombinator(EntityUID activatableUID)
+{
+	MapJournalRecord record;
+	record.m_type = (uint8_t)MapJournalRecordType::SET_SIGNAL_COMBINATOR;
+	record.m_value = (uint8_t)m_signalGraph.GetCombinator(activatableUID);
+	record.m_entity.m_uid = activatableUID.m_uid;
+	AppendJournalRecord(record);
+}
+
+void Map::JournalMovementDirection(MovingPlatform const* movingPlatform)
+{
+	MapJournalRecord record;
+	record.m_type = (uint8_t)MapJournalRecordType::SET_MOVEMENT_DIRECTION;
+	record.m_value = (uint8_t)movingPlatform->m_movementDirection;
+	record.m_entity.m_uid = movingPlatform->m_uid.m_uid;
+	AppendJournalRecord(record);
+}
+
+void Map::AppendJournalRecord(MapJournalRecord& record)
+{
+	// Every journaled action is an edit, even on a new map that has no file to journal next to yet
+	m_isUnsaved = true;
+	if (!m_journal.Append(record))
+	{
+		return;
+	}
+
+	CompactJournalIfNeeded();
 }
 
 Particle* Map::SpawnParticle(Vec3 const& position, Vec3 const& velocity, EulerAngles const& orientation, float size, Rgba8 const& color, float lifetime)
@@ -826,11 +1478,12 @@ void Map::TogglePulseActivatables()
 		{
 			if (m_isPulsingActivatables)
 			{
-				m_entities[entityIndex]->m_pulseTimer.Stop();
+				m_entities[entityIndex]->m_isPulsing = false;
 			}
 			else
 			{
-				m_entities[entityIndex]->m_pulseTimer.Start();
+				m_entities[entityIndex]->m_isPulsing = true;
+				m_entities[entityIndex]->m_pulseStartSeconds = m_pulseSeconds;
 			}
 		}
 	}
@@ -850,11 +1503,12 @@ void Map::TogglePulseActivators()
 		{
 			if (m_isPulsingActivators)
 			{
-				m_entities[entityIndex]->m_pulseTimer.Stop();
+				m_entities[entityIndex]->m_isPulsing = false;
 			}
 			else
 			{
-				m_entities[entityIndex]->m_pulseTimer.Start();
+				m_entities[entityIndex]->m_isPulsing = true;
+				m_entities[entityIndex]->m_pulseStartSeconds = m_pulseSeconds;
 			}
 		}
 	}
@@ -872,6 +1526,11 @@ void Map::SaveAllEntityStates()
 
 		m_entities[entityIndex]->SaveEditorState();
 	}
+
+	m_signalGraph.ResetSignals();
+	m_tickScheduler.MarkDirty();
+	m_triggerVolumes.ClearOverlaps();
+	m_triggerVolumes.MarkDirty();
 }
 
 void Map::ResetAllEntityStates()
@@ -882,6 +1541,9 @@ void Map::ResetAllEntityStates()
 	m_game->m_player->m_pawn->m_acceleration = Vec3::ZERO;
 	m_game->m_player->m_pawn->m_angularVelocity = EulerAngles::ZERO;
 	m_game->m_player->m_pawn->m_hasWon = false;
+	m_game->m_player->m_pawn->m_health = PlayerPawn::MAX_HEALTH;
+	m_coinsCollected = 0;
+	DestroyAllParticles();
 
 	for (int entityIndex = 0; entityIndex < (int)m_entities.size(); entityIndex++)
 	{
@@ -891,7 +1553,13 @@ void Map::ResetAllEntityStates()
 		}
 
 		m_entities[entityIndex]->ResetState();
+		OnEntityMoved(m_entities[entityIndex]);
 	}
+
+	m_signalGraph.ResetSignals();
+	m_tickScheduler.MarkDirty();
+	m_triggerVolumes.ClearOverlaps();
+	m_triggerVolumes.MarkDirty();
 }
 
 Entity* Map::GetEntityFromUID(EntityUID uid) const
@@ -981,6 +1649,14 @@ bool Map::Event_ToggleLinkLines(EventArgs& args)
 	return true;
 }
 
+bool Map::Event_ToggleParticleDepthSort(EventArgs& args)
+{
+	UNUSED(args);
+	ParticleRenderer& particleRenderer = g_app->m_game->m_currentMap->m_particleRenderer;
+	particleRenderer.m_isDepthSorted = !particleRenderer.m_isDepthSorted;
+	return true;
+}
+
 bool Map::Event_ResetTransform(EventArgs& args)
 {
 	unsigned int entityUID = (unsigned int)args.GetValue("entity", (int)ENTITYUID_INVALID);
@@ -994,6 +1670,8 @@ bool Map::Event_ResetTransform(EventArgs& args)
 	entity->m_position = Vec3::ZERO;
 	entity->m_orientation = EulerAngles::ZERO;
 	entity->m_scale = 1.f;
+	g_app->m_game->m_currentMap->m_isUnsaved = true;
+	g_app->m_game->m_currentMap->JournalEntityPlaced(entity);
 	return true;
 }
 
@@ -1007,37 +1685,169 @@ bool Map::Event_SaveMap(EventArgs& args)
 	{
 		return false;
 	}
+	if (currentMap->m_regionStreamer)
+	{
+		g_console->AddLine(Rgba8::RED, "Cannot save a map while only part of it is streamed in", false);
+		return false;
+	}
 
-	std::vector<uint8_t> buffer;
-	BufferWriter writer(buffer);
-
-	writer.AppendByte(SAVEFILE_4CC_CODE[0]);
-	writer.AppendByte(SAVEFILE_4CC_CODE[1]);
-	writer.AppendByte(SAVEFILE_4CC_CODE[2]);
-	writer.AppendByte(SAVEFILE_4CC_CODE[3]);
-	writer.AppendByte(SAVEFILE_VERSION);
-	writer.AppendUint32((uint32_t)currentMap->m_entities.size());
+	// Only one write is in flight at a time, a save pressed during it snapshots the map again once it lands
+	if (currentMap->m_mapSaver)
+	{
+		currentMap->m_isSaveRequested = true;
+		return true;
+	}
 
-	currentMap->m_playerStart->AppendToBuffer(writer);
+	currentMap->StartSave(GetSavedMapFilePath(mapName));
+	return true;
+}
 
-	for (int entityIndex = 0; entityIndex < (int)currentMap->m_entities.size(); entityIndex++)
+static void DeleteMapAndEntities(Map* map)
+{
+	for (int entityIndex = 0; entityIndex < (int)map->m_entities.size(); entityIndex++)
 	{
-		if (!currentMap->m_entities[entityIndex])
-		{
-			writer.AppendByte(0xFF);
-			continue;
-		}
+		delete map->m_entities[entityIndex];
+	}
+	map->m_entities.clear();
+	delete map->m_playerStart;
+	map->m_playerStart = nullptr;
+	delete map;
+}
+
+bool Map::Event_BenchmarkMapLoad(EventArgs& args)
+{
+	constexpr char const* BENCHMARK_MAP_PATH = "Saved/LoadBenchmark.almap";
+	constexpr char const* BENCHMARK_LEGACY_MAP_PATH = "Saved/LoadBenchmarkLegacy.almap";
 
-		currentMap->m_entities[entityIndex]->AppendToBuffer(writer);
+	int numEntities = args.GetValue("entities", 500000);
+	if (numEntities <= 0)
+	{
+		g_console->AddLine(Rgba8::RED, "BenchmarkMapLoad needs entities=<count> greater than zero", false);
+		return false;
 	}
 
-	FileWriteBuffer(Stringf("Saved\\%s.almap", mapName.c_str()), buffer);
+	Game* game = g_app->m_game;
+	std::string mapNameText = game->m_mapNameInputField->m_text;
 
-	currentMap->m_isUnsaved = false;
+	// A square field of alternating tiles stands in for a large level, UIDs wrap past the 16-bit index but tiles are never looked up by UID here
+	MapFileContents contents;
+	contents.m_playerStart.m_uid = EntityUID(0, 0).m_uid;
+	contents.m_playerStart.m_type = (uint8_t)EntityType::NONE;
+	int sideLength = RoundDownToInt(sqrtf((float)numEntities)) + 1;
+	contents.m_entities.resize(numEntities);
+	for (int entityIndex = 0; entityIndex < numEntities; entityIndex++)
+	{
+		MapEntityRecord& record = contents.m_entities[entityIndex];
+		record.m_uid = EntityUID((unsigned int)entityIndex & 0xFFFF, 1).m_uid;
+		record.m_position[0] = (float)(entityIndex % sideLength);
+		record.m_position[1] = (float)(entityIndex / sideLength);
+		record.m_position[2] = -1.f;
+		record.m_type = (uint8_t)((entityIndex % 2) == 0 ? EntityType::TILE_GRASS : EntityType::TILE_DIRT);
+	}
 
+	std::vector<uint8_t> buffer;
+	contents.WriteToBuffer(buffer);
+	FileWriteBuffer(BENCHMARK_MAP_PATH, buffer);
+
+	// Decode alone on one thread and on every core, the two results must be identical for loading to be deterministic
+	MapFileReader reader;
+	GUARANTEE_OR_DIE(reader.Open(buffer.data(), buffer.size()), "Benchmark map could not be decoded!");
+	std::vector<MapEntityRecord> serialDecodedRecords;
+	double serialDecodeStartTimeSeconds = GetCurrentTimeSeconds();
+	reader.GetEntityRecordsInSlotOrder(serialDecodedRecords, 1);
+	double serialDecodeSeconds = GetCurrentTimeSeconds() - serialDecodeStartTimeSeconds;
+	std::vector<MapEntityRecord> parallelDecodedRecords;
+	double parallelDecodeStartTimeSeconds = GetCurrentTimeSeconds();
+	reader.GetEntityRecordsInSlotOrder(parallelDecodedRecords, GetMapDecodeThreadCount());
+	double parallelDecodeSeconds = GetCurrentTimeSeconds() - parallelDecodeStartTimeSeconds;
+	bool isParallelDecodeIdentical = parallelDecodedRecords.size() == serialDecodedRecords.size() && memcmp(parallelDecodedRecords.data(), serialDecodedRecords.data(), sizeof(MapEntityRecord) * serialDecodedRecords.size()) == 0;
+
+	Map* benchmarkMap = new Map(game, BENCHMARK_MAP_PATH, MapMode::EDIT);
+	double readSeconds = benchmarkMap->m_lastLoadReadSeconds;
+	double totalSeconds = benchmarkMap->m_lastLoadTotalSeconds;
+
+	// The same level written in the version 3 layout goes through the old parser for comparison
+	std::vector<uint8_t> legacyBuffer;
+	BufferWriter legacyWriter(legacyBuffer);
+	benchmarkMap->AppendToLegacyBuffer(legacyWriter);
+	FileWriteBuffer(BENCHMARK_LEGACY_MAP_PATH, legacyBuffer);
+	DeleteMapAndEntities(benchmarkMap);
+
+	Map* legacyMap = new Map(game, BENCHMARK_LEGACY_MAP_PATH, MapMode::EDIT);
+	double legacyReadSeconds = legacyMap->m_lastLoadReadSeconds;
+	double legacyTotalSeconds = legacyMap->m_lastLoadTotalSeconds;
+	DeleteMapAndEntities(legacyMap);
+
+	remove(BENCHMARK_MAP_PATH);
+	remove(BENCHMARK_LEGACY_MAP_PATH);
+	game->m_mapNameInputField->SetText(mapNameText);
+
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Map load benchmark, %d entities", numEntities), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Version %d mapped: %.2f MB, read and decode %.2f ms, construct %.2f ms, total %.2f ms", SAVEFILE_VERSION, (double)buffer.size() / (1024.0 * 1024.0), readSeconds * 1000.0, (totalSeconds - readSeconds) * 1000.0, totalSeconds * 1000.0), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Version %d parsed: %.2f MB, read and parse %.2f ms, construct %.2f ms, total %.2f ms", SAVEFILE_VERSION_SIGNAL_GRAPH, (double)legacyBuffer.size() / (1024.0 * 1024.0), legacyReadSeconds * 1000.0, (legacyTotalSeconds - legacyReadSeconds) * 1000.0, legacyTotalSeconds * 1000.0), false);
+	g_console->AddLine(isParallelDecodeIdentical ? Rgba8::STEEL_BLUE : Rgba8::RED, Stringf("Decode only: 1 thread %.2f ms, %d threads %.2f ms, results %s", serialDecodeSeconds * 1000.0, GetMapDecodeThreadCount(), parallelDecodeSeconds * 1000.0, isParallelDecodeIdentical ? "identical" : "DIFFERENT"), false);
 	return true;
 }
 
+bool Map::Event_VerifyMapEncoding(EventArgs& args)
+{
+	UNUSED(args);
+
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap || currentMap->m_regionStreamer)
+	{
+		g_console->AddLine(Rgba8::RED, "VerifyMapEncoding needs a fully loaded map", false);
+		return false;
+	}
+
+	MapFileContents contents;
+	currentMap->AppendToMapFile(contents);
+	std::vector<uint8_t> buffer;
+	contents.WriteToBuffer(buffer);
+
+	std::vector<uint8_t> legacyBuffer;
+	BufferWriter legacyWriter(legacyBuffer);
+	currentMap->AppendToLegacyBuffer(legacyWriter);
+
+	MapFileReader reader;
+	std::vector<MapEntityRecord> decodedRecords;
+	if (!reader.Open(buffer.data(), buffer.size()) || !reader.GetEntityRecordsInSlotOrder(decodedRecords) || decodedRecords.size() != contents.m_entities.size())
+	{
+		g_console->AddLine(Rgba8::RED, "Map encoding round trip failed: the encoded map could not be decoded", false);
+		return false;
+	}
+
+	int numMismatches = 0;
+	for (int slotIndex = 0; slotIndex < (int)decodedRecords.size(); slotIndex++)
+	{
+		MapEntityRecord const& original = contents.m_entities[slotIndex];
+		MapEntityRecord const& decoded = decodedRecords[slotIndex];
+		bool isEmptyInBoth = original.m_type == MAP_RECORD_EMPTY_SLOT && decoded.m_type == MAP_RECORD_EMPTY_SLOT;
+		if (!isEmptyInBoth && memcmp(&original, &decoded, sizeof(MapEntityRecord)) != 0)
+		{
+			if (numMismatches < 8)
+			{
+				g_console->AddLine(Rgba8::RED, Stringf("Slot %d decoded as type %d at (%.2f, %.2f, %.2f), saved as type %d at (%.2f, %.2f, %.2f)", slotIndex, decoded.m_type, decoded.m_position[0], decoded.m_position[1], decoded.m_position[2], original.m_type, original.m_position[0], original.m_position[1], original.m_position[2]), false);
+			}
+			numMismatches++;
+		}
+	}
+
+	// Loading decodes on every core, which has to give exactly what the serial decode above gave
+	std::vector<MapEntityRecord> parallelDecodedRecords;
+	bool isParallelDecodeIdentical = reader.GetEntityRecordsInSlotOrder(parallelDecodedRecords, GetMapDecodeThreadCount()) && parallelDecodedRecords.size() == decodedRecords.size()
+		&& (decodedRecords.empty() || memcmp(parallelDecodedRecords.data(), decodedRecords.data(), sizeof(MapEntityRecord) * decodedRecords.size()) == 0);
+
+	MapFileSectionView<MapTileChunkRecord> tileChunks;
+	MapFileSectionView<MapEntityRecord> fullRecords;
+	reader.GetSection(MapFileSectionType::TILE_CHUNKS, tileChunks);
+	reader.GetSection(MapFileSectionType::ENTITIES, fullRecords);
+	g_console->AddLine(numMismatches == 0 ? Rgba8::STEEL_BLUE : Rgba8::RED, Stringf("Map encoding round trip: %d slots, %d mismatches, %d full records, %d tile chunks", (int)decodedRecords.size(), numMismatches, fullRecords.m_count, tileChunks.m_count), false);
+	g_console->AddLine(isParallelDecodeIdentical ? Rgba8::STEEL_BLUE : Rgba8::RED, Stringf("Decode on %d threads %s the serial decode", GetMapDecodeThreadCount(), isParallelDecodeIdentical ? "matches" : "differs from"), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Version %d: %d bytes, version %d: %d bytes, %.1fx smaller", SAVEFILE_VERSION, (int)buffer.size(), SAVEFILE_VERSION_SIGNAL_GRAPH, (int)legacyBuffer.size(), (double)legacyBuffer.size() / (double)buffer.size()), false);
+	return numMismatches == 0 && isParallelDecodeIdentical;
+}
+
 bool Map::Event_ChangeMovementDirection(EventArgs& args)
 {
 	EntityUID uid = EntityUID(args.GetValue("entity", (int)ENTITYUID_INVALID));
@@ -1053,5 +1863,48 @@ bool Map::Event_ChangeMovementDirection(EventArgs& args)
 	}
 
 	movingPlatform->m_movementDirection = newMovementDirection;
+	g_app->m_game->m_currentMap->m_isUnsaved = true;
+	g_app->m_game->m_currentMap->JournalMovementDirection(movingPlatform);
+	return true;
+}
+
+bool Map::Event_ToggleSignalCombinator(EventArgs& args)
+{
+	EntityUID uid = EntityUID(args.GetValue("entity", (int)ENTITYUID_INVALID));
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap)
+	{
+		return false;
+	}
+
+	Entity* entity = currentMap->GetEntityFromUID(uid);
+	if (!entity || !entity->IsActivatable())
+	{
+		return false;
+	}
+
+	SignalCombinator combinator = currentMap->m_signalGraph.GetCombinator(uid);
+	currentMap->m_signalGraph.SetCombinator(uid, combinator == SignalCombinator::AND ? SignalCombinator::OR : SignalCombinator::AND);
+	currentMap->m_isUnsaved = true;
+	currentMap->JournalSignalCombinator(uid);
+	return true;
+}
+
+bool Map::Event_SetSignalEdgeType(EventArgs& args)
+{
+	EntityUID activatorUID = EntityUID(args.GetValue("activator", (int)ENTITYUID_INVALID));
+	EntityUID activatableUID = EntityUID(args.GetValue("activatable", (int)ENTITYUID_INVALID));
+	bool isInverted = args.GetValue("inverted", false);
+
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap || !currentMap->m_signalGraph.HasEdge(activatorUID, activatableUID))
+	{
+		g_console->AddLine(Rgba8::RED, "No link exists between the given entities", false);
+		return false;
+	}
+
+	currentMap->m_signalGraph.SetEdgeType(activatorUID, activatableUID, isInverted ? SignalEdgeType::INVERTED : SignalEdgeType::DIRECT);
+	currentMap->m_isUnsaved = true;
+	currentMap->JournalSignalEdge(activatorUID, activatableUID);
 	return true;
 }
@@ -1,6 +1,16 @@
 #pragma once
 
+#include "Game/EntityCullingGrid.hpp"
+#include "Game/EntityTickScheduler.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/MapJournal.hpp"
+#include "Game/ModelInstanceRenderer.hpp"
+#include "Game/ParticleRenderer.hpp"
+#include "Game/RenderQueue.hpp"
+#include "Game/RetainedGeometry.hpp"
+#include "Game/SignalGraph.hpp"
+#include "Game/TileChunkBaker.hpp"
+#include "Game/TriggerVolumeSystem.hpp"
 
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Renderer/Camera.hpp"
@@ -10,7 +20,22 @@
 
 class EntityUID;
 class Game;
+class MapSaver;
+class MovingPlatform;
 class Particle;
+class RegionStreamer;
+
+
+// A signal edge resolved to its two entities, with the endpoints its line was last built from
+struct LinkLine
+{
+public:
+	Entity const* m_activator = nullptr;
+	Entity const* m_activatable = nullptr;
+	Vec3 m_activatorPosition = Vec3::ZERO;
+	Vec3 m_activatablePosition = Vec3::ZERO;
+	Rgba8 m_color = Rgba8::GRAY;
+};
 
 
 class Map
@@ -19,26 +44,45 @@ public:
 	~Map();
 	Map() = default;
 	explicit Map(Game* game);
+	explicit Map(Game* game, MapMode mode);
 	explicit Map(Game* game, std::string mapFileName, MapMode mode);
 
 	void LoadAssets();
 	void InitializeTiles();
 	void LoadFromFile(std::string filename);
+	void LoadPlayerStart(MapEntityRecord const& playerStartRecord);
+	void ConstructEntityFromRecord(int slotIndex, MapEntityRecord const& entityRecord);
+	void LoadSideTables(MapFileContents const& contents);
+	void OnEntitiesLoaded();
+	void EnterGameAfterLoad(std::string const& mapFileName);
+	void OpenJournal(std::string const& mapFileName, uint32_t lastJournalSequenceInFile);
+	void StartSave(std::string const& filePath);
+	void UpdateSave();
+	void CompactJournalIfNeeded();
+	bool HasUnsavedChanges() const;
+	void DiscardUnsavedEdits();
+	void AppendToMapFile(MapFileContents& contents);
+	void AppendToLegacyBuffer(BufferWriter& writer);
 
 	void Update();
+	void ExtractRenderFrame();
 	void Render() const;
 	void RenderScreen() const;
 
 	void UpdateParticles();
 	void DestroyGarbageParticles();
+	void DestroyAllParticles();
 
+	void UpdateLinkLineGeometry();
 	void RenderLinkLines() const;
-	void RenderParticles() const;
+	void RenderParticles();
+	RenderState GetDefaultRenderState() const;
 
 	void HandlePlayerPawnEntityInteractions();
 	void HandleMovingPlatformsVsEntities();
 	void HandleCratesVsEntities();
 	void HandleOrcsVsEntities();
+	void CollectCollisionCandidates(AABB3 const& bounds, std::vector<Entity*>& out_candidates);
 
 	void RenderCustomScreens() const;
 
@@ -51,6 +95,15 @@ public:
 	float GetDefaultEntityScaleForType(EntityType type);
 	bool RemoveEntityFromMap(Entity* entity);
 	void LinkEntities(Entity* entity1, Entity* entity2);
+	void OnEntityMoved(Entity* entity);
+	void UpdateHeldEntities();
+
+	void JournalEntityPlaced(Entity* entity);
+	void JournalEntityRemoved(Entity const* entity);
+	void JournalSignalEdge(EntityUID activatorUID, EntityUID activatableUID);
+	void JournalSignalCombinator(EntityUID activatableUID);
+	void JournalMovementDirection(MovingPlatform const* movingPlatform);
+	void AppendJournalRecord(MapJournalRecord& record);
 
 	Particle* SpawnParticle(Vec3 const& position, Vec3 const& velocity, EulerAngles const& orientation, float size, Rgba8 const& color, float lifetime);
 
@@ -71,13 +124,22 @@ public:
 
 	ArchiLeapRaycastResult3D RaycastVsEntities(Vec3 const& rayStartPos, Vec3 const& fwdNormal, float maxDistance, Entity const* entityToIgnore = nullptr);
 
+	static bool ReadMapFile(std::string const& filename, MapMode mode, MapFileContents& out_contents, bool& out_isStreamed, std::string& out_error);
+	static bool ParseLegacyBuffer(std::vector<uint8_t> const& mapRawData, MapFileContents& out_contents);
+
 	static bool Event_ToggleLinkLines(EventArgs& args);
+	static bool Event_ToggleParticleDepthSort(EventArgs& args);
 	static bool Event_ResetTransform(EventArgs& args);
 	static bool Event_SaveMap(EventArgs& args);
+	static bool Event_BenchmarkMapLoad(EventArgs& args);
+	static bool Event_VerifyMapEncoding(EventArgs& args);
 	static bool Event_ChangeMovementDirection(EventArgs& args);
+	static bool Event_ToggleSignalCombinator(EventArgs& args);
+	static bool Event_SetSignalEdgeType(EventArgs& args);
 
 public:
 	static constexpr int NEW_MAP_HALF_DIMENSIONS = 5;
+	static constexpr float COLLISION_QUERY_MARGIN = 2.f;
 
 	MapMode m_mode = MapMode::NONE;
 	std::vector<Entity*> m_entities;
@@ -93,6 +155,31 @@ public:
 	std::vector<Particle*> m_particles;
 	bool m_isPulsingActivatables = false;
 	bool m_isPulsingActivators = false;
+	double m_pulseSeconds = 0.0;
+	EntityTickScheduler m_tickScheduler;
+	SignalGraph m_signalGraph;
+	TriggerVolumeSystem m_triggerVolumes;
+	TileChunkBaker m_tileChunks;
+	EntityCullingGrid m_cullingGrid;
+	mutable ModelInstanceRenderer m_modelInstanceRenderer;
+	ParticleRenderer m_particleRenderer;
+	mutable RenderQueue m_renderQueue;
+	std::vector<Entity*> m_visibleEntities;
+	std::vector<TileChunk const*> m_visibleTileChunks;
+	std::vector<Entity*> m_collisionCandidates;
+	unsigned int m_entityListVersion = 0;
+	double m_lastLoadReadSeconds = 0.0;
+	double m_lastLoadTotalSeconds = 0.0;
+	RegionStreamer* m_regionStreamer = nullptr;
+	MapSaver* m_mapSaver = nullptr;
+	bool m_isSaveRequested = false;
+	MapJournal m_journal;
+
+	std::vector<LinkLine> m_linkLines;
+	std::vector<Vertex_PCU> m_linkLineVerts;
+	RetainedGeometry m_linkLinesGeometry;
+	unsigned int m_linkLinesEdgesVersion = 0xFFFFFFFF;
+	unsigned int m_linkLinesEntityListVersion = 0xFFFFFFFF;
 
 private:
 	Model* m_cubeModel = nullptr;
@@ -0,0 +1,392 @@
+#include "Game/MapCatalog.hpp"
+
+#include "Game/AtomicFileWriter.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapFile.hpp"
+#include "Game/MapJournal.hpp"
+#include "Game/MappedFile.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+#include <map>
+#include <set>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+static constexpr char const* MAP_FILE_EXTENSION = ".almap";
+static constexpr char const* MAP_THUMBNAIL_EXTENSION = ".png";
+
+
+static bool HasExtension(std::string const& fileName, char const* extension)
+{
+	size_t extensionLength = strlen(extension);
+	return fileName.size() > extensionLength && fileName.compare(fileName.size() - extensionLength, extensionLength, extension) == 0;
+}
+
+static std::string RemoveExtension(std::string const& fileName, char const* extension)
+{
+	return fileName.substr(0, fileName.size() - strlen(extension));
+}
+
+static bool IsSameEntry(MapCatalogEntry const& entry, MapCatalogEntry const& compare)
+{
+	return entry.m_fileName == compare.m_fileName && entry.m_thumbnailPath == compare.m_thumbnailPath && entry.m_fileSize == compare.m_fileSize
+		&& entry.m_lastWriteTime == compare.m_lastWriteTime && entry.m_journalSize == compare.m_journalSize && entry.m_isReadOnly == compare.m_isReadOnly
+		&& entry.m_hasStats == compare.m_hasStats;
+}
+
+// Decodes the whole map the same way loading does, but a file it cannot read is only reported rather than fatal
+// Bounds cover entity positions rather than their models, which is all the list shows
+static bool ReadMapStats(std::string const& filePath, int& out_numEntities, AABB3& out_bounds)
+{
+	MappedFile mappedFile;
+	if (!mappedFile.Open(filePath) || mappedFile.GetSize() <= 4 || memcmp(mappedFile.GetData(), SAVEFILE_4CC_CODE, 4) != 0)
+	{
+		return false;
+	}
+
+	MapFileContents contents;
+	uint8_t saveFileVersion = mappedFile.GetData()[4];
+	if (saveFileVersion < SAVEFILE_VERSION_FIXED_STRIDE)
+	{
+		std::vector<uint8_t> mapRawData(mappedFile.GetData(), mappedFile.GetData() + mappedFile.GetSize());
+		mappedFile.Close();
+		if (!Map::ParseLegacyBuffer(mapRawData, contents))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		MapFileReader reader;
+		if (!reader.Open(mappedFile.GetData(), mappedFile.GetSize()) || !reader.ReadSideTables(contents) || !reader.GetEntityRecordsInSlotOrder(contents.m_entities))
+		{
+			return false;
+		}
+	}
+
+	std::vector<MapJournalRecord> journalRecords;
+	ReadMapJournal(GetMapJournalFilePath(filePath), contents.m_lastJournalSequence, journalRecords);
+	ApplyMapJournalRecords(journalRecords, contents);
+
+	Vec3 playerStartPosition = contents.m_playerStart.GetPosition();
+	out_bounds = AABB3(playerStartPosition, playerStartPosition);
+	out_numEntities = 0;
+	for (int entityIndex = 0; entityIndex < (int)contents.m_entities.size(); entityIndex++)
+	{
+		MapEntityRecord const& entityRecord = contents.m_entities[entityIndex];
+		if (entityRecord.m_type == MAP_RECORD_EMPTY_SLOT)
+		{
+			continue;
+		}
+
+		Vec3 position = entityRecord.GetPosition();
+		out_bounds.m_mins = Vec3(GetMin(out_bounds.m_mins.x, position.x), GetMin(out_bounds.m_mins.y, position.y), GetMin(out_bounds.m_mins.z, position.z));
+		out_bounds.m_maxs = Vec3(GetMax(out_bounds.m_maxs.x, position.x), GetMax(out_bounds.m_maxs.y, position.y), GetMax(out_bounds.m_maxs.z, position.z));
+		out_numEntities++;
+	}
+
+	return true;
+}
+
+MapCatalog::~MapCatalog()
+{
+	if (m_workerThread.joinable())
+	{
+		m_workerThread.join();
+	}
+
+	StopChangeNotification();
+}
+
+bool MapCatalog::Refresh()
+{
+	// The worker holds its own copy of the entries, so a refresh while it runs waits for it to finish instead
+	if (IsReadingStats())
+	{
+		m_isRefreshPending = true;
+		return false;
+	}
+	m_isRefreshPending = false;
+
+	if (!m_isIndexRead)
+	{
+		ReadIndex();
+		StartChangeNotification();
+	}
+
+	// One pass over the directory gives the size, write time and read-only attribute of every file without opening any of them
+	std::vector<MapCatalogEntry> scannedEntries;
+	std::map<std::string, uint64_t> journalSizesByMapFileName;
+	std::set<std::string> thumbnailNames;
+
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA((m_directory + "/*").c_str(), &findData);
+	if (findHandle != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				continue;
+			}
+
+			std::string fileName = findData.cFileName;
+			uint64_t fileSize = ((uint64_t)findData.nFileSizeHigh << 32) | (uint64_t)findData.nFileSizeLow;
+			if (HasExtension(fileName, MAP_FILE_EXTENSION))
+			{
+				MapCatalogEntry entry;
+				entry.m_fileName = fileName;
+				entry.m_displayName = RemoveExtension(fileName, MAP_FILE_EXTENSION);
+				entry.m_fileSize = fileSize;
+				entry.m_lastWriteTime = ((uint64_t)findData.ftLastWriteTime.dwHighDateTime << 32) | (uint64_t)findData.ftLastWriteTime.dwLowDateTime;
+				entry.m_isReadOnly = (findData.dwFileAttributes & FILE_ATTRIBUTE_READONLY) != 0;
+				scannedEntries.push_back(entry);
+			}
+			else if (HasExtension(fileName, ".journal"))
+			{
+				journalSizesByMapFileName[RemoveExtension(fileName, ".journal")] = fileSize;
+			}
+			else if (HasExtension(fileName, MAP_THUMBNAIL_EXTENSION))
+			{
+				thumbnailNames.insert(RemoveExtension(fileName, MAP_THUMBNAIL_EXTENSION));
+			}
+		}
+		while (FindNextFileA(findHandle, &findData));
+
+		FindClose(findHandle);
+	}
+
+	std::map<std::string, int> previousEntryIndexesByFileName;
+	for (int entryIndex = 0; entryIndex < (int)m_entries.size(); entryIndex++)
+	{
+		previousEntryIndexesByFileName[m_entries[entryIndex].m_fileName] = entryIndex;
+	}
+
+	// Stats are kept for every map whose file and journal are unchanged, the rest are read again
+	bool hasChanged = scannedEntries.size() != m_entries.size();
+	for (int entryIndex = 0; entryIndex < (int)scannedEntries.size(); entryIndex++)
+	{
+		MapCatalogEntry& entry = scannedEntries[entryIndex];
+		auto journalSizeIter = journalSizesByMapFileName.find(entry.m_fileName);
+		entry.m_journalSize = journalSizeIter != journalSizesByMapFileName.end() ? journalSizeIter->second : 0;
+		if (thumbnailNames.count(entry.m_displayName) > 0)
+		{
+			entry.m_thumbnailPath = m_directory + "/" + entry.m_displayName + MAP_THUMBNAIL_EXTENSION;
+		}
+
+		auto previousEntryIter = previousEntryIndexesByFileName.find(entry.m_fileName);
+		if (previousEntryIter != previousEntryIndexesByFileName.end())
+		{
+			MapCatalogEntry const& previousEntry = m_entries[previousEntryIter->second];
+			if (previousEntry.m_fileSize == entry.m_fileSize && previousEntry.m_lastWriteTime == entry.m_lastWriteTime && previousEntry.m_journalSize == entry.m_journalSize)
+			{
+				entry.m_numEntities = previousEntry.m_numEntities;
+				entry.m_bounds = previousEntry.m_bounds;
+				entry.m_hasStats = previousEntry.m_hasStats;
+			}
+		}
+
+		hasChanged = hasChanged || entryIndex >= (int)m_entries.size() || !IsSameEntry(entry, m_entries[entryIndex]);
+	}
+
+	if (!hasChanged)
+	{
+		return false;
+	}
+
+	// The index is rewritten whenever the listing changed, even when every map kept its stats
+	m_entries = scannedEntries;
+	m_workerEntries = m_entries;
+	m_isWorkerFinished = false;
+	m_workerThread = std::thread(&MapCatalog::ReadStatsAndWriteIndex, this);
+	return true;
+}
+
+bool MapCatalog::HasDirectoryChanged()
+{
+	if (IsReadingStats())
+	{
+		return false;
+	}
+
+	if (m_isRefreshPending)
+	{
+		return true;
+	}
+
+	// Checked without waiting, the notification is rearmed before the scan so nothing that changes during it is missed
+	if (m_changeNotificationHandle && WaitForSingleObject((HANDLE)m_changeNotificationHandle, 0) == WAIT_OBJECT_0)
+	{
+		FindNextChangeNotification((HANDLE)m_changeNotificationHandle);
+		return true;
+	}
+
+	return false;
+}
+
+bool MapCatalog::Update()
+{
+	if (!m_workerThread.joinable() || !m_isWorkerFinished)
+	{
+		return false;
+	}
+
+	m_workerThread.join();
+	m_entries = std::move(m_workerEntries);
+	m_workerEntries.clear();
+	m_statsVersion++;
+	return true;
+}
+
+bool MapCatalog::IsReadingStats() const
+{
+	return m_workerThread.joinable();
+}
+
+int MapCatalog::GetNumEntries() const
+{
+	return (int)m_entries.size();
+}
+
+MapCatalogEntry const& MapCatalog::GetEntry(int entryIndex) const
+{
+	return m_entries[entryIndex];
+}
+
+void MapCatalog::ReadIndex()
+{
+	m_isIndexRead = true;
+	m_entries.clear();
+
+	// A missing, stale or damaged index only costs a full read of every map, so it is never an error
+	MappedFile mappedFile;
+	if (!mappedFile.Open(m_filePath) || mappedFile.GetSize() < sizeof(MapCatalogHeader))
+	{
+		return;
+	}
+
+	uint8_t const* data = mappedFile.GetData();
+	size_t size = mappedFile.GetSize();
+	MapCatalogHeader const* header = reinterpret_cast<MapCatalogHeader const*>(data);
+	size_t recordsEnd = sizeof(MapCatalogHeader) + (size_t)header->m_numRecords * sizeof(MapCatalogRecord);
+	if (memcmp(header->m_4cc, MAP_CATALOG_4CC_CODE, 4) != 0 || header->m_version != MAP_CATALOG_VERSION || recordsEnd > size || header->m_namesOffset < recordsEnd || header->m_namesOffset > size)
+	{
+		return;
+	}
+
+	MapCatalogRecord const* records = reinterpret_cast<MapCatalogRecord const*>(data + sizeof(MapCatalogHeader));
+	char const* names = reinterpret_cast<char const*>(data + header->m_namesOffset);
+	size_t namesSize = size - header->m_namesOffset;
+	for (int recordIndex = 0; recordIndex < (int)header->m_numRecords; recordIndex++)
+	{
+		MapCatalogRecord const& record = records[recordIndex];
+		if ((size_t)record.m_nameOffset + (size_t)record.m_nameLength > namesSize)
+		{
+			m_entries.clear();
+			return;
+		}
+
+		MapCatalogEntry entry;
+		entry.m_fileName = std::string(names + record.m_nameOffset, record.m_nameLength);
+		entry.m_displayName = RemoveExtension(entry.m_fileName, MAP_FILE_EXTENSION);
+		if (record.m_flags & MAP_CATALOG_FLAG_HAS_THUMBNAIL)
+		{
+			entry.m_thumbnailPath = m_directory + "/" + entry.m_displayName + MAP_THUMBNAIL_EXTENSION;
+		}
+		entry.m_fileSize = record.m_fileSize;
+		entry.m_lastWriteTime = record.m_lastWriteTime;
+		entry.m_journalSize = record.m_journalSize;
+		entry.m_numEntities = (int)record.m_numEntities;
+		entry.m_bounds = AABB3(Vec3(record.m_boundsMins[0], record.m_boundsMins[1], record.m_boundsMins[2]), Vec3(record.m_boundsMaxs[0], record.m_boundsMaxs[1], record.m_boundsMaxs[2]));
+		entry.m_isReadOnly = (record.m_flags & MAP_CATALOG_FLAG_READ_ONLY) != 0;
+		entry.m_hasStats = (record.m_flags & MAP_CATALOG_FLAG_HAS_STATS) != 0;
+		m_entries.push_back(entry);
+	}
+}
+
+void MapCatalog::ReadStatsAndWriteIndex()
+{
+	for (int entryIndex = 0; entryIndex < (int)m_workerEntries.size(); entryIndex++)
+	{
+		MapCatalogEntry& entry = m_workerEntries[entryIndex];
+		if (entry.m_hasStats)
+		{
+			continue;
+		}
+
+		entry.m_numEntities = -1;
+		entry.m_bounds = AABB3();
+		if (!ReadMapStats(m_directory + "/" + entry.m_fileName, entry.m_numEntities, entry.m_bounds))
+		{
+			entry.m_numEntities = -1;
+		}
+		entry.m_hasStats = true;
+	}
+
+	std::vector<MapCatalogRecord> records(m_workerEntries.size());
+	std::string names;
+	for (int entryIndex = 0; entryIndex < (int)m_workerEntries.size(); entryIndex++)
+	{
+		MapCatalogEntry const& entry = m_workerEntries[entryIndex];
+		MapCatalogRecord& record = records[entryIndex];
+		record.m_fileSize = entry.m_fileSize;
+		record.m_lastWriteTime = entry.m_lastWriteTime;
+		record.m_journalSize = entry.m_journalSize;
+		record.m_nameOffset = (uint32_t)names.size();
+		record.m_nameLength = (uint32_t)entry.m_fileName.size();
+		record.m_numEntities = (int32_t)entry.m_numEntities;
+		record.m_boundsMins[0] = entry.m_bounds.m_mins.x;
+		record.m_boundsMins[1] = entry.m_bounds.m_mins.y;
+		record.m_boundsMins[2] = entry.m_bounds.m_mins.z;
+		record.m_boundsMaxs[0] = entry.m_bounds.m_maxs.x;
+		record.m_boundsMaxs[1] = entry.m_bounds.m_maxs.y;
+		record.m_boundsMaxs[2] = entry.m_bounds.m_maxs.z;
+		record.m_flags = MAP_CATALOG_FLAG_HAS_STATS;
+		record.m_flags |= entry.m_isReadOnly ? MAP_CATALOG_FLAG_READ_ONLY : 0;
+		record.m_flags |= entry.m_thumbnailPath.empty() ? 0 : MAP_CATALOG_FLAG_HAS_THUMBNAIL;
+		names += entry.m_fileName;
+	}
+
+	MapCatalogHeader header;
+	memcpy(header.m_4cc, MAP_CATALOG_4CC_CODE, 4);
+	header.m_version = MAP_CATALOG_VERSION;
+	header.m_numRecords = (uint32_t)records.size();
+	header.m_namesOffset = (uint32_t)(sizeof(MapCatalogHeader) + records.size() * sizeof(MapCatalogRecord));
+
+	std::vector<uint8_t> buffer(header.m_namesOffset + names.size());
+	memcpy(buffer.data(), &header, sizeof(MapCatalogHeader));
+	if (!records.empty())
+	{
+		memcpy(buffer.data() + sizeof(MapCatalogHeader), records.data(), records.size() * sizeof(MapCatalogRecord));
+	}
+	if (!names.empty())
+	{
+		memcpy(buffer.data() + header.m_namesOffset, names.data(), names.size());
+	}
+
+	// Losing the index only means the next refresh reads every map again, so a failed write is not reported
+	WriteFileAtomically(m_filePath, buffer);
+	m_isWorkerFinished = true;
+}
+
+void MapCatalog::StartChangeNotification()
+{
+	HANDLE changeNotificationHandle = FindFirstChangeNotificationA(m_directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_ATTRIBUTES);
+	if (changeNotificationHandle != INVALID_HANDLE_VALUE)
+	{
+		m_changeNotificationHandle = changeNotificationHandle;
+	}
+}
+
+void MapCatalog::StopChangeNotification()
+{
+	if (m_changeNotificationHandle)
+	{
+		FindCloseChangeNotification((HANDLE)m_changeNotificationHandle);
+		m_changeNotificationHandle = nullptr;
+	}
+}
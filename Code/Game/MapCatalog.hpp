@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Engine/Math/AABB3.hpp"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Saved/MapCatalog.alcatalog layout: a fixed header, one fixed-size record per map, then every map file name packed back to back
+// File size, write time and journal size are compared against a directory scan, only maps where any of them changed are read again
+struct MapCatalogHeader
+{
+public:
+	char m_4cc[4] = {};
+	uint8_t m_version = 0;
+	uint8_t m_reserved[3] = {};
+	uint32_t m_numRecords = 0;
+	uint32_t m_namesOffset = 0;
+};
+
+struct MapCatalogRecord
+{
+public:
+	uint64_t m_fileSize = 0;
+	uint64_t m_lastWriteTime = 0;
+	uint64_t m_journalSize = 0;
+	uint32_t m_nameOffset = 0;
+	uint32_t m_nameLength = 0;
+	int32_t m_numEntities = -1;
+	float m_boundsMins[3] = {};
+	float m_boundsMaxs[3] = {};
+	uint8_t m_flags = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+static_assert(sizeof(MapCatalogHeader) == 16, "MapCatalogHeader is part of the file format");
+static_assert(sizeof(MapCatalogRecord) == 64, "MapCatalogRecord is part of the file format");
+
+constexpr char const* MAP_CATALOG_4CC_CODE = "GHAC";
+constexpr uint8_t MAP_CATALOG_VERSION = 1;
+constexpr uint8_t MAP_CATALOG_FLAG_HAS_STATS = 1 << 0;
+constexpr uint8_t MAP_CATALOG_FLAG_READ_ONLY = 1 << 1;
+constexpr uint8_t MAP_CATALOG_FLAG_HAS_THUMBNAIL = 1 << 2;
+
+
+// m_numEntities stays -1 for a map whose stats are still being read, or that could not be read at all once m_hasStats is set
+struct MapCatalogEntry
+{
+public:
+	std::string m_fileName;
+	std::string m_displayName;
+	std::string m_thumbnailPath;
+	uint64_t m_fileSize = 0;
+	uint64_t m_lastWriteTime = 0;
+	uint64_t m_journalSize = 0;
+	int m_numEntities = -1;
+	AABB3 m_bounds;
+	bool m_isReadOnly = false;
+	bool m_hasStats = false;
+};
+
+
+// Lists the saved maps with their stats from a cached index, a directory scan finds what changed and a worker thread reads only those maps
+class MapCatalog
+{
+public:
+	~MapCatalog();
+	MapCatalog() = default;
+	MapCatalog(MapCatalog const& copy) = delete;
+	MapCatalog& operator=(MapCatalog const& copy) = delete;
+
+	bool Refresh();
+	bool HasDirectoryChanged();
+	bool Update();
+
+	bool IsReadingStats() const;
+	int GetNumEntries() const;
+	MapCatalogEntry const& GetEntry(int entryIndex) const;
+
+public:
+	std::string m_directory = "Saved";
+	std::string m_filePath = "Saved/MapCatalog.alcatalog";
+	uint32_t m_statsVersion = 0;
+
+private:
+	void ReadIndex();
+	void ReadStatsAndWriteIndex();
+	void StartChangeNotification();
+	void StopChangeNotification();
+
+private:
+	std::vector<MapCatalogEntry> m_entries;
+	bool m_isIndexRead = false;
+	bool m_isRefreshPending = false;
+	void* m_changeNotificationHandle = nullptr;
+
+	// Owned by the worker from the moment it starts until m_isWorkerFinished is set
+	std::vector<MapCatalogEntry> m_workerEntries;
+	std::thread m_workerThread;
+	std::atomic<bool> m_isWorkerFinished = false;
+};
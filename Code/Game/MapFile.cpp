@@ -0,0 +1,722 @@
+#include "Game/MapFile.hpp"
+
+#include "Game/EntityUID.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+
+template <typename T_RecordType>
+static void AppendSection(std::vector<uint8_t>& buffer, MapFileSection* sections, int& numSections, MapFileSectionType type, T_RecordType const* records, size_t numRecords)
+{
+	MapFileSection& section = sections[numSections++];
+	section.m_type = (uint32_t)type;
+	section.m_offset = (uint32_t)buffer.size();
+	section.m_count = (uint32_t)numRecords;
+	section.m_stride = (uint32_t)sizeof(T_RecordType);
+
+	size_t recordsSize = numRecords * sizeof(T_RecordType);
+	buffer.resize(buffer.size() + recordsSize);
+	if (recordsSize > 0)
+	{
+		memcpy(buffer.data() + section.m_offset, records, recordsSize);
+	}
+}
+
+template <typename T_RecordType>
+static void CopySectionRecords(MapFileSectionView<T_RecordType> const& view, std::vector<T_RecordType>& out_records)
+{
+	out_records.reserve(out_records.size() + view.m_count);
+	for (int recordIndex = 0; recordIndex < view.m_count; recordIndex++)
+	{
+		out_records.push_back(view[recordIndex]);
+	}
+}
+
+// Sections this version does not know are skipped, so they only have to be in bounds
+// Version 4 regions have their own smaller layout and are never read, IsStreamable turns those files away first
+static size_t GetMapFileRecordSize(MapFileSectionType type, uint8_t version)
+{
+	switch (type)
+	{
+		case MapFileSectionType::PLAYER_START:			return sizeof(MapEntityRecord);
+		case MapFileSectionType::ENTITIES:				return sizeof(MapEntityRecord);
+		case MapFileSectionType::MOVEMENTS:				return sizeof(MapMovementRecord);
+		case MapFileSectionType::SIGNAL_EDGES:			return sizeof(MapSignalEdgeRecord);
+		case MapFileSectionType::SIGNAL_COMBINATORS:	return sizeof(MapSignalCombinatorRecord);
+		case MapFileSectionType::REGIONS:				return version > SAVEFILE_VERSION_FIXED_STRIDE ? sizeof(MapRegionRecord) : 0;
+		case MapFileSectionType::REGION_SLOTS:			return sizeof(uint32_t);
+		case MapFileSectionType::MAP_INFO:				return sizeof(MapInfoRecord);
+		case MapFileSectionType::ENTITY_SLOTS:			return sizeof(uint32_t);
+		case MapFileSectionType::TILE_CHUNKS:			return sizeof(MapTileChunkRecord);
+		case MapFileSectionType::TILE_CELLS:			return sizeof(uint32_t);
+		case MapFileSectionType::JOURNAL_INFO:			return sizeof(MapJournalInfoRecord);
+	}
+	return 0;
+}
+
+IntVec2 GetMapRegionForPosition(Vec3 const& position)
+{
+	return IntVec2(RoundDownToInt(position.x / MAP_REGION_SIZE), RoundDownToInt(position.y / MAP_REGION_SIZE));
+}
+
+long long GetMapRegionKey(IntVec2 const& region)
+{
+	return ((long long)region.x << 32) | (long long)(unsigned int)region.y;
+}
+
+int GetMapDecodeThreadCount()
+{
+	int numHardwareThreads = (int)std::thread::hardware_concurrency();
+	return numHardwareThreads > 1 ? numHardwareThreads : 1;
+}
+
+static void AppendVarint(std::vector<uint8_t>& bytes, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back((uint8_t)value);
+}
+
+static bool ParseVarint(uint8_t const*& cursor, uint8_t const* end, uint32_t& out_value)
+{
+	out_value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (cursor >= end)
+		{
+			return false;
+		}
+
+		uint8_t byte = *cursor++;
+		out_value |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint32_t EncodeZigZag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t DecodeZigZag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static bool IsIntegerCoordinate(float value)
+{
+	return value >= -8388608.f && value <= 8388608.f && value == floorf(value);
+}
+
+static int GetChunkForCell(int cell)
+{
+	return cell >= 0 ? cell / MAP_TILE_CHUNK_SIZE : -((-cell - 1) / MAP_TILE_CHUNK_SIZE) - 1;
+}
+
+static bool IsGridAlignedRecord(MapEntityRecord const& record, uint32_t slotIndex)
+{
+	if (!IsIntegerCoordinate(record.m_position[0]) || !IsIntegerCoordinate(record.m_position[1]) || !IsIntegerCoordinate(record.m_position[2]))
+	{
+		return false;
+	}
+
+	// Anything that would not decode back bit for bit from its cell, type and slot keeps a full record, negative zeros included
+	MapEntityRecord gridRecord;
+	gridRecord.m_uid = EntityUID(slotIndex & 0xFFFF, record.m_uid & 0xFFFF).m_uid;
+	gridRecord.m_position[0] = (float)(int)record.m_position[0];
+	gridRecord.m_position[1] = (float)(int)record.m_position[1];
+	gridRecord.m_position[2] = (float)(int)record.m_position[2];
+	gridRecord.m_type = record.m_type;
+	return memcmp(&gridRecord, &record, sizeof(MapEntityRecord)) == 0;
+}
+
+struct GridCellEntry
+{
+public:
+	bool operator<(GridCellEntry const& compare) const
+	{
+		return std::tie(m_regionKey, m_chunkX, m_chunkY, m_cellZ, m_cellIndex, m_slotIndex) < std::tie(compare.m_regionKey, compare.m_chunkX, compare.m_chunkY, compare.m_cellZ, compare.m_cellIndex, compare.m_slotIndex);
+	}
+
+	bool IsSameChunk(GridCellEntry const& compare) const
+	{
+		return m_chunkX == compare.m_chunkX && m_chunkY == compare.m_chunkY && m_cellZ == compare.m_cellZ;
+	}
+
+public:
+	long long m_regionKey = 0;
+	int m_chunkX = 0;
+	int m_chunkY = 0;
+	int m_cellZ = 0;
+	int m_cellIndex = 0;
+	uint32_t m_slotIndex = 0;
+};
+
+static void EncodeTileChunk(std::vector<MapEntityRecord> const& entities, GridCellEntry const* cells, int numCells, MapTileChunkRecord& out_chunk, std::vector<uint8_t>& cellBytes)
+{
+	out_chunk.m_chunkX = cells[0].m_chunkX;
+	out_chunk.m_chunkY = cells[0].m_chunkY;
+	out_chunk.m_cellZ = cells[0].m_cellZ;
+	out_chunk.m_firstSlotIndex = cells[0].m_slotIndex;
+	out_chunk.m_cellDataOffset = (uint32_t)cellBytes.size();
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		out_chunk.m_occupancy[cells[cellIndex].m_cellIndex / 32] |= 1u << (cells[cellIndex].m_cellIndex % 32);
+	}
+
+	// Floors are mostly one type, so the types collapse to a handful of runs
+	for (int cellIndex = 0; cellIndex < numCells;)
+	{
+		uint8_t type = entities[cells[cellIndex].m_slotIndex].m_type;
+		int runLength = 1;
+		while (cellIndex + runLength < numCells && entities[cells[cellIndex + runLength].m_slotIndex].m_type == type)
+		{
+			runLength++;
+		}
+
+		AppendVarint(cellBytes, (uint32_t)runLength);
+		cellBytes.push_back(type);
+		cellIndex += runLength;
+	}
+
+	// Tiles painted together were spawned in a steady stride, so each slot is coded against the previous step
+	uint32_t previousSlotIndex = out_chunk.m_firstSlotIndex;
+	int32_t previousSlotDelta = 0;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		int32_t slotDelta = (int32_t)(cells[cellIndex].m_slotIndex - previousSlotIndex);
+		AppendVarint(cellBytes, EncodeZigZag(slotDelta - previousSlotDelta));
+		previousSlotIndex = cells[cellIndex].m_slotIndex;
+		previousSlotDelta = slotDelta;
+	}
+
+	// Salts advance once per spawn just like slots, so only their difference from the slot step is stored
+	previousSlotIndex = out_chunk.m_firstSlotIndex;
+	uint16_t previousSalt = 0;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		uint16_t salt = (uint16_t)(entities[cells[cellIndex].m_slotIndex].m_uid & 0xFFFF);
+		int16_t slotDelta = (int16_t)(cells[cellIndex].m_slotIndex - previousSlotIndex);
+		AppendVarint(cellBytes, EncodeZigZag((int16_t)((int16_t)(salt - previousSalt) - slotDelta)));
+		previousSlotIndex = cells[cellIndex].m_slotIndex;
+		previousSalt = salt;
+	}
+
+	out_chunk.m_cellDataSize = (uint32_t)cellBytes.size() - out_chunk.m_cellDataOffset;
+}
+
+void MapFileContents::WriteToBuffer(std::vector<uint8_t>& out_buffer) const
+{
+	out_buffer.clear();
+
+	// Grid-aligned entities go into tile chunks, everything else keeps a full record with its slot alongside
+	std::vector<GridCellEntry> gridCells;
+	std::vector<std::pair<long long, uint32_t>> fullRecordSlots;
+	gridCells.reserve(m_entities.size());
+	for (int slotIndex = 0; slotIndex < (int)m_entities.size(); slotIndex++)
+	{
+		MapEntityRecord const& record = m_entities[slotIndex];
+		if (record.m_type == MAP_RECORD_EMPTY_SLOT)
+		{
+			continue;
+		}
+
+		long long regionKey = GetMapRegionKey(GetMapRegionForPosition(record.GetPosition()));
+		if (!IsGridAlignedRecord(record, (uint32_t)slotIndex))
+		{
+			fullRecordSlots.push_back(std::make_pair(regionKey, (uint32_t)slotIndex));
+			continue;
+		}
+
+		GridCellEntry cell;
+		int cellX = (int)record.m_position[0];
+		int cellY = (int)record.m_position[1];
+		cell.m_regionKey = regionKey;
+		cell.m_chunkX = GetChunkForCell(cellX);
+		cell.m_chunkY = GetChunkForCell(cellY);
+		cell.m_cellZ = (int)record.m_position[2];
+		cell.m_cellIndex = (cellY - cell.m_chunkY * MAP_TILE_CHUNK_SIZE) * MAP_TILE_CHUNK_SIZE + (cellX - cell.m_chunkX * MAP_TILE_CHUNK_SIZE);
+		cell.m_slotIndex = (uint32_t)slotIndex;
+		gridCells.push_back(cell);
+	}
+	std::sort(gridCells.begin(), gridCells.end());
+
+	// A cell holds one entity, any others stacked in the same spot fall back to full records
+	std::vector<GridCellEntry> uniqueGridCells;
+	uniqueGridCells.reserve(gridCells.size());
+	for (int cellIndex = 0; cellIndex < (int)gridCells.size(); cellIndex++)
+	{
+		if (!uniqueGridCells.empty() && uniqueGridCells.back().IsSameChunk(gridCells[cellIndex]) && uniqueGridCells.back().m_cellIndex == gridCells[cellIndex].m_cellIndex)
+		{
+			fullRecordSlots.push_back(std::make_pair(gridCells[cellIndex].m_regionKey, gridCells[cellIndex].m_slotIndex));
+			continue;
+		}
+
+		uniqueGridCells.push_back(gridCells[cellIndex]);
+	}
+	std::sort(fullRecordSlots.begin(), fullRecordSlots.end());
+
+	std::vector<MapEntityRecord> fullRecords;
+	std::vector<uint32_t> entitySlots;
+	fullRecords.reserve(fullRecordSlots.size());
+	entitySlots.reserve(fullRecordSlots.size());
+	for (int recordIndex = 0; recordIndex < (int)fullRecordSlots.size(); recordIndex++)
+	{
+		fullRecords.push_back(m_entities[fullRecordSlots[recordIndex].second]);
+		entitySlots.push_back(fullRecordSlots[recordIndex].second);
+	}
+
+	std::vector<MapTileChunkRecord> tileChunks;
+	std::vector<long long> tileChunkRegionKeys;
+	std::vector<uint8_t> tileCellBytes;
+	for (int firstCellIndex = 0; firstCellIndex < (int)uniqueGridCells.size();)
+	{
+		int numCells = 1;
+		while (firstCellIndex + numCells < (int)uniqueGridCells.size() && uniqueGridCells[firstCellIndex + numCells].IsSameChunk(uniqueGridCells[firstCellIndex]))
+		{
+			numCells++;
+		}
+
+		MapTileChunkRecord chunk;
+		EncodeTileChunk(m_entities, &uniqueGridCells[firstCellIndex], numCells, chunk, tileCellBytes);
+		tileChunks.push_back(chunk);
+		tileChunkRegionKeys.push_back(uniqueGridCells[firstCellIndex].m_regionKey);
+		firstCellIndex += numCells;
+	}
+	tileCellBytes.resize((tileCellBytes.size() + 3) & ~(size_t)3);
+
+	// Both lists are sorted by region key, so walking them together gives each region its two runs
+	std::vector<MapRegionRecord> regions;
+	int recordIndex = 0;
+	int chunkIndex = 0;
+	while (recordIndex < (int)fullRecordSlots.size() || chunkIndex < (int)tileChunks.size())
+	{
+		long long regionKey = 0;
+		if (chunkIndex >= (int)tileChunks.size() || (recordIndex < (int)fullRecordSlots.size() && fullRecordSlots[recordIndex].first < tileChunkRegionKeys[chunkIndex]))
+		{
+			regionKey = fullRecordSlots[recordIndex].first;
+		}
+		else
+		{
+			regionKey = tileChunkRegionKeys[chunkIndex];
+		}
+
+		MapRegionRecord region;
+		region.m_regionX = (int32_t)(regionKey >> 32);
+		region.m_regionY = (int32_t)(regionKey & 0xFFFFFFFF);
+		region.m_firstEntityRecord = (uint32_t)recordIndex;
+		region.m_firstTileChunk = (uint32_t)chunkIndex;
+		while (recordIndex < (int)fullRecordSlots.size() && fullRecordSlots[recordIndex].first == regionKey)
+		{
+			region.m_numEntityRecords++;
+			recordIndex++;
+		}
+		while (chunkIndex < (int)tileChunks.size() && tileChunkRegionKeys[chunkIndex] == regionKey)
+		{
+			region.m_numTileChunks++;
+			chunkIndex++;
+		}
+		regions.push_back(region);
+	}
+
+	MapInfoRecord info;
+	info.m_numEntitySlots = (uint32_t)m_entities.size();
+
+	MapJournalInfoRecord journalInfo;
+	journalInfo.m_lastJournalSequence = m_lastJournalSequence;
+
+	size_t recordsSize = sizeof(MapEntityRecord) * (1 + fullRecords.size()) + sizeof(uint32_t) * entitySlots.size() + sizeof(MapMovementRecord) * m_movements.size() + sizeof(MapSignalEdgeRecord) * m_signalEdges.size() + sizeof(MapSignalCombinatorRecord) * m_signalCombinators.size()
+		+ sizeof(MapInfoRecord) + sizeof(MapJournalInfoRecord) + sizeof(MapRegionRecord) * regions.size() + sizeof(MapTileChunkRecord) * tileChunks.size() + tileCellBytes.size();
+	size_t sectionTableSize = sizeof(MapFileSection) * (size_t)MapFileSectionType::NUM;
+	out_buffer.reserve(sizeof(MapFileHeader) + sectionTableSize + recordsSize);
+	out_buffer.resize(sizeof(MapFileHeader) + sectionTableSize);
+
+	MapFileSection sections[(int)MapFileSectionType::NUM];
+	int numSections = 0;
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::PLAYER_START, &m_playerStart, 1);
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::MAP_INFO, &info, 1);
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::JOURNAL_INFO, &journalInfo, 1);
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::ENTITIES, fullRecords.data(), fullRecords.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::ENTITY_SLOTS, entitySlots.data(), entitySlots.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::TILE_CHUNKS, tileChunks.data(), tileChunks.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::TILE_CELLS, reinterpret_cast<uint32_t const*>(tileCellBytes.data()), tileCellBytes.size() / 4);
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::MOVEMENTS, m_movements.data(), m_movements.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::SIGNAL_EDGES, m_signalEdges.data(), m_signalEdges.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::SIGNAL_COMBINATORS, m_signalCombinators.data(), m_signalCombinators.size());
+	AppendSection(out_buffer, sections, numSections, MapFileSectionType::REGIONS, regions.data(), regions.size());
+
+	MapFileHeader header;
+	memcpy(header.m_4cc, SAVEFILE_4CC_CODE, 4);
+	header.m_version = SAVEFILE_VERSION;
+	header.m_numSections = (uint32_t)numSections;
+	header.m_sectionTableOffset = (uint32_t)sizeof(MapFileHeader);
+	memcpy(out_buffer.data(), &header, sizeof(MapFileHeader));
+	memcpy(out_buffer.data() + header.m_sectionTableOffset, sections, sizeof(MapFileSection) * numSections);
+}
+
+bool MapFileReader::Open(uint8_t const* data, size_t size)
+{
+	m_data = data;
+	m_size = size;
+	m_header = nullptr;
+	m_sections = nullptr;
+
+	if (!data || size < sizeof(MapFileHeader))
+	{
+		return false;
+	}
+
+	MapFileHeader const* header = reinterpret_cast<MapFileHeader const*>(data);
+	if (memcmp(header->m_4cc, SAVEFILE_4CC_CODE, 4) != 0 || header->m_version < SAVEFILE_VERSION_FIXED_STRIDE || header->m_version > SAVEFILE_VERSION)
+	{
+		return false;
+	}
+
+	size_t sectionTableEnd = (size_t)header->m_sectionTableOffset + (size_t)header->m_numSections * sizeof(MapFileSection);
+	if ((header->m_sectionTableOffset % 4) != 0 || sectionTableEnd > size)
+	{
+		return false;
+	}
+
+	// Every section is bounds and stride checked once here, so record access afterwards needs no checks
+	MapFileSection const* sections = reinterpret_cast<MapFileSection const*>(data + header->m_sectionTableOffset);
+	for (int sectionIndex = 0; sectionIndex < (int)header->m_numSections; sectionIndex++)
+	{
+		MapFileSection const& section = sections[sectionIndex];
+		size_t sectionEnd = (size_t)section.m_offset + (size_t)section.m_count * (size_t)section.m_stride;
+		if ((section.m_offset % 4) != 0 || (section.m_stride % 4) != 0 || section.m_stride < GetMapFileRecordSize((MapFileSectionType)section.m_type, header->m_version) || sectionEnd > size)
+		{
+			return false;
+		}
+	}
+
+	m_header = header;
+	m_sections = sections;
+	return true;
+}
+
+MapFileSection const* MapFileReader::FindSection(MapFileSectionType type) const
+{
+	if (!m_header)
+	{
+		return nullptr;
+	}
+
+	for (int sectionIndex = 0; sectionIndex < (int)m_header->m_numSections; sectionIndex++)
+	{
+		if (m_sections[sectionIndex].m_type == (uint32_t)type)
+		{
+			return &m_sections[sectionIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+int MapFileReader::GetNumEntitySlots() const
+{
+	MapFileSectionView<MapInfoRecord> infoRecords;
+	MapFileSectionView<MapEntityRecord> entityRecords;
+	if (!GetSection(MapFileSectionType::MAP_INFO, infoRecords) || !GetSection(MapFileSectionType::ENTITIES, entityRecords))
+	{
+		return 0;
+	}
+
+	if (infoRecords.m_count > 0)
+	{
+		return (int)infoRecords[0].m_numEntitySlots;
+	}
+
+	return entityRecords.m_count;
+}
+
+bool MapFileReader::GetRegions(MapFileSectionView<MapRegionRecord>& out_regions) const
+{
+	MapFileSectionView<MapEntityRecord> entityRecords;
+	MapFileSectionView<MapTileChunkRecord> tileChunks;
+	if (!GetSection(MapFileSectionType::REGIONS, out_regions) || !GetSection(MapFileSectionType::ENTITIES, entityRecords) || !GetSection(MapFileSectionType::TILE_CHUNKS, tileChunks))
+	{
+		return false;
+	}
+
+	// Each region owns one run of full records and one of tile chunks, both have to lie inside their sections
+	for (int regionIndex = 0; regionIndex < out_regions.m_count; regionIndex++)
+	{
+		MapRegionRecord const& region = out_regions[regionIndex];
+		if ((uint64_t)region.m_firstEntityRecord + region.m_numEntityRecords > (uint64_t)entityRecords.m_count || (uint64_t)region.m_firstTileChunk + region.m_numTileChunks > (uint64_t)tileChunks.m_count)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MapFileReader::ReadSideTables(MapFileContents& out_contents) const
+{
+	MapFileSectionView<MapEntityRecord> playerStartRecords;
+	if (!GetSection(MapFileSectionType::PLAYER_START, playerStartRecords) || playerStartRecords.m_count != 1)
+	{
+		return false;
+	}
+
+	MapFileSectionView<MapMovementRecord> movementRecords;
+	MapFileSectionView<MapSignalEdgeRecord> signalEdgeRecords;
+	MapFileSectionView<MapSignalCombinatorRecord> signalCombinatorRecords;
+	MapFileSectionView<MapJournalInfoRecord> journalInfoRecords;
+	if (!GetSection(MapFileSectionType::MOVEMENTS, movementRecords) || !GetSection(MapFileSectionType::SIGNAL_EDGES, signalEdgeRecords)
+		|| !GetSection(MapFileSectionType::SIGNAL_COMBINATORS, signalCombinatorRecords) || !GetSection(MapFileSectionType::JOURNAL_INFO, journalInfoRecords))
+	{
+		return false;
+	}
+
+	out_contents.m_playerStart = playerStartRecords[0];
+	CopySectionRecords(movementRecords, out_contents.m_movements);
+	CopySectionRecords(signalEdgeRecords, out_contents.m_signalEdges);
+	CopySectionRecords(signalCombinatorRecords, out_contents.m_signalCombinators);
+	out_contents.m_lastJournalSequence = journalInfoRecords.m_count > 0 ? journalInfoRecords[0].m_lastJournalSequence : 0;
+	return true;
+}
+
+// A run of full records or tile chunks that decodes into its own lists, so any number of them can be decoded at once
+struct MapDecodeJob
+{
+public:
+	bool m_isTileChunks = false;
+	int m_firstIndex = 0;
+	int m_count = 0;
+	bool m_isDecoded = false;
+	std::vector<uint32_t> m_slotIndexes;
+	std::vector<MapEntityRecord> m_records;
+};
+
+bool MapFileReader::GetEntityRecordsInSlotOrder(std::vector<MapEntityRecord>& out_records, int numDecodeThreads) const
+{
+	MapEntityRecord emptySlot;
+	emptySlot.m_uid = ENTITYUID_INVALID;
+	emptySlot.m_type = MAP_RECORD_EMPTY_SLOT;
+	out_records.assign(GetNumEntitySlots(), emptySlot);
+
+	// Tile chunks carry the offset of their own cell data, so every job can start decoding without scanning the ones before it
+	MapFileSectionView<MapEntityRecord> entityRecords;
+	MapFileSectionView<MapTileChunkRecord> tileChunks;
+	if (!GetSection(MapFileSectionType::ENTITIES, entityRecords) || !GetSection(MapFileSectionType::TILE_CHUNKS, tileChunks))
+	{
+		return false;
+	}
+
+	std::vector<MapDecodeJob> jobs;
+	int numFullRecords = entityRecords.m_count;
+	for (int firstRecordIndex = 0; firstRecordIndex < numFullRecords; firstRecordIndex += MAP_DECODE_RECORDS_PER_JOB)
+	{
+		MapDecodeJob job;
+		job.m_firstIndex = firstRecordIndex;
+		job.m_count = numFullRecords - firstRecordIndex < MAP_DECODE_RECORDS_PER_JOB ? numFullRecords - firstRecordIndex : MAP_DECODE_RECORDS_PER_JOB;
+		jobs.push_back(job);
+	}
+
+	int numTileChunks = tileChunks.m_count;
+	for (int firstChunkIndex = 0; firstChunkIndex < numTileChunks; firstChunkIndex += MAP_DECODE_TILE_CHUNKS_PER_JOB)
+	{
+		MapDecodeJob job;
+		job.m_isTileChunks = true;
+		job.m_firstIndex = firstChunkIndex;
+		job.m_count = numTileChunks - firstChunkIndex < MAP_DECODE_TILE_CHUNKS_PER_JOB ? numTileChunks - firstChunkIndex : MAP_DECODE_TILE_CHUNKS_PER_JOB;
+		jobs.push_back(job);
+	}
+
+	std::atomic<int> nextJobIndex = 0;
+	auto decodeJobs = [this, &jobs, &nextJobIndex]()
+	{
+		for (int jobIndex = nextJobIndex++; jobIndex < (int)jobs.size(); jobIndex = nextJobIndex++)
+		{
+			MapDecodeJob& job = jobs[jobIndex];
+			if (!job.m_isTileChunks)
+			{
+				job.m_isDecoded = DecodeEntityRecords(job.m_firstIndex, job.m_count, job.m_slotIndexes, job.m_records);
+				continue;
+			}
+
+			job.m_isDecoded = true;
+			for (int chunkIndex = job.m_firstIndex; job.m_isDecoded && chunkIndex < job.m_firstIndex + job.m_count; chunkIndex++)
+			{
+				job.m_isDecoded = DecodeTileChunk(chunkIndex, job.m_slotIndexes, job.m_records);
+			}
+		}
+	};
+
+	// Small maps fit in one job and never start a thread, the calling thread always takes jobs alongside the helpers
+	int numThreads = numDecodeThreads < (int)jobs.size() ? numDecodeThreads : (int)jobs.size();
+	std::vector<std::thread> helperThreads;
+	for (int threadIndex = 1; threadIndex < numThreads; threadIndex++)
+	{
+		helperThreads.emplace_back(decodeJobs);
+	}
+	decodeJobs();
+	for (int threadIndex = 0; threadIndex < (int)helperThreads.size(); threadIndex++)
+	{
+		helperThreads[threadIndex].join();
+	}
+
+	// Slots are filled in job order, the order a serial decode writes them in, so the result never depends on the thread count
+	for (int jobIndex = 0; jobIndex < (int)jobs.size(); jobIndex++)
+	{
+		MapDecodeJob const& job = jobs[jobIndex];
+		if (!job.m_isDecoded)
+		{
+			return false;
+		}
+
+		for (int recordIndex = 0; recordIndex < (int)job.m_records.size(); recordIndex++)
+		{
+			if (job.m_slotIndexes[recordIndex] >= (uint32_t)out_records.size())
+			{
+				return false;
+			}
+
+			out_records[job.m_slotIndexes[recordIndex]] = job.m_records[recordIndex];
+		}
+	}
+
+	return true;
+}
+
+bool MapFileReader::DecodeEntityRecords(int firstRecordIndex, int numRecords, std::vector<uint32_t>& out_slotIndexes, std::vector<MapEntityRecord>& out_records) const
+{
+	MapFileSectionView<MapEntityRecord> entityRecords;
+	MapFileSectionView<uint32_t> entitySlots;
+	if (!GetSection(MapFileSectionType::ENTITIES, entityRecords) || !GetSection(MapFileSectionType::ENTITY_SLOTS, entitySlots))
+	{
+		return false;
+	}
+	if (firstRecordIndex < 0 || numRecords < 0 || firstRecordIndex + numRecords > entityRecords.m_count)
+	{
+		return false;
+	}
+
+	// Version 4 has no slot table, its records are already in slot order
+	bool hasSlotTable = entitySlots.m_count > 0;
+	if (hasSlotTable && entitySlots.m_count != entityRecords.m_count)
+	{
+		return false;
+	}
+
+	for (int recordIndex = firstRecordIndex; recordIndex < firstRecordIndex + numRecords; recordIndex++)
+	{
+		if (entityRecords[recordIndex].m_type == MAP_RECORD_EMPTY_SLOT)
+		{
+			continue;
+		}
+
+		out_slotIndexes.push_back(hasSlotTable ? entitySlots[recordIndex] : (uint32_t)recordIndex);
+		out_records.push_back(entityRecords[recordIndex]);
+	}
+
+	return true;
+}
+
+bool MapFileReader::DecodeTileChunk(int chunkIndex, std::vector<uint32_t>& out_slotIndexes, std::vector<MapEntityRecord>& out_records) const
+{
+	MapFileSectionView<MapTileChunkRecord> tileChunks;
+	MapFileSectionView<uint32_t> tileCells;
+	if (!GetSection(MapFileSectionType::TILE_CHUNKS, tileChunks) || !GetSection(MapFileSectionType::TILE_CELLS, tileCells))
+	{
+		return false;
+	}
+	if (chunkIndex < 0 || chunkIndex >= tileChunks.m_count)
+	{
+		return false;
+	}
+
+	MapTileChunkRecord const& chunk = tileChunks[chunkIndex];
+	size_t cellBytesSize = (size_t)tileCells.m_count * (size_t)tileCells.m_stride;
+	if ((size_t)chunk.m_cellDataOffset + (size_t)chunk.m_cellDataSize > cellBytesSize)
+	{
+		return false;
+	}
+
+	int cellIndexes[MAP_TILE_CHUNK_CELLS];
+	int numCells = 0;
+	for (int cellIndex = 0; cellIndex < MAP_TILE_CHUNK_CELLS; cellIndex++)
+	{
+		if ((chunk.m_occupancy[cellIndex / 32] & (1u << (cellIndex % 32))) != 0)
+		{
+			cellIndexes[numCells++] = cellIndex;
+		}
+	}
+
+	uint8_t const* cursor = tileCells.m_data + chunk.m_cellDataOffset;
+	uint8_t const* end = cursor + chunk.m_cellDataSize;
+	size_t firstOutputIndex = out_records.size();
+	out_records.resize(firstOutputIndex + numCells);
+	out_slotIndexes.resize(firstOutputIndex + numCells);
+
+	for (int cellIndex = 0; cellIndex < numCells;)
+	{
+		uint32_t runLength = 0;
+		if (!ParseVarint(cursor, end, runLength) || runLength == 0 || runLength > (uint32_t)(numCells - cellIndex) || cursor >= end)
+		{
+			return false;
+		}
+
+		uint8_t type = *cursor++;
+		for (uint32_t runIndex = 0; runIndex < runLength; runIndex++, cellIndex++)
+		{
+			MapEntityRecord& record = out_records[firstOutputIndex + cellIndex];
+			record = MapEntityRecord();
+			record.m_type = type;
+			record.m_position[0] = (float)(chunk.m_chunkX * MAP_TILE_CHUNK_SIZE + cellIndexes[cellIndex] % MAP_TILE_CHUNK_SIZE);
+			record.m_position[1] = (float)(chunk.m_chunkY * MAP_TILE_CHUNK_SIZE + cellIndexes[cellIndex] / MAP_TILE_CHUNK_SIZE);
+			record.m_position[2] = (float)chunk.m_cellZ;
+		}
+	}
+
+	uint32_t slotIndex = chunk.m_firstSlotIndex;
+	int32_t slotDelta = 0;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		uint32_t encodedSlotStep = 0;
+		if (!ParseVarint(cursor, end, encodedSlotStep))
+		{
+			return false;
+		}
+
+		slotDelta += DecodeZigZag(encodedSlotStep);
+		slotIndex += (uint32_t)slotDelta;
+		out_slotIndexes[firstOutputIndex + cellIndex] = slotIndex;
+	}
+
+	uint32_t previousSlotIndex = chunk.m_firstSlotIndex;
+	uint16_t salt = 0;
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		uint32_t encodedSaltStep = 0;
+		if (!ParseVarint(cursor, end, encodedSaltStep))
+		{
+			return false;
+		}
+
+		uint32_t cellSlotIndex = out_slotIndexes[firstOutputIndex + cellIndex];
+		salt = (uint16_t)(salt + (int16_t)(cellSlotIndex - previousSlotIndex) + DecodeZigZag(encodedSaltStep));
+		previousSlotIndex = cellSlotIndex;
+		out_records[firstOutputIndex + cellIndex].m_uid = EntityUID(cellSlotIndex & 0xFFFF, salt).m_uid;
+	}
+
+	return true;
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+
+// Version 4 and 5 .almap layout: a fixed header, a section table, then one fixed-stride record array per section
+// Every record is a multiple of 4 bytes and every section starts 4-byte aligned, so the arrays are read in place from a mapped file
+// Version 5 moves grid-aligned entities out of ENTITIES into TILE_CHUNKS, the remaining full records carry their slot in ENTITY_SLOTS
+// JOURNAL_INFO is optional, files written before the edit journal simply have none
+enum class MapFileSectionType : uint32_t
+{
+	PLAYER_START,
+	ENTITIES,
+	MOVEMENTS,
+	SIGNAL_EDGES,
+	SIGNAL_COMBINATORS,
+	REGIONS,
+	REGION_SLOTS, // Version 4 only
+	MAP_INFO,
+	ENTITY_SLOTS,
+	TILE_CHUNKS,
+	TILE_CELLS,
+	JOURNAL_INFO,
+	NUM
+};
+
+struct MapFileHeader
+{
+public:
+	char m_4cc[4] = {};
+	uint8_t m_version = 0;
+	uint8_t m_reserved[3] = {};
+	uint32_t m_numSections = 0;
+	uint32_t m_sectionTableOffset = 0;
+};
+
+struct MapFileSection
+{
+public:
+	uint32_t m_type = 0;
+	uint32_t m_offset = 0;
+	uint32_t m_count = 0;
+	uint32_t m_stride = 0;
+};
+
+// Entity slots keep their index so UIDs stay valid, version 4 stores every slot in order and marks empty ones with m_type MAP_RECORD_EMPTY_SLOT
+struct MapEntityRecord
+{
+public:
+	Vec3 const GetPosition() const { return Vec3(m_position[0], m_position[1], m_position[2]); }
+	EulerAngles const GetOrientation() const { return EulerAngles(m_orientation[0], m_orientation[1], m_orientation[2]); }
+
+public:
+	uint32_t m_uid = 0;
+	float m_position[3] = {};
+	float m_orientation[3] = {};
+	float m_scale = 1.f;
+	uint8_t m_type = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+// Side table for moving platforms, keyed by entity slot
+struct MapMovementRecord
+{
+public:
+	uint32_t m_entityIndex = 0;
+	uint8_t m_movementDirection = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+struct MapSignalEdgeRecord
+{
+public:
+	uint32_t m_activatorUID = 0;
+	uint32_t m_activatableUID = 0;
+	uint8_t m_type = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+struct MapSignalCombinatorRecord
+{
+public:
+	uint32_t m_activatableUID = 0;
+	uint8_t m_combinator = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+struct MapInfoRecord
+{
+public:
+	uint32_t m_numEntitySlots = 0;
+};
+
+// The last edit journal record compacted into this file, replaying the journal skips everything up to it
+struct MapJournalInfoRecord
+{
+public:
+	uint32_t m_lastJournalSequence = 0;
+};
+
+// Entities grouped by the square region their saved position falls in, so a region can be loaded on its own
+// Full records and tile chunks are both sorted by region, so each region owns one run of each
+struct MapRegionRecord
+{
+public:
+	int32_t m_regionX = 0;
+	int32_t m_regionY = 0;
+	uint32_t m_firstEntityRecord = 0;
+	uint32_t m_numEntityRecords = 0;
+	uint32_t m_firstTileChunk = 0;
+	uint32_t m_numTileChunks = 0;
+};
+
+// Entities on integer coordinates with no rotation and unit scale, stored as one bit per cell of a 16x16 layer at a single height
+// The occupied cells' types, slots and UID salts follow in TILE_CELLS at m_cellDataOffset, each as a varint stream:
+// types as (run length, type) pairs, then each slot as the zigzag change in step from the previous slot starting at m_firstSlotIndex,
+// then each UID salt as the zigzag difference between its own step and its slot's step
+struct MapTileChunkRecord
+{
+public:
+	int32_t m_chunkX = 0;
+	int32_t m_chunkY = 0;
+	int32_t m_cellZ = 0;
+	uint32_t m_occupancy[8] = {};
+	uint32_t m_firstSlotIndex = 0;
+	uint32_t m_cellDataOffset = 0;
+	uint32_t m_cellDataSize = 0;
+};
+
+static_assert(sizeof(MapFileHeader) == 16, "MapFileHeader is part of the file format");
+static_assert(sizeof(MapFileSection) == 16, "MapFileSection is part of the file format");
+static_assert(sizeof(MapEntityRecord) == 36, "MapEntityRecord is part of the file format");
+static_assert(sizeof(MapMovementRecord) == 8, "MapMovementRecord is part of the file format");
+static_assert(sizeof(MapSignalEdgeRecord) == 12, "MapSignalEdgeRecord is part of the file format");
+static_assert(sizeof(MapSignalCombinatorRecord) == 8, "MapSignalCombinatorRecord is part of the file format");
+static_assert(sizeof(MapInfoRecord) == 4, "MapInfoRecord is part of the file format");
+static_assert(sizeof(MapJournalInfoRecord) == 4, "MapJournalInfoRecord is part of the file format");
+static_assert(sizeof(MapRegionRecord) == 24, "MapRegionRecord is part of the file format");
+static_assert(sizeof(MapTileChunkRecord) == 56, "MapTileChunkRecord is part of the file format");
+
+constexpr uint8_t MAP_RECORD_EMPTY_SLOT = 0xFF;
+constexpr float MAP_REGION_SIZE = 32.f;
+constexpr int MAP_TILE_CHUNK_SIZE = 16;
+constexpr int MAP_TILE_CHUNK_CELLS = MAP_TILE_CHUNK_SIZE * MAP_TILE_CHUNK_SIZE;
+static_assert((int)MAP_REGION_SIZE % MAP_TILE_CHUNK_SIZE == 0, "Tile chunks must not straddle regions");
+
+constexpr int MAP_DECODE_RECORDS_PER_JOB = 16384;
+constexpr int MAP_DECODE_TILE_CHUNKS_PER_JOB = 64;
+
+IntVec2 GetMapRegionForPosition(Vec3 const& position);
+long long GetMapRegionKey(IntVec2 const& region);
+int GetMapDecodeThreadCount();
+
+
+// Records may grow in later versions, so they are always addressed through the stride stored in the file
+template <typename T_RecordType>
+struct MapFileSectionView
+{
+public:
+	T_RecordType const& operator[](int recordIndex) const
+	{
+		return *reinterpret_cast<T_RecordType const*>(m_data + (size_t)recordIndex * (size_t)m_stride);
+	}
+
+public:
+	uint8_t const* m_data = nullptr;
+	int m_count = 0;
+	int m_stride = 0;
+};
+
+
+// Everything a map file holds with entities in slot order, gathered on the main thread and encoded in one pass, or decoded from a file on any thread
+struct MapFileContents
+{
+public:
+	void WriteToBuffer(std::vector<uint8_t>& out_buffer) const;
+
+public:
+	MapEntityRecord m_playerStart;
+	std::vector<MapEntityRecord> m_entities;
+	std::vector<MapMovementRecord> m_movements;
+	std::vector<MapSignalEdgeRecord> m_signalEdges;
+	std::vector<MapSignalCombinatorRecord> m_signalCombinators;
+	uint32_t m_lastJournalSequence = 0;
+};
+
+
+class MapFileReader
+{
+public:
+	bool Open(uint8_t const* data, size_t size);
+
+	// A missing section reads as empty, a stride too small for the record means the file is corrupt
+	template <typename T_RecordType>
+	bool GetSection(MapFileSectionType type, MapFileSectionView<T_RecordType>& out_view) const
+	{
+		out_view = MapFileSectionView<T_RecordType>();
+		MapFileSection const* section = FindSection(type);
+		if (!section)
+		{
+			return true;
+		}
+		if (section->m_stride < sizeof(T_RecordType))
+		{
+			return false;
+		}
+
+		out_view.m_data = m_data + section->m_offset;
+		out_view.m_count = (int)section->m_count;
+		out_view.m_stride = (int)section->m_stride;
+		return true;
+	}
+
+	int GetNumEntitySlots() const;
+	bool GetRegions(MapFileSectionView<MapRegionRecord>& out_regions) const;
+	bool ReadSideTables(MapFileContents& out_contents) const;
+	bool GetEntityRecordsInSlotOrder(std::vector<MapEntityRecord>& out_records, int numDecodeThreads = 1) const;
+	bool DecodeEntityRecords(int firstRecordIndex, int numRecords, std::vector<uint32_t>& out_slotIndexes, std::vector<MapEntityRecord>& out_records) const;
+	bool DecodeTileChunk(int chunkIndex, std::vector<uint32_t>& out_slotIndexes, std::vector<MapEntityRecord>& out_records) const;
+
+public:
+	MapFileHeader const* m_header = nullptr;
+
+private:
+	MapFileSection const* FindSection(MapFileSectionType type) const;
+
+private:
+	uint8_t const* m_data = nullptr;
+	size_t m_size = 0;
+	MapFileSection const* m_sections = nullptr;
+};
@@ -0,0 +1,512 @@
+#include "Game/MapJournal.hpp"
+
+#include "Game/AtomicFileWriter.hpp"
+#include "Game/EntityUID.hpp"
+#include "Game/MappedFile.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <algorithm>
+#include <string.h>
+
+
+std::string GetMapJournalFilePath(std::string const& mapFilePath)
+{
+	return mapFilePath + ".journal";
+}
+
+static bool ReadMapJournalFile(std::string const& journalFilePath, uint32_t lastSequenceInMap, std::vector<MapJournalRecord>& out_records, size_t& out_fileSize)
+{
+	out_fileSize = 0;
+
+	MappedFile mappedFile;
+	if (!mappedFile.Open(journalFilePath))
+	{
+		return false;
+	}
+
+	out_fileSize = mappedFile.GetSize();
+	MapJournalHeader const* header = reinterpret_cast<MapJournalHeader const*>(mappedFile.GetData());
+	if (mappedFile.GetSize() < sizeof(MapJournalHeader) || memcmp(header->m_4cc, MAP_JOURNAL_4CC_CODE, 4) != 0 || header->m_version != MAP_JOURNAL_VERSION)
+	{
+		return false;
+	}
+
+	// A crash in the middle of an append leaves a partial record at the end, which is dropped along with anything out of sequence after it
+	int numRecordsInFile = (int)((mappedFile.GetSize() - sizeof(MapJournalHeader)) / sizeof(MapJournalRecord));
+	MapJournalRecord const* records = reinterpret_cast<MapJournalRecord const*>(mappedFile.GetData() + sizeof(MapJournalHeader));
+	uint32_t previousSequence = 0;
+	for (int recordIndex = 0; recordIndex < numRecordsInFile; recordIndex++)
+	{
+		MapJournalRecord const& record = records[recordIndex];
+		if (record.m_sequence <= previousSequence || record.m_type >= (uint8_t)MapJournalRecordType::NUM)
+		{
+			break;
+		}
+
+		previousSequence = record.m_sequence;
+
+		// Records up to the map file's sequence were already compacted into it by a save that finished before the journal was trimmed
+		if (record.m_sequence > lastSequenceInMap)
+		{
+			out_records.push_back(record);
+		}
+	}
+
+	return true;
+}
+
+bool ReadMapJournal(std::string const& journalFilePath, uint32_t lastSequenceInMap, std::vector<MapJournalRecord>& out_records)
+{
+	size_t unusedFileSize = 0;
+	return ReadMapJournalFile(journalFilePath, lastSequenceInMap, out_records, unusedFileSize);
+}
+
+static void RemoveMovementForSlot(MapFileContents& contents, uint32_t slotIndex)
+{
+	std::vector<MapMovementRecord>& movements = contents.m_movements;
+	movements.erase(std::remove_if(movements.begin(), movements.end(), [slotIndex](MapMovementRecord const& movement) { return movement.m_entityIndex == slotIndex; }), movements.end());
+}
+
+static void PlaceEntity(MapFileContents& contents, MapEntityRecord const& entityRecord)
+{
+	if (entityRecord.m_uid == contents.m_playerStart.m_uid)
+	{
+		contents.m_playerStart = entityRecord;
+		return;
+	}
+
+	uint32_t slotIndex = EntityUID(entityRecord.m_uid).GetIndex();
+	if (slotIndex >= (uint32_t)contents.m_entities.size())
+	{
+		MapEntityRecord emptySlot;
+		emptySlot.m_uid = ENTITYUID_INVALID;
+		emptySlot.m_type = MAP_RECORD_EMPTY_SLOT;
+		contents.m_entities.resize(slotIndex + 1, emptySlot);
+	}
+
+	// A new entity in a reused slot must not inherit the movement of whatever was there before
+	if (contents.m_entities[slotIndex].m_uid != entityRecord.m_uid)
+	{
+		RemoveMovementForSlot(contents, slotIndex);
+	}
+
+	contents.m_entities[slotIndex] = entityRecord;
+}
+
+static void RemoveEntity(MapFileContents& contents, uint32_t uid)
+{
+	uint32_t slotIndex = EntityUID(uid).GetIndex();
+	if (slotIndex >= (uint32_t)contents.m_entities.size() || contents.m_entities[slotIndex].m_uid != uid)
+	{
+		return;
+	}
+
+	contents.m_entities[slotIndex].m_uid = ENTITYUID_INVALID;
+	contents.m_entities[slotIndex].m_type = MAP_RECORD_EMPTY_SLOT;
+	RemoveMovementForSlot(contents, slotIndex);
+
+	// Same clean up as SignalGraph::RemoveEdgesForEntity
+	std::vector<MapSignalEdgeRecord>& edges = contents.m_signalEdges;
+	edges.erase(std::remove_if(edges.begin(), edges.end(), [uid](MapSignalEdgeRecord const& edge) { return edge.m_activatorUID == uid || edge.m_activatableUID == uid; }), edges.end());
+	std::vector<MapSignalCombinatorRecord>& combinators = contents.m_signalCombinators;
+	combinators.erase(std::remove_if(combinators.begin(), combinators.end(), [uid](MapSignalCombinatorRecord const& combinator) { return combinator.m_activatableUID == uid; }), combinators.end());
+}
+
+static void SetSignalEdge(MapFileContents& contents, uint32_t activatorUID, uint32_t activatableUID, uint8_t type)
+{
+	for (int edgeIndex = 0; edgeIndex < (int)contents.m_signalEdges.size(); edgeIndex++)
+	{
+		MapSignalEdgeRecord& edge = contents.m_signalEdges[edgeIndex];
+		if (edge.m_activatorUID == activatorUID && edge.m_activatableUID == activatableUID)
+		{
+			edge.m_type = type;
+			return;
+		}
+	}
+
+	MapSignalEdgeRecord edge;
+	edge.m_activatorUID = activatorUID;
+	edge.m_activatableUID = activatableUID;
+	edge.m_type = type;
+	contents.m_signalEdges.push_back(edge);
+}
+
+static void RemoveSignalEdge(MapFileContents& contents, uint32_t activatorUID, uint32_t activatableUID)
+{
+	std::vector<MapSignalEdgeRecord>& edges = contents.m_signalEdges;
+	edges.erase(std::remove_if(edges.begin(), edges.end(), [activatorUID, activatableUID](MapSignalEdgeRecord const& edge) { return edge.m_activatorUID == activatorUID && edge.m_activatableUID == activatableUID; }), edges.end());
+}
+
+static void SetSignalCombinator(MapFileContents& contents, uint32_t activatableUID, uint8_t combinator)
+{
+	// OR is the default, which the graph stores by having no record at all
+	std::vector<MapSignalCombinatorRecord>& combinators = contents.m_signalCombinators;
+	combinators.erase(std::remove_if(combinators.begin(), combinators.end(), [activatableUID](MapSignalCombinatorRecord const& record) { return record.m_activatableUID == activatableUID; }), combinators.end());
+	if (combinator == 0)
+	{
+		return;
+	}
+
+	MapSignalCombinatorRecord record;
+	record.m_activatableUID = activatableUID;
+	record.m_combinator = combinator;
+	combinators.push_back(record);
+}
+
+static void SetMovementDirection(MapFileContents& contents, uint32_t uid, uint8_t movementDirection)
+{
+	uint32_t slotIndex = EntityUID(uid).GetIndex();
+	if (slotIndex >= (uint32_t)contents.m_entities.size() || contents.m_entities[slotIndex].m_uid != uid)
+	{
+		return;
+	}
+
+	RemoveMovementForSlot(contents, slotIndex);
+
+	MapMovementRecord movement;
+	movement.m_entityIndex = slotIndex;
+	movement.m_movementDirection = movementDirection;
+	contents.m_movements.push_back(movement);
+}
+
+MapJournalKey GetMapJournalKey(MapJournalRecord const& record)
+{
+	MapJournalKey key;
+	key.m_uid = record.m_entity.m_uid;
+	switch ((MapJournalRecordType)record.m_type)
+	{
+		case MapJournalRecordType::PLACE_ENTITY:
+		case MapJournalRecordType::REMOVE_ENTITY:			key.m_kind = MapJournalKeyKind::ENTITY; break;
+		case MapJournalRecordType::SET_SIGNAL_EDGE:
+		case MapJournalRecordType::REMOVE_SIGNAL_EDGE:		key.m_kind = MapJournalKeyKind::SIGNAL_EDGE; key.m_otherUID = record.m_otherUID; break;
+		case MapJournalRecordType::SET_SIGNAL_COMBINATOR:	key.m_kind = MapJournalKeyKind::SIGNAL_COMBINATOR; break;
+		case MapJournalRecordType::SET_MOVEMENT_DIRECTION:	key.m_kind = MapJournalKeyKind::MOVEMENT_DIRECTION; break;
+	}
+	return key;
+}
+
+void ApplyMapJournalRecords(std::vector<MapJournalRecord> const& records, MapFileContents& contents)
+{
+	for (int recordIndex = 0; recordIndex < (int)records.size(); recordIndex++)
+	{
+		MapJournalRecord const& record = records[recordIndex];
+		switch ((MapJournalRecordType)record.m_type)
+		{
+			case MapJournalRecordType::PLACE_ENTITY:			PlaceEntity(contents, record.m_entity); break;
+			case MapJournalRecordType::REMOVE_ENTITY:			RemoveEntity(contents, record.m_entity.m_uid); break;
+			case MapJournalRecordType::SET_SIGNAL_EDGE:			SetSignalEdge(contents, record.m_entity.m_uid, record.m_otherUID, record.m_value); break;
+			case MapJournalRecordType::REMOVE_SIGNAL_EDGE:		RemoveSignalEdge(contents, record.m_entity.m_uid, record.m_otherUID); break;
+			case MapJournalRecordType::SET_SIGNAL_COMBINATOR:	SetSignalCombinator(contents, record.m_entity.m_uid, record.m_value); break;
+			case MapJournalRecordType::SET_MOVEMENT_DIRECTION:	SetMovementDirection(contents, record.m_entity.m_uid, record.m_value); break;
+		}
+	}
+}
+
+
+MapJournal::~MapJournal()
+{
+	FinishRewrite();
+	CloseFile();
+}
+
+void MapJournal::Open(std::string const& mapFilePath, uint32_t lastSequenceInMap)
+{
+	Close();
+
+	m_mapFilePath = mapFilePath;
+	m_filePath = GetMapJournalFilePath(mapFilePath);
+	m_lastSequence = lastSequenceInMap;
+	m_isOpen = true;
+
+	size_t fileSize = 0;
+	bool isRead = ReadMapJournalFile(m_filePath, lastSequenceInMap, m_records, fileSize);
+	if (!m_records.empty())
+	{
+		m_lastSequence = m_records.back().m_sequence;
+	}
+
+	// Appending after a torn or already compacted tail would bury the new records behind it, so the file is trimmed to what is kept first
+	size_t keptFileSize = sizeof(MapJournalHeader) + m_records.size() * sizeof(MapJournalRecord);
+	if ((isRead && fileSize != keptFileSize) || (!isRead && fileSize > 0))
+	{
+		RewriteFile();
+	}
+}
+
+void MapJournal::Reset(std::string const& mapFilePath, uint32_t lastSequenceInMap)
+{
+	Close();
+
+	m_mapFilePath = mapFilePath;
+	m_filePath = GetMapJournalFilePath(mapFilePath);
+	m_lastSequence = lastSequenceInMap;
+	m_isOpen = true;
+
+	// A journal left behind by an older map of the same name would otherwise be replayed on top of this one
+	DeleteFileA(m_filePath.c_str());
+}
+
+void MapJournal::MoveTo(std::string const& mapFilePath, uint32_t lastSequenceInMap)
+{
+	// Records the new map file already holds go with the old journal, the ones made while it was written carry over in order
+	std::vector<MapJournalRecord> newerRecords;
+	for (int recordIndex = 0; recordIndex < (int)m_records.size(); recordIndex++)
+	{
+		if (m_records[recordIndex].m_sequence > lastSequenceInMap)
+		{
+			newerRecords.push_back(m_records[recordIndex]);
+		}
+	}
+
+	Delete();
+	Reset(mapFilePath, lastSequenceInMap);
+	for (int recordIndex = 0; recordIndex < (int)newerRecords.size(); recordIndex++)
+	{
+		Append(newerRecords[recordIndex]);
+	}
+}
+
+void MapJournal::Close()
+{
+	FinishRewrite();
+	CloseFile();
+	m_mapFilePath.clear();
+	m_filePath.clear();
+	m_records.clear();
+	m_lastSequence = 0;
+	m_numRecordsBeforeCompaction = MAP_JOURNAL_RECORDS_BEFORE_COMPACTION;
+	m_isOpen = false;
+}
+
+void MapJournal::Delete()
+{
+	FinishRewrite();
+	CloseFile();
+	if (!m_filePath.empty())
+	{
+		DeleteFileA(m_filePath.c_str());
+	}
+	Close();
+}
+
+void MapJournal::Update()
+{
+	if (!m_isRewriting || !m_isRewriteFinished)
+	{
+		return;
+	}
+
+	FinishRewrite();
+}
+
+bool MapJournal::IsOpen() const
+{
+	return m_isOpen;
+}
+
+bool MapJournal::Append(MapJournalRecord& record)
+{
+	if (!m_isOpen)
+	{
+		return false;
+	}
+
+	record.m_sequence = m_lastSequence + 1;
+	if (m_isRewriting)
+	{
+		// The file is being replaced, so the record waits until the new one is in place
+		m_recordsAwaitingRewrite.push_back(record);
+	}
+	else if (!WriteRecordToFile(record))
+	{
+		return false;
+	}
+
+	m_lastSequence = record.m_sequence;
+	m_records.push_back(record);
+	return true;
+}
+
+void MapJournal::DiscardRecordsUpTo(uint32_t sequence)
+{
+	if (!m_isOpen)
+	{
+		return;
+	}
+
+	m_records.erase(std::remove_if(m_records.begin(), m_records.end(), [sequence](MapJournalRecord const& record) { return record.m_sequence <= sequence; }), m_records.end());
+	m_numRecordsBeforeCompaction = MAP_JOURNAL_RECORDS_BEFORE_COMPACTION;
+	RewriteFile();
+}
+
+bool MapJournal::IsCompactionDue() const
+{
+	return m_isOpen && !m_isRewriting && (int)m_records.size() >= m_numRecordsBeforeCompaction;
+}
+
+void MapJournal::Compact()
+{
+	// Walking backwards, a record is dropped when a later one with the same key overwrites it and nothing in between touches the same entities
+	// Anything that does touch them pins the earlier records, since replaying them out of order against it could give a different result
+	std::vector<MapJournalKey> overwrittenKeys;
+	std::vector<MapJournalRecord> keptRecords;
+	for (int recordIndex = (int)m_records.size() - 1; recordIndex >= 0; recordIndex--)
+	{
+		MapJournalRecord const& record = m_records[recordIndex];
+		MapJournalKey key = GetMapJournalKey(record);
+		if (std::find(overwrittenKeys.begin(), overwrittenKeys.end(), key) != overwrittenKeys.end())
+		{
+			continue;
+		}
+
+		uint32_t otherUID = key.m_otherUID;
+		overwrittenKeys.erase(std::remove_if(overwrittenKeys.begin(), overwrittenKeys.end(), [&key, otherUID](MapJournalKey const& overwrittenKey)
+		{
+			return overwrittenKey.IsTouchingUID(key.m_uid) || (otherUID != ENTITYUID_INVALID && overwrittenKey.IsTouchingUID(otherUID));
+		}), overwrittenKeys.end());
+		overwrittenKeys.push_back(key);
+		keptRecords.push_back(record);
+	}
+
+	std::reverse(keptRecords.begin(), keptRecords.end());
+	m_records.swap(keptRecords);
+	RewriteFile();
+
+	// A journal that is mostly distinct edits would otherwise be rewritten on every append
+	m_numRecordsBeforeCompaction = (int)m_records.size() * 2 > MAP_JOURNAL_RECORDS_BEFORE_COMPACTION ? (int)m_records.size() * 2 : MAP_JOURNAL_RECORDS_BEFORE_COMPACTION;
+}
+
+uint32_t MapJournal::GetLastSequence() const
+{
+	return m_lastSequence;
+}
+
+int MapJournal::GetNumRecords() const
+{
+	return (int)m_records.size();
+}
+
+bool MapJournal::OpenFileForAppend()
+{
+	HANDLE fileHandle = CreateFileA(m_filePath.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	if (fileSize.QuadPart == 0)
+	{
+		MapJournalHeader header;
+		memcpy(header.m_4cc, MAP_JOURNAL_4CC_CODE, 4);
+		header.m_version = MAP_JOURNAL_VERSION;
+
+		DWORD numBytesWritten = 0;
+		if (!WriteFile(fileHandle, &header, (DWORD)sizeof(MapJournalHeader), &numBytesWritten, nullptr) || numBytesWritten != sizeof(MapJournalHeader))
+		{
+			CloseHandle(fileHandle);
+			DeleteFileA(m_filePath.c_str());
+			return false;
+		}
+	}
+
+	m_fileHandle = fileHandle;
+	return true;
+}
+
+bool MapJournal::WriteRecordToFile(MapJournalRecord const& record)
+{
+	if (!m_fileHandle && !OpenFileForAppend())
+	{
+		return false;
+	}
+
+	// Once WriteFile returns the record is in the system cache, so it survives the game crashing, compaction is what flushes it to disk
+	DWORD numBytesWritten = 0;
+	if (!WriteFile((HANDLE)m_fileHandle, &record, (DWORD)sizeof(MapJournalRecord), &numBytesWritten, nullptr) || numBytesWritten != sizeof(MapJournalRecord))
+	{
+		// Whatever part of the record did make it out is dropped as a torn tail the next time the journal is opened
+		CloseFile();
+		return false;
+	}
+
+	return true;
+}
+
+void MapJournal::CloseFile()
+{
+	if (m_fileHandle)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+}
+
+void MapJournal::RewriteFile()
+{
+	// A rewrite still in flight is superseded, the new buffer already holds every record it was holding back
+	if (m_rewriteThread.joinable())
+	{
+		m_rewriteThread.join();
+	}
+	m_isRewriting = false;
+	m_recordsAwaitingRewrite.clear();
+
+	// The append handle would keep the old file alive under the new one, it is reopened by the next append
+	CloseFile();
+
+	if (m_records.empty())
+	{
+		DeleteFileA(m_filePath.c_str());
+		return;
+	}
+
+	m_rewriteBuffer.resize(sizeof(MapJournalHeader) + m_records.size() * sizeof(MapJournalRecord));
+	MapJournalHeader header;
+	memcpy(header.m_4cc, MAP_JOURNAL_4CC_CODE, 4);
+	header.m_version = MAP_JOURNAL_VERSION;
+	memcpy(m_rewriteBuffer.data(), &header, sizeof(MapJournalHeader));
+	memcpy(m_rewriteBuffer.data() + sizeof(MapJournalHeader), m_records.data(), m_records.size() * sizeof(MapJournalRecord));
+
+	m_rewriteFilePath = m_filePath;
+	m_isRewriteFinished = false;
+	m_isRewriting = true;
+	m_rewriteThread = std::thread(&MapJournal::WriteRewriteBuffer, this);
+}
+
+void MapJournal::FinishRewrite()
+{
+	if (!m_isRewriting)
+	{
+		return;
+	}
+
+	m_rewriteThread.join();
+	m_isRewriting = false;
+	m_rewriteBuffer.clear();
+
+	// Records made during the write go after the ones it holds, in the order they happened
+	for (int recordIndex = 0; recordIndex < (int)m_recordsAwaitingRewrite.size(); recordIndex++)
+	{
+		if (!WriteRecordToFile(m_recordsAwaitingRewrite[recordIndex]))
+		{
+			break;
+		}
+	}
+	m_recordsAwaitingRewrite.clear();
+}
+
+void MapJournal::WriteRewriteBuffer()
+{
+	// Either the old journal or the trimmed one is on disk afterwards, the old one replays the same way since the map file skips what it already has
+	WriteFileAtomically(m_rewriteFilePath, m_rewriteBuffer);
+	m_isRewriteFinished = true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Game/EntityUID.hpp"
+#include "Game/MapFile.hpp"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Sidecar .almap.journal layout: a fixed header, then one fixed-size record per editor action in the order they happened
+// Records hold the state an action left behind rather than the change it made, so replaying a record twice is harmless
+enum class MapJournalRecordType : uint8_t
+{
+	PLACE_ENTITY,
+	REMOVE_ENTITY,
+	SET_SIGNAL_EDGE,
+	REMOVE_SIGNAL_EDGE,
+	SET_SIGNAL_COMBINATOR,
+	SET_MOVEMENT_DIRECTION,
+	NUM
+};
+
+struct MapJournalHeader
+{
+public:
+	char m_4cc[4] = {};
+	uint8_t m_version = 0;
+	uint8_t m_reserved[3] = {};
+};
+
+// Signal records keep the activator or activatable in m_entity.m_uid and the activatable of an edge in m_otherUID
+// m_value is the edge type, combinator or movement direction for the records that set one
+struct MapJournalRecord
+{
+public:
+	uint32_t m_sequence = 0;
+	uint8_t m_type = 0;
+	uint8_t m_value = 0;
+	uint8_t m_reserved[2] = {};
+	MapEntityRecord m_entity;
+	uint32_t m_otherUID = 0;
+};
+
+static_assert(sizeof(MapJournalHeader) == 8, "MapJournalHeader is part of the file format");
+static_assert(sizeof(MapJournalRecord) == 48, "MapJournalRecord is part of the file format");
+
+constexpr char const* MAP_JOURNAL_4CC_CODE = "GHAJ";
+constexpr uint8_t MAP_JOURNAL_VERSION = 1;
+constexpr int MAP_JOURNAL_RECORDS_BEFORE_COMPACTION = 256;
+
+// Records with the same key overwrite each other on replay, which is what lets compaction drop all but the last of them
+enum class MapJournalKeyKind : uint8_t
+{
+	ENTITY,
+	SIGNAL_EDGE,
+	SIGNAL_COMBINATOR,
+	MOVEMENT_DIRECTION
+};
+
+struct MapJournalKey
+{
+public:
+	bool operator==(MapJournalKey const& other) const { return m_kind == other.m_kind && m_uid == other.m_uid && m_otherUID == other.m_otherUID; }
+	bool IsTouchingUID(uint32_t uid) const { return m_uid == uid || m_otherUID == uid; }
+
+public:
+	MapJournalKeyKind m_kind = MapJournalKeyKind::ENTITY;
+	uint32_t m_uid = 0;
+	uint32_t m_otherUID = ENTITYUID_INVALID;
+};
+
+std::string GetMapJournalFilePath(std::string const& mapFilePath);
+MapJournalKey GetMapJournalKey(MapJournalRecord const& record);
+bool ReadMapJournal(std::string const& journalFilePath, uint32_t lastSequenceInMap, std::vector<MapJournalRecord>& out_records);
+void ApplyMapJournalRecords(std::vector<MapJournalRecord> const& records, MapFileContents& contents);
+
+
+// Appends editor actions to the journal next to a map file as they happen, so unsaved edits survive a crash until the map is saved or left
+// Records the map file does not contain yet are also kept in memory, so compaction can rewrite the journal without reading it back
+// Rewrites are written on a worker thread, records appended meanwhile are held back and added to the new file once it is in place
+class MapJournal
+{
+public:
+	~MapJournal();
+	MapJournal() = default;
+	MapJournal(MapJournal const& copy) = delete;
+	MapJournal& operator=(MapJournal const& copy) = delete;
+
+	void Open(std::string const& mapFilePath, uint32_t lastSequenceInMap);
+	void Reset(std::string const& mapFilePath, uint32_t lastSequenceInMap);
+	void MoveTo(std::string const& mapFilePath, uint32_t lastSequenceInMap);
+	void Close();
+	void Delete();
+	void Update();
+
+	bool IsOpen() const;
+	bool Append(MapJournalRecord& record);
+	void DiscardRecordsUpTo(uint32_t sequence);
+	bool IsCompactionDue() const;
+	void Compact();
+	uint32_t GetLastSequence() const;
+	int GetNumRecords() const;
+
+public:
+	std::string m_mapFilePath;
+	std::string m_filePath;
+
+private:
+	bool OpenFileForAppend();
+	bool WriteRecordToFile(MapJournalRecord const& record);
+	void CloseFile();
+	void RewriteFile();
+	void FinishRewrite();
+	void WriteRewriteBuffer();
+
+private:
+	void* m_fileHandle = nullptr;
+	std::vector<MapJournalRecord> m_records;
+	uint32_t m_lastSequence = 0;
+	int m_numRecordsBeforeCompaction = MAP_JOURNAL_RECORDS_BEFORE_COMPACTION;
+	bool m_isOpen = false;
+
+	// The buffer and path are only touched by the worker until m_isRewriteFinished is set
+	std::vector<uint8_t> m_rewriteBuffer;
+	std::string m_rewriteFilePath;
+	std::thread m_rewriteThread;
+	std::atomic<bool> m_isRewriteFinished = false;
+	bool m_isRewriting = false;
+	std::vector<MapJournalRecord> m_recordsAwaitingRewrite;
+};
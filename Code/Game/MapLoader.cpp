@@ -0,0 +1,192 @@
+#include "Game/MapLoader.hpp"
+
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/PlayerStart.hpp"
+#include "Game/RegionStreamer.hpp"
+
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+MapLoader::~MapLoader()
+{
+	if (m_readThread.joinable())
+	{
+		m_readThread.join();
+	}
+
+	delete m_map;
+}
+
+MapLoader::MapLoader(Game* game, std::string const& mapFileName, MapMode mode)
+	: m_mapFileName(mapFileName)
+	, m_mode(mode)
+	, m_game(game)
+{
+	m_loadStartTimeSeconds = GetCurrentTimeSeconds();
+
+	// The empty map only creates its shader constants and console commands, which need the main thread
+	m_map = new Map(game, mode);
+	m_readThread = std::thread(&MapLoader::ReadMapFile, this);
+}
+
+void MapLoader::Update()
+{
+	double endTimeSeconds = GetCurrentTimeSeconds() + FRAME_BUDGET_SECONDS;
+
+	// Phases run back to back within one frame for as long as its budget lasts
+	if (m_phase == MapLoadPhase::READING)
+	{
+		// Entities are built from the preloaded models and sounds, so nothing is constructed until every one of them is ready
+		if (!m_isReadComplete || !m_game->m_assetPreloader.IsFinished())
+		{
+			return;
+		}
+
+		BeginConstruction();
+	}
+	if (m_phase == MapLoadPhase::CONSTRUCTING)
+	{
+		ConstructEntities(endTimeSeconds);
+	}
+	if (m_phase == MapLoadPhase::STREAMING)
+	{
+		StreamStartRegions();
+	}
+	if (m_phase == MapLoadPhase::BAKING)
+	{
+		BakeTileChunks(endTimeSeconds);
+	}
+}
+
+bool MapLoader::IsFinished() const
+{
+	return m_phase == MapLoadPhase::FINISHED;
+}
+
+bool MapLoader::IsFailed() const
+{
+	return m_phase == MapLoadPhase::FAILED;
+}
+
+float MapLoader::GetProgress() const
+{
+	switch (m_phase)
+	{
+		case MapLoadPhase::READING:
+		{
+			return 0.f;
+		}
+		case MapLoadPhase::CONSTRUCTING:
+		{
+			float constructedFraction = m_contents.m_entities.empty() ? 1.f : (float)m_numRecordsConstructed / (float)m_contents.m_entities.size();
+			return READ_PROGRESS_WEIGHT + CONSTRUCT_PROGRESS_WEIGHT * constructedFraction;
+		}
+		case MapLoadPhase::STREAMING:
+		{
+			return READ_PROGRESS_WEIGHT + CONSTRUCT_PROGRESS_WEIGHT * m_streamedFraction;
+		}
+		case MapLoadPhase::BAKING:
+		{
+			float bakedFraction = m_numChunksToBake == 0 ? 0.f : 1.f - (float)m_numChunksLeftToBake / (float)m_numChunksToBake;
+			return READ_PROGRESS_WEIGHT + CONSTRUCT_PROGRESS_WEIGHT + BAKE_PROGRESS_WEIGHT * bakedFraction;
+		}
+	}
+
+	return 1.f;
+}
+
+Map* MapLoader::TakeMap()
+{
+	GUARANTEE_OR_DIE(m_phase == MapLoadPhase::FINISHED, "Tried to take a map that has not finished loading!");
+
+	Map* map = m_map;
+	m_map = nullptr;
+	return map;
+}
+
+void MapLoader::ReadMapFile()
+{
+	m_isReadSuccessful = Map::ReadMapFile(m_mapFileName, m_mode, m_contents, m_isStreamed, m_error);
+	m_isReadComplete = true;
+}
+
+void MapLoader::BeginConstruction()
+{
+	m_readThread.join();
+	if (!m_isReadSuccessful)
+	{
+		m_phase = MapLoadPhase::FAILED;
+		return;
+	}
+	m_map->m_lastLoadReadSeconds = GetCurrentTimeSeconds() - m_loadStartTimeSeconds;
+
+	m_map->LoadPlayerStart(m_contents.m_playerStart);
+	if (m_isStreamed)
+	{
+		m_map->m_regionStreamer = new RegionStreamer(m_map, m_mapFileName);
+		m_phase = MapLoadPhase::STREAMING;
+	}
+	else
+	{
+		m_map->m_entities.assign(m_contents.m_entities.size(), nullptr);
+		m_phase = MapLoadPhase::CONSTRUCTING;
+	}
+
+	// Both indexes are built while every slot is still empty, so each constructed entity is added on its own instead of in one rebuild on the first frame of play
+	m_map->m_tileChunks.BakeDirtyChunks(0.0);
+	m_map->m_cullingGrid.Update();
+}
+
+void MapLoader::ConstructEntities(double endTimeSeconds)
+{
+	std::vector<MapEntityRecord> const& entityRecords = m_contents.m_entities;
+	while (m_numRecordsConstructed < (int)entityRecords.size() && GetCurrentTimeSeconds() < endTimeSeconds)
+	{
+		m_map->ConstructEntityFromRecord(m_numRecordsConstructed, entityRecords[m_numRecordsConstructed]);
+		m_numRecordsConstructed++;
+	}
+
+	if (m_numRecordsConstructed < (int)entityRecords.size())
+	{
+		return;
+	}
+
+	m_map->LoadSideTables(m_contents);
+	m_map->OpenJournal(m_mapFileName, m_contents.m_lastJournalSequence);
+	m_map->OnEntitiesLoaded();
+	m_contents = MapFileContents();
+	m_phase = MapLoadPhase::BAKING;
+}
+
+void MapLoader::StreamStartRegions()
+{
+	// The streamer already limits how much it constructs per frame, it only has to settle around the player start
+	Vec3 const& startPosition = m_map->m_playerStart->m_position;
+	m_map->m_regionStreamer->Update(startPosition);
+	m_streamedFraction = m_map->m_regionStreamer->GetResidentFractionAround(startPosition);
+	if (m_streamedFraction < 1.f)
+	{
+		return;
+	}
+
+	m_map->OnEntitiesLoaded();
+	m_phase = MapLoadPhase::BAKING;
+}
+
+void MapLoader::BakeTileChunks(double endTimeSeconds)
+{
+	m_numChunksLeftToBake = m_map->m_tileChunks.BakeDirtyChunks(endTimeSeconds);
+	if (m_numChunksLeftToBake > m_numChunksToBake)
+	{
+		m_numChunksToBake = m_numChunksLeftToBake;
+	}
+	if (m_numChunksLeftToBake > 0)
+	{
+		return;
+	}
+
+	m_map->m_lastLoadTotalSeconds = GetCurrentTimeSeconds() - m_loadStartTimeSeconds;
+	m_phase = MapLoadPhase::FINISHED;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+#include "Game/MapFile.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+
+class Game;
+class Map;
+
+
+enum class MapLoadPhase
+{
+	READING,
+	CONSTRUCTING,
+	STREAMING,
+	BAKING,
+	FINISHED,
+	FAILED
+};
+
+
+// Builds a map over several frames so the headset keeps its frame rate while a level loads
+// The file is read and decoded on a worker thread, entities create models and UI widgets so they are constructed on the main thread in time-boxed slices
+// Construction waits for the asset preloader, which keeps finishing its assets a slice per frame while the file is read
+class MapLoader
+{
+public:
+	~MapLoader();
+	MapLoader(Game* game, std::string const& mapFileName, MapMode mode);
+	MapLoader(MapLoader const& copy) = delete;
+	MapLoader& operator=(MapLoader const& copy) = delete;
+
+	void Update();
+	bool IsFinished() const;
+	bool IsFailed() const;
+	float GetProgress() const;
+	Map* TakeMap();
+
+public:
+	static constexpr double FRAME_BUDGET_SECONDS = 0.004;
+	static constexpr float READ_PROGRESS_WEIGHT = 0.1f;
+	static constexpr float CONSTRUCT_PROGRESS_WEIGHT = 0.7f;
+	static constexpr float BAKE_PROGRESS_WEIGHT = 0.2f;
+
+	std::string m_mapFileName;
+	MapMode m_mode = MapMode::NONE;
+	MapLoadPhase m_phase = MapLoadPhase::READING;
+	std::string m_error; // Set by the worker when the file cannot be read, only looked at once the load has FAILED
+
+private:
+	void ReadMapFile();
+	void BeginConstruction();
+	void ConstructEntities(double endTimeSeconds);
+	void StreamStartRegions();
+	void BakeTileChunks(double endTimeSeconds);
+
+private:
+	Game* m_game = nullptr;
+	Map* m_map = nullptr;
+	double m_loadStartTimeSeconds = 0.0;
+
+	// Written by the worker before m_isReadComplete is set, the main thread only reads them afterwards
+	MapFileContents m_contents;
+	bool m_isStreamed = false;
+	bool m_isReadSuccessful = false;
+	std::thread m_readThread;
+	std::atomic<bool> m_isReadComplete = false;
+
+	int m_numRecordsConstructed = 0;
+	float m_streamedFraction = 0.f;
+	int m_numChunksToBake = 0;
+	int m_numChunksLeftToBake = 0;
+};
@@ -0,0 +1,48 @@
+#include "Game/MapSaver.hpp"
+
+#include "Game/AtomicFileWriter.hpp"
+
+#include "Engine/Core/Time.hpp"
+
+#include <utility>
+
+
+MapSaver::~MapSaver()
+{
+	// A save that is still writing is finished rather than abandoned, the file on disk is never left half written either way
+	if (m_writeThread.joinable())
+	{
+		m_writeThread.join();
+	}
+}
+
+MapSaver::MapSaver(MapFileContents&& contents, std::string const& filePath)
+	: m_filePath(filePath)
+	, m_contents(std::move(contents))
+{
+	m_writeThread = std::thread(&MapSaver::WriteMapFile, this);
+}
+
+bool MapSaver::IsFinished() const
+{
+	return m_isFinished;
+}
+
+bool MapSaver::HasSucceeded() const
+{
+	return m_isFinished && m_hasSucceeded;
+}
+
+void MapSaver::WriteMapFile()
+{
+	double writeStartTimeSeconds = GetCurrentTimeSeconds();
+
+	std::vector<uint8_t> buffer;
+	m_contents.WriteToBuffer(buffer);
+	m_contents = MapFileContents();
+
+	m_hasSucceeded = WriteFileAtomically(m_filePath, buffer);
+	m_numBytesWritten = buffer.size();
+	m_writeSeconds = GetCurrentTimeSeconds() - writeStartTimeSeconds;
+	m_isFinished = true;
+}
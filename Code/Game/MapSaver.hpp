@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Game/MapFile.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+
+// Encodes and writes a snapshot of a map on a worker thread, the main thread only copies out the records
+class MapSaver
+{
+public:
+	~MapSaver();
+	MapSaver(MapFileContents&& contents, std::string const& filePath);
+	MapSaver(MapSaver const& copy) = delete;
+	MapSaver& operator=(MapSaver const& copy) = delete;
+
+	bool IsFinished() const;
+	bool HasSucceeded() const;
+
+public:
+	std::string m_filePath;
+	double m_snapshotSeconds = 0.0;
+	uint32_t m_lastJournalSequence = 0;
+
+	// Written by the worker before m_isFinished is set, the main thread only reads them afterwards
+	size_t m_numBytesWritten = 0;
+	double m_writeSeconds = 0.0;
+
+private:
+	void WriteMapFile();
+
+private:
+	MapFileContents m_contents;
+	std::thread m_writeThread;
+	std::atomic<bool> m_isFinished = false;
+	bool m_hasSucceeded = false;
+};
@@ -0,0 +1,82 @@
+#include "Game/MappedFile.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(std::string const& filePath)
+{
+	Close();
+
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	m_size = (size_t)fileSize.QuadPart;
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		Close();
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+
+	m_data = (uint8_t const*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!m_data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+		m_fileHandle = nullptr;
+	}
+	m_size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return m_data != nullptr;
+}
+
+uint8_t const* MappedFile::GetData() const
+{
+	return m_data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return m_size;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+
+// Read-only view of a whole file mapped into the address space, pages are only read from disk when they are touched
+class MappedFile
+{
+public:
+	~MappedFile();
+	MappedFile() = default;
+	MappedFile(MappedFile const& copy) = delete;
+	MappedFile& operator=(MappedFile const& copy) = delete;
+
+	bool Open(std::string const& filePath);
+	void Close();
+
+	bool IsOpen() const;
+	uint8_t const* GetData() const;
+	size_t GetSize() const;
+
+private:
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+	uint8_t const* m_data = nullptr;
+	size_t m_size = 0;
+};
@@ -0,0 +1,188 @@
+#include "Game/MeshCache.hpp"
+
+#include "Game/AtomicFileWriter.hpp"
+#include "Game/MappedFile.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+static constexpr uint64_t FNV_OFFSET_BASIS_64 = 0xCBF29CE484222325ull;
+static constexpr uint64_t FNV_PRIME_64 = 0x100000001B3ull;
+
+
+static uint64_t HashBytes(uint64_t hash, void const* data, size_t size)
+{
+	uint8_t const* bytes = reinterpret_cast<uint8_t const*>(data);
+	for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+	{
+		hash ^= bytes[byteIndex];
+		hash *= FNV_PRIME_64;
+	}
+	return hash;
+}
+
+static bool HashFile(uint64_t& hash, std::string const& filePath)
+{
+	MappedFile mappedFile;
+	if (!mappedFile.Open(filePath))
+	{
+		return false;
+	}
+
+	hash = HashBytes(hash, mappedFile.GetData(), mappedFile.GetSize());
+	return true;
+}
+
+uint64_t ComputeMeshSourceHash(std::string const& objFilePath, Mat44 const& transform)
+{
+	MappedFile objFile;
+	if (!objFile.Open(objFilePath))
+	{
+		return 0;
+	}
+
+	uint64_t hash = FNV_OFFSET_BASIS_64;
+	uint8_t version = MESH_CACHE_VERSION;
+	hash = HashBytes(hash, &version, sizeof(version));
+	hash = HashBytes(hash, &transform, sizeof(Mat44));
+	hash = HashBytes(hash, objFile.GetData(), objFile.GetSize());
+
+	std::string objDirectory = "";
+	size_t lastSlashIndex = objFilePath.find_last_of("/\\");
+	if (lastSlashIndex != std::string::npos)
+	{
+		objDirectory = objFilePath.substr(0, lastSlashIndex + 1);
+	}
+
+	// Material libraries are found the same way the parser finds them, a missing one is skipped there too
+	char const* objText = reinterpret_cast<char const*>(objFile.GetData());
+	size_t objSize = objFile.GetSize();
+	for (size_t lineStart = 0; lineStart < objSize;)
+	{
+		size_t lineEnd = lineStart;
+		while (lineEnd < objSize && objText[lineEnd] != '\n')
+		{
+			lineEnd++;
+		}
+
+		std::vector<std::string> tokens;
+		int numTokens = InstancedModel::SplitObjLine(tokens, std::string(objText + lineStart, lineEnd - lineStart));
+		if (numTokens >= 2 && tokens[0] == "mtllib")
+		{
+			hash = HashBytes(hash, tokens[1].data(), tokens[1].size());
+			HashFile(hash, objDirectory + tokens[1]);
+		}
+
+		lineStart = lineEnd + 1;
+	}
+
+	// Zero means the source could not be read, so it is never used as a key
+	return hash != 0 ? hash : 1;
+}
+
+std::string GetMeshCacheFilePath(uint64_t contentHash)
+{
+	return Stringf("%s/%016llx.almesh", MESH_CACHE_DIRECTORY, (unsigned long long)contentHash);
+}
+
+bool ReadMeshCache(std::string const& cacheFilePath, uint64_t contentHash, std::vector<InstancedSubMesh>& out_subMeshes)
+{
+	MappedFile mappedFile;
+	if (!mappedFile.Open(cacheFilePath) || mappedFile.GetSize() < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+
+	uint8_t const* data = mappedFile.GetData();
+	size_t size = mappedFile.GetSize();
+	MeshCacheHeader const* header = reinterpret_cast<MeshCacheHeader const*>(data);
+	size_t subMeshesEnd = sizeof(MeshCacheHeader) + (size_t)header->m_numSubMeshes * sizeof(MeshCacheSubMeshRecord);
+	if (memcmp(header->m_4cc, MESH_CACHE_4CC_CODE, 4) != 0 || header->m_version != MESH_CACHE_VERSION || header->m_contentHash != contentHash || header->m_vertexStride != sizeof(Vertex_PCUTBN)
+		|| subMeshesEnd > size || header->m_namesOffset < subMeshesEnd || header->m_vertexesOffset < header->m_namesOffset || header->m_vertexesOffset > size)
+	{
+		return false;
+	}
+
+	// Every record is checked before anything is copied, a damaged cache file is simply cooked again
+	MeshCacheSubMeshRecord const* records = reinterpret_cast<MeshCacheSubMeshRecord const*>(data + sizeof(MeshCacheHeader));
+	size_t namesSize = header->m_vertexesOffset - header->m_namesOffset;
+	size_t numVertexes = (size - header->m_vertexesOffset) / sizeof(Vertex_PCUTBN);
+	for (int subMeshIndex = 0; subMeshIndex < (int)header->m_numSubMeshes; subMeshIndex++)
+	{
+		MeshCacheSubMeshRecord const& record = records[subMeshIndex];
+		if ((size_t)record.m_nameOffset + (size_t)record.m_nameLength > namesSize || (size_t)record.m_firstVertex + (size_t)record.m_numVertexes > numVertexes)
+		{
+			return false;
+		}
+	}
+
+	char const* names = reinterpret_cast<char const*>(data + header->m_namesOffset);
+	Vertex_PCUTBN const* vertexes = reinterpret_cast<Vertex_PCUTBN const*>(data + header->m_vertexesOffset);
+	out_subMeshes.resize(header->m_numSubMeshes);
+	for (int subMeshIndex = 0; subMeshIndex < (int)header->m_numSubMeshes; subMeshIndex++)
+	{
+		MeshCacheSubMeshRecord const& record = records[subMeshIndex];
+		InstancedSubMesh& subMesh = out_subMeshes[subMeshIndex];
+		subMesh.m_name = std::string(names + record.m_nameOffset, record.m_nameLength);
+		subMesh.m_vertexes.assign(vertexes + record.m_firstVertex, vertexes + record.m_firstVertex + record.m_numVertexes);
+	}
+
+	return true;
+}
+
+bool WriteMeshCache(std::string const& cacheFilePath, uint64_t contentHash, std::vector<InstancedSubMesh> const& subMeshes)
+{
+	std::vector<MeshCacheSubMeshRecord> records(subMeshes.size());
+	std::string names;
+	size_t numVertexes = 0;
+	for (int subMeshIndex = 0; subMeshIndex < (int)subMeshes.size(); subMeshIndex++)
+	{
+		InstancedSubMesh const& subMesh = subMeshes[subMeshIndex];
+		MeshCacheSubMeshRecord& record = records[subMeshIndex];
+		record.m_nameOffset = (uint32_t)names.size();
+		record.m_nameLength = (uint32_t)subMesh.m_name.size();
+		record.m_firstVertex = (uint32_t)numVertexes;
+		record.m_numVertexes = (uint32_t)subMesh.m_vertexes.size();
+		names += subMesh.m_name;
+		numVertexes += subMesh.m_vertexes.size();
+	}
+
+	// Vertexes start 4-byte aligned so they can be copied straight out of the mapped file
+	MeshCacheHeader header;
+	memcpy(header.m_4cc, MESH_CACHE_4CC_CODE, 4);
+	header.m_version = MESH_CACHE_VERSION;
+	header.m_numSubMeshes = (uint32_t)subMeshes.size();
+	header.m_vertexStride = (uint32_t)sizeof(Vertex_PCUTBN);
+	header.m_contentHash = contentHash;
+	header.m_namesOffset = (uint32_t)(sizeof(MeshCacheHeader) + records.size() * sizeof(MeshCacheSubMeshRecord));
+	header.m_vertexesOffset = (uint32_t)((header.m_namesOffset + names.size() + 3) & ~(size_t)3);
+
+	std::vector<uint8_t> buffer(header.m_vertexesOffset + numVertexes * sizeof(Vertex_PCUTBN));
+	memcpy(buffer.data(), &header, sizeof(MeshCacheHeader));
+	if (!records.empty())
+	{
+		memcpy(buffer.data() + sizeof(MeshCacheHeader), records.data(), records.size() * sizeof(MeshCacheSubMeshRecord));
+	}
+	if (!names.empty())
+	{
+		memcpy(buffer.data() + header.m_namesOffset, names.data(), names.size());
+	}
+	for (int subMeshIndex = 0; subMeshIndex < (int)subMeshes.size(); subMeshIndex++)
+	{
+		std::vector<Vertex_PCUTBN> const& vertexes = subMeshes[subMeshIndex].m_vertexes;
+		if (!vertexes.empty())
+		{
+			memcpy(buffer.data() + header.m_vertexesOffset + (size_t)records[subMeshIndex].m_firstVertex * sizeof(Vertex_PCUTBN), vertexes.data(), vertexes.size() * sizeof(Vertex_PCUTBN));
+		}
+	}
+
+	// Both levels are created on first use, one that already exists is not an error
+	CreateDirectoryA("Cache", nullptr);
+	CreateDirectoryA(MESH_CACHE_DIRECTORY, nullptr);
+	return WriteFileAtomically(cacheFilePath, buffer);
+}
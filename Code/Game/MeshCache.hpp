@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Game/InstancedModel.hpp"
+
+#include "Engine/Math/Mat44.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+// Cache/Meshes/<hash>.almesh layout: a fixed header, one record per named sub-mesh, the sub-mesh names packed back to back, then every vertex
+// The file is named after a hash of the OBJ, its material libraries and the basis transform, so editing any of them simply misses the cache
+struct MeshCacheHeader
+{
+public:
+	char m_4cc[4] = {};
+	uint8_t m_version = 0;
+	uint8_t m_reserved[3] = {};
+	uint32_t m_numSubMeshes = 0;
+	uint32_t m_vertexStride = 0;
+	uint32_t m_namesOffset = 0;
+	uint32_t m_vertexesOffset = 0;
+	uint64_t m_contentHash = 0;
+};
+
+struct MeshCacheSubMeshRecord
+{
+public:
+	uint32_t m_nameOffset = 0;
+	uint32_t m_nameLength = 0;
+	uint32_t m_firstVertex = 0;
+	uint32_t m_numVertexes = 0;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 32, "MeshCacheHeader is part of the file format");
+static_assert(sizeof(MeshCacheSubMeshRecord) == 16, "MeshCacheSubMeshRecord is part of the file format");
+
+constexpr char const* MESH_CACHE_4CC_CODE = "GHAM";
+constexpr uint8_t MESH_CACHE_VERSION = 2;
+constexpr char const* MESH_CACHE_DIRECTORY = "Cache/Meshes";
+
+uint64_t ComputeMeshSourceHash(std::string const& objFilePath, Mat44 const& transform);
+std::string GetMeshCacheFilePath(uint64_t contentHash);
+bool ReadMeshCache(std::string const& cacheFilePath, uint64_t contentHash, std::vector<InstancedSubMesh>& out_subMeshes);
+bool WriteMeshCache(std::string const& cacheFilePath, uint64_t contentHash, std::vector<InstancedSubMesh> const& subMeshes);
@@ -0,0 +1,104 @@
+#include "Game/ModelInstanceRenderer.hpp"
+
+#include "Game/InstancedModel.hpp"
+#include "Game/RenderQueue.hpp"
+
+#include "Engine/Renderer/ConstantBuffer.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+#include <algorithm>
+
+
+ModelInstanceRenderer::~ModelInstanceRenderer()
+{
+	delete m_instanceCBO;
+}
+
+ModelInstanceRenderer::ModelInstanceRenderer()
+{
+	m_instancedShader = g_renderer->CreateOrGetShader("Data/Shaders/DiffuseInstanced", VertexType::VERTEX_PCUTBN);
+	m_instanceCBO = g_renderer->CreateConstantBuffer(sizeof(ModelInstanceConstants) * InstancedModel::MAX_INSTANCES_PER_DRAW);
+}
+
+void ModelInstanceRenderer::BeginFrame()
+{
+	for (auto groupIter = m_instancesBySubMesh.begin(); groupIter != m_instancesBySubMesh.end(); ++groupIter)
+	{
+		groupIter->second.clear();
+	}
+}
+
+bool ModelInstanceRenderer::AddInstance(InstancedModel const* model, std::string const& subMeshName, Mat44 const& transform, Rgba8 const& color)
+{
+	if (!model)
+	{
+		return false;
+	}
+
+	InstancedSubMesh const* subMesh = model->GetSubMesh(subMeshName);
+	if (!subMesh || !subMesh->m_vertexBuffer)
+	{
+		return false;
+	}
+
+	AddInstance(subMesh, transform, color);
+	return true;
+}
+
+void ModelInstanceRenderer::AddInstance(InstancedSubMesh const* subMesh, Mat44 const& transform, Rgba8 const& color)
+{
+	ModelInstanceConstants instance;
+	instance.m_modelMatrix = transform;
+	color.GetAsFloats(instance.m_color);
+	m_instancesBySubMesh[subMesh].push_back(instance);
+}
+
+void ModelInstanceRenderer::Render(RenderQueue& queue) const
+{
+	// The instanced shader reads its transforms from the instance buffer, so model constants are left alone
+	RenderCommand command;
+	command.m_state.m_shader = m_instancedShader;
+	command.m_state.m_lighting = RenderLighting::SUN;
+	command.m_usesModelConstants = false;
+	command.m_constantBuffer = m_instanceCBO;
+	command.m_constantBufferSlot = g_instanceConstantsSlot;
+
+	for (auto groupIter = m_instancesBySubMesh.begin(); groupIter != m_instancesBySubMesh.end(); ++groupIter)
+	{
+		InstancedSubMesh const* subMesh = groupIter->first;
+		std::vector<ModelInstanceConstants> const& instances = groupIter->second;
+		int numVertexesPerInstance = (int)subMesh->m_vertexes.size();
+
+		for (int firstInstanceIndex = 0; firstInstanceIndex < (int)instances.size(); firstInstanceIndex += subMesh->m_maxInstancesPerDraw)
+		{
+			int numInstancesInDraw = std::min(subMesh->m_maxInstancesPerDraw, (int)instances.size() - firstInstanceIndex);
+			command.m_sortPosition = instances[firstInstanceIndex].m_modelMatrix.GetTranslation3D();
+			command.m_vertexBuffer = subMesh->m_vertexBuffer;
+			command.m_count = numVertexesPerInstance * numInstancesInDraw;
+			command.m_constantData = &instances[firstInstanceIndex];
+			command.m_constantDataSize = sizeof(ModelInstanceConstants) * numInstancesInDraw;
+			queue.Submit(command);
+		}
+	}
+}
+
+int ModelInstanceRenderer::GetNumInstances() const
+{
+	int numInstances = 0;
+	for (auto groupIter = m_instancesBySubMesh.begin(); groupIter != m_instancesBySubMesh.end(); ++groupIter)
+	{
+		numInstances += (int)groupIter->second.size();
+	}
+	return numInstances;
+}
+
+int ModelInstanceRenderer::GetNumDrawCalls() const
+{
+	int numDrawCalls = 0;
+	for (auto groupIter = m_instancesBySubMesh.begin(); groupIter != m_instancesBySubMesh.end(); ++groupIter)
+	{
+		int maxInstancesPerDraw = groupIter->first->m_maxInstancesPerDraw;
+		numDrawCalls += ((int)groupIter->second.size() + maxInstancesPerDraw - 1) / maxInstancesPerDraw;
+	}
+	return numDrawCalls;
+}
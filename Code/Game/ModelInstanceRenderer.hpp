@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/Mat44.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+class ConstantBuffer;
+class InstancedModel;
+class RenderQueue;
+class Shader;
+struct InstancedSubMesh;
+
+
+// Mirrors InstanceData in DiffuseInstanced.hlsl
+struct ModelInstanceConstants
+{
+public:
+	Mat44 m_modelMatrix;
+	float m_color[4] = {};
+};
+
+
+class ModelInstanceRenderer
+{
+public:
+	~ModelInstanceRenderer();
+	ModelInstanceRenderer();
+
+	void BeginFrame();
+	bool AddInstance(InstancedModel const* model, std::string const& subMeshName, Mat44 const& transform, Rgba8 const& color);
+	void AddInstance(InstancedSubMesh const* subMesh, Mat44 const& transform, Rgba8 const& color);
+	void Render(RenderQueue& queue) const;
+
+	int GetNumInstances() const;
+	int GetNumDrawCalls() const;
+
+public:
+	Shader* m_instancedShader = nullptr;
+	ConstantBuffer* m_instanceCBO = nullptr;
+
+private:
+	// Groups persist between frames so their instance arrays keep their capacity
+	std::map<InstancedSubMesh const*, std::vector<ModelInstanceConstants>> m_instancesBySubMesh;
+};
@@ -2,13 +2,14 @@
 
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
+#include "Game/MapFile.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
 
 #include "Game/GameMathUtils.hpp"
 
-#include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 #include "Engine/Renderer/Renderer.hpp"
@@ -17,7 +18,7 @@
 MovingPlatform::MovingPlatform(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale)
 	: Activatable(map, uid, position, orientation, scale, EntityType::MOVING_PLATFORM)
 {
-	m_model = g_modelLoader->CreateOrGetModelFromObj("Data/Models/Activatables/blockMoving", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
+	m_model = InstancedModel::CreateOrGetFromObj("Data/Models/Activatables/blockMoving.obj", Mat44(Vec3::NORTH, Vec3::SKYWARD, Vec3::EAST, Vec3::ZERO));
 	m_scale = MODEL_SCALE;
 	m_localBounds = AABB3(Vec3(-0.425f, -0.425f, 0.f), Vec3(0.425f, 0.425f, 0.25f));
 }
@@ -99,7 +100,7 @@ void MovingPlatform::Update()
 		return;
 	}
 
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_tickDeltaSeconds;
 	m_movementTime += deltaSeconds;
 
 	Player* player = m_map->m_game->m_player;
@@ -117,31 +118,27 @@ void MovingPlatform::Update()
 		case MovementDirection::UP_DOWN:			movementDir = up;			break;
 	}
 
-	m_position += m_movementAmplitude * sinf(m_movementTime * m_movementFrequency) * movementDir * deltaSeconds;
+	// Evaluate the integral of the velocity directly so the position stays exact when the platform is ticked at a reduced rate
+	Vec3 previousPosition = m_position;
+	m_position = m_editorPosition + m_movementAmplitude * (1.f - cosf(m_movementTime * m_movementFrequency)) / m_movementFrequency * movementDir;
 
 	if (m_isPlayerStandingOn)
 	{
-		playerPawn->m_position += m_movementAmplitude * sinf(m_movementTime * m_movementFrequency) * movementDir * deltaSeconds;
+		playerPawn->m_position += m_position - previousPosition;
 	}
 
 	m_isPlayerStandingOn = false;
 }
 
-void MovingPlatform::Render() const
+void MovingPlatform::Render(RenderQueue& queue) const
 {
 	Mat44 transform = Mat44::CreateTranslation3D(m_position);
 	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
 	transform.AppendScaleUniform3D(m_scale);
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
+	RenderState state = m_map->GetDefaultRenderState();
 
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer(), m_model->GetIndexBuffer(), m_model->GetIndexCount());
+	m_model->Submit(queue, state, transform, GetColor());
 }
 
 void MovingPlatform::HandlePlayerInteraction()
@@ -215,6 +212,16 @@ void MovingPlatform::AppendToBuffer(BufferWriter& writer)
 	writer.AppendByte((uint8_t)m_movementDirection);
 }
 
+void MovingPlatform::AppendToMapFile(MapFileContents& contents)
+{
+	Activatable::AppendToMapFile(contents);
+
+	MapMovementRecord movement;
+	movement.m_entityIndex = (uint32_t)(contents.m_entities.size() - 1);
+	movement.m_movementDirection = (uint8_t)m_movementDirection;
+	contents.m_movements.push_back(movement);
+}
+
 void MovingPlatform::Activate()
 {
 	m_isMoving = true;
@@ -19,10 +19,11 @@ public:
 	explicit MovingPlatform(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
 	virtual void HandlePlayerInteraction() override;
 	virtual void ResetState() override;
 	virtual void AppendToBuffer(BufferWriter& writer) override;
+	virtual void AppendToMapFile(MapFileContents& contents) override;
 
 	virtual void Activate() override;
 	virtual void Deactivate() override;
@@ -25,7 +25,7 @@ void Particle::Update()
 		return;
 	}
 
-	float deltaSeconds = m_map->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_map->m_game->GetDeltaSeconds();
 
 	m_position += m_velocity * deltaSeconds;
 	m_age += deltaSeconds;
@@ -37,16 +37,3 @@ void Particle::Update()
 		m_isDestroyed = true;
 	}
 }
-
-void Particle::Render()
-{
-	if (m_isDestroyed)
-	{
-		return;
-	}
-
-	Mat44 transform = Mat44::CreateTranslation3D(m_position);
-	transform.AppendScaleUniform3D(m_size);
-	g_renderer->SetModelConstants(transform, m_color);
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer(), m_model->GetIndexBuffer(), m_model->GetIndexCount());
-}
@@ -14,7 +14,6 @@ public:
 	~Particle() = default;
 	Particle(Map* map, Vec3 const& position, Vec3 const& velocity, EulerAngles const& orientation, float size, Rgba8 const& color, float lifetime, Model* model);
 	void Update();
-	void Render();
 
 public:
 	Map* m_map = nullptr;
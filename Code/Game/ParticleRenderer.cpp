@@ -0,0 +1,129 @@
+#include "Game/ParticleRenderer.hpp"
+
+#include "Game/Particle.hpp"
+#include "Game/RenderQueue.hpp"
+
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/ConstantBuffer.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+
+#include <algorithm>
+
+
+ParticleRenderer::~ParticleRenderer()
+{
+	delete m_instanceCBO;
+	m_instanceCBO = nullptr;
+	delete m_vertexBuffer;
+	m_vertexBuffer = nullptr;
+}
+
+ParticleRenderer::ParticleRenderer()
+{
+	m_instancedShader = g_renderer->CreateOrGetShader("Data/Shaders/ParticleInstanced", VertexType::VERTEX_PCUTBN);
+	m_instanceCBO = g_renderer->CreateConstantBuffer(sizeof(ParticleInstanceConstants) * MAX_PARTICLES_PER_DRAW);
+
+	std::vector<Vertex_PCUTBN> cubeVerts;
+	std::vector<unsigned int> cubeIndexes;
+	AddVertsForAABB3(cubeVerts, cubeIndexes, AABB3(Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, 0.5f, 0.5f)), Rgba8::WHITE, AABB2::ZERO_TO_ONE);
+	m_numVertexesPerParticle = (int)cubeIndexes.size();
+
+	// The unit cube is unrolled into a triangle list and repeated once per instance slot, with the slot carried in tangent.x
+	std::vector<Vertex_PCUTBN> replicatedVertexes;
+	replicatedVertexes.reserve((size_t)m_numVertexesPerParticle * (size_t)MAX_PARTICLES_PER_DRAW);
+	for (int instanceSlot = 0; instanceSlot < MAX_PARTICLES_PER_DRAW; instanceSlot++)
+	{
+		for (int indexIndex = 0; indexIndex < m_numVertexesPerParticle; indexIndex++)
+		{
+			Vertex_PCUTBN vertex = cubeVerts[cubeIndexes[indexIndex]];
+			vertex.m_tangent = Vec3((float)instanceSlot, 0.f, 0.f);
+			replicatedVertexes.push_back(vertex);
+		}
+	}
+
+	size_t vertexBufferSize = replicatedVertexes.size() * sizeof(Vertex_PCUTBN);
+	m_vertexBuffer = g_renderer->CreateVertexBuffer(vertexBufferSize, VertexType::VERTEX_PCUTBN);
+	g_renderer->CopyCPUToGPU(replicatedVertexes.data(), vertexBufferSize, m_vertexBuffer);
+}
+
+void ParticleRenderer::BuildInstances(std::vector<Particle*> const& particles, Vec3 const& sortOrigin)
+{
+	m_instances.clear();
+	m_sortDistancesSquared.clear();
+	m_sortedIndexes.clear();
+
+	for (int particleIndex = 0; particleIndex < (int)particles.size(); particleIndex++)
+	{
+		Particle const* particle = particles[particleIndex];
+		if (particle->m_isDestroyed)
+		{
+			continue;
+		}
+
+		ParticleInstanceConstants instance;
+		instance.m_positionAndSize[0] = particle->m_position.x;
+		instance.m_positionAndSize[1] = particle->m_position.y;
+		instance.m_positionAndSize[2] = particle->m_position.z;
+		instance.m_positionAndSize[3] = particle->m_size;
+		particle->m_color.GetAsFloats(instance.m_color);
+		m_instances.push_back(instance);
+		m_sortDistancesSquared.push_back(GetDistanceSquared3D(particle->m_position, sortOrigin));
+	}
+
+	if (!m_isDepthSorted || m_instances.size() < 2)
+	{
+		return;
+	}
+
+	// Slots are rasterized in order, so writing the instances back to front blends them correctly within one draw
+	for (int instanceIndex = 0; instanceIndex < (int)m_instances.size(); instanceIndex++)
+	{
+		m_sortedIndexes.push_back(instanceIndex);
+	}
+	std::sort(m_sortedIndexes.begin(), m_sortedIndexes.end(), [this](int a, int b) { return m_sortDistancesSquared[a] > m_sortDistancesSquared[b]; });
+
+	std::vector<ParticleInstanceConstants> sortedInstances;
+	sortedInstances.reserve(m_instances.size());
+	for (int sortedIndex = 0; sortedIndex < (int)m_sortedIndexes.size(); sortedIndex++)
+	{
+		sortedInstances.push_back(m_instances[m_sortedIndexes[sortedIndex]]);
+	}
+	m_instances.swap(sortedInstances);
+}
+
+void ParticleRenderer::Render(RenderQueue& queue) const
+{
+	RenderCommand command;
+	command.m_state.m_shader = m_instancedShader;
+	command.m_state.m_lighting = RenderLighting::FULLBRIGHT;
+	command.m_state.m_blendMode = BlendMode::ALPHA;
+	command.m_usesModelConstants = false;
+	command.m_vertexBuffer = m_vertexBuffer;
+	command.m_constantBuffer = m_instanceCBO;
+	command.m_constantBufferSlot = g_instanceConstantsSlot;
+
+	for (int firstInstanceIndex = 0; firstInstanceIndex < (int)m_instances.size(); firstInstanceIndex += MAX_PARTICLES_PER_DRAW)
+	{
+		int numInstancesInDraw = std::min(MAX_PARTICLES_PER_DRAW, (int)m_instances.size() - firstInstanceIndex);
+		ParticleInstanceConstants const& firstInstance = m_instances[firstInstanceIndex];
+		command.m_sortPosition = Vec3(firstInstance.m_positionAndSize[0], firstInstance.m_positionAndSize[1], firstInstance.m_positionAndSize[2]);
+		command.m_count = m_numVertexesPerParticle * numInstancesInDraw;
+		command.m_constantData = &firstInstance;
+		command.m_constantDataSize = sizeof(ParticleInstanceConstants) * numInstancesInDraw;
+		queue.Submit(command);
+	}
+}
+
+int ParticleRenderer::GetNumInstances() const
+{
+	return (int)m_instances.size();
+}
+
+int ParticleRenderer::GetNumDrawCalls() const
+{
+	return ((int)m_instances.size() + MAX_PARTICLES_PER_DRAW - 1) / MAX_PARTICLES_PER_DRAW;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/Vec3.hpp"
+
+#include <vector>
+
+
+class ConstantBuffer;
+class Particle;
+class RenderQueue;
+class Shader;
+class VertexBuffer;
+
+
+// Mirrors ParticleInstanceData in ParticleInstanced.hlsl
+struct ParticleInstanceConstants
+{
+public:
+	float m_positionAndSize[4] = {};
+	float m_color[4] = {};
+};
+
+
+class ParticleRenderer
+{
+public:
+	~ParticleRenderer();
+	ParticleRenderer();
+
+	void BuildInstances(std::vector<Particle*> const& particles, Vec3 const& sortOrigin);
+	void Render(RenderQueue& queue) const;
+
+	int GetNumInstances() const;
+	int GetNumDrawCalls() const;
+
+public:
+	// A constant buffer holds at most 64KB, which is 2048 compact particle instances
+	static constexpr int MAX_PARTICLES_PER_DRAW = 2048;
+
+	Shader* m_instancedShader = nullptr;
+	ConstantBuffer* m_instanceCBO = nullptr;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	int m_numVertexesPerParticle = 0;
+	bool m_isDepthSorted = true;
+
+private:
+	std::vector<ParticleInstanceConstants> m_instances;
+	std::vector<float> m_sortDistancesSquared;
+	std::vector<int> m_sortedIndexes;
+};
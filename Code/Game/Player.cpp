@@ -10,6 +10,7 @@
 #include "Game/PlayerPawn.hpp"
 #include "Game/Tile.hpp"
 #include "Game/HandController.hpp"
+#include "Game/InstancedModel.hpp"
 
 #include "Engine/Core/Models/ModelLoader.hpp"
 #include "Engine/Core/VertexUtils.hpp"
@@ -45,7 +46,7 @@ Player::Player(Game* game, Vec3 const& position, EulerAngles const& orientation)
 
 void Player::Update()
 {
-	VRController leftController = g_openXR->GetLeftController();
+	ControllerInputState const& leftController = m_game->GetInputFrame().m_leftController;
 
 	UpdateMovementInput();
 	if (m_state == PlayerState::PLAY)
@@ -54,7 +55,7 @@ void Player::Update()
 		m_orientation = m_pawn->m_orientation;
 	}
 
-	if (g_openXR && g_openXR->IsInitialized())
+	if (m_game->GetInputFrame().m_isVRActive)
 	{
 		UpdateVRControllers();
 		m_leftController->HandleInput();
@@ -128,12 +129,16 @@ void Player::UpdateCameras()
 		rightEyeTransform.Append(m_hmdOrientation.GetAsMatrix_iFwd_jLeft_kUp());
 		g_app->m_rightEyeCamera.SetTransform(rightEyeTransform);
 
+		g_app->m_leftEyeFrustum = ViewFrustum::CreateFromFovAngles(leftEyeTransform.GetTranslation3D(), leftEyeTransform.GetIBasis3D().GetNormalized(), leftEyeTransform.GetJBasis3D().GetNormalized(), leftEyeTransform.GetKBasis3D().GetNormalized(), lFovLeft, lFovRight, lFovUp, lFovDown, XR_NEAR, XR_FAR);
+		g_app->m_rightEyeFrustum = ViewFrustum::CreateFromFovAngles(rightEyeTransform.GetTranslation3D(), rightEyeTransform.GetIBasis3D().GetNormalized(), rightEyeTransform.GetJBasis3D().GetNormalized(), rightEyeTransform.GetKBasis3D().GetNormalized(), rFovLeft, rFovRight, rFovUp, rFovDown, XR_NEAR, XR_FAR);
+
 		float leftEyeFov = ConvertRadiansToDegrees(lFovUp - lFovDown);
 		float leftEyeAspect = (lFovRight - lFovLeft) / (lFovUp - lFovDown);
 
 		g_app->m_leftWorldCamera.SetPerspectiveView(leftEyeAspect, leftEyeFov, XR_NEAR, XR_FAR);
 		g_app->m_leftWorldCamera.SetNormalizedViewport(Vec2::ZERO, Vec2(0.5f, 1.f));
 		g_app->m_leftWorldCamera.SetTransform(GetPlayerPosition() + leftEyePosition, GetPlayerOrientation() + leftEyeOrientation);
+		g_app->m_leftWorldFrustum = ViewFrustum::CreatePerspective(GetPlayerPosition() + leftEyePosition, GetPlayerOrientation() + leftEyeOrientation, leftEyeAspect, leftEyeFov, XR_NEAR, XR_FAR);
 
 		float rightEyeFov = ConvertRadiansToDegrees(rFovUp - rFovDown);
 		float rightEyeAspect = (rFovRight - rFovLeft) / (rFovUp - rFovDown);
@@ -141,9 +146,22 @@ void Player::UpdateCameras()
 		g_app->m_rightWorldCamera.SetPerspectiveView(rightEyeAspect, rightEyeFov, XR_NEAR, XR_FAR);
 		g_app->m_rightWorldCamera.SetNormalizedViewport(Vec2(0.5f, 0.f), Vec2(0.5f, 1.f));
 		g_app->m_rightWorldCamera.SetTransform(GetPlayerPosition() + rightEyePosition, GetPlayerOrientation() + rightEyeOrientation);
+		g_app->m_rightWorldFrustum = ViewFrustum::CreatePerspective(GetPlayerPosition() + rightEyePosition, GetPlayerOrientation() + rightEyeOrientation, rightEyeAspect, rightEyeFov, XR_NEAR, XR_FAR);
 	}
 
 	g_app->m_worldCamera.SetTransform(GetPlayerPosition(), GetPlayerOrientation() + m_hmdOrientation);
+	g_app->m_worldFrustum = ViewFrustum::CreatePerspective(GetPlayerPosition(), GetPlayerOrientation() + m_hmdOrientation, WINDOW_ASPECT, WORLD_CAMERA_FOV_DEGREES, NEAR_PLANE_DISTANCE, FAR_PLANE_DISTANCE);
+
+	// The visible set is built once per frame, so it is culled against a frustum enclosing every view that will replay it
+	if (g_openXR && g_openXR->IsInitialized())
+	{
+		ViewFrustum const frameViews[3] = { g_app->m_leftEyeFrustum, g_app->m_rightEyeFrustum, g_app->GetDesktopFrustum() };
+		g_app->m_frameFrustum = ViewFrustum::CreateCombined(frameViews, g_app->IsDesktopSceneRendered() ? 3 : 2);
+	}
+	else
+	{
+		g_app->m_frameFrustum = g_app->GetDesktopFrustum();
+	}
 }
 
 void Player::UpdateMovementInput()
@@ -157,19 +175,16 @@ void Player::UpdateMovementInput()
 		UpdateFreeFlyInput();
 	}
 
-	EulerAngles leftEyeOrientation;
-	g_openXR->GetTransformForEye_iFwd_jLeft_kUp(XREye::LEFT, m_leftEyeLocalPosition, leftEyeOrientation);
-
-	EulerAngles rightEyeOrientation;
-	g_openXR->GetTransformForEye_iFwd_jLeft_kUp(XREye::RIGHT, m_rightEyeLocalPosition, rightEyeOrientation);
-
-	m_hmdOrientation = rightEyeOrientation;
+	InputFrame const& input = m_game->GetInputFrame();
+	m_leftEyeLocalPosition = input.m_leftEyeLocalPosition;
+	m_rightEyeLocalPosition = input.m_rightEyeLocalPosition;
+	m_hmdOrientation = input.m_rightEyeOrientation;
 	m_orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees, -89.f, 89.f);
 }
 
 void Player::UpdateFreeFlyInput()
 {
-	if (g_openXR && g_openXR->IsInitialized())
+	if (m_game->GetInputFrame().m_isVRActive)
 	{
 		UpdateFreeFlyVRInput();
 	}
@@ -182,10 +197,10 @@ void Player::UpdateFreeFlyInput()
 
 void Player::UpdateFreeFlyKeyboardInput()
 {
-	float deltaSeconds = m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_game->GetDeltaSeconds();
 
 	float movementSpeed = FREEFLY_SPEED;
-	if (g_input->IsShiftHeld())
+	if (m_game->GetInputFrame().IsShiftHeld())
 	{
 		movementSpeed *= FREEFLY_SPRINT_FACTOR;
 	}
@@ -193,32 +208,32 @@ void Player::UpdateFreeFlyKeyboardInput()
 	Vec3 playerFwd, playerLeft, playerUp;
 	m_orientation.GetAsVectors_iFwd_jLeft_kUp(playerFwd, playerLeft, playerUp);
 
-	if (g_input->IsKeyDown('W'))
+	if (m_game->GetInputFrame().IsKeyDown('W'))
 	{
 		m_position += playerFwd * movementSpeed * deltaSeconds;
 	}
-	if (g_input->IsKeyDown('S'))
+	if (m_game->GetInputFrame().IsKeyDown('S'))
 	{
 		m_position -= playerFwd * movementSpeed * deltaSeconds;
 	}
-	if (g_input->IsKeyDown('A'))
+	if (m_game->GetInputFrame().IsKeyDown('A'))
 	{
 		m_position += playerLeft * movementSpeed * deltaSeconds;
 	}
-	if (g_input->IsKeyDown('D'))
+	if (m_game->GetInputFrame().IsKeyDown('D'))
 	{
 		m_position -= playerLeft * movementSpeed * deltaSeconds;
 	}
 
-	m_orientation.m_yawDegrees += (float)g_input->GetCursorClientDelta().x * 0.075f;
-	m_orientation.m_pitchDegrees -= (float)g_input->GetCursorClientDelta().y * 0.075f;
+	m_orientation.m_yawDegrees += (float)m_game->GetInputFrame().GetCursorClientDelta().x * 0.075f;
+	m_orientation.m_pitchDegrees -= (float)m_game->GetInputFrame().GetCursorClientDelta().y * 0.075f;
 }
 
 void Player::UpdateFreeFlyVRInput()
 {
-	VRController leftController = g_openXR->GetLeftController();
-	VRController rightController = g_openXR->GetRightController();
-	float deltaSeconds = m_game->m_clock.GetDeltaSeconds();
+	ControllerInputState const& leftController = m_game->GetInputFrame().m_leftController;
+	ControllerInputState const& rightController = m_game->GetInputFrame().m_rightController;
+	float deltaSeconds = m_game->GetDeltaSeconds();
 	float movementSpeed = FREEFLY_SPEED;
 
 	if (leftController.GetTrigger() > 0.f)
@@ -248,7 +263,7 @@ void Player::UpdateFreeFlyVRInput()
 
 void Player::UpdateFirstPersonInput()
 {
-	if (g_openXR && g_openXR->IsInitialized())
+	if (m_game->GetInputFrame().m_isVRActive)
 	{
 		UpdateFirstPersonVRInput();
 	}
@@ -264,37 +279,37 @@ void Player::UpdateFirstPersonKeyboardInput()
 	Vec3 movementFwd = playerFwd.GetXY().GetNormalized().ToVec3();
 	Vec3 movementLeft = playerLeft.GetXY().GetNormalized().ToVec3();
 
-	if (g_input->IsKeyDown('W'))
+	if (m_game->GetInputFrame().IsKeyDown('W'))
 	{
 		m_pawn->MoveInDirection(movementFwd.GetXY().ToVec3());
 	}
-	if (g_input->IsKeyDown('S'))
+	if (m_game->GetInputFrame().IsKeyDown('S'))
 	{
 		m_pawn->MoveInDirection(-movementFwd.GetXY().ToVec3());
 	}
-	if (g_input->IsKeyDown('A'))
+	if (m_game->GetInputFrame().IsKeyDown('A'))
 	{
 		m_pawn->MoveInDirection(movementLeft.GetXY().ToVec3());
 	}
-	if (g_input->IsKeyDown('D'))
+	if (m_game->GetInputFrame().IsKeyDown('D'))
 	{
 		m_pawn->MoveInDirection(-movementLeft.GetXY().ToVec3());
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_SPACE))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_SPACE))
 	{
 		m_pawn->Jump();
 	}
 
-	m_pawn->m_orientation.m_yawDegrees += (float)g_input->GetCursorClientDelta().x * 0.075f;
-	m_pawn->m_orientation.m_pitchDegrees -= (float)g_input->GetCursorClientDelta().y * 0.075f;
+	m_pawn->m_orientation.m_yawDegrees += (float)m_game->GetInputFrame().GetCursorClientDelta().x * 0.075f;
+	m_pawn->m_orientation.m_pitchDegrees -= (float)m_game->GetInputFrame().GetCursorClientDelta().y * 0.075f;
 }
 
 void Player::UpdateFirstPersonVRInput()
 {
-	float deltaSeconds = m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_game->GetDeltaSeconds();
 
-	VRController leftController = g_openXR->GetLeftController();
-	VRController rightController = g_openXR->GetRightController();
+	ControllerInputState const& leftController = m_game->GetInputFrame().m_leftController;
+	ControllerInputState const& rightController = m_game->GetInputFrame().m_rightController;
 
 	Vec3 playerFwd, playerLeft, playerUp;
 	EulerAngles cameraOrientation = g_app->GetCurrentCamera().GetOrientation();
@@ -341,15 +356,15 @@ void Player::HandleKeyboardMouseEditing()
 		m_raycastDirection = m_orientation.GetAsMatrix_iFwd_jLeft_kUp().GetIBasis3D();
 		m_raycastPosition = m_position + m_raycastDirection * (m_entityDistance ? m_entityDistance : RAYCAST_DISTANCE);
 	
-		if (g_input->IsKeyDown(KEYCODE_CTRL) && !g_input->IsShiftHeld() && g_input->WasKeyJustPressed('Z'))
+		if (m_game->GetInputFrame().IsKeyDown(KEYCODE_CTRL) && !m_game->GetInputFrame().IsShiftHeld() && m_game->GetInputFrame().WasKeyJustPressed('Z'))
 		{
 			UndoLastAction();
 		}
-		if (g_input->IsKeyDown(KEYCODE_CTRL) && g_input->WasKeyJustPressed('Y'))
+		if (m_game->GetInputFrame().IsKeyDown(KEYCODE_CTRL) && m_game->GetInputFrame().WasKeyJustPressed('Y'))
 		{
 			RedoLastAction();
 		}
-		if (g_input->IsKeyDown(KEYCODE_CTRL) && g_input->IsShiftHeld() && g_input->WasKeyJustPressed('Z'))
+		if (m_game->GetInputFrame().IsKeyDown(KEYCODE_CTRL) && m_game->GetInputFrame().IsShiftHeld() && m_game->GetInputFrame().WasKeyJustPressed('Z'))
 		{
 			RedoLastAction();
 		}
@@ -395,16 +410,16 @@ void Player::HandleKeyboardMouseEditing_Create()
 {
 	if (m_selectedEntityType != EntityType::NONE)
 	{
-		m_entityDistance += g_input->m_cursorState.m_wheelScrollDelta * ENTITY_DISTANCE_ADJUST_PER_MOUSE_WHEEL_DELTA;
+		m_entityDistance += m_game->GetInputFrame().GetWheelScrollDelta() * ENTITY_DISTANCE_ADJUST_PER_MOUSE_WHEEL_DELTA;
 		m_entityDistance = GetClamped(m_entityDistance, 0.5f, 10.f);
 	}
 
-	if (g_input->WasKeyJustPressed('E'))
+	if (m_game->GetInputFrame().WasKeyJustPressed('E'))
 	{
 		m_selectedEntityType = EntityType(((int)m_selectedEntityType + 1) % (int)EntityType::NUM);
 		m_selectedEntity = m_game->m_currentMap->CreateEntityOfType(m_selectedEntityType, Vec3::ZERO, EulerAngles::ZERO, 1.f);
 	}
-	if (g_input->WasKeyJustPressed('Q'))
+	if (m_game->GetInputFrame().WasKeyJustPressed('Q'))
 	{
 		m_selectedEntityType = EntityType((int)m_selectedEntityType - 1);
 		if ((int)m_selectedEntityType < 0)
@@ -413,11 +428,11 @@ void Player::HandleKeyboardMouseEditing_Create()
 		}
 		m_selectedEntity = m_game->m_currentMap->CreateEntityOfType(m_selectedEntityType, Vec3::ZERO, EulerAngles::ZERO, 1.f);
 	}
-	if (g_input->WasKeyJustReleased(KEYCODE_LMB))
+	if (m_game->GetInputFrame().WasKeyJustReleased(KEYCODE_LMB))
 	{
 		SpawnEntities();
 	}
-	if (g_input->IsKeyDown(KEYCODE_LMB))
+	if (m_game->GetInputFrame().IsKeyDown(KEYCODE_LMB))
 	{
 		m_entitySpawnEndPosition = m_raycastPosition;
 	}
@@ -430,7 +445,7 @@ void Player::HandleKeyboardMouseEditing_Create()
 
 void Player::HandleKeyboardMouseEditing_Edit()
 {
-	if (g_input->WasKeyJustPressed(KEYCODE_LMB) && !g_input->IsKeyDown(KEYCODE_LEFT_ALT) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_LMB) && !m_game->GetInputFrame().IsKeyDown(KEYCODE_LEFT_ALT) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
 	{
 		if (m_hoveredEntity)
 		{
@@ -449,7 +464,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_LMB) && g_input->IsKeyDown(KEYCODE_LEFT_ALT) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_LMB) && m_game->GetInputFrame().IsKeyDown(KEYCODE_LEFT_ALT) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
 	{
 		if (m_hoveredEntity)
 		{
@@ -467,14 +482,20 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 		}
 	}
-	if (g_input->WasKeyJustReleased(KEYCODE_LMB) && (m_mouseActionState == ActionType::TRANSLATE || m_mouseActionState == ActionType::CLONE))
+	if (m_game->GetInputFrame().WasKeyJustReleased(KEYCODE_LMB) && (m_mouseActionState == ActionType::TRANSLATE || m_mouseActionState == ActionType::CLONE))
 	{
+		// A drag is journaled once where it ends rather than every frame it moves
+		if (m_selectedEntity)
+		{
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
+		}
+
 		m_selectedEntityType = EntityType::NONE;
 		m_selectedEntity = nullptr;
 		m_game->m_currentMap->SetSelectedEntity(nullptr);
 		m_mouseActionState = ActionType::NONE;
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_DELETE) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_DELETE) && (m_mouseActionState == ActionType::NONE || m_mouseActionState == ActionType::SELECT))
 	{
 		if (m_selectedEntity)
 		{
@@ -508,11 +529,11 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->RemoveEntityFromMap(m_hoveredEntity);
 		}
 	}
-	if (g_input->IsKeyDown(KEYCODE_LMB) && (m_mouseActionState == ActionType::TRANSLATE || m_mouseActionState == ActionType::CLONE))
+	if (m_game->GetInputFrame().IsKeyDown(KEYCODE_LMB) && (m_mouseActionState == ActionType::TRANSLATE || m_mouseActionState == ActionType::CLONE))
 	{
 		if (m_selectedEntity)
 		{
-			m_entityDistance += g_input->m_cursorState.m_wheelScrollDelta * ENTITY_DISTANCE_ADJUST_PER_MOUSE_WHEEL_DELTA;
+			m_entityDistance += m_game->GetInputFrame().GetWheelScrollDelta() * ENTITY_DISTANCE_ADJUST_PER_MOUSE_WHEEL_DELTA;
 			m_entityDistance = GetClamped(m_entityDistance, 0.5f, 10.f);
 
 			Vec3 mouseRaycastDelta = m_raycastPosition - m_raycastPositionLastFrame;
@@ -538,7 +559,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			}
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_SPACE))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_SPACE))
 	{
 		if (m_mouseActionState == ActionType::NONE && m_hoveredEntity)
 		{
@@ -578,9 +599,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 				Action linkAction;
 				linkAction.m_actionType = ActionType::LINK;
 				linkAction.m_activator = activator;
-				linkAction.m_prevLinkedActivatable = activator->m_activatableUID;
 				linkAction.m_activatable = activatable;
-				linkAction.m_prevLinkedActivator = activatable->m_activatorUID;
 
 				m_undoActionStack.push(linkAction);
 				m_game->m_currentMap->m_isUnsaved = true;
@@ -597,7 +616,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->SetSelectedEntity(nullptr);
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_LEFTARROW))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_LEFTARROW))
 	{
 		if (m_selectedEntity)
 		{
@@ -611,6 +630,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_selectedEntity->m_orientation.m_yawDegrees += 15.f;
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 		}
 		else if (m_hoveredEntity)
 		{
@@ -624,9 +644,10 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_hoveredEntity->m_orientation.m_yawDegrees += 15.f;
+			m_game->m_currentMap->JournalEntityPlaced(m_hoveredEntity);
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_RIGHTARROW))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_RIGHTARROW))
 	{
 		if (m_selectedEntity)
 		{
@@ -640,6 +661,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_selectedEntity->m_orientation.m_yawDegrees -= 15.f;
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 		}
 		else if (m_hoveredEntity)
 		{
@@ -653,9 +675,10 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_hoveredEntity->m_orientation.m_yawDegrees -= 15.f;
+			m_game->m_currentMap->JournalEntityPlaced(m_hoveredEntity);
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_UPARROW))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_UPARROW))
 	{
 		if (m_selectedEntity)
 		{
@@ -669,6 +692,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_selectedEntity->m_scale += 0.1f;
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 		}
 		else if (m_hoveredEntity)
 		{
@@ -682,9 +706,10 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_hoveredEntity->m_scale += 0.1f;
+			m_game->m_currentMap->JournalEntityPlaced(m_hoveredEntity);
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_DOWNARROW))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_DOWNARROW))
 	{
 		if (m_selectedEntity)
 		{
@@ -698,6 +723,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_selectedEntity->m_scale -= 0.1f;
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 		}
 		if (m_hoveredEntity)
 		{
@@ -711,9 +737,10 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			m_game->m_currentMap->m_isUnsaved = true;
 
 			m_hoveredEntity->m_scale -= 0.1f;
+			m_game->m_currentMap->JournalEntityPlaced(m_hoveredEntity);
 		}
 	}
-	if (g_input->WasKeyJustPressed(KEYCODE_END))
+	if (m_game->GetInputFrame().WasKeyJustPressed(KEYCODE_END))
 	{
 		if (m_selectedEntity && m_mouseActionState == ActionType::TRANSLATE)
 		{
@@ -762,6 +789,7 @@ void Player::HandleKeyboardMouseEditing_Edit()
 			{
 				m_selectedEntity->m_position.z = 0.f;
 			}
+			m_game->m_currentMap->JournalEntityPlaced(m_selectedEntity);
 
 			m_selectedEntity = nullptr;
 			m_game->m_currentMap->SetSelectedEntity(nullptr);
@@ -890,7 +918,7 @@ void Player::RenderFakeEntitiesForSpawn() const
 				g_renderer->BindTexture(nullptr);
 				g_renderer->BindShader(nullptr);
 				g_renderer->SetModelConstants(transform, Rgba8(255, 255, 255, 195));
-				g_renderer->DrawIndexBuffer(m_selectedEntity->m_model->GetVertexBuffer(), m_selectedEntity->m_model->GetIndexBuffer(), m_selectedEntity->m_model->GetIndexCount());
+				m_selectedEntity->m_model->Draw();
 
 				ArchiLeapRaycastResult3D groundwardRaycastResult = m_game->m_currentMap->RaycastVsEntities(entityPosition, Vec3::GROUNDWARD, 100.f, m_selectedEntity);
 				if (groundwardRaycastResult.m_didImpact)
@@ -1013,6 +1041,7 @@ void Player::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_position = lastAction.m_actionEntityPreviousPosition;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::ROTATE:
@@ -1024,6 +1053,7 @@ void Player::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_orientation = lastAction.m_actionEntityPreviousOrientation;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::SCALE:
@@ -1035,6 +1065,7 @@ void Player::UndoLastAction()
 			m_redoActionStack.push(redoAction);
 
 			lastAction.m_actionEntity->m_scale = lastAction.m_actionEntityPreviousScale;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::CREATE:
@@ -1099,12 +1130,11 @@ void Player::UndoLastAction()
 			redoAction.m_actionType = ActionType::LINK;
 			redoAction.m_activator = lastAction.m_activator;
 			redoAction.m_activatable = lastAction.m_activatable;
-			redoAction.m_prevLinkedActivatable = lastAction.m_activator->m_activatableUID;
-			redoAction.m_prevLinkedActivator = lastAction.m_activatable->m_activatorUID;
 			m_redoActionStack.push(redoAction);
 
-			lastAction.m_activator->m_activatableUID = lastAction.m_prevLinkedActivatable;
-			lastAction.m_activatable->m_activatorUID = lastAction.m_prevLinkedActivator;
+			// Linking toggles an edge, so toggling it again undoes it
+			m_game->m_currentMap->m_signalGraph.ToggleEdge(lastAction.m_activator->m_uid, lastAction.m_activatable->m_uid);
+			m_game->m_currentMap->JournalSignalEdge(lastAction.m_activator->m_uid, lastAction.m_activatable->m_uid);
 
 			break;
 		}
@@ -1126,16 +1156,19 @@ void Player::RedoLastAction()
 		case ActionType::TRANSLATE:
 		{
 			lastAction.m_actionEntity->m_position = lastAction.m_actionEntityPreviousPosition;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::ROTATE:
 		{
 			lastAction.m_actionEntity->m_orientation = lastAction.m_actionEntityPreviousOrientation;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::SCALE:
 		{
 			lastAction.m_actionEntity->m_scale = lastAction.m_actionEntityPreviousScale;
+			m_game->m_currentMap->JournalEntityPlaced(lastAction.m_actionEntity);
 			break;
 		}
 		case ActionType::CREATE:
@@ -1187,8 +1220,8 @@ void Player::RedoLastAction()
 		}
 		case ActionType::LINK:
 		{
-			lastAction.m_activator->m_activatableUID = lastAction.m_prevLinkedActivatable;
-			lastAction.m_activatable->m_activatorUID = lastAction.m_prevLinkedActivator;
+			m_game->m_currentMap->m_signalGraph.ToggleEdge(lastAction.m_activator->m_uid, lastAction.m_activatable->m_uid);
+			m_game->m_currentMap->JournalSignalEdge(lastAction.m_activator->m_uid, lastAction.m_activatable->m_uid);
 
 			break;
 		}
@@ -1206,6 +1239,11 @@ void Player::ChangeState(PlayerState prevState, PlayerState newState)
 		m_game->m_currentMap->SaveAllEntityStates();
 		m_game->m_currentMap->SetSelectedEntity(nullptr);
 
+		// Hovered tiles lose their editor tint in play, so they go back into their chunk geometry
+		m_game->m_currentMap->m_tileChunks.OnEntityChanged(m_hoveredEntity);
+		m_game->m_currentMap->m_tileChunks.OnEntityChanged(m_leftController->m_hoveredEntity);
+		m_game->m_currentMap->m_tileChunks.OnEntityChanged(m_rightController->m_hoveredEntity);
+
 		m_game->m_isMapImageVisible = false;
 		m_game->m_toggleMapImageButton->SetImage("Data/Images/Image.png");
 
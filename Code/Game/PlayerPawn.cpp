@@ -25,7 +25,7 @@ void PlayerPawn::Update()
 		return;
 	}
 
-	float deltaSeconds = m_player->m_game->m_clock.GetDeltaSeconds();
+	float deltaSeconds = m_player->m_game->GetDeltaSeconds();
 
 	// Add force due to gravity
 	AddForce(Vec3::GROUNDWARD * GRAVITY * MASS);
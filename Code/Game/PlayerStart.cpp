@@ -38,7 +38,7 @@ void PlayerStart::Update()
 	Entity::Update();
 }
 
-void PlayerStart::Render() const
+void PlayerStart::Render(RenderQueue& queue) const
 {
 	if (m_map->m_game->m_player->m_state == PlayerState::PLAY)
 	{
@@ -49,18 +49,20 @@ void PlayerStart::Render() const
 	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
 	transform.AppendScaleUniform3D(m_scale);
 
-	g_renderer->BindShader(nullptr);
-	g_renderer->SetBlendMode(BlendMode::ALPHA);
-	g_renderer->SetDepthMode(DepthMode::DISABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_NONE);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawVertexBuffer(m_vertexBuffer, (int)(m_vertexBuffer->m_size / sizeof(Vertex_PCU)));
+	RenderState state;
+	state.m_blendMode = BlendMode::ALPHA;
+	state.m_depthMode = DepthMode::DISABLED;
+	state.m_cullMode = RasterizerCullMode::CULL_NONE;
+	queue.SubmitVertexes(state, transform, GetColor(), m_vertexBuffer, (int)(m_vertexBuffer->m_size / sizeof(Vertex_PCU)));
 
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->DrawVertexBuffer(m_basisVBO, (int)(m_basisVBO->m_size / sizeof(Vertex_PCU)));
+	state.m_depthMode = DepthMode::ENABLED;
+	queue.SubmitVertexes(state, transform, GetColor(), m_basisVBO, (int)(m_basisVBO->m_size / sizeof(Vertex_PCU)));
+}
+
+bool PlayerStart::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	UNUSED(renderer);
+	return false;
 }
 
 void PlayerStart::HandlePlayerInteraction()
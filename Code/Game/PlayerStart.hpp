@@ -10,7 +10,8 @@ public:
 	explicit PlayerStart(Map* map, EntityUID uid, Vec3 const& position, EulerAngles const& orientation);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const override;
 	virtual void HandlePlayerInteraction() override;
 
 private:
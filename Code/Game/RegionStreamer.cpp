@@ -0,0 +1,625 @@
+#include "Game/RegionStreamer.hpp"
+
+#include "Game/Button.hpp"
+#include "Game/Coin.hpp"
+#include "Game/Door.hpp"
+#include "Game/Enemy_Orc.hpp"
+#include "Game/Entity.hpp"
+#include "Game/EntityUID.hpp"
+#include "Game/Lever.hpp"
+#include "Game/Map.hpp"
+#include "Game/MovingPlatform.hpp"
+
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <limits.h>
+
+
+RegionStreamer::~RegionStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_wakeCondition.notify_all();
+	if (m_workerThread.joinable())
+	{
+		m_workerThread.join();
+	}
+
+	for (int activeIndex = 0; activeIndex < (int)m_activeRegionIndexes.size(); activeIndex++)
+	{
+		StreamedRegion& region = m_regions[m_activeRegionIndexes[activeIndex]];
+		for (int entityIndex = 0; entityIndex < (int)region.m_entities.size(); entityIndex++)
+		{
+			m_map->m_entities[region.m_entities[entityIndex].m_slotIndex] = nullptr;
+			delete region.m_entities[entityIndex].m_entity;
+		}
+	}
+}
+
+RegionStreamer::RegionStreamer(Map* map, std::string const& mapFilePath)
+	: m_map(map)
+{
+	// Map::ReadMapFile has already checked this file, so these only fail if it changed on disk since
+	GUARANTEE_OR_DIE(m_mappedFile.Open(mapFilePath), "Could not read data in map file!");
+	GUARANTEE_OR_DIE(m_reader.Open(m_mappedFile.GetData(), m_mappedFile.GetSize()), "Map file is truncated or corrupt!");
+
+	MapFileSectionView<MapRegionRecord> regionRecords;
+	GUARANTEE_OR_DIE(m_reader.GetRegions(regionRecords), "Map file region points past its records!");
+	m_regions.resize(regionRecords.m_count);
+	for (int regionIndex = 0; regionIndex < regionRecords.m_count; regionIndex++)
+	{
+		MapRegionRecord const& regionRecord = regionRecords[regionIndex];
+		StreamedRegion& region = m_regions[regionIndex];
+		region.m_coords = IntVec2(regionRecord.m_regionX, regionRecord.m_regionY);
+		region.m_firstEntityRecord = regionRecord.m_firstEntityRecord;
+		region.m_numEntityRecords = regionRecord.m_numEntityRecords;
+		region.m_firstTileChunk = regionRecord.m_firstTileChunk;
+		region.m_numTileChunks = regionRecord.m_numTileChunks;
+		m_regionIndexesByKey[GetMapRegionKey(region.m_coords)] = regionIndex;
+	}
+
+	MapFileContents sideTables;
+	GUARANTEE_OR_DIE(m_reader.ReadSideTables(sideTables), "Map file has no player start!");
+	for (int movementIndex = 0; movementIndex < (int)sideTables.m_movements.size(); movementIndex++)
+	{
+		m_movementDirectionsBySlot[sideTables.m_movements[movementIndex].m_entityIndex] = sideTables.m_movements[movementIndex].m_movementDirection;
+	}
+
+	// Slots stay in file order so UIDs keep pointing at the right index, they are only filled while their region is resident
+	m_numEntitySlots = m_reader.GetNumEntitySlots();
+	m_map->m_entities.assign(m_numEntitySlots, nullptr);
+	m_map->m_signalGraph.LoadFromMapFile(sideTables);
+
+	m_workerThread = std::thread(&RegionStreamer::WorkerMain, this);
+}
+
+bool RegionStreamer::IsStreamable(MapFileReader const& reader)
+{
+	// Version 4 regions list raw slots instead of record runs, so only the current version streams
+	if (reader.m_header->m_version != SAVEFILE_VERSION)
+	{
+		return false;
+	}
+
+	MapFileSectionView<MapRegionRecord> regionRecords;
+	return reader.GetSection(MapFileSectionType::REGIONS, regionRecords) && regionRecords.m_count > 0 && reader.GetNumEntitySlots() >= MIN_ENTITIES_TO_STREAM;
+}
+
+void RegionStreamer::Update(Vec3 const& focusPosition)
+{
+	CollectDecodedRegions(focusPosition);
+	RequestRegionsAround(focusPosition);
+
+	bool didUnload = UnloadDistantRegions(focusPosition);
+	bool didConstruct = ConstructNearbyRegions(focusPosition, MAX_ENTITIES_CONSTRUCTED_PER_FRAME);
+	if (didUnload || didConstruct)
+	{
+		m_map->m_triggerVolumes.MarkDirty();
+		m_map->m_entityListVersion++;
+	}
+}
+
+void RegionStreamer::LoadRegionsAroundNow(Vec3 const& focusPosition)
+{
+	// For loads that block anyway, the start of the level is decoded on the main thread so the first frame already has ground under the player
+	IntVec2 minCoords = GetMapRegionForPosition(focusPosition - Vec3(RESIDENT_RADIUS, RESIDENT_RADIUS, 0.f));
+	IntVec2 maxCoords = GetMapRegionForPosition(focusPosition + Vec3(RESIDENT_RADIUS, RESIDENT_RADIUS, 0.f));
+	for (int regionY = minCoords.y; regionY <= maxCoords.y; regionY++)
+	{
+		for (int regionX = minCoords.x; regionX <= maxCoords.x; regionX++)
+		{
+			auto regionIter = m_regionIndexesByKey.find(GetMapRegionKey(IntVec2(regionX, regionY)));
+			if (regionIter == m_regionIndexesByKey.end())
+			{
+				continue;
+			}
+
+			StreamedRegion& region = m_regions[regionIter->second];
+			DecodeRegion(regionIter->second, region.m_decoded);
+			if (!region.m_decoded.m_isValid)
+			{
+				FailRegion(region);
+				continue;
+			}
+
+			region.m_state = StreamedRegionState::DECODED;
+			m_activeRegionIndexes.push_back(regionIter->second);
+		}
+	}
+
+	ConstructNearbyRegions(focusPosition, INT_MAX);
+}
+
+float RegionStreamer::GetResidentFractionAround(Vec3 const& focusPosition) const
+{
+	// Only the regions that Update keeps resident around this position count, prefetched ones may still be decoding
+	IntVec2 minCoords = GetMapRegionForPosition(focusPosition - Vec3(RESIDENT_RADIUS, RESIDENT_RADIUS, 0.f));
+	IntVec2 maxCoords = GetMapRegionForPosition(focusPosition + Vec3(RESIDENT_RADIUS, RESIDENT_RADIUS, 0.f));
+	int numNearbyRegions = 0;
+	int numResidentRegions = 0;
+	for (int regionY = minCoords.y; regionY <= maxCoords.y; regionY++)
+	{
+		for (int regionX = minCoords.x; regionX <= maxCoords.x; regionX++)
+		{
+			auto regionIter = m_regionIndexesByKey.find(GetMapRegionKey(IntVec2(regionX, regionY)));
+			if (regionIter == m_regionIndexesByKey.end())
+			{
+				continue;
+			}
+
+			StreamedRegion const& region = m_regions[regionIter->second];
+			if (GetDistanceSquaredToRegion(region, focusPosition) > RESIDENT_RADIUS * RESIDENT_RADIUS)
+			{
+				continue;
+			}
+
+			numNearbyRegions++;
+			// A failed region will never become resident, so it must not hold up the loading screen
+			numResidentRegions += (region.m_state == StreamedRegionState::RESIDENT || region.m_state == StreamedRegionState::FAILED) ? 1 : 0;
+		}
+	}
+
+	if (numNearbyRegions == 0)
+	{
+		return 1.f;
+	}
+
+	return (float)numResidentRegions / (float)numNearbyRegions;
+}
+
+void RegionStreamer::RequestRegionsAround(Vec3 const& focusPosition)
+{
+	IntVec2 minCoords = GetMapRegionForPosition(focusPosition - Vec3(PREFETCH_RADIUS, PREFETCH_RADIUS, 0.f));
+	IntVec2 maxCoords = GetMapRegionForPosition(focusPosition + Vec3(PREFETCH_RADIUS, PREFETCH_RADIUS, 0.f));
+	bool didRequest = false;
+	for (int regionY = minCoords.y; regionY <= maxCoords.y; regionY++)
+	{
+		for (int regionX = minCoords.x; regionX <= maxCoords.x; regionX++)
+		{
+			auto regionIter = m_regionIndexesByKey.find(GetMapRegionKey(IntVec2(regionX, regionY)));
+			if (regionIter == m_regionIndexesByKey.end())
+			{
+				continue;
+			}
+
+			StreamedRegion& region = m_regions[regionIter->second];
+			if (region.m_state != StreamedRegionState::UNLOADED || GetDistanceSquaredToRegion(region, focusPosition) > PREFETCH_RADIUS * PREFETCH_RADIUS)
+			{
+				continue;
+			}
+
+			region.m_state = StreamedRegionState::DECODING;
+			m_activeRegionIndexes.push_back(regionIter->second);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pendingRegionIndexes.push_back(regionIter->second);
+			}
+			didRequest = true;
+		}
+	}
+
+	if (didRequest)
+	{
+		m_wakeCondition.notify_one();
+	}
+}
+
+void RegionStreamer::CollectDecodedRegions(Vec3 const& focusPosition)
+{
+	std::vector<DecodedRegion> completedRegions;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		completedRegions.swap(m_completedRegions);
+	}
+
+	for (int completedIndex = 0; completedIndex < (int)completedRegions.size(); completedIndex++)
+	{
+		StreamedRegion& region = m_regions[completedRegions[completedIndex].m_regionIndex];
+		if (!completedRegions[completedIndex].m_isValid)
+		{
+			FailRegion(region);
+			continue;
+		}
+
+		region.m_decoded = std::move(completedRegions[completedIndex]);
+		region.m_state = StreamedRegionState::DECODED;
+
+		// The player may have turned back while the region was decoding
+		if (GetDistanceSquaredToRegion(region, focusPosition) > UNLOAD_RADIUS * UNLOAD_RADIUS)
+		{
+			UnloadRegion(region);
+		}
+	}
+}
+
+bool RegionStreamer::ConstructNearbyRegions(Vec3 const& focusPosition, int maxEntitiesToConstruct)
+{
+	int numEntitiesConstructed = 0;
+	for (int activeIndex = 0; activeIndex < (int)m_activeRegionIndexes.size() && numEntitiesConstructed < maxEntitiesToConstruct; activeIndex++)
+	{
+		int regionIndex = m_activeRegionIndexes[activeIndex];
+		StreamedRegion& region = m_regions[regionIndex];
+		if (region.m_state != StreamedRegionState::DECODED || GetDistanceSquaredToRegion(region, focusPosition) > RESIDENT_RADIUS * RESIDENT_RADIUS)
+		{
+			continue;
+		}
+
+		// A region that does not fit in this frame's budget picks up where it left off next frame
+		std::vector<MapEntityRecord> const& records = region.m_decoded.m_records;
+		while (region.m_numRecordsConstructed < (int)records.size() && numEntitiesConstructed < maxEntitiesToConstruct)
+		{
+			uint32_t slotIndex = region.m_decoded.m_slotIndexes[region.m_numRecordsConstructed];
+			MapEntityRecord const& record = records[region.m_numRecordsConstructed];
+			region.m_numRecordsConstructed++;
+			// A slot can still be alive if its entity wandered into a neighbouring region that stayed resident
+			if (m_map->m_entities[slotIndex])
+			{
+				continue;
+			}
+
+			StreamedEntityState const* state = nullptr;
+			auto stateIter = m_entityStatesBySlot.find(slotIndex);
+			if (stateIter != m_entityStatesBySlot.end())
+			{
+				// Consumed entities stay gone, and one that was left in another region comes back with that region instead
+				if (stateIter->second.m_isConsumed || stateIter->second.m_regionIndex != regionIndex)
+				{
+					continue;
+				}
+				state = &stateIter->second;
+			}
+
+			ConstructEntity(region, slotIndex, regionIndex, record, state);
+			numEntitiesConstructed++;
+		}
+
+		if (region.m_numRecordsConstructed == (int)records.size())
+		{
+			region.m_state = StreamedRegionState::RESIDENT;
+			region.m_decoded = DecodedRegion();
+			m_numResidentRegions++;
+			if (ConstructStrandedEntities(region))
+			{
+				numEntitiesConstructed++;
+			}
+		}
+	}
+
+	return numEntitiesConstructed > 0;
+}
+
+bool RegionStreamer::ConstructStrandedEntities(StreamedRegion& region)
+{
+	int regionIndex = (int)(&region - m_regions.data());
+	auto strandedIter = m_strandedSlotsByRegion.find(regionIndex);
+	if (strandedIter == m_strandedSlotsByRegion.end())
+	{
+		return false;
+	}
+
+	std::vector<uint32_t> strandedSlots;
+	strandedSlots.swap(strandedIter->second);
+	m_strandedSlotsByRegion.erase(strandedIter);
+
+	bool didConstruct = false;
+	for (int strandedIndex = 0; strandedIndex < (int)strandedSlots.size(); strandedIndex++)
+	{
+		// The list can still hold slots whose entity has been rebuilt or moved on since it was stranded here
+		uint32_t slotIndex = strandedSlots[strandedIndex];
+		auto stateIter = m_entityStatesBySlot.find(slotIndex);
+		if (stateIter == m_entityStatesBySlot.end() || stateIter->second.m_regionIndex != regionIndex || stateIter->second.m_isConsumed || m_map->m_entities[slotIndex])
+		{
+			continue;
+		}
+
+		StreamedEntityState const& state = stateIter->second;
+		ConstructEntity(region, slotIndex, state.m_homeRegionIndex, state.m_record, &state);
+		didConstruct = true;
+	}
+
+	return didConstruct;
+}
+
+void RegionStreamer::ConstructEntity(StreamedRegion& region, uint32_t slotIndex, int homeRegionIndex, MapEntityRecord const& record, StreamedEntityState const* state)
+{
+	Entity* entity = m_map->CreateEntityOfTypeWithUID((EntityType)record.m_type, EntityUID(record.m_uid), record.GetPosition(), record.GetOrientation(), record.m_scale);
+	auto movementIter = m_movementDirectionsBySlot.find(slotIndex);
+	if (movementIter != m_movementDirectionsBySlot.end() && entity->m_type == EntityType::MOVING_PLATFORM)
+	{
+		((MovingPlatform*)entity)->m_movementDirection = (MovementDirection)movementIter->second;
+	}
+
+	// The saved state is dropped once applied, the entity saves a fresh one if it unloads again
+	if (state)
+	{
+		RestoreEntityState(entity, *state);
+		m_entityStatesBySlot.erase(slotIndex);
+	}
+
+	m_map->m_entities[slotIndex] = entity;
+	m_map->m_tickScheduler.OnEntityAdded(entity);
+	m_map->m_tileChunks.OnEntityAdded(entity);
+	m_map->m_cullingGrid.OnEntityAdded(entity);
+	m_map->m_signalGraph.OnEntityStreamedIn(entity);
+
+	StreamedEntity streamedEntity;
+	streamedEntity.m_entity = entity;
+	streamedEntity.m_slotIndex = slotIndex;
+	streamedEntity.m_homeRegionIndex = homeRegionIndex;
+	region.m_entities.push_back(streamedEntity);
+	m_numResidentEntities++;
+}
+
+bool RegionStreamer::UnloadDistantRegions(Vec3 const& focusPosition)
+{
+	bool didUnload = false;
+	for (int activeIndex = 0; activeIndex < (int)m_activeRegionIndexes.size(); activeIndex++)
+	{
+		StreamedRegion& region = m_regions[m_activeRegionIndexes[activeIndex]];
+		if (region.m_state == StreamedRegionState::DECODING || GetDistanceSquaredToRegion(region, focusPosition) <= UNLOAD_RADIUS * UNLOAD_RADIUS)
+		{
+			continue;
+		}
+
+		didUnload = didUnload || !region.m_entities.empty();
+		UnloadRegion(region);
+		activeIndex--;
+	}
+
+	return didUnload;
+}
+
+void RegionStreamer::UnloadRegion(StreamedRegion& region)
+{
+	int regionIndex = (int)(&region - m_regions.data());
+	if (region.m_state == StreamedRegionState::RESIDENT)
+	{
+		m_numResidentRegions--;
+	}
+
+	for (int entityIndex = 0; entityIndex < (int)region.m_entities.size(); entityIndex++)
+	{
+		StreamedEntity const& streamedEntity = region.m_entities[entityIndex];
+		Entity* entity = streamedEntity.m_entity;
+
+		// Entities that were pushed or walked into another resident region move there instead of vanishing with their old one
+		StreamedRegion* currentRegion = FindRegion(GetMapRegionForPosition(entity->m_position));
+		if (currentRegion && currentRegion != &region && currentRegion->m_state == StreamedRegionState::RESIDENT)
+		{
+			currentRegion->m_entities.push_back(streamedEntity);
+			continue;
+		}
+
+		// Anything that no longer matches its record is remembered, along with the region it is in now so it comes back with that region
+		StreamedRegion* targetRegion = (currentRegion && currentRegion->m_state != StreamedRegionState::FAILED) ? currentRegion : &region;
+		int targetRegionIndex = (int)(targetRegion - m_regions.data());
+		bool isOutsideHomeRegion = targetRegionIndex != streamedEntity.m_homeRegionIndex;
+		StreamedEntityState state;
+		if (SaveEntityState(entity, state) || isOutsideHomeRegion)
+		{
+			state.m_regionIndex = targetRegionIndex;
+			state.m_homeRegionIndex = streamedEntity.m_homeRegionIndex;
+			m_entityStatesBySlot[streamedEntity.m_slotIndex] = state;
+			if (isOutsideHomeRegion)
+			{
+				m_strandedSlotsByRegion[targetRegionIndex].push_back(streamedEntity.m_slotIndex);
+			}
+		}
+		if (m_map->m_selectedEntity == entity)
+		{
+			m_map->m_selectedEntity = nullptr;
+		}
+
+		m_map->m_tickScheduler.OnEntityRemoved(entity);
+		m_map->m_tileChunks.OnEntityRemoved(entity);
+		m_map->m_cullingGrid.OnEntityRemoved(entity);
+		m_map->m_entities[streamedEntity.m_slotIndex] = nullptr;
+		delete entity;
+		m_numResidentEntities--;
+	}
+
+	region.m_entities.clear();
+	region.m_decoded = DecodedRegion();
+	region.m_numRecordsConstructed = 0;
+	region.m_state = StreamedRegionState::UNLOADED;
+
+	for (int activeIndex = 0; activeIndex < (int)m_activeRegionIndexes.size(); activeIndex++)
+	{
+		if (m_activeRegionIndexes[activeIndex] == regionIndex)
+		{
+			m_activeRegionIndexes[activeIndex] = m_activeRegionIndexes.back();
+			m_activeRegionIndexes.pop_back();
+			break;
+		}
+	}
+}
+
+void RegionStreamer::FailRegion(StreamedRegion& region)
+{
+	// A damaged region stays empty for the rest of the session instead of taking the game down or being decoded again every frame
+	g_console->AddLine(Rgba8::RED, Stringf("Map region (%d, %d) is truncated or corrupt and was not loaded", region.m_coords.x, region.m_coords.y), false);
+	UnloadRegion(region);
+	region.m_state = StreamedRegionState::FAILED;
+}
+
+void RegionStreamer::DecodeRegion(int regionIndex, DecodedRegion& out_decoded) const
+{
+	StreamedRegion const& region = m_regions[regionIndex];
+	out_decoded.m_regionIndex = regionIndex;
+	out_decoded.m_slotIndexes.clear();
+	out_decoded.m_records.clear();
+
+	out_decoded.m_isValid = m_reader.DecodeEntityRecords((int)region.m_firstEntityRecord, (int)region.m_numEntityRecords, out_decoded.m_slotIndexes, out_decoded.m_records);
+	for (uint32_t chunkIndex = 0; chunkIndex < region.m_numTileChunks && out_decoded.m_isValid; chunkIndex++)
+	{
+		out_decoded.m_isValid = m_reader.DecodeTileChunk((int)(region.m_firstTileChunk + chunkIndex), out_decoded.m_slotIndexes, out_decoded.m_records);
+	}
+
+	// Slots outside the map are dropped here so construction can index m_entities without checks
+	for (int recordIndex = 0; recordIndex < (int)out_decoded.m_slotIndexes.size() && out_decoded.m_isValid; recordIndex++)
+	{
+		out_decoded.m_isValid = out_decoded.m_slotIndexes[recordIndex] < (uint32_t)m_numEntitySlots;
+	}
+}
+
+void RegionStreamer::WorkerMain()
+{
+	while (true)
+	{
+		int regionIndex = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this]() { return m_isQuitting || !m_pendingRegionIndexes.empty(); });
+			if (m_isQuitting)
+			{
+				return;
+			}
+
+			regionIndex = m_pendingRegionIndexes.front();
+			m_pendingRegionIndexes.pop_front();
+		}
+
+		// Only the immutable region table and the mapped view are touched here, so decoding needs no lock
+		DecodedRegion decoded;
+		DecodeRegion(regionIndex, decoded);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_completedRegions.push_back(std::move(decoded));
+	}
+}
+
+StreamedRegion* RegionStreamer::FindRegion(IntVec2 const& coords)
+{
+	auto regionIter = m_regionIndexesByKey.find(GetMapRegionKey(coords));
+	if (regionIter == m_regionIndexesByKey.end())
+	{
+		return nullptr;
+	}
+
+	return &m_regions[regionIter->second];
+}
+
+float RegionStreamer::GetDistanceSquaredToRegion(StreamedRegion const& region, Vec3 const& position) const
+{
+	float minX = (float)region.m_coords.x * MAP_REGION_SIZE;
+	float minY = (float)region.m_coords.y * MAP_REGION_SIZE;
+	float deltaX = position.x - GetClamped(position.x, minX, minX + MAP_REGION_SIZE);
+	float deltaY = position.y - GetClamped(position.y, minY, minY + MAP_REGION_SIZE);
+	return deltaX * deltaX + deltaY * deltaY;
+}
+
+bool RegionStreamer::IsEntityConsumed(Entity const* entity)
+{
+	// Collected coins and dead orcs are remembered so they stay gone when their region comes back
+	if (entity->m_type == EntityType::COIN)
+	{
+		return ((Coin const*)entity)->m_isCollected;
+	}
+	if (entity->m_type == EntityType::ENEMY_ORC)
+	{
+		return ((Enemy_Orc const*)entity)->m_isDead;
+	}
+
+	return false;
+}
+
+bool RegionStreamer::SaveEntityState(Entity const* entity, StreamedEntityState& out_state)
+{
+	out_state.m_record = entity->GetMapRecord();
+	out_state.m_position = entity->m_position;
+	out_state.m_orientation = entity->m_orientation;
+	out_state.m_isConsumed = IsEntityConsumed(entity);
+
+	bool isActivationChanged = false;
+	switch (entity->m_type)
+	{
+		case EntityType::LEVER:
+		{
+			out_state.m_activationValue = ((Lever const*)entity)->m_value;
+			isActivationChanged = out_state.m_activationValue != -1.f;
+			break;
+		}
+		case EntityType::BUTTON:
+		{
+			out_state.m_isActivated = ((Button const*)entity)->m_isPressed;
+			isActivationChanged = out_state.m_isActivated;
+			break;
+		}
+		case EntityType::DOOR:
+		{
+			out_state.m_isActivated = ((Door const*)entity)->m_isOpen;
+			isActivationChanged = out_state.m_isActivated;
+			break;
+		}
+		case EntityType::MOVING_PLATFORM:
+		{
+			out_state.m_activationValue = ((MovingPlatform const*)entity)->m_movementTime;
+			out_state.m_isActivated = ((MovingPlatform const*)entity)->m_isMoving;
+			isActivationChanged = out_state.m_isActivated || out_state.m_activationValue != 0.f;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	// Untouched entities are rebuilt from the map file as they are, so walking past them costs no memory
+	Vec3 const& position = entity->m_position;
+	Vec3 const& editorPosition = entity->m_editorPosition;
+	EulerAngles const& orientation = entity->m_orientation;
+	EulerAngles const& editorOrientation = entity->m_editorOrientation;
+	bool isMoved = position.x != editorPosition.x || position.y != editorPosition.y || position.z != editorPosition.z
+		|| orientation.m_yawDegrees != editorOrientation.m_yawDegrees || orientation.m_pitchDegrees != editorOrientation.m_pitchDegrees || orientation.m_rollDegrees != editorOrientation.m_rollDegrees;
+	return out_state.m_isConsumed || isMoved || isActivationChanged;
+}
+
+void RegionStreamer::RestoreEntityState(Entity* entity, StreamedEntityState const& state)
+{
+	entity->m_position = state.m_position;
+	entity->m_orientation = state.m_orientation;
+
+	switch (entity->m_type)
+	{
+		case EntityType::LEVER:
+		{
+			// The previous value is restored too, so coming back does not fire the lever's edge again
+			Lever* lever = (Lever*)entity;
+			lever->m_value = state.m_activationValue;
+			lever->m_valueLastFrame = state.m_activationValue;
+			break;
+		}
+		case EntityType::BUTTON:
+		{
+			Button* button = (Button*)entity;
+			button->m_isPressed = state.m_isActivated;
+			button->m_wasPressedLastFrame = state.m_isActivated;
+			break;
+		}
+		case EntityType::DOOR:
+		{
+			if (state.m_isActivated)
+			{
+				((Door*)entity)->Activate();
+			}
+			break;
+		}
+		case EntityType::MOVING_PLATFORM:
+		{
+			MovingPlatform* movingPlatform = (MovingPlatform*)entity;
+			movingPlatform->m_movementTime = state.m_activationValue;
+			movingPlatform->m_isMoving = state.m_isActivated;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
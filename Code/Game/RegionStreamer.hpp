@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Game/MapFile.hpp"
+#include "Game/MappedFile.hpp"
+
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+class Entity;
+class Map;
+
+
+enum class StreamedRegionState
+{
+	UNLOADED,
+	DECODING,
+	DECODED,
+	RESIDENT,
+	FAILED
+};
+
+// Records copied out of the mapped file by the worker, the main thread turns them into entities
+struct DecodedRegion
+{
+public:
+	int m_regionIndex = -1;
+	bool m_isValid = true;
+	std::vector<uint32_t> m_slotIndexes;
+	std::vector<MapEntityRecord> m_records;
+};
+
+struct StreamedEntity
+{
+public:
+	Entity* m_entity = nullptr;
+	uint32_t m_slotIndex = 0;
+	int m_homeRegionIndex = -1;
+};
+
+// Runtime state of an unloaded entity that no longer matches its map file record, it is rebuilt from this when its region comes back
+// m_regionIndex is where the entity was when it unloaded, which is not its home region if it was pushed or walked across a border
+struct StreamedEntityState
+{
+public:
+	MapEntityRecord m_record;
+	Vec3 m_position = Vec3::ZERO;
+	EulerAngles m_orientation = EulerAngles::ZERO;
+	float m_activationValue = 0.f;
+	bool m_isActivated = false;
+	bool m_isConsumed = false;
+	int m_regionIndex = -1;
+	int m_homeRegionIndex = -1;
+};
+
+struct StreamedRegion
+{
+public:
+	IntVec2 m_coords = IntVec2::ZERO;
+	uint32_t m_firstEntityRecord = 0;
+	uint32_t m_numEntityRecords = 0;
+	uint32_t m_firstTileChunk = 0;
+	uint32_t m_numTileChunks = 0;
+	StreamedRegionState m_state = StreamedRegionState::UNLOADED;
+	DecodedRegion m_decoded;
+	int m_numRecordsConstructed = 0;
+	std::vector<StreamedEntity> m_entities;
+};
+
+
+// Keeps only the regions of a large map around the player alive during play
+// Records are decoded off the main thread and entity construction is spread over frames, so crossing into a new region never stalls on the whole level
+class RegionStreamer
+{
+public:
+	~RegionStreamer();
+	RegionStreamer(Map* map, std::string const& mapFilePath);
+	RegionStreamer(RegionStreamer const& copy) = delete;
+	RegionStreamer& operator=(RegionStreamer const& copy) = delete;
+
+	static bool IsStreamable(MapFileReader const& reader);
+
+	void LoadRegionsAroundNow(Vec3 const& focusPosition);
+	void Update(Vec3 const& focusPosition);
+	float GetResidentFractionAround(Vec3 const& focusPosition) const;
+
+public:
+	static constexpr int MIN_ENTITIES_TO_STREAM = 20000;
+	static constexpr int MAX_ENTITIES_CONSTRUCTED_PER_FRAME = 256;
+	static constexpr float RESIDENT_RADIUS = 64.f;
+	static constexpr float PREFETCH_RADIUS = 96.f;
+	static constexpr float UNLOAD_RADIUS = 112.f;
+
+	Map* m_map = nullptr;
+	int m_numResidentRegions = 0;
+	int m_numResidentEntities = 0;
+
+private:
+	void RequestRegionsAround(Vec3 const& focusPosition);
+	void CollectDecodedRegions(Vec3 const& focusPosition);
+	bool ConstructNearbyRegions(Vec3 const& focusPosition, int maxEntitiesToConstruct);
+	bool ConstructStrandedEntities(StreamedRegion& region);
+	void ConstructEntity(StreamedRegion& region, uint32_t slotIndex, int homeRegionIndex, MapEntityRecord const& record, StreamedEntityState const* state);
+	bool UnloadDistantRegions(Vec3 const& focusPosition);
+	void UnloadRegion(StreamedRegion& region);
+	void FailRegion(StreamedRegion& region);
+	void DecodeRegion(int regionIndex, DecodedRegion& out_decoded) const;
+	void WorkerMain();
+
+	StreamedRegion* FindRegion(IntVec2 const& coords);
+	float GetDistanceSquaredToRegion(StreamedRegion const& region, Vec3 const& position) const;
+	static bool IsEntityConsumed(Entity const* entity);
+	static bool SaveEntityState(Entity const* entity, StreamedEntityState& out_state);
+	static void RestoreEntityState(Entity* entity, StreamedEntityState const& state);
+
+private:
+	MappedFile m_mappedFile;
+	MapFileReader m_reader;
+	int m_numEntitySlots = 0;
+	std::vector<StreamedRegion> m_regions;
+	std::unordered_map<long long, int> m_regionIndexesByKey;
+	std::vector<int> m_activeRegionIndexes;
+	std::unordered_map<uint32_t, uint8_t> m_movementDirectionsBySlot;
+	std::unordered_map<uint32_t, StreamedEntityState> m_entityStatesBySlot;
+	std::unordered_map<int, std::vector<uint32_t>> m_strandedSlotsByRegion;
+
+	std::thread m_workerThread;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::deque<int> m_pendingRegionIndexes;
+	std::vector<DecodedRegion> m_completedRegions;
+	bool m_isQuitting = false;
+};
@@ -0,0 +1,325 @@
+#include "Game/RenderQueue.hpp"
+
+#include "Game/App.hpp"
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/ConstantBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+static constexpr int SHADER_ID_BITS = 7;
+static constexpr int TEXTURE_ID_BITS = 8;
+static constexpr int GEOMETRY_ID_BITS = 16;
+static constexpr int DEPTH_BITS = 20;
+static constexpr unsigned long long MAX_QUANTIZED_DEPTH = (1ull << DEPTH_BITS) - 1ull;
+
+
+void RenderQueue::BeginFrame(Vec3 const& sortOrigin)
+{
+	m_sortOrigin = sortOrigin;
+	m_commands.clear();
+	m_sortedCommands.clear();
+	m_numVertexArraysUsed = 0;
+	m_numViewsLastFrame = 0;
+	m_isSorted = false;
+}
+
+void RenderQueue::Submit(RenderCommand const& command)
+{
+	m_sortedCommands.push_back(std::make_pair(ComputeSortKey(command), (int)m_commands.size()));
+	m_commands.push_back(command);
+}
+
+void RenderQueue::SubmitIndexed(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, int indexCount)
+{
+	RenderCommand command;
+	command.m_state = state;
+	command.m_modelMatrix = modelMatrix;
+	command.m_modelColor = modelColor;
+	command.m_sortPosition = modelMatrix.GetTranslation3D();
+	command.m_vertexBuffer = vertexBuffer;
+	command.m_indexBuffer = indexBuffer;
+	command.m_count = indexCount;
+	Submit(command);
+}
+
+void RenderQueue::SubmitVertexes(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, VertexBuffer* vertexBuffer, int vertexCount)
+{
+	RenderCommand command;
+	command.m_state = state;
+	command.m_modelMatrix = modelMatrix;
+	command.m_modelColor = modelColor;
+	command.m_sortPosition = modelMatrix.GetTranslation3D();
+	command.m_vertexBuffer = vertexBuffer;
+	command.m_count = vertexCount;
+	Submit(command);
+}
+
+void RenderQueue::SubmitVertexArray(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, std::vector<Vertex_PCU>& vertexes)
+{
+	if (vertexes.empty())
+	{
+		return;
+	}
+
+	// Arrays are swapped into pooled storage so their capacity is reused by the next view
+	if (m_numVertexArraysUsed == (int)m_vertexArrays.size())
+	{
+		m_vertexArrays.push_back(std::vector<Vertex_PCU>());
+	}
+	std::vector<Vertex_PCU>& pooledVertexes = m_vertexArrays[m_numVertexArraysUsed];
+	pooledVertexes.clear();
+	pooledVertexes.swap(vertexes);
+
+	RenderCommand command;
+	command.m_state = state;
+	command.m_modelMatrix = modelMatrix;
+	command.m_modelColor = modelColor;
+	command.m_sortPosition = modelMatrix.GetTranslation3D();
+	command.m_count = (int)pooledVertexes.size();
+	command.m_vertexArrayIndex = m_numVertexArraysUsed;
+	m_numVertexArraysUsed++;
+	Submit(command);
+}
+
+void RenderQueue::Sort()
+{
+	// Replaying in submission order without issuing anything shows how much of the saving comes from the sort
+	RenderStateCache unsortedCache;
+	m_numStateChangesUnsortedLastView = 0;
+	for (int commandIndex = 0; commandIndex < (int)m_commands.size(); commandIndex++)
+	{
+		m_numStateChangesUnsortedLastView += ApplyStateChanges(unsortedCache, m_commands[commandIndex], false);
+	}
+
+	std::sort(m_sortedCommands.begin(), m_sortedCommands.end());
+	m_isSorted = true;
+}
+
+void RenderQueue::Execute(Vec3 const& eyePosition)
+{
+	GUARANTEE_OR_DIE(m_isSorted, "RenderQueue must be sorted once per frame before any view executes it");
+
+	// Every view replays the same sorted commands, only the lighting eye position differs between them
+	m_eyePosition = eyePosition;
+	m_numViewsLastFrame++;
+	m_numCommandsLastView = (int)m_commands.size();
+	m_numStateChangesRequestedLastView = m_numCommandsLastView * NUM_STATES_PER_COMMAND;
+
+	// Nothing is known about what was bound before the queue runs, so the first command sets everything
+	RenderStateCache cache;
+	m_numStateChangesIssuedLastView = 0;
+	for (int sortedIndex = 0; sortedIndex < (int)m_sortedCommands.size(); sortedIndex++)
+	{
+		RenderCommand const& command = m_commands[m_sortedCommands[sortedIndex].second];
+		m_numStateChangesIssuedLastView += ApplyStateChanges(cache, command, true);
+		Draw(command);
+	}
+}
+
+bool RenderQueue::Event_RenderQueueStats(EventArgs& args)
+{
+	UNUSED(args);
+
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap)
+	{
+		return false;
+	}
+
+	RenderQueue const& queue = currentMap->m_renderQueue;
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Render commands last view: %d, built once and replayed by %d views", queue.m_numCommandsLastView, queue.m_numViewsLastFrame), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("State changes: %d set per command, %d deduplicated in submission order, %d deduplicated after sorting", queue.m_numStateChangesRequestedLastView, queue.m_numStateChangesUnsortedLastView, queue.m_numStateChangesIssuedLastView), false);
+	return true;
+}
+
+unsigned long long RenderQueue::ComputeSortKey(RenderCommand const& command)
+{
+	RenderState const& state = command.m_state;
+
+	unsigned long long stateBits = GetResourceID(m_shaderIDs, state.m_shader, SHADER_ID_BITS);
+	stateBits = (stateBits << 2) | (unsigned long long)(((int)state.m_lighting + 1) & 0x3);
+	stateBits = (stateBits << 2) | (unsigned long long)((int)state.m_blendMode & 0x3);
+	stateBits = (stateBits << 2) | (unsigned long long)((int)state.m_depthMode & 0x3);
+	stateBits = (stateBits << 2) | (unsigned long long)((int)state.m_cullMode & 0x3);
+	stateBits = (stateBits << 1) | (unsigned long long)((int)state.m_fillMode & 0x1);
+	stateBits = (stateBits << 3) | (unsigned long long)((int)state.m_samplerMode & 0x7);
+	stateBits = (stateBits << TEXTURE_ID_BITS) | GetResourceID(m_textureIDs, state.m_texture, TEXTURE_ID_BITS);
+
+	unsigned long long geometryID = GetResourceID(m_geometryIDs, command.m_vertexBuffer, GEOMETRY_ID_BITS);
+
+	// Depth is measured from the head rather than each eye, the few centimeters between them rarely change the order
+	float distanceFraction = GetClamped(GetDistance3D(command.m_sortPosition, m_sortOrigin) / FAR_PLANE_DISTANCE, 0.f, 1.f);
+	unsigned long long quantizedDepth = (unsigned long long)(distanceFraction * (float)MAX_QUANTIZED_DEPTH);
+
+	// Opaque draws group by state then geometry and go front to back, blended draws must go back to front before anything else
+	if (state.m_blendMode == BlendMode::OPAQUE)
+	{
+		return (stateBits << (GEOMETRY_ID_BITS + DEPTH_BITS)) | (geometryID << DEPTH_BITS) | quantizedDepth;
+	}
+
+	return (1ull << 63) | ((MAX_QUANTIZED_DEPTH - quantizedDepth) << 43) | (stateBits << GEOMETRY_ID_BITS) | geometryID;
+}
+
+int RenderQueue::ApplyStateChanges(RenderStateCache& cache, RenderCommand const& command, bool issueCalls) const
+{
+	RenderState const& state = command.m_state;
+	RenderState& current = cache.m_state;
+	bool isForced = !cache.m_isValid;
+	int numChanges = 0;
+
+	if (isForced || state.m_shader != current.m_shader)
+	{
+		if (issueCalls)
+		{
+			g_renderer->BindShader(state.m_shader);
+		}
+		numChanges++;
+	}
+
+	// Shaders that ignore lighting leave whatever was last uploaded in place
+	if (state.m_lighting != RenderLighting::NONE && (isForced || state.m_lighting != current.m_lighting))
+	{
+		if (issueCalls)
+		{
+			if (state.m_lighting == RenderLighting::SUN)
+			{
+				g_renderer->SetLightConstants(SUN_DIRECTION.GetNormalized(), SUN_INTENSITY, 1.f - SUN_INTENSITY, m_eyePosition);
+			}
+			else
+			{
+				g_renderer->SetLightConstants(Vec3::ZERO, 0.f, 1.f);
+			}
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_blendMode != current.m_blendMode)
+	{
+		if (issueCalls)
+		{
+			g_renderer->SetBlendMode(state.m_blendMode);
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_depthMode != current.m_depthMode)
+	{
+		if (issueCalls)
+		{
+			g_renderer->SetDepthMode(state.m_depthMode);
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_cullMode != current.m_cullMode)
+	{
+		if (issueCalls)
+		{
+			g_renderer->SetRasterizerCullMode(state.m_cullMode);
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_fillMode != current.m_fillMode)
+	{
+		if (issueCalls)
+		{
+			g_renderer->SetRasterizerFillMode(state.m_fillMode);
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_samplerMode != current.m_samplerMode)
+	{
+		if (issueCalls)
+		{
+			g_renderer->SetSamplerMode(state.m_samplerMode);
+		}
+		numChanges++;
+	}
+
+	if (isForced || state.m_texture != current.m_texture)
+	{
+		if (issueCalls)
+		{
+			g_renderer->BindTexture(state.m_texture);
+		}
+		numChanges++;
+	}
+
+	RenderLighting boundLighting = state.m_lighting != RenderLighting::NONE ? state.m_lighting : current.m_lighting;
+	current = state;
+	current.m_lighting = boundLighting;
+	cache.m_isValid = true;
+
+	if (command.m_usesModelConstants)
+	{
+		Rgba8 const& color = command.m_modelColor;
+		Rgba8 const& boundColor = cache.m_modelColor;
+		bool isSameColor = color.r == boundColor.r && color.g == boundColor.g && color.b == boundColor.b && color.a == boundColor.a;
+		if (!cache.m_hasModelConstants || !isSameColor || memcmp(&command.m_modelMatrix, &cache.m_modelMatrix, sizeof(Mat44)) != 0)
+		{
+			if (issueCalls)
+			{
+				g_renderer->SetModelConstants(command.m_modelMatrix, command.m_modelColor);
+			}
+			cache.m_hasModelConstants = true;
+			cache.m_modelMatrix = command.m_modelMatrix;
+			cache.m_modelColor = command.m_modelColor;
+			numChanges++;
+		}
+	}
+
+	return numChanges;
+}
+
+void RenderQueue::Draw(RenderCommand const& command) const
+{
+	if (command.m_constantBuffer)
+	{
+		g_renderer->CopyCPUToGPU(const_cast<void*>(command.m_constantData), command.m_constantDataSize, command.m_constantBuffer);
+		g_renderer->BindConstantBuffer(command.m_constantBufferSlot, command.m_constantBuffer);
+	}
+
+	if (command.m_vertexArrayIndex >= 0)
+	{
+		g_renderer->DrawVertexArray(m_vertexArrays[command.m_vertexArrayIndex]);
+	}
+	else if (command.m_indexBuffer)
+	{
+		g_renderer->DrawIndexBuffer(command.m_vertexBuffer, command.m_indexBuffer, command.m_count);
+	}
+	else if (command.m_vertexBuffer)
+	{
+		g_renderer->DrawVertexBuffer(command.m_vertexBuffer, command.m_count);
+	}
+}
+
+unsigned long long RenderQueue::GetResourceID(std::map<void const*, unsigned long long>& resourceIDs, void const* resource, int numBits)
+{
+	if (!resource)
+	{
+		return 0ull;
+	}
+
+	// IDs only feed the sort key, a collision just groups two resources less tightly
+	auto resourceIter = resourceIDs.find(resource);
+	if (resourceIter == resourceIDs.end())
+	{
+		// Rebuilt buffers keep adding entries, so start over once the IDs would no longer fit
+		if (resourceIDs.size() >= (1ull << numBits) - 1ull)
+		{
+			resourceIDs.clear();
+		}
+		unsigned long long newID = (unsigned long long)resourceIDs.size() + 1ull;
+		resourceIter = resourceIDs.insert(std::make_pair(resource, newID)).first;
+	}
+	return resourceIter->second & ((1ull << numBits) - 1ull);
+}
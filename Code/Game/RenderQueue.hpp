@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+
+class ConstantBuffer;
+class IndexBuffer;
+class Shader;
+class Texture;
+class VertexBuffer;
+
+
+enum class RenderLighting
+{
+	NONE = -1,
+	SUN,
+	FULLBRIGHT,
+	NUM
+};
+
+struct RenderState
+{
+public:
+	Shader* m_shader = nullptr;
+	RenderLighting m_lighting = RenderLighting::NONE;
+	BlendMode m_blendMode = BlendMode::OPAQUE;
+	DepthMode m_depthMode = DepthMode::ENABLED;
+	RasterizerCullMode m_cullMode = RasterizerCullMode::CULL_BACK;
+	RasterizerFillMode m_fillMode = RasterizerFillMode::SOLID;
+	SamplerMode m_samplerMode = SamplerMode::POINT_CLAMP;
+	Texture* m_texture = nullptr;
+};
+
+struct RenderCommand
+{
+public:
+	RenderState m_state;
+	Mat44 m_modelMatrix;
+	Rgba8 m_modelColor = Rgba8::WHITE;
+	bool m_usesModelConstants = true;
+	Vec3 m_sortPosition = Vec3::ZERO;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	IndexBuffer* m_indexBuffer = nullptr;
+	int m_count = 0;
+	int m_vertexArrayIndex = -1;
+
+	// Optional upload done right before the draw, the data must stay alive until the queue is executed
+	ConstantBuffer* m_constantBuffer = nullptr;
+	int m_constantBufferSlot = 0;
+	void const* m_constantData = nullptr;
+	size_t m_constantDataSize = 0;
+};
+
+// What the renderer currently has bound, so replay can skip calls that would not change anything
+struct RenderStateCache
+{
+public:
+	bool m_isValid = false;
+	RenderState m_state;
+	bool m_hasModelConstants = false;
+	Mat44 m_modelMatrix;
+	Rgba8 m_modelColor = Rgba8::WHITE;
+};
+
+
+class RenderQueue
+{
+public:
+	void BeginFrame(Vec3 const& sortOrigin);
+	void Submit(RenderCommand const& command);
+	void SubmitIndexed(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, int indexCount);
+	void SubmitVertexes(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, VertexBuffer* vertexBuffer, int vertexCount);
+	void SubmitVertexArray(RenderState const& state, Mat44 const& modelMatrix, Rgba8 const& modelColor, std::vector<Vertex_PCU>& vertexes);
+	void Sort();
+	void Execute(Vec3 const& eyePosition);
+
+	static bool Event_RenderQueueStats(EventArgs& args);
+
+public:
+	static constexpr int NUM_STATES_PER_COMMAND = 9;
+
+	int m_numViewsLastFrame = 0;
+	int m_numCommandsLastView = 0;
+	int m_numStateChangesRequestedLastView = 0;
+	int m_numStateChangesUnsortedLastView = 0;
+	int m_numStateChangesIssuedLastView = 0;
+
+private:
+	unsigned long long ComputeSortKey(RenderCommand const& command);
+	int ApplyStateChanges(RenderStateCache& cache, RenderCommand const& command, bool issueCalls) const;
+	void Draw(RenderCommand const& command) const;
+
+	static unsigned long long GetResourceID(std::map<void const*, unsigned long long>& resourceIDs, void const* resource, int numBits);
+
+private:
+	Vec3 m_sortOrigin = Vec3::ZERO;
+	Vec3 m_eyePosition = Vec3::ZERO;
+	bool m_isSorted = false;
+	std::vector<RenderCommand> m_commands;
+	std::vector<std::pair<unsigned long long, int>> m_sortedCommands;
+	std::vector<std::vector<Vertex_PCU>> m_vertexArrays;
+	int m_numVertexArraysUsed = 0;
+	std::map<void const*, unsigned long long> m_shaderIDs;
+	std::map<void const*, unsigned long long> m_textureIDs;
+	std::map<void const*, unsigned long long> m_geometryIDs;
+};
@@ -0,0 +1,48 @@
+#include "Game/RetainedGeometry.hpp"
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+
+
+RetainedGeometry::~RetainedGeometry()
+{
+	delete m_vertexBuffer;
+	m_vertexBuffer = nullptr;
+}
+
+void RetainedGeometry::Upload(std::vector<Vertex_PCU> const& vertexes)
+{
+	m_numVertexes = (int)vertexes.size();
+	m_isBuilt = true;
+	m_numUploads++;
+	if (vertexes.empty())
+	{
+		return;
+	}
+
+	// The buffer only grows, shapes that change size every so often settle into one allocation
+	size_t vertexesSize = vertexes.size() * sizeof(Vertex_PCU);
+	if (!m_vertexBuffer || m_vertexBuffer->m_size < vertexesSize)
+	{
+		delete m_vertexBuffer;
+		m_vertexBuffer = g_renderer->CreateVertexBuffer(vertexesSize);
+	}
+	g_renderer->CopyCPUToGPU(vertexes.data(), vertexesSize, m_vertexBuffer);
+}
+
+void RetainedGeometry::Draw() const
+{
+	if (m_numVertexes == 0)
+	{
+		return;
+	}
+
+	g_renderer->DrawVertexBuffer(m_vertexBuffer, m_numVertexes);
+}
+
+bool RetainedGeometry::IsBuilt() const
+{
+	return m_isBuilt;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Engine/Core/Vertex_PCU.hpp"
+
+#include <vector>
+
+
+class VertexBuffer;
+
+
+// Vertexes that stay in a GPU buffer across frames and views, they are only uploaded again when whatever they were built from changes
+class RetainedGeometry
+{
+public:
+	~RetainedGeometry();
+	RetainedGeometry() = default;
+	RetainedGeometry(RetainedGeometry const& copy) = delete;
+	RetainedGeometry& operator=(RetainedGeometry const& copy) = delete;
+
+	void Upload(std::vector<Vertex_PCU> const& vertexes);
+	void Draw() const;
+	bool IsBuilt() const;
+
+public:
+	VertexBuffer* m_vertexBuffer = nullptr;
+	int m_numVertexes = 0;
+	int m_numUploads = 0;
+
+private:
+	bool m_isBuilt = false;
+};
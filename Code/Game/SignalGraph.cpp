@@ -0,0 +1,416 @@
+#include "Game/SignalGraph.hpp"
+
+#include "Game/Activatable.hpp"
+#include "Game/Entity.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapFile.hpp"
+
+#include <algorithm>
+
+
+SignalGraph::SignalGraph(Map* map)
+	: m_map(map)
+{
+}
+
+void SignalGraph::AddEdge(EntityUID activatorUID, EntityUID activatableUID, SignalEdgeType type)
+{
+	if (activatorUID.m_uid == ENTITYUID_INVALID || activatableUID.m_uid == ENTITYUID_INVALID)
+	{
+		return;
+	}
+	if (HasEdge(activatorUID, activatableUID))
+	{
+		return;
+	}
+
+	SignalEdge edge;
+	edge.m_activatorUID = activatorUID;
+	edge.m_activatableUID = activatableUID;
+	edge.m_type = type;
+	m_edges.push_back(edge);
+	m_edgesVersion++;
+	m_isAdjacencyDirty = true;
+}
+
+bool SignalGraph::RemoveEdge(EntityUID activatorUID, EntityUID activatableUID)
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatorUID.m_uid == activatorUID.m_uid && m_edges[edgeIndex].m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			m_edges.erase(m_edges.begin() + edgeIndex);
+			m_edgesVersion++;
+			m_isAdjacencyDirty = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SignalGraph::ToggleEdge(EntityUID activatorUID, EntityUID activatableUID)
+{
+	if (!RemoveEdge(activatorUID, activatableUID))
+	{
+		AddEdge(activatorUID, activatableUID);
+	}
+}
+
+bool SignalGraph::HasEdge(EntityUID activatorUID, EntityUID activatableUID) const
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatorUID.m_uid == activatorUID.m_uid && m_edges[edgeIndex].m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SignalGraph::SetEdgeType(EntityUID activatorUID, EntityUID activatableUID, SignalEdgeType type)
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatorUID.m_uid == activatorUID.m_uid && m_edges[edgeIndex].m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			m_edges[edgeIndex].m_type = type;
+			m_edgesVersion++;
+			return;
+		}
+	}
+}
+
+void SignalGraph::RemoveEdgesForEntity(EntityUID entityUID)
+{
+	unsigned int uid = entityUID.m_uid;
+	m_edges.erase(std::remove_if(m_edges.begin(), m_edges.end(), [uid](SignalEdge const& edge) { return edge.m_activatorUID.m_uid == uid || edge.m_activatableUID.m_uid == uid; }), m_edges.end());
+	m_combinatorsByActivatable.erase(uid);
+	m_edgesVersion++;
+	m_isAdjacencyDirty = true;
+}
+
+void SignalGraph::SetCombinator(EntityUID activatableUID, SignalCombinator combinator)
+{
+	if (combinator == SignalCombinator::OR)
+	{
+		m_combinatorsByActivatable.erase(activatableUID.m_uid);
+		return;
+	}
+
+	m_combinatorsByActivatable[activatableUID.m_uid] = combinator;
+}
+
+SignalCombinator SignalGraph::GetCombinator(EntityUID activatableUID) const
+{
+	auto combinatorIter = m_combinatorsByActivatable.find(activatableUID.m_uid);
+	if (combinatorIter == m_combinatorsByActivatable.end())
+	{
+		return SignalCombinator::OR;
+	}
+
+	return combinatorIter->second;
+}
+
+void SignalGraph::GetActivatablesForActivator(EntityUID activatorUID, std::vector<EntityUID>& out_activatableUIDs) const
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatorUID.m_uid == activatorUID.m_uid)
+		{
+			out_activatableUIDs.push_back(m_edges[edgeIndex].m_activatableUID);
+		}
+	}
+}
+
+void SignalGraph::GetActivatorsForActivatable(EntityUID activatableUID, std::vector<EntityUID>& out_activatorUIDs) const
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			out_activatorUIDs.push_back(m_edges[edgeIndex].m_activatorUID);
+		}
+	}
+}
+
+EntityUID SignalGraph::GetFirstActivatableForActivator(EntityUID activatorUID) const
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatorUID.m_uid == activatorUID.m_uid)
+		{
+			return m_edges[edgeIndex].m_activatableUID;
+		}
+	}
+
+	return EntityUID::INVALID;
+}
+
+EntityUID SignalGraph::GetFirstActivatorForActivatable(EntityUID activatableUID) const
+{
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		if (m_edges[edgeIndex].m_activatableUID.m_uid == activatableUID.m_uid)
+		{
+			return m_edges[edgeIndex].m_activatorUID;
+		}
+	}
+
+	return EntityUID::INVALID;
+}
+
+void SignalGraph::EmitSignal(EntityUID activatorUID, bool isOn)
+{
+	SignalEvent signalEvent;
+	signalEvent.m_activatorUID = activatorUID;
+	signalEvent.m_isOn = isOn;
+	m_pendingEvents.push_back(signalEvent);
+}
+
+void SignalGraph::DispatchSignals()
+{
+	if (m_pendingEvents.empty() && !m_shouldEvaluateAll)
+	{
+		return;
+	}
+
+	if (m_isAdjacencyDirty)
+	{
+		RebuildAdjacency();
+	}
+
+	m_activatablesToEvaluate.clear();
+
+	if (m_shouldEvaluateAll)
+	{
+		for (auto edgeIndexesIter = m_edgeIndexesByActivatable.begin(); edgeIndexesIter != m_edgeIndexesByActivatable.end(); ++edgeIndexesIter)
+		{
+			m_activatablesToEvaluate.push_back(edgeIndexesIter->first);
+		}
+		m_shouldEvaluateAll = false;
+	}
+
+	for (int eventIndex = 0; eventIndex < (int)m_pendingEvents.size(); eventIndex++)
+	{
+		SignalEvent const& signalEvent = m_pendingEvents[eventIndex];
+		m_activatorStates[signalEvent.m_activatorUID.m_uid] = signalEvent.m_isOn;
+
+		auto edgeIndexesIter = m_edgeIndexesByActivator.find(signalEvent.m_activatorUID.m_uid);
+		if (edgeIndexesIter == m_edgeIndexesByActivator.end())
+		{
+			continue;
+		}
+
+		std::vector<int> const& edgeIndexes = edgeIndexesIter->second;
+		for (int edgeIndex = 0; edgeIndex < (int)edgeIndexes.size(); edgeIndex++)
+		{
+			m_activatablesToEvaluate.push_back(m_edges[edgeIndexes[edgeIndex]].m_activatableUID.m_uid);
+		}
+	}
+	m_pendingEvents.clear();
+
+	std::sort(m_activatablesToEvaluate.begin(), m_activatablesToEvaluate.end());
+	m_activatablesToEvaluate.erase(std::unique(m_activatablesToEvaluate.begin(), m_activatablesToEvaluate.end()), m_activatablesToEvaluate.end());
+
+	for (int activatableIndex = 0; activatableIndex < (int)m_activatablesToEvaluate.size(); activatableIndex++)
+	{
+		unsigned int activatableUID = m_activatablesToEvaluate[activatableIndex];
+		bool isActive = EvaluateActivatable(activatableUID);
+		bool& wasActive = m_activatableStates[activatableUID];
+		if (isActive == wasActive)
+		{
+			continue;
+		}
+		wasActive = isActive;
+
+		Entity* entity = m_map->GetEntityFromUID(activatableUID);
+		if (!entity || !entity->IsActivatable())
+		{
+			continue;
+		}
+
+		Activatable* activatable = (Activatable*)entity;
+		if (isActive)
+		{
+			activatable->Activate();
+		}
+		else
+		{
+			activatable->Deactivate();
+		}
+	}
+}
+
+void SignalGraph::ResetSignals()
+{
+	m_activatorStates.clear();
+	m_activatableStates.clear();
+	m_pendingEvents.clear();
+	m_shouldEvaluateAll = true;
+}
+
+void SignalGraph::OnEntityStreamedIn(Entity* entity)
+{
+	// Streamed entities are constructed in their default state, so an activatable catches up with whatever the graph settled on while it was unloaded
+	if (!entity->IsActivatable())
+	{
+		return;
+	}
+
+	auto stateIter = m_activatableStates.find(entity->m_uid.m_uid);
+	if (stateIter != m_activatableStates.end() && stateIter->second)
+	{
+		((Activatable*)entity)->Activate();
+	}
+}
+
+void SignalGraph::AppendToBuffer(BufferWriter& writer) const
+{
+	writer.AppendUint32((uint32_t)m_edges.size());
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		writer.AppendUint32(m_edges[edgeIndex].m_activatorUID.m_uid);
+		writer.AppendUint32(m_edges[edgeIndex].m_activatableUID.m_uid);
+		writer.AppendByte((uint8_t)m_edges[edgeIndex].m_type);
+	}
+
+	writer.AppendUint32((uint32_t)m_combinatorsByActivatable.size());
+	for (auto combinatorIter = m_combinatorsByActivatable.begin(); combinatorIter != m_combinatorsByActivatable.end(); ++combinatorIter)
+	{
+		writer.AppendUint32(combinatorIter->first);
+		writer.AppendByte((uint8_t)combinatorIter->second);
+	}
+}
+
+void SignalGraph::ParseFromBuffer(BufferParser& parser)
+{
+	m_edges.clear();
+	m_edgesVersion++;
+	m_combinatorsByActivatable.clear();
+
+	uint32_t numEdges = parser.ParseUint32();
+	for (int edgeIndex = 0; edgeIndex < (int)numEdges; edgeIndex++)
+	{
+		EntityUID activatorUID(parser.ParseUint32());
+		EntityUID activatableUID(parser.ParseUint32());
+		SignalEdgeType type = (SignalEdgeType)parser.ParseByte();
+		AddEdge(activatorUID, activatableUID, type);
+	}
+
+	uint32_t numCombinators = parser.ParseUint32();
+	for (int combinatorIndex = 0; combinatorIndex < (int)numCombinators; combinatorIndex++)
+	{
+		EntityUID activatableUID(parser.ParseUint32());
+		SignalCombinator combinator = (SignalCombinator)parser.ParseByte();
+		SetCombinator(activatableUID, combinator);
+	}
+
+	m_isAdjacencyDirty = true;
+	m_shouldEvaluateAll = true;
+}
+
+void SignalGraph::AppendToMapFile(MapFileContents& contents) const
+{
+	contents.m_signalEdges.reserve(m_edges.size());
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		MapSignalEdgeRecord edgeRecord;
+		edgeRecord.m_activatorUID = m_edges[edgeIndex].m_activatorUID.m_uid;
+		edgeRecord.m_activatableUID = m_edges[edgeIndex].m_activatableUID.m_uid;
+		edgeRecord.m_type = (uint8_t)m_edges[edgeIndex].m_type;
+		contents.m_signalEdges.push_back(edgeRecord);
+	}
+
+	for (auto combinatorIter = m_combinatorsByActivatable.begin(); combinatorIter != m_combinatorsByActivatable.end(); ++combinatorIter)
+	{
+		MapSignalCombinatorRecord combinatorRecord;
+		combinatorRecord.m_activatableUID = combinatorIter->first;
+		combinatorRecord.m_combinator = (uint8_t)combinatorIter->second;
+		contents.m_signalCombinators.push_back(combinatorRecord);
+	}
+}
+
+void SignalGraph::LoadFromMapFile(MapFileContents const& contents)
+{
+	m_edges.clear();
+	m_edgesVersion++;
+	m_combinatorsByActivatable.clear();
+
+	m_edges.reserve(contents.m_signalEdges.size());
+	for (int edgeIndex = 0; edgeIndex < (int)contents.m_signalEdges.size(); edgeIndex++)
+	{
+		// Saved edges are already unique, so they skip the duplicate scan AddEdge does
+		MapSignalEdgeRecord const& edgeRecord = contents.m_signalEdges[edgeIndex];
+		if (edgeRecord.m_activatorUID == ENTITYUID_INVALID || edgeRecord.m_activatableUID == ENTITYUID_INVALID)
+		{
+			continue;
+		}
+
+		SignalEdge edge;
+		edge.m_activatorUID = EntityUID(edgeRecord.m_activatorUID);
+		edge.m_activatableUID = EntityUID(edgeRecord.m_activatableUID);
+		edge.m_type = (SignalEdgeType)edgeRecord.m_type;
+		m_edges.push_back(edge);
+	}
+
+	for (int combinatorIndex = 0; combinatorIndex < (int)contents.m_signalCombinators.size(); combinatorIndex++)
+	{
+		MapSignalCombinatorRecord const& combinatorRecord = contents.m_signalCombinators[combinatorIndex];
+		SetCombinator(EntityUID(combinatorRecord.m_activatableUID), (SignalCombinator)combinatorRecord.m_combinator);
+	}
+
+	m_isAdjacencyDirty = true;
+	m_shouldEvaluateAll = true;
+}
+
+void SignalGraph::RebuildAdjacency()
+{
+	m_edgeIndexesByActivator.clear();
+	m_edgeIndexesByActivatable.clear();
+
+	for (int edgeIndex = 0; edgeIndex < (int)m_edges.size(); edgeIndex++)
+	{
+		m_edgeIndexesByActivator[m_edges[edgeIndex].m_activatorUID.m_uid].push_back(edgeIndex);
+		m_edgeIndexesByActivatable[m_edges[edgeIndex].m_activatableUID.m_uid].push_back(edgeIndex);
+	}
+
+	m_isAdjacencyDirty = false;
+}
+
+bool SignalGraph::EvaluateActivatable(unsigned int activatableUID) const
+{
+	auto edgeIndexesIter = m_edgeIndexesByActivatable.find(activatableUID);
+	if (edgeIndexesIter == m_edgeIndexesByActivatable.end())
+	{
+		return false;
+	}
+
+	SignalCombinator combinator = GetCombinator(EntityUID(activatableUID));
+	std::vector<int> const& edgeIndexes = edgeIndexesIter->second;
+	for (int edgeIndex = 0; edgeIndex < (int)edgeIndexes.size(); edgeIndex++)
+	{
+		SignalEdge const& edge = m_edges[edgeIndexes[edgeIndex]];
+
+		bool isActivatorOn = false;
+		auto activatorStateIter = m_activatorStates.find(edge.m_activatorUID.m_uid);
+		if (activatorStateIter != m_activatorStates.end())
+		{
+			isActivatorOn = activatorStateIter->second;
+		}
+
+		bool isEdgeOn = (edge.m_type == SignalEdgeType::INVERTED) ? !isActivatorOn : isActivatorOn;
+		if (combinator == SignalCombinator::OR && isEdgeOn)
+		{
+			return true;
+		}
+		if (combinator == SignalCombinator::AND && !isEdgeOn)
+		{
+			return false;
+		}
+	}
+
+	return combinator == SignalCombinator::AND;
+}
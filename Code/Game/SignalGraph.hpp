@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Game/EntityUID.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+
+class Map;
+struct MapFileContents;
+
+
+enum class SignalEdgeType : uint8_t
+{
+	DIRECT,
+	INVERTED,
+	NUM
+};
+
+enum class SignalCombinator : uint8_t
+{
+	OR,
+	AND,
+	NUM
+};
+
+struct SignalEdge
+{
+	EntityUID m_activatorUID = EntityUID::INVALID;
+	EntityUID m_activatableUID = EntityUID::INVALID;
+	SignalEdgeType m_type = SignalEdgeType::DIRECT;
+};
+
+struct SignalEvent
+{
+	EntityUID m_activatorUID = EntityUID::INVALID;
+	bool m_isOn = false;
+};
+
+
+class SignalGraph
+{
+public:
+	~SignalGraph() = default;
+	SignalGraph() = default;
+	explicit SignalGraph(Map* map);
+
+	void AddEdge(EntityUID activatorUID, EntityUID activatableUID, SignalEdgeType type = SignalEdgeType::DIRECT);
+	bool RemoveEdge(EntityUID activatorUID, EntityUID activatableUID);
+	void ToggleEdge(EntityUID activatorUID, EntityUID activatableUID);
+	bool HasEdge(EntityUID activatorUID, EntityUID activatableUID) const;
+	void SetEdgeType(EntityUID activatorUID, EntityUID activatableUID, SignalEdgeType type);
+	void RemoveEdgesForEntity(EntityUID entityUID);
+
+	void SetCombinator(EntityUID activatableUID, SignalCombinator combinator);
+	SignalCombinator GetCombinator(EntityUID activatableUID) const;
+
+	void GetActivatablesForActivator(EntityUID activatorUID, std::vector<EntityUID>& out_activatableUIDs) const;
+	void GetActivatorsForActivatable(EntityUID activatableUID, std::vector<EntityUID>& out_activatorUIDs) const;
+	EntityUID GetFirstActivatableForActivator(EntityUID activatorUID) const;
+	EntityUID GetFirstActivatorForActivatable(EntityUID activatableUID) const;
+
+	void EmitSignal(EntityUID activatorUID, bool isOn);
+	void DispatchSignals();
+	void ResetSignals();
+	void OnEntityStreamedIn(Entity* entity);
+
+	void AppendToBuffer(BufferWriter& writer) const;
+	void ParseFromBuffer(BufferParser& parser);
+	void AppendToMapFile(MapFileContents& contents) const;
+	void LoadFromMapFile(MapFileContents const& contents);
+
+public:
+	Map* m_map = nullptr;
+	std::vector<SignalEdge> m_edges;
+	unsigned int m_edgesVersion = 0;
+
+private:
+	void RebuildAdjacency();
+	bool EvaluateActivatable(unsigned int activatableUID) const;
+
+private:
+	std::unordered_map<unsigned int, SignalCombinator> m_combinatorsByActivatable;
+	std::unordered_map<unsigned int, bool> m_activatorStates;
+	std::unordered_map<unsigned int, bool> m_activatableStates;
+	std::unordered_map<unsigned int, std::vector<int>> m_edgeIndexesByActivator;
+	std::unordered_map<unsigned int, std::vector<int>> m_edgeIndexesByActivatable;
+	std::vector<SignalEvent> m_pendingEvents;
+	std::vector<unsigned int> m_activatablesToEvaluate;
+	bool m_isAdjacencyDirty = true;
+	bool m_shouldEvaluateAll = true;
+};
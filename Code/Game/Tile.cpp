@@ -3,6 +3,7 @@
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/HandController.hpp"
+#include "Game/InstancedModel.hpp"
 #include "Game/Map.hpp"
 #include "Game/Player.hpp"
 #include "Game/PlayerPawn.hpp"
@@ -27,20 +28,25 @@ void Tile::Update()
 	Entity::Update();
 }
 
-void Tile::Render() const
+void Tile::Render(RenderQueue& queue) const
 {
 	Mat44 transform = Mat44::CreateTranslation3D(m_position);
 	transform.Append(m_orientation.GetAsMatrix_iFwd_jLeft_kUp());
 	transform.AppendScaleUniform3D(m_scale);
 
-	g_renderer->SetBlendMode(BlendMode::OPAQUE);
-	g_renderer->SetDepthMode(DepthMode::ENABLED);
-	g_renderer->SetRasterizerCullMode(RasterizerCullMode::CULL_BACK);
-	g_renderer->SetRasterizerFillMode(RasterizerFillMode::SOLID);
-	g_renderer->SetSamplerMode(SamplerMode::POINT_CLAMP);
-	g_renderer->BindTexture(nullptr);
-	g_renderer->SetModelConstants(transform, GetColor());
-	g_renderer->DrawIndexBuffer(m_model->GetVertexBuffer(), m_model->GetIndexBuffer(), m_model->GetIndexCount());
+	RenderState state = m_map->GetDefaultRenderState();
+	m_model->Submit(queue, state, transform, GetColor());
+}
+
+bool Tile::AddModelInstances(ModelInstanceRenderer& renderer) const
+{
+	// Baked tiles are drawn with their chunk
+	if (m_isBaked)
+	{
+		return true;
+	}
+
+	return Entity::AddModelInstances(renderer);
 }
 
 void Tile::HandlePlayerInteraction()
@@ -19,10 +19,14 @@ public:
 	Tile(Map* map, EntityUID uid, TileDefinition const& definition, Vec3 const& position, EulerAngles const& orientation, float scale);
 
 	virtual void Update() override;
-	virtual void Render() const override;
+	virtual void Render(RenderQueue& queue) const override;
+	virtual bool AddModelInstances(ModelInstanceRenderer& renderer) const override;
 	virtual void HandlePlayerInteraction() override;
 
 public:
 	TileDefinition m_definition;
+	bool m_isBaked = false;
+	bool m_isInTileChunk = false;
+	long long m_tileChunkKey = 0;
 };
 
@@ -0,0 +1,641 @@
+#include "Game/TileChunkBaker.hpp"
+
+#include "Game/App.hpp"
+#include "Game/Game.hpp"
+#include "Game/InstancedModel.hpp"
+#include "Game/GameMathUtils.hpp"
+#include "Game/Map.hpp"
+#include "Game/RenderQueue.hpp"
+#include "Game/Tile.hpp"
+#include "Game/ViewFrustum.hpp"
+
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/VertexBuffer.hpp"
+
+
+static constexpr int FACE_OFFSETS[(int)TileFaceDirection::NUM][3] =
+{
+	{ 1, 0, 0 },
+	{ -1, 0, 0 },
+	{ 0, 1, 0 },
+	{ 0, -1, 0 },
+	{ 0, 0, 1 },
+	{ 0, 0, -1 },
+};
+
+
+TileChunkBaker::~TileChunkBaker()
+{
+	for (auto chunkIter = m_chunksByKey.begin(); chunkIter != m_chunksByKey.end(); ++chunkIter)
+	{
+		delete chunkIter->second.m_vertexBuffer;
+	}
+}
+
+TileChunkBaker::TileChunkBaker(Map* map)
+	: m_map(map)
+{
+	SubscribeEventCallbackFunction("TileChunkStats", Event_TileChunkStats, "Prints vertex and draw call counts for baked tile chunks");
+}
+
+void TileChunkBaker::OnEntityAdded(Entity* entity)
+{
+	if (m_isDirty || !entity || !IsTileType(entity->m_type))
+	{
+		return;
+	}
+
+	InsertTile((Tile*)entity);
+}
+
+void TileChunkBaker::OnEntityRemoved(Entity* entity)
+{
+	if (m_isDirty || !entity || !IsTileType(entity->m_type))
+	{
+		return;
+	}
+
+	EraseTile((Tile*)entity);
+	for (int tileIndex = 0; tileIndex < (int)m_changedTiles.size(); tileIndex++)
+	{
+		if (m_changedTiles[tileIndex] == entity)
+		{
+			m_changedTiles[tileIndex] = m_changedTiles.back();
+			m_changedTiles.pop_back();
+			tileIndex--;
+		}
+	}
+}
+
+void TileChunkBaker::OnEntityChanged(Entity* entity)
+{
+	if (m_isDirty || !entity || !IsTileType(entity->m_type))
+	{
+		return;
+	}
+
+	// Moves and highlight changes are both settled in Update, once per frame however often a tile was reported
+	m_changedTiles.push_back((Tile*)entity);
+}
+
+void TileChunkBaker::MarkDirty()
+{
+	m_isDirty = true;
+}
+
+void TileChunkBaker::Update()
+{
+	if (m_isDirty)
+	{
+		RebuildAll();
+	}
+
+	for (int tileIndex = 0; tileIndex < (int)m_changedTiles.size(); tileIndex++)
+	{
+		UpdateChangedTile(m_changedTiles[tileIndex]);
+	}
+	m_changedTiles.clear();
+
+	m_numChunksRebuiltLastFrame = 0;
+	for (auto chunkIter = m_chunksByKey.begin(); chunkIter != m_chunksByKey.end(); ++chunkIter)
+	{
+		if (chunkIter->second.m_isDirty)
+		{
+			RebuildChunk(chunkIter->second);
+			m_numChunksRebuiltLastFrame++;
+		}
+	}
+}
+
+int TileChunkBaker::BakeDirtyChunks(double endTimeSeconds)
+{
+	if (m_isDirty)
+	{
+		RebuildAll();
+	}
+
+	// Lets a loading screen spread the first bake over frames, whatever is left when time runs out is counted and picked up by the next call or by Update
+	int numDirtyChunks = 0;
+	for (auto chunkIter = m_chunksByKey.begin(); chunkIter != m_chunksByKey.end(); ++chunkIter)
+	{
+		if (!chunkIter->second.m_isDirty)
+		{
+			continue;
+		}
+
+		if (GetCurrentTimeSeconds() < endTimeSeconds)
+		{
+			RebuildChunk(chunkIter->second);
+		}
+		else
+		{
+			numDirtyChunks++;
+		}
+	}
+
+	return numDirtyChunks;
+}
+
+void TileChunkBaker::CollectVisibleChunks(ViewFrustum const& frustum, std::vector<TileChunk const*>& out_visibleChunks)
+{
+	m_numChunksDrawn = 0;
+	m_numChunksCulled = 0;
+
+	for (auto chunkIter = m_chunksByKey.begin(); chunkIter != m_chunksByKey.end(); ++chunkIter)
+	{
+		TileChunk const& chunk = chunkIter->second;
+		if (chunk.m_tiles.empty())
+		{
+			continue;
+		}
+
+		if (frustum.IsAABB3Visible(chunk.m_bounds))
+		{
+			out_visibleChunks.push_back(&chunk);
+			m_numChunksDrawn++;
+		}
+		else
+		{
+			m_numChunksCulled++;
+		}
+	}
+}
+
+void TileChunkBaker::CollectTilesInBounds(AABB3 const& bounds, std::vector<Entity*>& out_tiles)
+{
+	if (m_isDirty)
+	{
+		RebuildAll();
+	}
+
+	// Chunked tiles sit one per unit cell, off-grid tiles are not in a chunk and are found through the culling grid instead
+	int minCellX = RoundDownToInt(bounds.m_mins.x + 0.5f) - 1;
+	int minCellY = RoundDownToInt(bounds.m_mins.y + 0.5f) - 1;
+	int minCellZ = RoundDownToInt(bounds.m_mins.z + 0.5f) - 1;
+	int maxCellX = RoundDownToInt(bounds.m_maxs.x + 0.5f) + 1;
+	int maxCellY = RoundDownToInt(bounds.m_maxs.y + 0.5f) + 1;
+	int maxCellZ = RoundDownToInt(bounds.m_maxs.z + 0.5f) + 1;
+	for (int cellZ = minCellZ; cellZ <= maxCellZ; cellZ++)
+	{
+		for (int cellY = minCellY; cellY <= maxCellY; cellY++)
+		{
+			for (int cellX = minCellX; cellX <= maxCellX; cellX++)
+			{
+				auto cellIter = m_chunkedTilesByCell.find(GetKey(cellX, cellY, cellZ));
+				if (cellIter != m_chunkedTilesByCell.end())
+				{
+					out_tiles.insert(out_tiles.end(), cellIter->second.begin(), cellIter->second.end());
+				}
+			}
+		}
+	}
+}
+
+void TileChunkBaker::RenderChunks(std::vector<TileChunk const*> const& chunks, RenderQueue& queue, ModelInstanceRenderer& modelInstanceRenderer) const
+{
+	RenderCommand command;
+	command.m_state = m_map->GetDefaultRenderState();
+
+	for (int chunkIndex = 0; chunkIndex < (int)chunks.size(); chunkIndex++)
+	{
+		TileChunk const& chunk = *chunks[chunkIndex];
+		if (chunk.m_vertexBuffer && chunk.m_numVertexes > 0)
+		{
+			command.m_sortPosition = (chunk.m_bounds.m_mins + chunk.m_bounds.m_maxs) * 0.5f;
+			command.m_vertexBuffer = chunk.m_vertexBuffer;
+			command.m_count = chunk.m_numVertexes;
+			queue.Submit(command);
+		}
+
+		// Highlighted tiles are left out of the chunk geometry and drawn on their own
+		for (int tileIndex = 0; tileIndex < (int)chunk.m_unbakedTiles.size(); tileIndex++)
+		{
+			Tile const* tile = chunk.m_unbakedTiles[tileIndex];
+			if (!tile->AddModelInstances(modelInstanceRenderer))
+			{
+				tile->Render(queue);
+			}
+		}
+	}
+}
+
+bool TileChunkBaker::IsTileType(EntityType type)
+{
+	return type == EntityType::TILE_GRASS || type == EntityType::TILE_DIRT;
+}
+
+bool TileChunkBaker::Event_TileChunkStats(EventArgs& args)
+{
+	UNUSED(args);
+
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap)
+	{
+		return false;
+	}
+
+	TileChunkBaker const& baker = currentMap->m_tileChunks;
+	int numTiles = (int)baker.m_offGridTiles.size();
+	int numBakedTiles = 0;
+	int numUnbakedVertexes = 0;
+	int numBakedVertexes = 0;
+	int numChunkDrawCalls = 0;
+	for (auto chunkIter = baker.m_chunksByKey.begin(); chunkIter != baker.m_chunksByKey.end(); ++chunkIter)
+	{
+		TileChunk const& chunk = chunkIter->second;
+		numTiles += (int)chunk.m_tiles.size();
+		numBakedVertexes += chunk.m_numVertexes;
+		numChunkDrawCalls += chunk.m_numVertexes > 0 ? 1 : 0;
+
+		for (int recordIndex = 0; recordIndex < (int)chunk.m_tiles.size(); recordIndex++)
+		{
+			Tile const* tile = chunk.m_tiles[recordIndex].m_tile;
+			InstancedModel const* instancedModel = tile->m_model;
+			InstancedSubMesh const* subMesh = instancedModel ? instancedModel->GetSubMesh("") : nullptr;
+			if (tile->m_isBaked && subMesh)
+			{
+				numBakedTiles++;
+				numUnbakedVertexes += (int)subMesh->m_vertexes.size();
+			}
+		}
+	}
+
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Tiles: %d (%d baked into %d chunks, %d drawn individually)", numTiles, numBakedTiles, numChunkDrawCalls, numTiles - numBakedTiles), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Baked tile vertexes: %d per-tile, %d after merging and hidden face removal", numUnbakedVertexes, numBakedVertexes), false);
+	g_console->AddLine(Rgba8::STEEL_BLUE, Stringf("Baked tile draw calls: %d per-tile, %d chunked", numBakedTiles, numChunkDrawCalls), false);
+	return true;
+}
+
+void TileChunkBaker::RebuildAll()
+{
+	ClearChunks();
+	m_numSolidTilesByCell.clear();
+	m_chunkedTilesByCell.clear();
+	m_offGridTiles.clear();
+	m_changedTiles.clear();
+
+	for (int entityIndex = 0; entityIndex < (int)m_map->m_entities.size(); entityIndex++)
+	{
+		Entity* entity = m_map->m_entities[entityIndex];
+		if (entity && IsTileType(entity->m_type))
+		{
+			InsertTile((Tile*)entity);
+		}
+	}
+
+	m_isDirty = false;
+}
+
+void TileChunkBaker::RebuildChunk(TileChunk& chunk)
+{
+	std::vector<Vertex_PCUTBN> chunkVertexes;
+	chunk.m_unbakedTiles.clear();
+
+	for (int recordIndex = 0; recordIndex < (int)chunk.m_tiles.size(); recordIndex++)
+	{
+		BakedTileRecord const& record = chunk.m_tiles[recordIndex];
+		Tile* tile = record.m_tile;
+		tile->m_isBaked = false;
+		chunk.m_bounds = recordIndex == 0 ? tile->ComputeRenderBounds() : GetUnionOfAABB3s(chunk.m_bounds, tile->ComputeRenderBounds());
+
+		// Highlighted tiles keep their own draw so the editor tint still applies, but they still hide their neighbours' faces
+		if (record.m_isHighlighted)
+		{
+			continue;
+		}
+
+		InstancedModel const* instancedModel = tile->m_model;
+		InstancedSubMesh const* subMesh = instancedModel ? instancedModel->GetSubMesh("") : nullptr;
+		if (!subMesh)
+		{
+			continue;
+		}
+
+		std::vector<TileFaceDirection> const& faceDirections = GetFaceDirections(subMesh);
+		int numQuarterTurns = ((RoundDownToInt(record.m_orientation.m_yawDegrees / 90.f + 0.5f) % 4) + 4) % 4;
+		Mat44 transform = tile->GetModelMatrix();
+
+		for (int triangleIndex = 0; triangleIndex < (int)faceDirections.size(); triangleIndex++)
+		{
+			TileFaceDirection faceDirection = faceDirections[triangleIndex];
+			if (faceDirection != TileFaceDirection::NONE)
+			{
+				int offsetX = FACE_OFFSETS[(int)faceDirection][0];
+				int offsetY = FACE_OFFSETS[(int)faceDirection][1];
+				int offsetZ = FACE_OFFSETS[(int)faceDirection][2];
+				for (int turnIndex = 0; turnIndex < numQuarterTurns; turnIndex++)
+				{
+					int previousOffsetX = offsetX;
+					offsetX = -offsetY;
+					offsetY = previousOffsetX;
+				}
+
+				if (IsSolidCell(record.m_cellX + offsetX, record.m_cellY + offsetY, record.m_cellZ + offsetZ))
+				{
+					continue;
+				}
+			}
+
+			for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++)
+			{
+				Vertex_PCUTBN vertex = subMesh->m_vertexes[triangleIndex * 3 + cornerIndex];
+				vertex.m_position = transform.TransformPosition3D(vertex.m_position);
+				vertex.m_normal = transform.TransformVectorQuantity3D(vertex.m_normal).GetNormalized();
+				chunkVertexes.push_back(vertex);
+			}
+		}
+
+		tile->m_isBaked = true;
+	}
+
+	for (int recordIndex = 0; recordIndex < (int)chunk.m_tiles.size(); recordIndex++)
+	{
+		if (!chunk.m_tiles[recordIndex].m_tile->m_isBaked)
+		{
+			chunk.m_unbakedTiles.push_back(chunk.m_tiles[recordIndex].m_tile);
+		}
+	}
+
+	delete chunk.m_vertexBuffer;
+	chunk.m_vertexBuffer = nullptr;
+	chunk.m_numVertexes = (int)chunkVertexes.size();
+	if (chunk.m_numVertexes > 0)
+	{
+		size_t vertexBufferSize = chunkVertexes.size() * sizeof(Vertex_PCUTBN);
+		chunk.m_vertexBuffer = g_renderer->CreateVertexBuffer(vertexBufferSize, VertexType::VERTEX_PCUTBN);
+		g_renderer->CopyCPUToGPU(chunkVertexes.data(), vertexBufferSize, chunk.m_vertexBuffer);
+	}
+
+	chunk.m_isDirty = false;
+}
+
+void TileChunkBaker::ClearChunks()
+{
+	for (auto chunkIter = m_chunksByKey.begin(); chunkIter != m_chunksByKey.end(); ++chunkIter)
+	{
+		TileChunk& chunk = chunkIter->second;
+		for (int recordIndex = 0; recordIndex < (int)chunk.m_tiles.size(); recordIndex++)
+		{
+			chunk.m_tiles[recordIndex].m_tile->m_isBaked = false;
+			chunk.m_tiles[recordIndex].m_tile->m_isInTileChunk = false;
+		}
+		delete chunk.m_vertexBuffer;
+	}
+	m_chunksByKey.clear();
+}
+
+void TileChunkBaker::InsertTile(Tile* tile)
+{
+	BakedTileRecord record = CreateRecord(tile);
+	tile->m_isBaked = false;
+
+	if (!record.m_isOnGrid)
+	{
+		tile->m_isInTileChunk = false;
+		m_offGridTiles.push_back(record);
+		return;
+	}
+
+	long long chunkKey = GetKey(GetChunkCoordForCell(record.m_cellX), GetChunkCoordForCell(record.m_cellY), GetChunkCoordForCell(record.m_cellZ));
+	m_chunksByKey[chunkKey].m_tiles.push_back(record);
+	tile->m_isInTileChunk = true;
+	tile->m_tileChunkKey = chunkKey;
+	m_chunkedTilesByCell[GetKey(record.m_cellX, record.m_cellY, record.m_cellZ)].push_back(tile);
+
+	if (tile->m_definition.m_isSolid)
+	{
+		m_numSolidTilesByCell[GetKey(record.m_cellX, record.m_cellY, record.m_cellZ)]++;
+	}
+	MarkCellNeighborhoodDirty(record.m_cellX, record.m_cellY, record.m_cellZ);
+}
+
+void TileChunkBaker::EraseTile(Tile* tile)
+{
+	tile->m_isBaked = false;
+
+	if (!tile->m_isInTileChunk)
+	{
+		for (int recordIndex = 0; recordIndex < (int)m_offGridTiles.size(); recordIndex++)
+		{
+			if (m_offGridTiles[recordIndex].m_tile == tile)
+			{
+				m_offGridTiles.erase(m_offGridTiles.begin() + recordIndex);
+				return;
+			}
+		}
+		return;
+	}
+
+	tile->m_isInTileChunk = false;
+	auto chunkIter = m_chunksByKey.find(tile->m_tileChunkKey);
+	if (chunkIter == m_chunksByKey.end())
+	{
+		return;
+	}
+
+	std::vector<BakedTileRecord>& records = chunkIter->second.m_tiles;
+	for (int recordIndex = 0; recordIndex < (int)records.size(); recordIndex++)
+	{
+		if (records[recordIndex].m_tile != tile)
+		{
+			continue;
+		}
+
+		BakedTileRecord record = records[recordIndex];
+		records.erase(records.begin() + recordIndex);
+
+		auto tilesIter = m_chunkedTilesByCell.find(GetKey(record.m_cellX, record.m_cellY, record.m_cellZ));
+		if (tilesIter != m_chunkedTilesByCell.end())
+		{
+			std::vector<Tile*>& cellTiles = tilesIter->second;
+			for (int tileIndex = 0; tileIndex < (int)cellTiles.size(); tileIndex++)
+			{
+				if (cellTiles[tileIndex] == tile)
+				{
+					cellTiles[tileIndex] = cellTiles.back();
+					cellTiles.pop_back();
+					break;
+				}
+			}
+			if (cellTiles.empty())
+			{
+				m_chunkedTilesByCell.erase(tilesIter);
+			}
+		}
+
+		if (tile->m_definition.m_isSolid)
+		{
+			auto cellIter = m_numSolidTilesByCell.find(GetKey(record.m_cellX, record.m_cellY, record.m_cellZ));
+			if (cellIter != m_numSolidTilesByCell.end() && --cellIter->second <= 0)
+			{
+				m_numSolidTilesByCell.erase(cellIter);
+			}
+		}
+		MarkCellNeighborhoodDirty(record.m_cellX, record.m_cellY, record.m_cellZ);
+		return;
+	}
+}
+
+void TileChunkBaker::UpdateChangedTile(Tile* tile)
+{
+	if (!tile->m_isInTileChunk)
+	{
+		for (int recordIndex = 0; recordIndex < (int)m_offGridTiles.size(); recordIndex++)
+		{
+			if (m_offGridTiles[recordIndex].m_tile == tile && HasRecordChanged(m_offGridTiles[recordIndex]))
+			{
+				EraseTile(tile);
+				InsertTile(tile);
+				return;
+			}
+		}
+		return;
+	}
+
+	auto chunkIter = m_chunksByKey.find(tile->m_tileChunkKey);
+	if (chunkIter == m_chunksByKey.end())
+	{
+		return;
+	}
+
+	TileChunk& chunk = chunkIter->second;
+	for (int recordIndex = 0; recordIndex < (int)chunk.m_tiles.size(); recordIndex++)
+	{
+		BakedTileRecord& record = chunk.m_tiles[recordIndex];
+		if (record.m_tile != tile || !HasRecordChanged(record))
+		{
+			continue;
+		}
+
+		// A highlight change does not move the tile, so only its own chunk needs rebaking
+		BakedTileRecord currentRecord = CreateRecord(tile);
+		if (currentRecord.m_isOnGrid && currentRecord.m_cellX == record.m_cellX && currentRecord.m_cellY == record.m_cellY && currentRecord.m_cellZ == record.m_cellZ && currentRecord.m_orientation.m_yawDegrees == record.m_orientation.m_yawDegrees)
+		{
+			record = currentRecord;
+			chunk.m_isDirty = true;
+			return;
+		}
+
+		EraseTile(tile);
+		InsertTile(tile);
+		return;
+	}
+}
+
+void TileChunkBaker::MarkChunkDirtyForCell(int cellX, int cellY, int cellZ)
+{
+	auto chunkIter = m_chunksByKey.find(GetKey(GetChunkCoordForCell(cellX), GetChunkCoordForCell(cellY), GetChunkCoordForCell(cellZ)));
+	if (chunkIter != m_chunksByKey.end())
+	{
+		chunkIter->second.m_isDirty = true;
+	}
+}
+
+void TileChunkBaker::MarkCellNeighborhoodDirty(int cellX, int cellY, int cellZ)
+{
+	MarkChunkDirtyForCell(cellX, cellY, cellZ);
+	for (int directionIndex = 0; directionIndex < (int)TileFaceDirection::NUM; directionIndex++)
+	{
+		MarkChunkDirtyForCell(cellX + FACE_OFFSETS[directionIndex][0], cellY + FACE_OFFSETS[directionIndex][1], cellZ + FACE_OFFSETS[directionIndex][2]);
+	}
+}
+
+bool TileChunkBaker::IsSolidCell(int cellX, int cellY, int cellZ) const
+{
+	return m_numSolidTilesByCell.find(GetKey(cellX, cellY, cellZ)) != m_numSolidTilesByCell.end();
+}
+
+std::vector<TileFaceDirection> const& TileChunkBaker::GetFaceDirections(InstancedSubMesh const* subMesh)
+{
+	auto subMeshIter = m_faceDirectionsBySubMesh.find(subMesh);
+	if (subMeshIter != m_faceDirectionsBySubMesh.end())
+	{
+		return subMeshIter->second;
+	}
+
+	// A triangle is a cube face if all its corners lie on one side of the unit tile bounds and it faces outward
+	constexpr float PLANE_TOLERANCE = 0.001f;
+	std::vector<TileFaceDirection>& faceDirections = m_faceDirectionsBySubMesh[subMesh];
+	int numTriangles = (int)subMesh->m_vertexes.size() / 3;
+	faceDirections.resize(numTriangles, TileFaceDirection::NONE);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+	{
+		for (int directionIndex = 0; directionIndex < (int)TileFaceDirection::NUM; directionIndex++)
+		{
+			Vec3 direction((float)FACE_OFFSETS[directionIndex][0], (float)FACE_OFFSETS[directionIndex][1], (float)FACE_OFFSETS[directionIndex][2]);
+			float planeDistance = direction.z < 0.f ? 0.f : (direction.z > 0.f ? 1.f : 0.5f);
+
+			bool isOnPlane = true;
+			for (int cornerIndex = 0; cornerIndex < 3; cornerIndex++)
+			{
+				Vec3 const& position = subMesh->m_vertexes[triangleIndex * 3 + cornerIndex].m_position;
+				if (fabsf(DotProduct3D(position, direction) - planeDistance) > PLANE_TOLERANCE)
+				{
+					isOnPlane = false;
+					break;
+				}
+			}
+
+			if (isOnPlane && DotProduct3D(subMesh->m_vertexes[triangleIndex * 3].m_normal, direction) > 0.5f)
+			{
+				faceDirections[triangleIndex] = (TileFaceDirection)directionIndex;
+				break;
+			}
+		}
+	}
+
+	return faceDirections;
+}
+
+BakedTileRecord TileChunkBaker::CreateRecord(Tile* tile) const
+{
+	constexpr float GRID_TOLERANCE = 0.001f;
+
+	BakedTileRecord record;
+	record.m_tile = tile;
+	record.m_position = tile->m_position;
+	record.m_orientation = tile->m_orientation;
+	record.m_scale = tile->m_scale;
+	record.m_isHighlighted = IsTileHighlighted(tile);
+
+	record.m_cellX = RoundDownToInt(tile->m_position.x + 0.5f);
+	record.m_cellY = RoundDownToInt(tile->m_position.y + 0.5f);
+	record.m_cellZ = RoundDownToInt(tile->m_position.z + 0.5f);
+
+	float yawQuarterTurns = tile->m_orientation.m_yawDegrees / 90.f;
+	bool isOnCell = fabsf(tile->m_position.x - (float)record.m_cellX) < GRID_TOLERANCE && fabsf(tile->m_position.y - (float)record.m_cellY) < GRID_TOLERANCE && fabsf(tile->m_position.z - (float)record.m_cellZ) < GRID_TOLERANCE;
+	bool isAxisAligned = fabsf(yawQuarterTurns - (float)RoundDownToInt(yawQuarterTurns + 0.5f)) < GRID_TOLERANCE && fabsf(tile->m_orientation.m_pitchDegrees) < GRID_TOLERANCE && fabsf(tile->m_orientation.m_rollDegrees) < GRID_TOLERANCE;
+	bool isUnitScale = fabsf(tile->m_scale - 1.f) < GRID_TOLERANCE;
+	record.m_isOnGrid = isOnCell && isAxisAligned && isUnitScale;
+	return record;
+}
+
+bool TileChunkBaker::HasRecordChanged(BakedTileRecord const& record) const
+{
+	Tile const* tile = record.m_tile;
+	return tile->m_position.x != record.m_position.x || tile->m_position.y != record.m_position.y || tile->m_position.z != record.m_position.z
+		|| tile->m_orientation.m_yawDegrees != record.m_orientation.m_yawDegrees || tile->m_orientation.m_pitchDegrees != record.m_orientation.m_pitchDegrees || tile->m_orientation.m_rollDegrees != record.m_orientation.m_rollDegrees
+		|| tile->m_scale != record.m_scale
+		|| IsTileHighlighted(tile) != record.m_isHighlighted;
+}
+
+bool TileChunkBaker::IsTileHighlighted(Tile const* tile)
+{
+	Rgba8 color = tile->GetColor();
+	return color.r != 255 || color.g != 255 || color.b != 255 || color.a != 255;
+}
+
+long long TileChunkBaker::GetKey(int x, int y, int z)
+{
+	constexpr long long COORD_MASK = 0x1FFFFF;
+	return (((long long)x & COORD_MASK) << 42) | (((long long)y & COORD_MASK) << 21) | ((long long)z & COORD_MASK);
+}
+
+int TileChunkBaker::GetChunkCoordForCell(int cellCoord)
+{
+	return cellCoord >= 0 ? cellCoord / CHUNK_SIZE : ((cellCoord + 1) / CHUNK_SIZE) - 1;
+}
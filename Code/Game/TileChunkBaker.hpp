@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+
+class Entity;
+class Map;
+class ModelInstanceRenderer;
+class RenderQueue;
+class Tile;
+class VertexBuffer;
+class ViewFrustum;
+struct InstancedSubMesh;
+
+
+enum class TileFaceDirection
+{
+	NONE = -1,
+	EAST,
+	WEST,
+	NORTH,
+	SOUTH,
+	SKYWARD,
+	GROUNDWARD,
+	NUM
+};
+
+// Snapshot of the transform a tile was baked with, so a reported change can tell whether the tile left its cell
+struct BakedTileRecord
+{
+public:
+	Tile* m_tile = nullptr;
+	Vec3 m_position = Vec3::ZERO;
+	EulerAngles m_orientation = EulerAngles::ZERO;
+	float m_scale = 1.f;
+	bool m_isHighlighted = false;
+	bool m_isOnGrid = false;
+	int m_cellX = 0;
+	int m_cellY = 0;
+	int m_cellZ = 0;
+};
+
+struct TileChunk
+{
+public:
+	std::vector<BakedTileRecord> m_tiles;
+	VertexBuffer* m_vertexBuffer = nullptr;
+	int m_numVertexes = 0;
+	AABB3 m_bounds;
+	std::vector<Tile*> m_unbakedTiles;
+	bool m_isDirty = true;
+};
+
+
+class TileChunkBaker
+{
+public:
+	~TileChunkBaker();
+	TileChunkBaker() = default;
+	explicit TileChunkBaker(Map* map);
+
+	void OnEntityAdded(Entity* entity);
+	void OnEntityRemoved(Entity* entity);
+	void OnEntityChanged(Entity* entity);
+	void MarkDirty();
+
+	void Update();
+	int BakeDirtyChunks(double endTimeSeconds);
+	void CollectVisibleChunks(ViewFrustum const& frustum, std::vector<TileChunk const*>& out_visibleChunks);
+	void CollectTilesInBounds(AABB3 const& bounds, std::vector<Entity*>& out_tiles);
+	void RenderChunks(std::vector<TileChunk const*> const& chunks, RenderQueue& queue, ModelInstanceRenderer& modelInstanceRenderer) const;
+
+	static bool IsTileType(EntityType type);
+	static bool Event_TileChunkStats(EventArgs& args);
+
+public:
+	static constexpr int CHUNK_SIZE = 16;
+
+	Map* m_map = nullptr;
+	int m_numChunksRebuiltLastFrame = 0;
+	int m_numChunksDrawn = 0;
+	int m_numChunksCulled = 0;
+
+private:
+	void RebuildAll();
+	void RebuildChunk(TileChunk& chunk);
+	void ClearChunks();
+	void InsertTile(Tile* tile);
+	void EraseTile(Tile* tile);
+	void UpdateChangedTile(Tile* tile);
+	void MarkChunkDirtyForCell(int cellX, int cellY, int cellZ);
+	void MarkCellNeighborhoodDirty(int cellX, int cellY, int cellZ);
+	bool IsSolidCell(int cellX, int cellY, int cellZ) const;
+	std::vector<TileFaceDirection> const& GetFaceDirections(InstancedSubMesh const* subMesh);
+	BakedTileRecord CreateRecord(Tile* tile) const;
+	bool HasRecordChanged(BakedTileRecord const& record) const;
+
+	static bool IsTileHighlighted(Tile const* tile);
+	static long long GetKey(int x, int y, int z);
+	static int GetChunkCoordForCell(int cellCoord);
+
+private:
+	std::unordered_map<long long, TileChunk> m_chunksByKey;
+	std::unordered_map<long long, int> m_numSolidTilesByCell;
+	std::unordered_map<long long, std::vector<Tile*>> m_chunkedTilesByCell;
+	std::vector<BakedTileRecord> m_offGridTiles;
+	std::vector<Tile*> m_changedTiles;
+	std::map<InstancedSubMesh const*, std::vector<TileFaceDirection>> m_faceDirectionsBySubMesh;
+	bool m_isDirty = true;
+};
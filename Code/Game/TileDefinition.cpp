@@ -1,9 +1,9 @@
 #include "Game/TileDefinition.hpp"
 
 #include "Game/GameCommon.hpp"
+#include "Game/InstancedModel.hpp"
 
 #include "Engine/Core/ErrorWarningAssert.hpp"
-#include "Engine/Core/Models/ModelLoader.hpp"
 
 
 std::map<std::string, TileDefinition> TileDefinition::s_definitions;
@@ -18,7 +18,17 @@ TileDefinition::TileDefinition(XmlElement const* element)
 	XmlElement const* modelElement = element->FirstChildElement("Model");
 	if (modelElement)
 	{
-		m_model = g_modelLoader->CreateOrGetModelFromXml(modelElement);
+		Mat44 transform;
+		XmlElement const* transformElement = modelElement->FirstChildElement("Transform");
+		if (transformElement)
+		{
+			Vec3 iBasis = ParseXmlAttribute(*transformElement, "x", Vec3(1.f, 0.f, 0.f));
+			Vec3 jBasis = ParseXmlAttribute(*transformElement, "y", Vec3(0.f, 1.f, 0.f));
+			Vec3 kBasis = ParseXmlAttribute(*transformElement, "z", Vec3(0.f, 0.f, 1.f));
+			Vec3 translation = ParseXmlAttribute(*transformElement, "T", Vec3::ZERO);
+			transform = Mat44(iBasis, jBasis, kBasis, translation);
+		}
+		m_model = InstancedModel::CreateOrGetFromObj(ParseXmlAttribute(*modelElement, "path", std::string("")), transform);
 	}
 }
 
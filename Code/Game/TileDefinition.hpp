@@ -1,10 +1,14 @@
 #pragma once
 
-#include "Engine/Core/Models/Model.hpp"
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Math/AABB3.hpp"
 
 #include <map>
+#include <string>
+
+
+class InstancedModel;
+
 
 class TileDefinition
 {
@@ -15,7 +19,7 @@ public:
 
 public:
 	std::string m_name = "";
-	Model* m_model = nullptr;
+	InstancedModel const* m_model = nullptr;
 	bool m_isSolid = false;
 	AABB3 m_bounds;
 
@@ -0,0 +1,271 @@
+#include "Game/TriggerVolumeSystem.hpp"
+
+#include "Game/App.hpp"
+#include "Game/Entity.hpp"
+#include "Game/Game.hpp"
+#include "Game/GameMathUtils.hpp"
+#include "Game/Map.hpp"
+
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Renderer/DebugRenderSystem.hpp"
+
+#include <algorithm>
+
+
+TriggerVolumeSystem::TriggerVolumeSystem(Map* map)
+	: m_map(map)
+{
+	SubscribeEventCallbackFunction("ToggleTriggerVolumes", Event_ToggleTriggerVolumeDebugDraw, "Toggles debug drawing of trigger volumes");
+}
+
+int TriggerVolumeSystem::AddVolume(AABB3 const& bounds, std::string const& eventName, bool wantsStayEvents)
+{
+	TriggerVolume volume;
+	volume.m_id = m_nextVolumeID;
+	volume.m_bounds = OBB3(bounds.GetCenter(), bounds.GetDimensions() * 0.5f, Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f));
+	volume.m_worldBounds = bounds;
+	volume.m_eventName = eventName;
+	volume.m_wantsStayEvents = wantsStayEvents;
+	volume.m_minCell = GetCellForPosition(bounds.m_mins);
+	volume.m_maxCell = GetCellForPosition(bounds.m_maxs);
+	m_staticVolumes.push_back(volume);
+
+	m_nextVolumeID++;
+	m_isDirty = true;
+	return volume.m_id;
+}
+
+void TriggerVolumeSystem::RemoveVolume(int volumeID)
+{
+	for (int volumeIndex = 0; volumeIndex < (int)m_staticVolumes.size(); volumeIndex++)
+	{
+		if (m_staticVolumes[volumeIndex].m_id == volumeID)
+		{
+			m_staticVolumes.erase(m_staticVolumes.begin() + volumeIndex);
+			m_isDirty = true;
+			return;
+		}
+	}
+}
+
+void TriggerVolumeSystem::ClearVolumes()
+{
+	ClearOverlaps();
+	m_staticVolumes.clear();
+	m_isDirty = true;
+}
+
+void TriggerVolumeSystem::MarkDirty()
+{
+	m_isDirty = true;
+}
+
+void TriggerVolumeSystem::Update(Vec3 const& cylinderBaseCenter, float cylinderHeight, float cylinderRadius)
+{
+	if (m_isDirty)
+	{
+		RebuildIndex();
+	}
+
+	m_queryIndex++;
+	m_numVolumesTested = 0;
+	m_overlappingVolumeIndexes.clear();
+
+	Vec3 cylinderTopCenter = cylinderBaseCenter + Vec3::SKYWARD * cylinderHeight;
+	IntVec2 minCell = GetCellForPosition(cylinderBaseCenter - Vec3(cylinderRadius, cylinderRadius, 0.f));
+	IntVec2 maxCell = GetCellForPosition(cylinderBaseCenter + Vec3(cylinderRadius, cylinderRadius, 0.f));
+
+	for (int cellY = minCell.y; cellY <= maxCell.y; cellY++)
+	{
+		for (int cellX = minCell.x; cellX <= maxCell.x; cellX++)
+		{
+			auto cellIter = m_volumeIndexesByCell.find(GetCellKey(IntVec2(cellX, cellY)));
+			if (cellIter == m_volumeIndexesByCell.end())
+			{
+				continue;
+			}
+
+			std::vector<int> const& cellVolumeIndexes = cellIter->second;
+			for (int cellVolumeIndex = 0; cellVolumeIndex < (int)cellVolumeIndexes.size(); cellVolumeIndex++)
+			{
+				int volumeIndex = cellVolumeIndexes[cellVolumeIndex];
+				TriggerVolume& volume = m_volumes[volumeIndex];
+
+				// Volumes spanning several cells would otherwise be tested once per cell
+				if (volume.m_lastQueryIndex == m_queryIndex)
+				{
+					continue;
+				}
+				volume.m_lastQueryIndex = m_queryIndex;
+				m_numVolumesTested++;
+
+				if (!DoZCylinderAndZOBB3Overlap(cylinderBaseCenter, cylinderTopCenter, cylinderRadius, volume.m_bounds))
+				{
+					continue;
+				}
+
+				volume.m_lastOverlapQueryIndex = m_queryIndex;
+				m_overlappingVolumeIndexes.push_back(volumeIndex);
+				if (!volume.m_isOverlapping)
+				{
+					volume.m_isOverlapping = true;
+					FireTriggerEvent(volume, TriggerEventType::ENTER);
+				}
+				else if (volume.m_wantsStayEvents)
+				{
+					FireTriggerEvent(volume, TriggerEventType::STAY);
+				}
+			}
+		}
+	}
+
+	// Anything that overlapped last frame and was not found this frame has been left
+	for (int previousIndex = 0; previousIndex < (int)m_previousOverlappingVolumeIndexes.size(); previousIndex++)
+	{
+		TriggerVolume& volume = m_volumes[m_previousOverlappingVolumeIndexes[previousIndex]];
+		if (volume.m_lastOverlapQueryIndex == m_queryIndex)
+		{
+			continue;
+		}
+
+		volume.m_isOverlapping = false;
+		FireTriggerEvent(volume, TriggerEventType::EXIT);
+	}
+
+	m_previousOverlappingVolumeIndexes.swap(m_overlappingVolumeIndexes);
+}
+
+void TriggerVolumeSystem::ClearOverlaps()
+{
+	for (int previousIndex = 0; previousIndex < (int)m_previousOverlappingVolumeIndexes.size(); previousIndex++)
+	{
+		TriggerVolume& volume = m_volumes[m_previousOverlappingVolumeIndexes[previousIndex]];
+		volume.m_isOverlapping = false;
+		FireTriggerEvent(volume, TriggerEventType::EXIT);
+	}
+
+	m_previousOverlappingVolumeIndexes.clear();
+}
+
+void TriggerVolumeSystem::AddDebugDraw() const
+{
+	if (!m_isDebugDrawEnabled)
+	{
+		return;
+	}
+
+	for (int volumeIndex = 0; volumeIndex < (int)m_staticVolumes.size(); volumeIndex++)
+	{
+		DebugAddWorldWireBox(m_staticVolumes[volumeIndex].m_worldBounds, 0.f, Rgba8::MAGENTA, Rgba8::MAGENTA, DebugRenderMode::USE_DEPTH);
+	}
+}
+
+bool TriggerVolumeSystem::Event_ToggleTriggerVolumeDebugDraw(EventArgs& args)
+{
+	UNUSED(args);
+
+	Map* currentMap = g_app->m_game->m_currentMap;
+	if (!currentMap)
+	{
+		return false;
+	}
+
+	currentMap->m_triggerVolumes.m_isDebugDrawEnabled = !currentMap->m_triggerVolumes.m_isDebugDrawEnabled;
+	return true;
+}
+
+void TriggerVolumeSystem::RebuildIndex()
+{
+	// Overlaps are keyed by volume index, which is about to change, so carry them over by identity
+	std::vector<int> overlappingVolumeIDs;
+	std::vector<Entity*> overlappingEntities;
+	for (int previousIndex = 0; previousIndex < (int)m_previousOverlappingVolumeIndexes.size(); previousIndex++)
+	{
+		TriggerVolume const& volume = m_volumes[m_previousOverlappingVolumeIndexes[previousIndex]];
+		if (volume.m_entity)
+		{
+			overlappingEntities.push_back(volume.m_entity);
+		}
+		else
+		{
+			overlappingVolumeIDs.push_back(volume.m_id);
+		}
+	}
+
+	m_volumes = m_staticVolumes;
+
+	for (int entityIndex = 0; entityIndex < (int)m_map->m_entities.size(); entityIndex++)
+	{
+		Entity* entity = m_map->m_entities[entityIndex];
+		if (!entity || !entity->IsTrigger())
+		{
+			continue;
+		}
+
+		TriggerVolume volume;
+		volume.m_entity = entity;
+		volume.m_bounds = entity->GetBounds();
+
+		float boundsRadius = volume.m_bounds.m_halfDimensions.GetLength();
+		volume.m_minCell = GetCellForPosition(entity->m_position - Vec3(boundsRadius, boundsRadius, 0.f));
+		volume.m_maxCell = GetCellForPosition(entity->m_position + Vec3(boundsRadius, boundsRadius, 0.f));
+		m_volumes.push_back(volume);
+	}
+
+	m_volumeIndexesByCell.clear();
+	m_previousOverlappingVolumeIndexes.clear();
+	for (int volumeIndex = 0; volumeIndex < (int)m_volumes.size(); volumeIndex++)
+	{
+		TriggerVolume& volume = m_volumes[volumeIndex];
+		bool wasOverlapping = volume.m_entity ? (std::find(overlappingEntities.begin(), overlappingEntities.end(), volume.m_entity) != overlappingEntities.end()) : (std::find(overlappingVolumeIDs.begin(), overlappingVolumeIDs.end(), volume.m_id) != overlappingVolumeIDs.end());
+		volume.m_isOverlapping = wasOverlapping;
+		volume.m_lastQueryIndex = -1;
+		volume.m_lastOverlapQueryIndex = -1;
+		if (wasOverlapping)
+		{
+			m_previousOverlappingVolumeIndexes.push_back(volumeIndex);
+		}
+
+		InsertIntoIndex(volumeIndex);
+	}
+
+	m_isDirty = false;
+}
+
+void TriggerVolumeSystem::InsertIntoIndex(int volumeIndex)
+{
+	TriggerVolume const& volume = m_volumes[volumeIndex];
+	for (int cellY = volume.m_minCell.y; cellY <= volume.m_maxCell.y; cellY++)
+	{
+		for (int cellX = volume.m_minCell.x; cellX <= volume.m_maxCell.x; cellX++)
+		{
+			m_volumeIndexesByCell[GetCellKey(IntVec2(cellX, cellY))].push_back(volumeIndex);
+		}
+	}
+}
+
+void TriggerVolumeSystem::FireTriggerEvent(TriggerVolume const& volume, TriggerEventType type)
+{
+	if (volume.m_entity)
+	{
+		volume.m_entity->HandleTriggerEvent(type);
+		return;
+	}
+
+	if (!volume.m_eventName.empty())
+	{
+		FireEvent(Stringf("%s volume=%d trigger=%d", volume.m_eventName.c_str(), volume.m_id, (int)type));
+	}
+}
+
+IntVec2 TriggerVolumeSystem::GetCellForPosition(Vec3 const& position) const
+{
+	return IntVec2(RoundDownToInt(position.x / CELL_SIZE), RoundDownToInt(position.y / CELL_SIZE));
+}
+
+long long TriggerVolumeSystem::GetCellKey(IntVec2 const& cell)
+{
+	return ((long long)cell.x << 32) | (long long)(unsigned int)cell.y;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/OBB3.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+class Entity;
+class Map;
+
+
+enum class TriggerEventType
+{
+	NONE = -1,
+	ENTER,
+	STAY,
+	EXIT,
+	NUM
+};
+
+struct TriggerVolume
+{
+public:
+	int m_id = -1;
+	OBB3 m_bounds;
+	AABB3 m_worldBounds;
+	Entity* m_entity = nullptr;
+	std::string m_eventName = "";
+	bool m_wantsStayEvents = false;
+
+	bool m_isOverlapping = false;
+	int m_lastQueryIndex = -1;
+	int m_lastOverlapQueryIndex = -1;
+	IntVec2 m_minCell = IntVec2::ZERO;
+	IntVec2 m_maxCell = IntVec2::ZERO;
+};
+
+
+class TriggerVolumeSystem
+{
+public:
+	~TriggerVolumeSystem() = default;
+	TriggerVolumeSystem() = default;
+	explicit TriggerVolumeSystem(Map* map);
+
+	int AddVolume(AABB3 const& bounds, std::string const& eventName, bool wantsStayEvents = false);
+	void RemoveVolume(int volumeID);
+	void ClearVolumes();
+	void MarkDirty();
+
+	void Update(Vec3 const& cylinderBaseCenter, float cylinderHeight, float cylinderRadius);
+	void ClearOverlaps();
+	void AddDebugDraw() const;
+
+	static bool Event_ToggleTriggerVolumeDebugDraw(EventArgs& args);
+
+public:
+	static constexpr float CELL_SIZE = 4.f;
+
+	Map* m_map = nullptr;
+	bool m_isDebugDrawEnabled = false;
+	int m_numVolumesTested = 0;
+
+private:
+	void RebuildIndex();
+	void InsertIntoIndex(int volumeIndex);
+	void FireTriggerEvent(TriggerVolume const& volume, TriggerEventType type);
+	IntVec2 GetCellForPosition(Vec3 const& position) const;
+	static long long GetCellKey(IntVec2 const& cell);
+
+private:
+	std::vector<TriggerVolume> m_staticVolumes;
+	std::vector<TriggerVolume> m_volumes;
+	std::unordered_map<long long, std::vector<int>> m_volumeIndexesByCell;
+	std::vector<int> m_overlappingVolumeIndexes;
+	std::vector<int> m_previousOverlappingVolumeIndexes;
+	int m_nextVolumeID = 0;
+	int m_queryIndex = 0;
+	bool m_isDirty = true;
+};
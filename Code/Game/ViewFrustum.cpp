@@ -0,0 +1,137 @@
+#include "Game/ViewFrustum.hpp"
+
+#include "Engine/Math/MathUtils.hpp"
+
+#include <math.h>
+
+
+ViewFrustum ViewFrustum::CreateFromFovAngles(Vec3 const& position, Vec3 const& fwd, Vec3 const& left, Vec3 const& up, float fovLeftRadians, float fovRightRadians, float fovUpRadians, float fovDownRadians, float nearDistance, float farDistance)
+{
+	ViewFrustum frustum;
+	if (fovRightRadians <= fovLeftRadians || fovUpRadians <= fovDownRadians)
+	{
+		return frustum;
+	}
+	frustum.m_isValid = true;
+
+	// Angles follow the OpenXR convention, left and down are negative
+	Vec3 right = -left;
+	Vec3 planeNormals[NUM_PLANES] =
+	{
+		fwd * -sinf(fovLeftRadians) + right * cosf(fovLeftRadians),
+		fwd * sinf(fovRightRadians) - right * cosf(fovRightRadians),
+		fwd * -sinf(fovDownRadians) + up * cosf(fovDownRadians),
+		fwd * sinf(fovUpRadians) - up * cosf(fovUpRadians),
+		fwd,
+		-fwd,
+	};
+
+	for (int planeIndex = 0; planeIndex < 4; planeIndex++)
+	{
+		frustum.m_planes[planeIndex].m_normal = planeNormals[planeIndex];
+		frustum.m_planes[planeIndex].m_distance = DotProduct3D(planeNormals[planeIndex], position);
+	}
+	frustum.m_planes[4].m_normal = fwd;
+	frustum.m_planes[4].m_distance = DotProduct3D(fwd, position) + nearDistance;
+	frustum.m_planes[5].m_normal = -fwd;
+	frustum.m_planes[5].m_distance = -(DotProduct3D(fwd, position) + farDistance);
+
+	float depths[2] = { nearDistance, farDistance };
+	float horizontalTangents[2] = { tanf(fovLeftRadians), tanf(fovRightRadians) };
+	float verticalTangents[2] = { tanf(fovDownRadians), tanf(fovUpRadians) };
+	for (int cornerIndex = 0; cornerIndex < NUM_CORNERS; cornerIndex++)
+	{
+		float depth = depths[cornerIndex / 4];
+		float horizontalTangent = horizontalTangents[cornerIndex % 2];
+		float verticalTangent = verticalTangents[(cornerIndex / 2) % 2];
+		frustum.m_corners[cornerIndex] = position + fwd * depth + right * (depth * horizontalTangent) + up * (depth * verticalTangent);
+	}
+
+	return frustum;
+}
+
+ViewFrustum ViewFrustum::CreatePerspective(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearDistance, float farDistance)
+{
+	Vec3 fwd, left, up;
+	orientation.GetAsVectors_iFwd_jLeft_kUp(fwd, left, up);
+
+	float halfVerticalRadians = ConvertDegreesToRadians(fovDegrees * 0.5f);
+	float halfHorizontalRadians = atanf(aspect * tanf(halfVerticalRadians));
+	return CreateFromFovAngles(position, fwd, left, up, -halfHorizontalRadians, halfHorizontalRadians, halfVerticalRadians, -halfVerticalRadians, nearDistance, farDistance);
+}
+
+ViewFrustum ViewFrustum::CreateCombined(ViewFrustum const* frustums, int numFrustums)
+{
+	if (numFrustums <= 0)
+	{
+		return ViewFrustum();
+	}
+	for (int frustumIndex = 0; frustumIndex < numFrustums; frustumIndex++)
+	{
+		if (!frustums[frustumIndex].m_isValid)
+		{
+			return ViewFrustum();
+		}
+	}
+
+	// Each plane takes the averaged normal of all views and is pushed out until every corner of every frustum is inside, which is conservative for any set of views
+	ViewFrustum combined;
+	combined.m_isValid = true;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; planeIndex++)
+	{
+		Vec3 normalSum = Vec3::ZERO;
+		for (int frustumIndex = 0; frustumIndex < numFrustums; frustumIndex++)
+		{
+			normalSum += frustums[frustumIndex].m_planes[planeIndex].m_normal;
+		}
+
+		Vec3 normal = normalSum.GetNormalized();
+		float distance = DotProduct3D(normal, frustums[0].m_corners[0]);
+		for (int frustumIndex = 0; frustumIndex < numFrustums; frustumIndex++)
+		{
+			for (int cornerIndex = 0; cornerIndex < NUM_CORNERS; cornerIndex++)
+			{
+				distance = GetMin(distance, DotProduct3D(normal, frustums[frustumIndex].m_corners[cornerIndex]));
+			}
+		}
+
+		combined.m_planes[planeIndex].m_normal = normal;
+		combined.m_planes[planeIndex].m_distance = distance;
+	}
+
+	return combined;
+}
+
+FrustumTestResult ViewFrustum::TestAABB3(AABB3 const& bounds) const
+{
+	if (!m_isValid)
+	{
+		return FrustumTestResult::INSIDE;
+	}
+
+	FrustumTestResult result = FrustumTestResult::INSIDE;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; planeIndex++)
+	{
+		Vec3 const& normal = m_planes[planeIndex].m_normal;
+
+		// Only the box corners furthest along and against the normal need checking
+		Vec3 furthestInside(normal.x >= 0.f ? bounds.m_maxs.x : bounds.m_mins.x, normal.y >= 0.f ? bounds.m_maxs.y : bounds.m_mins.y, normal.z >= 0.f ? bounds.m_maxs.z : bounds.m_mins.z);
+		if (DotProduct3D(normal, furthestInside) < m_planes[planeIndex].m_distance)
+		{
+			return FrustumTestResult::OUTSIDE;
+		}
+
+		Vec3 furthestOutside(normal.x >= 0.f ? bounds.m_mins.x : bounds.m_maxs.x, normal.y >= 0.f ? bounds.m_mins.y : bounds.m_maxs.y, normal.z >= 0.f ? bounds.m_mins.z : bounds.m_maxs.z);
+		if (DotProduct3D(normal, furthestOutside) < m_planes[planeIndex].m_distance)
+		{
+			result = FrustumTestResult::INTERSECTING;
+		}
+	}
+
+	return result;
+}
+
+bool ViewFrustum::IsAABB3Visible(AABB3 const& bounds) const
+{
+	return TestAABB3(bounds) != FrustumTestResult::OUTSIDE;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+
+enum class FrustumTestResult
+{
+	OUTSIDE,
+	INTERSECTING,
+	INSIDE
+};
+
+// Points on the inner side of the plane satisfy DotProduct3D(m_normal, point) >= m_distance
+struct FrustumPlane
+{
+public:
+	Vec3 m_normal = Vec3::ZERO;
+	float m_distance = 0.f;
+};
+
+
+class ViewFrustum
+{
+public:
+	static ViewFrustum CreateFromFovAngles(Vec3 const& position, Vec3 const& fwd, Vec3 const& left, Vec3 const& up, float fovLeftRadians, float fovRightRadians, float fovUpRadians, float fovDownRadians, float nearDistance, float farDistance);
+	static ViewFrustum CreatePerspective(Vec3 const& position, EulerAngles const& orientation, float aspect, float fovDegrees, float nearDistance, float farDistance);
+	static ViewFrustum CreateCombined(ViewFrustum const* frustums, int numFrustums);
+
+	FrustumTestResult TestAABB3(AABB3 const& bounds) const;
+	bool IsAABB3Visible(AABB3 const& bounds) const;
+
+public:
+	static constexpr int NUM_PLANES = 6;
+	static constexpr int NUM_CORNERS = 8;
+
+	// An invalid frustum culls nothing, so views without one fall back to drawing everything
+	bool m_isValid = false;
+	FrustumPlane m_planes[NUM_PLANES];
+
+	// Only filled in for single views, a combined frustum has no corners of its own
+	Vec3 m_corners[NUM_CORNERS];
+};
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------------------------
+struct vs_input_t
+{
+	float3 localPosition : POSITION;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+	float3 localTangent : TANGENT;
+	float3 localBitangent : BITANGENT;
+	float3 localNormal : NORMAL;
+};
+
+//------------------------------------------------------------------------------------------------
+struct v2p_t
+{
+	float4 position : SV_Position;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+	float4 tangent : TANGENT;
+	float4 bitangent : BITANGENT;
+	float4 normal : NORMAL;
+	float3 worldPosition : WORLD_POSITION;
+};
+
+//------------------------------------------------------------------------------------------------
+cbuffer LightConstants : register(b1)
+{
+	float3 SunDirection;
+	float SunIntensity;
+	float AmbientIntensity;
+	float3 padding0;
+	float4x4 LightViewMatrix;
+	float4x4 LightProjectionMatrix;
+	float3 WorldEyePosition;
+};
+
+//------------------------------------------------------------------------------------------------
+cbuffer CameraConstants : register(b2)
+{
+	float4x4 ViewMatrix;
+	float4x4 ProjectionMatrix;
+};
+
+//------------------------------------------------------------------------------------------------
+cbuffer ArchiLeapShaderConstants : register(b4)
+{
+	float4 SkyColor;
+	float FogStartDistance;
+	float FogEndDistance;
+	float FogMaxAlpha;
+};
+
+//------------------------------------------------------------------------------------------------
+struct ParticleInstanceData
+{
+	float4 PositionAndSize;
+	float4 Color;
+};
+
+//------------------------------------------------------------------------------------------------
+// Must match ParticleRenderer::MAX_PARTICLES_PER_DRAW
+cbuffer ParticleInstanceConstants : register(b5)
+{
+	ParticleInstanceData Particles[2048];
+};
+
+//------------------------------------------------------------------------------------------------
+Texture2D diffuseTexture : register(t0);
+
+//------------------------------------------------------------------------------------------------
+SamplerState diffuseSampler : register(s0);
+
+//------------------------------------------------------------------------------------------------
+// A unit cube is replicated once per instance slot, and the slot index is carried in tangent.x
+v2p_t VertexMain(vs_input_t input)
+{
+	uint instanceIndex = (uint)input.localTangent.x;
+	float4 positionAndSize = Particles[instanceIndex].PositionAndSize;
+
+	float4 worldPosition = float4(positionAndSize.xyz + input.localPosition * positionAndSize.w, 1);
+	float4 viewPosition = mul(ViewMatrix, worldPosition);
+	float4 clipPosition = mul(ProjectionMatrix, viewPosition);
+
+	v2p_t v2p;
+	v2p.position = clipPosition;
+	v2p.color = input.color * Particles[instanceIndex].Color;
+	v2p.uv = input.uv;
+	v2p.tangent = float4(0, 0, 0, 0);
+	v2p.bitangent = float4(0, 0, 0, 0);
+	v2p.normal = float4(input.localNormal, 0);
+	v2p.worldPosition = worldPosition.xyz;
+	return v2p;
+}
+
+//------------------------------------------------------------------------------------------------
+// Particles are fullbright, so only the texture, vertex color and fog contribute
+float4 PixelMain(v2p_t input) : SV_Target0
+{
+	float4 textureColor = diffuseTexture.Sample(diffuseSampler, input.uv);
+	float4 vertexColor = input.color;
+	float4 color = textureColor * vertexColor;
+	clip(color.a - 0.01f);
+	
+	// Compute the fog
+	float3 dispCamToPixel = input.worldPosition.xyz - WorldEyePosition.xyz;
+	float distCamToPixel = length( dispCamToPixel );
+	float fogDensity = FogMaxAlpha * saturate( (distCamToPixel - FogStartDistance) / (FogEndDistance - FogStartDistance) );
+	float3 finalRGB = lerp( color.rgb, SkyColor.rgb, fogDensity );
+	float finalAlpha = saturate( color.a + fogDensity ); // fog can add opacity
+	float4 finalColor = float4( finalRGB, finalAlpha );
+	
+	return finalColor;
+}